@@ -80,16 +80,21 @@ void Controller::update(const Eigen::Vector3d& _targetPosition)
   // Get equation of motions
   Eigen::Vector3d x    = mEndEffector->getTransform().translation();
   Eigen::Vector3d dx   = mEndEffector->getLinearVelocity();
-  Eigen::MatrixXd invM = mRobot->getInvMassMatrix();                   // n x n
   Eigen::VectorXd Cg   = mRobot->getCoriolisAndGravityForces();        // n x 1
-  math::LinearJacobian Jv   = mEndEffector->getLinearJacobian();       // 3 x n
   math::LinearJacobian dJv  = mEndEffector->getLinearJacobianDeriv();  // 3 x n
   Eigen::VectorXd dq        = mRobot->getVelocities();                 // n x 1
 
-  // Compute operational space values
-  Eigen::MatrixXd A = Jv*invM;                 // 3 x n
-  Eigen::Vector3d b = /*-(A*Cg) + */dJv*dq;    // 3 x 1
-  Eigen::MatrixXd M2 = Jv*invM*Jv.transpose(); // 3 x 3
+  // Compute operational space values. The operational space inertia is
+  // computed recursively, without forming the inverse of the mass matrix.
+  const std::vector<const dynamics::JacobianNode*> task(1, mEndEffector);
+  const std::vector<Eigen::Vector3d> offsets;
+  Eigen::MatrixXd Jv;
+  mRobot->getWorldLinearJacobians(task, offsets, Jv);                  // 3 x n
+  Eigen::Vector3d b = dJv*dq;                                          // 3 x 1
+  Eigen::Matrix3d M2
+      = mRobot->getInvOperationalSpaceInertia(task, offsets, true);   // 3 x 3
+  Eigen::Matrix3d Lambda
+      = mRobot->getOperationalSpaceInertia(task, offsets, true);      // 3 x 3
 
   // Compute virtual operational space spring force at the end effector
   Eigen::Vector3d f = -mKp*(x - _targetPosition) - mKv*dx;
@@ -100,9 +105,9 @@ void Controller::update(const Eigen::Vector3d& _targetPosition)
   // Gravity compensation
   mForces = Cg;
 
-  // Compute joint space forces to acheive the desired acceleration by solving:
-  // A tau + b = desired_ddx
-  mForces += A.colPivHouseholderQr().solve(desired_ddx - b);
+  // Compute joint space forces to acheive the desired acceleration, i.e.,
+  // Jv * M^-1 * tau + b = desired_ddx
+  mForces += Jv.transpose() * Lambda * (desired_ddx - b);
 
   // Apply the joint space forces to the robot
   mRobot->setForces(mForces);
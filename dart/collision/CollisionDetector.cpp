@@ -38,24 +38,205 @@
 #include "dart/collision/CollisionDetector.h"
 
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <vector>
 
 #include "dart/common/Console.h"
+#include "dart/common/Parallel.h"
 #include "dart/dynamics/BodyNode.h"
+#include "dart/dynamics/Shape.h"
 #include "dart/dynamics/Skeleton.h"
 #include "dart/collision/CollisionNode.h"
+#include "dart/collision/dart/DARTCollide.h"
 
 namespace dart {
 namespace collision {
 
+namespace {
+
+/// Number of consecutive pairs that a narrow phase thread takes at once
+const size_t NARROW_PHASE_BLOCK_SIZE = 8;
+
+/// Twice the signed area of the triangle (_a, _b, _c) projected on the plane
+/// whose normal is _n
+double signedArea2(const Eigen::Vector3d& _a, const Eigen::Vector3d& _b,
+                   const Eigen::Vector3d& _c, const Eigen::Vector3d& _n) {
+  return (_b - _a).cross(_c - _a).dot(_n);
+}
+
+/// Select at most _maxNumContacts of the contacts listed in _group, which all
+/// belong to the same body pair
+void selectContactManifold(const std::vector<ContactRecord>& _contacts,
+                           const std::vector<size_t>& _group,
+                           size_t _maxNumContacts,
+                           std::vector<size_t>& _selected) {
+  const double eps = 1e-12;
+
+  _selected.clear();
+
+  Eigen::Vector3d normal = Eigen::Vector3d::Zero();
+  size_t deepest = _group[0];
+  for (size_t i = 0; i < _group.size(); ++i) {
+    const ContactRecord& contact = _contacts[_group[i]];
+    normal += contact.normal;
+    if (contact.penetrationDepth > _contacts[deepest].penetrationDepth)
+      deepest = _group[i];
+  }
+  if (normal.norm() < eps)
+    normal = _contacts[_group[0]].normal;
+  normal.normalize();
+
+  // The deepest point comes first
+  _selected.push_back(deepest);
+  if (_maxNumContacts == 1)
+    return;
+
+  // Then the point farthest from it in the contact plane
+  const Eigen::Vector3d& p0 = _contacts[deepest].point;
+  size_t farthest = deepest;
+  double maxDist = eps;
+  for (size_t i = 0; i < _group.size(); ++i) {
+    Eigen::Vector3d d = _contacts[_group[i]].point - p0;
+    d -= d.dot(normal) * normal;
+    if (d.squaredNorm() > maxDist) {
+      maxDist = d.squaredNorm();
+      farthest = _group[i];
+    }
+  }
+  if (farthest == deepest)
+    return;
+  _selected.push_back(farthest);
+
+  // Grow the polygon, kept counterclockwise about the normal, by the point
+  // that adds the largest area outside one of its edges
+  while (_selected.size() < _maxNumContacts) {
+    double bestArea = eps;
+    size_t bestContact = 0;
+    size_t bestEdge = 0;
+    for (size_t i = 0; i < _group.size(); ++i) {
+      const size_t candidate = _group[i];
+      if (std::find(_selected.begin(), _selected.end(), candidate)
+          != _selected.end()) {
+        continue;
+      }
+
+      for (size_t j = 0; j < _selected.size(); ++j) {
+        const double area = -signedArea2(
+            _contacts[_selected[j]].point,
+            _contacts[_selected[(j + 1) % _selected.size()]].point,
+            _contacts[candidate].point, normal);
+        if (area > bestArea) {
+          bestArea = area;
+          bestContact = candidate;
+          bestEdge = j;
+        }
+      }
+    }
+
+    if (bestArea <= eps)
+      break;
+
+    _selected.insert(_selected.begin() + bestEdge + 1, bestContact);
+  }
+}
+
+/// Return the collision shape of _bodyNode that _shape points to
+dynamics::ShapePtr findCollisionShape(dynamics::BodyNode* _bodyNode,
+                                      const dynamics::Shape* _shape) {
+  for (size_t i = 0; i < _bodyNode->getNumCollisionShapes(); ++i) {
+    dynamics::ShapePtr shape = _bodyNode->getCollisionShape(i);
+    if (shape.get() == _shape)
+      return shape;
+  }
+
+  return nullptr;
+}
+
+/// Axis-aligned bounding box w.r.t. the world frame
+struct WorldAabb {
+  Eigen::Vector3d min;
+  Eigen::Vector3d max;
+};
+
+/// Return the world bounding box of _shape placed by _T. Planes are unbounded.
+WorldAabb computeWorldAabb(const dynamics::Shape* _shape,
+                           const Eigen::Isometry3d& _T) {
+  WorldAabb aabb;
+  if (_shape->getShapeType() == dynamics::Shape::PLANE) {
+    aabb.min.setConstant(-std::numeric_limits<double>::infinity());
+    aabb.max.setConstant(std::numeric_limits<double>::infinity());
+    return aabb;
+  }
+
+  const math::BoundingBox& box = _shape->getBoundingBox();
+  const Eigen::Vector3d center = _T * box.computeCenter();
+  const Eigen::Vector3d halfExtents
+      = _T.linear().cwiseAbs() * box.computeHalfExtents();
+  aabb.min = center - halfExtents;
+  aabb.max = center + halfExtents;
+  return aabb;
+}
+
+/// Return the world bounding box of the collision shapes of _bodyNode
+WorldAabb computeWorldAabb(const dynamics::BodyNode* _bodyNode) {
+  WorldAabb aabb;
+  aabb.min.setConstant(std::numeric_limits<double>::infinity());
+  aabb.max.setConstant(-std::numeric_limits<double>::infinity());
+  for (size_t i = 0; i < _bodyNode->getNumCollisionShapes(); ++i) {
+    const dynamics::ConstShapePtr& shape = _bodyNode->getCollisionShape(i);
+    const WorldAabb shapeAabb = computeWorldAabb(
+        shape.get(), _bodyNode->getTransform() * shape->getLocalTransform());
+    aabb.min = aabb.min.cwiseMin(shapeAabb.min);
+    aabb.max = aabb.max.cwiseMax(shapeAabb.max);
+  }
+  return aabb;
+}
+
+/// Return the sum of the versions of the body nodes of _skeleton and of their
+/// collision shapes. The versions only grow, so the sum changes whenever any
+/// of them does.
+size_t computeSkeletonVersion(const dynamics::Skeleton* _skeleton) {
+  size_t version = 0;
+  for (size_t i = 0; i < _skeleton->getNumBodyNodes(); ++i) {
+    const dynamics::BodyNode* bodyNode = _skeleton->getBodyNode(i);
+    version += bodyNode->getVersion();
+    for (size_t j = 0; j < bodyNode->getNumCollisionShapes(); ++j)
+      version += bodyNode->getCollisionShape(j)->getVersion();
+  }
+  return version;
+}
+
+/// Return true if two bounding boxes overlap
+bool overlaps(const WorldAabb& _aabb1, const WorldAabb& _aabb2) {
+  return (_aabb1.min.array() <= _aabb2.max.array()).all()
+      && (_aabb2.min.array() <= _aabb1.max.array()).all();
+}
+
+/// Lower bound of the distance between the contents of two bounding boxes
+double computeAabbDistance(const WorldAabb& _aabb1, const WorldAabb& _aabb2) {
+  const Eigen::Vector3d gap = (_aabb2.min - _aabb1.max).cwiseMax(
+      _aabb1.min - _aabb2.max).cwiseMax(0.0);
+  return gap.norm();
+}
+
+}  // namespace
+
 CollisionDetector::CollisionDetector()
-  : mNumMaxContacts(100) {
+  : mNumMaxContacts(100),
+    mAreContactsUpdated(true),
+    mNumThreads(1),
+    mSweepAxis(0),
+    mMaxSweepExtent(0.0),
+    mIsBroadPhaseDirty(true) {
 }
 
 CollisionDetector::~CollisionDetector() {
   for (size_t i = 0; i < mCollisionNodes.size(); i++)
     delete mCollisionNodes[i];
+
+  for (auto& connection : mShapeRemovedConnections)
+    connection.second.disconnect();
 }
 
 //==============================================================================
@@ -129,8 +310,15 @@ void CollisionDetector::addCollisionSkeletonNode(dynamics::BodyNode* _bodyNode,
   mBodyCollisionMap[_bodyNode] = collNode;
 
   // Add collidable pairs for the collision node
-  mCollidablePairs.push_back(
-        std::vector<bool>(mCollisionNodes.size() - 1, true));
+  mCollidablePairs.resize(mCollisionNodes.size(), true);
+
+  // A removed shape may be freed and its address reused by another shape, so
+  // its separating directions must not outlive it
+  mShapeRemovedConnections[_bodyNode] = _bodyNode->onColShapeRemoved.connect(
+      [=](const dynamics::BodyNode*, dynamics::ConstShapePtr _shape)
+      { this->removeCachedDistances(_shape.get()); });
+
+  mIsBroadPhaseDirty = true;
 
   if (_isRecursive) {
     for (size_t i = 0; i < _bodyNode->getNumChildBodyNodes(); i++)
@@ -167,14 +355,14 @@ void CollisionDetector::removeCollisionSkeletonNode(
   // Delete collNode
   delete collNode;
 
+  // Forget the cached distance results, which may refer to the removed node
+  removeCachedDistances(_bodyNode);
+  mShapeRemovedConnections[_bodyNode].disconnect();
+  mShapeRemovedConnections.erase(_bodyNode);
+  mIsBroadPhaseDirty = true;
+
   // Update mCollidablePairs
-  for (size_t i = iCollNode + 1; i < mCollidablePairs.size(); ++i) {
-    for (size_t j = 0; j < iCollNode; ++j)
-      mCollidablePairs[i-1][j] = mCollidablePairs[i][j];
-    for (size_t j = iCollNode + 1; j < mCollidablePairs[i].size(); ++j)
-      mCollidablePairs[i-1][j-1] = mCollidablePairs[i][j];
-  }
-  mCollidablePairs.pop_back();
+  mCollidablePairs.remove(iCollNode);
 
   if (_isRecursive) {
     for (size_t i = 0; i < _bodyNode->getNumChildBodyNodes(); i++)
@@ -191,15 +379,114 @@ bool CollisionDetector::detectCollision(dynamics::BodyNode* _node1,
 }
 
 size_t CollisionDetector::getNumContacts() {
-  return mContacts.size();
+  return mContactRecords.size();
 }
 
 Contact& CollisionDetector::getContact(int _idx) {
-  return mContacts[_idx];
+  if (!mAreContactsUpdated) {
+    mContacts.resize(mContactRecords.size());
+    for (size_t i = 0; i < mContactRecords.size(); ++i) {
+      const ContactRecord& record = mContactRecords[i];
+      Contact& contact = mContacts[i];
+      contact.point = record.point;
+      contact.normal = record.normal;
+      contact.penetrationDepth = record.penetrationDepth;
+      contact.bodyNode1 = record.bodyNode1;
+      contact.bodyNode2 = record.bodyNode2;
+      contact.shape1 = findCollisionShape(record.bodyNode1, record.shape1);
+      contact.shape2 = findCollisionShape(record.bodyNode2, record.shape2);
+      contact.triID1 = record.triID1;
+      contact.triID2 = record.triID2;
+      contact.userData = record.userData;
+    }
+    mAreContactsUpdated = true;
+  }
+
+  // The constraint solver writes the contact forces to the records
+  Contact& contact = mContacts[_idx];
+  contact.force = mContactRecords[_idx].force;
+  return contact;
+}
+
+ContactRecord& CollisionDetector::getContactRecord(size_t _idx) {
+  return mContactRecords[_idx];
+}
+
+const std::vector<ContactRecord>& CollisionDetector::getContactRecords() const {
+  return mContactRecords;
+}
+
+void CollisionDetector::setContactRecords(
+    const std::vector<ContactRecord>& _records) {
+  mContactRecords = _records;
+  for (ContactRecord& record : mContactRecords)
+    record.userData = nullptr;
+  mAreContactsUpdated = false;
 }
 
 void CollisionDetector::clearAllContacts() {
-  mContacts.clear();
+  // The capacity of the buffer is kept for the next detection
+  mContactRecords.clear();
+  mAreContactsUpdated = false;
+}
+
+void CollisionDetector::clearContactHistory() {
+  // Nothing is carried over by default. The records are cleared without
+  // letting a subclass save their information.
+  CollisionDetector::clearAllContacts();
+}
+
+void CollisionDetector::reduceContacts(size_t _maxNumContactsPerPair) {
+  if (_maxNumContactsPerPair == 0
+      || mContactRecords.size() <= _maxNumContactsPerPair)
+    return;
+
+  // Group the contacts by body pair. The pairs are ordered since swapping the
+  // bodies flips the contact normals.
+  typedef std::pair<const dynamics::BodyNode*, const dynamics::BodyNode*>
+      BodyNodePair;
+  std::map<BodyNodePair, size_t> groupIndices;
+  std::vector<std::vector<size_t>> groups;
+  for (size_t i = 0; i < mContactRecords.size(); ++i) {
+    const BodyNodePair pair(mContactRecords[i].bodyNode1,
+                            mContactRecords[i].bodyNode2);
+    auto result = groupIndices.insert(std::make_pair(pair, groups.size()));
+    if (result.second)
+      groups.push_back(std::vector<size_t>());
+    groups[result.first->second].push_back(i);
+  }
+
+  std::vector<bool> keep(mContactRecords.size(), true);
+  std::vector<size_t> selected;
+  bool reduced = false;
+  for (const std::vector<size_t>& group : groups) {
+    if (group.size() <= _maxNumContactsPerPair)
+      continue;
+
+    selectContactManifold(mContactRecords, group, _maxNumContactsPerPair,
+                          selected);
+    for (size_t index : group) {
+      if (std::find(selected.begin(), selected.end(), index) == selected.end())
+        keep[index] = false;
+    }
+    reduced = true;
+  }
+
+  if (!reduced)
+    return;
+
+  // Compact the remaining contacts, preserving their order
+  size_t numKept = 0;
+  for (size_t i = 0; i < mContactRecords.size(); ++i) {
+    if (keep[i]) {
+      if (numKept != i)
+        mContactRecords[numKept] = mContactRecords[i];
+      ++numKept;
+    }
+  }
+  mContactRecords.erase(mContactRecords.begin() + numKept,
+                        mContactRecords.end());
+  mAreContactsUpdated = false;
 }
 
 int CollisionDetector::getNumMaxContacts() const {
@@ -210,6 +497,76 @@ void CollisionDetector::setNumMaxContacs(int _num) {
   mNumMaxContacts = _num;
 }
 
+void CollisionDetector::setNumThreads(size_t _numThreads) {
+  mNumThreads = _numThreads;
+}
+
+size_t CollisionDetector::getNumThreads() const {
+  return mNumThreads;
+}
+
+void CollisionDetector::runNarrowPhase(
+    const std::vector<CollisionNodePair>& _pairs,
+    const NarrowPhase& _narrowPhase) {
+  // Every thread should get at least one block of pairs
+  const size_t numBlocks = (_pairs.size() + NARROW_PHASE_BLOCK_SIZE - 1)
+                           / NARROW_PHASE_BLOCK_SIZE;
+  const size_t numThreads = common::getNumParallelThreads(mNumThreads,
+                                                          numBlocks);
+
+  if (numThreads <= 1) {
+    for (const CollisionNodePair& pair : _pairs)
+      _narrowPhase(pair.first, pair.second, &mContactRecords);
+    return;
+  }
+
+  // Range of the contacts of each pair in the buffer of the thread that
+  // tested it
+  struct PairContacts {
+    size_t mThread;
+    size_t mBegin;
+    size_t mEnd;
+  };
+  std::vector<PairContacts> pairContacts(_pairs.size());
+
+  if (mThreadContactRecords.size() < numThreads)
+    mThreadContactRecords.resize(numThreads);
+
+  // The cost of the pairs varies a lot, e.g., sphere-sphere versus
+  // mesh-mesh, so the threads take blocks of pairs as they become idle
+  // instead of being assigned a fixed share
+  std::atomic<size_t> nextBlock(0);
+  auto testPairs = [&](size_t _thread) {
+    std::vector<ContactRecord>& contacts = mThreadContactRecords[_thread];
+    contacts.clear();
+
+    for (size_t block = nextBlock++; block < numBlocks; block = nextBlock++) {
+      const size_t begin = block * NARROW_PHASE_BLOCK_SIZE;
+      const size_t end
+          = std::min(begin + NARROW_PHASE_BLOCK_SIZE, _pairs.size());
+      for (size_t i = begin; i < end; ++i) {
+        pairContacts[i].mThread = _thread;
+        pairContacts[i].mBegin = contacts.size();
+        _narrowPhase(_pairs[i].first, _pairs[i].second, &contacts);
+        pairContacts[i].mEnd = contacts.size();
+      }
+    }
+  };
+
+  common::parallelFor(numThreads, numThreads,
+                      [&](size_t _thread, size_t, size_t)
+                      { testPairs(_thread); });
+
+  // Merge the buffers in the order of the pairs
+  for (const PairContacts& range : pairContacts) {
+    const std::vector<ContactRecord>& contacts
+        = mThreadContactRecords[range.mThread];
+    mContactRecords.insert(mContactRecords.end(),
+                           contacts.begin() + range.mBegin,
+                           contacts.begin() + range.mEnd);
+  }
+}
+
 void CollisionDetector::enablePair(dynamics::BodyNode* _node1,
                                    dynamics::BodyNode* _node2) {
   CollisionNode* collisionNode1 = getCollisionNode(_node1);
@@ -230,56 +587,528 @@ void CollisionDetector::disablePair(dynamics::BodyNode* _node1,
 bool CollisionDetector::isCollidable(const CollisionNode* _node1,
                                      const CollisionNode* _node2)
 {
-  dynamics::BodyNode* bn1 = _node1->getBodyNode();
-  dynamics::BodyNode* bn2 = _node2->getBodyNode();
+  const dynamics::BodyNode* bn1 = _node1->getBodyNode();
+  const dynamics::BodyNode* bn2 = _node2->getBodyNode();
+
+  if (!bn1->isCollidable() || !bn2->isCollidable())
+    return false;
+
+  if (!(bn1->getCollisionCategory() & bn2->getCollisionMask())
+      || !(bn2->getCollisionCategory() & bn1->getCollisionMask()))
+    return false;
 
   if (!getPairCollidable(_node1, _node2))
     return false;
 
-  if (!bn1->isCollidable() || !bn2->isCollidable())
+  const dynamics::ConstSkeletonPtr skel = bn1->getSkeleton();
+  if (skel == bn2->getSkeleton())
+  {
+    return skel->isCollisionAllowed(bn1->getIndexInSkeleton(),
+                                    bn2->getIndexInSkeleton());
+  }
+
+  return true;
+}
+
+//==============================================================================
+bool CollisionDetector::isCollidable(const dynamics::BodyNode* _bodyNode1,
+                                     const dynamics::BodyNode* _bodyNode2)
+{
+  const CollisionNode* collisionNode1 = getCollisionNode(_bodyNode1);
+  const CollisionNode* collisionNode2 = getCollisionNode(_bodyNode2);
+  if (!collisionNode1 || !collisionNode2 || collisionNode1 == collisionNode2)
     return false;
 
-  if (bn1->getSkeleton() == bn2->getSkeleton())
+  return isCollidable(collisionNode1, collisionNode2);
+}
+
+//==============================================================================
+double CollisionDetector::computeDistance(dynamics::BodyNode* _bodyNode1,
+                                          dynamics::BodyNode* _bodyNode2,
+                                          DistanceResult* _result,
+                                          double _upperBound)
+{
+  CollisionNode* collisionNode1 = getCollisionNode(_bodyNode1);
+  CollisionNode* collisionNode2 = getCollisionNode(_bodyNode2);
+  if (!collisionNode1 || !collisionNode2)
   {
-    if (bn1->getSkeleton()->isEnabledSelfCollisionCheck())
+    dtwarn << "[CollisionDetector::computeDistance] Body nodes must be added "
+           << "to the collision detector before their distance is queried."
+           << std::endl;
+    return _upperBound;
+  }
+
+  return computeDistance(collisionNode1, collisionNode2, _result,
+                         _upperBound);
+}
+
+//==============================================================================
+double CollisionDetector::computeDistance(dynamics::BodyNode* _bodyNode,
+                                          DistanceResult* _result,
+                                          double _upperBound)
+{
+  CollisionNode* collisionNode = getCollisionNode(_bodyNode);
+  if (!collisionNode)
+  {
+    dtwarn << "[CollisionDetector::computeDistance] Body node ["
+           << _bodyNode->getName() << "] must be added to the collision "
+           << "detector before its distance is queried." << std::endl;
+    return _upperBound;
+  }
+
+  double minDistance = _upperBound;
+  const CollisionNode* closestNode = nullptr;
+
+  // The closest body node of the previous query is likely to be the closest
+  // one again, and gives a tight bound for pruning the others
+  const auto cached = mClosestBodyNodes.find(_bodyNode);
+  CollisionNode* cachedNode = nullptr;
+  if (cached != mClosestBodyNodes.end())
+  {
+    cachedNode = getCollisionNode(cached->second);
+    if (cachedNode && isCollidable(collisionNode, cachedNode))
     {
-      if (isAdjacentBodies(bn1, bn2))
+      const double distance = computeDistance(collisionNode, cachedNode,
+                                              _result, minDistance);
+      if (distance < minDistance)
       {
-        if (!bn1->getSkeleton()->isEnabledAdjacentBodyCheck())
-          return false;
+        minDistance = distance;
+        closestNode = cachedNode;
       }
     }
-    else
+  }
+
+  updateBroadPhase();
+
+  const WorldAabb aabb = computeWorldAabb(_bodyNode);
+
+  // Query _other unless _bound, a lower bound of its distance, shows that it
+  // cannot be the closest one
+  auto visit = [&](CollisionNode* _other, double _bound)
+  {
+    if (_bound >= minDistance || _other == collisionNode
+        || _other == cachedNode || !isCollidable(collisionNode, _other))
     {
-      return false;
+      return;
     }
+
+    const double distance = computeDistance(collisionNode, _other, _result,
+                                            minDistance);
+    if (distance < minDistance)
+    {
+      minDistance = distance;
+      closestNode = _other;
+    }
+  };
+
+  // The nodes that are not sorted, i.e., the moving and the unbounded ones
+  for (size_t i = 0; i < mUnsortedNodes.size() && minDistance > 0.0; ++i)
+  {
+    CollisionNode* other = mUnsortedNodes[i];
+    visit(other,
+          computeAabbDistance(aabb, computeWorldAabb(other->getBodyNode())));
   }
 
-  return true;
+  // The static nodes, visited outwards from the query box along the sweep
+  // axis. The gap along the axis bounds the distance from below and grows in
+  // both directions, so each direction ends at the first entry whose gap
+  // exceeds the best distance found so far.
+  const int axis = mSweepAxis;
+  const double infinity = std::numeric_limits<double>::infinity();
+  auto upper = std::lower_bound(
+      mStaticEntries.begin(), mStaticEntries.end(), aabb.min[axis],
+      [axis](const BroadPhaseEntry& _entry, double _value)
+      { return _entry.mMin[axis] < _value; });
+  auto lower = upper;
+  while (minDistance > 0.0)
+  {
+    const double upperGap = upper != mStaticEntries.end()
+        ? std::max(0.0, upper->mMin[axis] - aabb.max[axis]) : infinity;
+    const double lowerGap = lower != mStaticEntries.begin()
+        ? std::max(0.0, aabb.min[axis] - (lower - 1)->mMin[axis]
+                        - mMaxSweepExtent)
+        : infinity;
+    if (std::min(upperGap, lowerGap) >= minDistance)
+      break;
+
+    const BroadPhaseEntry& entry = upperGap <= lowerGap ? *upper++ : *--lower;
+    WorldAabb entryAabb;
+    entryAabb.min = entry.mMin;
+    entryAabb.max = entry.mMax;
+    visit(entry.mNode, computeAabbDistance(aabb, entryAabb));
+  }
+
+  if (closestNode)
+    mClosestBodyNodes[_bodyNode] = closestNode->getBodyNode();
+
+  return minDistance;
 }
 
 //==============================================================================
-bool CollisionDetector::containSkeleton(const dynamics::SkeletonPtr& _skeleton)
+bool CollisionDetector::checkCollision(
+    const std::vector<dynamics::BodyNode*>& _bodyNodes)
 {
-  for (std::vector<dynamics::SkeletonPtr>::const_iterator it = mSkeletons.begin();
-       it != mSkeletons.end(); ++it)
+  std::vector<CollisionNode*> queryNodes;
+  queryNodes.reserve(_bodyNodes.size());
+  for (dynamics::BodyNode* bodyNode : _bodyNodes)
   {
-    if ((*it) == _skeleton)
-      return true;
+    CollisionNode* collisionNode = getCollisionNode(bodyNode);
+    if (!collisionNode)
+    {
+      dtwarn << "[CollisionDetector::checkCollision] Body node ["
+             << bodyNode->getName() << "] is not in the collision detector."
+             << std::endl;
+      continue;
+    }
+
+    if (std::find(queryNodes.begin(), queryNodes.end(), collisionNode)
+        == queryNodes.end())
+    {
+      queryNodes.push_back(collisionNode);
+    }
+  }
+
+  updateBroadPhase();
+
+  // The query nodes are tested against each other separately
+  auto isQueryNode = [&queryNodes](const CollisionNode* _node)
+  {
+    return std::find(queryNodes.begin(), queryNodes.end(), _node)
+        != queryNodes.end();
+  };
+
+  std::vector<WorldAabb> queryAabbs;
+  queryAabbs.reserve(queryNodes.size());
+  for (const CollisionNode* node : queryNodes)
+    queryAabbs.push_back(computeWorldAabb(node->getBodyNode()));
+
+  // The query nodes against each other
+  for (size_t i = 0; i < queryNodes.size(); ++i)
+  {
+    for (size_t j = i + 1; j < queryNodes.size(); ++j)
+    {
+      if (overlaps(queryAabbs[i], queryAabbs[j])
+          && isCollidable(queryNodes[i], queryNodes[j])
+          && detectCollision(queryNodes[i], queryNodes[j], false))
+      {
+        return true;
+      }
+    }
+  }
+
+  // The query nodes against the nodes that are not sorted
+  for (CollisionNode* other : mUnsortedNodes)
+  {
+    if (isQueryNode(other))
+      continue;
+
+    const WorldAabb aabb = computeWorldAabb(other->getBodyNode());
+    for (size_t i = 0; i < queryNodes.size(); ++i)
+    {
+      if (overlaps(queryAabbs[i], aabb)
+          && isCollidable(queryNodes[i], other)
+          && detectCollision(queryNodes[i], other, false))
+      {
+        return true;
+      }
+    }
+  }
+
+  // The query nodes against the static nodes. Only the entries whose lower
+  // bounds lie within the largest extent below the query box can overlap it.
+  const int axis = mSweepAxis;
+  for (size_t i = 0; i < queryNodes.size(); ++i)
+  {
+    const WorldAabb& aabb = queryAabbs[i];
+    const double lower = aabb.min[axis] - mMaxSweepExtent;
+    auto it = std::lower_bound(
+        mStaticEntries.begin(), mStaticEntries.end(), lower,
+        [axis](const BroadPhaseEntry& _entry, double _value)
+        { return _entry.mMin[axis] < _value; });
+    for (; it != mStaticEntries.end() && it->mMin[axis] <= aabb.max[axis];
+         ++it)
+    {
+      if ((it->mMin.array() <= aabb.max.array()).all()
+          && (aabb.min.array() <= it->mMax.array()).all()
+          && !isQueryNode(it->mNode)
+          && isCollidable(queryNodes[i], it->mNode)
+          && detectCollision(queryNodes[i], it->mNode, false))
+      {
+        return true;
+      }
+    }
   }
 
   return false;
 }
 
-bool isValidIndex(const std::vector<std::vector<bool>>& _collidablePairs,
-                  const std::size_t _index1,
-                  const std::size_t _index2)
+//==============================================================================
+void CollisionDetector::updateBroadPhase()
+{
+  // The skeletons that started and stopped moving since the last call
+  std::vector<const dynamics::Skeleton*> started;
+  std::vector<const dynamics::Skeleton*> stopped;
+
+  if (mIsBroadPhaseDirty)
+  {
+    // Track the skeletons of the current collision nodes, which all start out
+    // static
+    mSkeletonStates.clear();
+    mStaticEntries.clear();
+    mUnsortedNodes.clear();
+    mMaxSweepExtent = 0.0;
+    for (const CollisionNode* node : mCollisionNodes)
+    {
+      const dynamics::Skeleton* skeleton
+          = node->getBodyNode()->getSkeleton().get();
+      const auto it = std::find_if(
+          mSkeletonStates.begin(), mSkeletonStates.end(),
+          [skeleton](const SkeletonState& _state)
+          { return _state.mSkeleton == skeleton; });
+      if (it == mSkeletonStates.end())
+      {
+        SkeletonState state;
+        state.mSkeleton = skeleton;
+        state.mVersion = computeSkeletonVersion(skeleton);
+        state.mIsStatic = true;
+        mSkeletonStates.push_back(state);
+        stopped.push_back(skeleton);
+      }
+    }
+  }
+  else
+  {
+    // A skeleton is static as long as none of its body nodes moves or
+    // changes its collision shapes. The versions catch the changes that do
+    // not show in the positions, e.g., of the joint transforms or of the
+    // shape dimensions.
+    for (SkeletonState& state : mSkeletonStates)
+    {
+      const size_t version = computeSkeletonVersion(state.mSkeleton);
+      const bool isStatic = version == state.mVersion;
+      state.mVersion = version;
+
+      if (isStatic != state.mIsStatic)
+      {
+        state.mIsStatic = isStatic;
+        (isStatic ? stopped : started).push_back(state.mSkeleton);
+      }
+    }
+
+    if (started.empty() && stopped.empty())
+      return;
+  }
+
+  // Only the nodes of the skeletons that started or stopped moving are moved
+  // between the sorted entries and the unsorted nodes. The entries of the
+  // other static skeletons are still valid and stay sorted.
+  auto isIn = [](const std::vector<const dynamics::Skeleton*>& _skeletons,
+                 const CollisionNode* _node)
+  {
+    return std::find(_skeletons.begin(), _skeletons.end(),
+                     _node->getBodyNode()->getSkeleton().get())
+        != _skeletons.end();
+  };
+
+  if (!started.empty())
+  {
+    mStaticEntries.erase(
+        std::remove_if(mStaticEntries.begin(), mStaticEntries.end(),
+                       [&](const BroadPhaseEntry& _entry)
+                       { return isIn(started, _entry.mNode); }),
+        mStaticEntries.end());
+
+    const int axis = mSweepAxis;
+    mMaxSweepExtent = 0.0;
+    for (const BroadPhaseEntry& entry : mStaticEntries)
+    {
+      mMaxSweepExtent = std::max(mMaxSweepExtent,
+                                 entry.mMax[axis] - entry.mMin[axis]);
+    }
+  }
+
+  mUnsortedNodes.erase(
+      std::remove_if(mUnsortedNodes.begin(), mUnsortedNodes.end(),
+                     [&](const CollisionNode* _node)
+                     { return isIn(started, _node) || isIn(stopped, _node); }),
+      mUnsortedNodes.end());
+
+  std::vector<BroadPhaseEntry> newEntries;
+  for (CollisionNode* node : mCollisionNodes)
+  {
+    // The nodes of a changing skeleton may gain collision shapes without
+    // another update, so they are kept even if they have none yet
+    if (isIn(started, node))
+    {
+      mUnsortedNodes.push_back(node);
+      continue;
+    }
+
+    const dynamics::BodyNode* bodyNode = node->getBodyNode();
+    if (!isIn(stopped, node) || bodyNode->getNumCollisionShapes() == 0)
+      continue;
+
+    // Unbounded nodes, e.g., planes, would defeat the sweep
+    const WorldAabb aabb = computeWorldAabb(bodyNode);
+    if (!aabb.min.allFinite() || !aabb.max.allFinite())
+    {
+      mUnsortedNodes.push_back(node);
+      continue;
+    }
+
+    BroadPhaseEntry entry;
+    entry.mNode = node;
+    entry.mMin = aabb.min;
+    entry.mMax = aabb.max;
+    newEntries.push_back(entry);
+  }
+
+  if (mIsBroadPhaseDirty)
+  {
+    // Sweep along the axis in which the boxes are spread the most
+    Eigen::Vector3d mean = Eigen::Vector3d::Zero();
+    Eigen::Vector3d meanSquared = Eigen::Vector3d::Zero();
+    for (const BroadPhaseEntry& entry : newEntries)
+    {
+      const Eigen::Vector3d center = 0.5 * (entry.mMin + entry.mMax);
+      mean += center;
+      meanSquared += center.cwiseProduct(center);
+    }
+    if (!newEntries.empty())
+    {
+      mean /= newEntries.size();
+      meanSquared /= newEntries.size();
+    }
+    (meanSquared - mean.cwiseProduct(mean)).maxCoeff(&mSweepAxis);
+
+    mIsBroadPhaseDirty = false;
+  }
+
+  // Sort the new entries and merge them into the sorted ones
+  const int axis = mSweepAxis;
+  const auto isLess = [axis](const BroadPhaseEntry& _a,
+                             const BroadPhaseEntry& _b)
+                      { return _a.mMin[axis] < _b.mMin[axis]; };
+  std::sort(newEntries.begin(), newEntries.end(), isLess);
+
+  for (const BroadPhaseEntry& entry : newEntries)
+  {
+    mMaxSweepExtent = std::max(mMaxSweepExtent,
+                               entry.mMax[axis] - entry.mMin[axis]);
+  }
+
+  const size_t numSortedEntries = mStaticEntries.size();
+  mStaticEntries.insert(mStaticEntries.end(), newEntries.begin(),
+                        newEntries.end());
+  std::inplace_merge(mStaticEntries.begin(),
+                     mStaticEntries.begin() + numSortedEntries,
+                     mStaticEntries.end(), isLess);
+}
+
+//==============================================================================
+double CollisionDetector::computeDistance(CollisionNode* _node1,
+                                          CollisionNode* _node2,
+                                          DistanceResult* _result,
+                                          double _upperBound)
 {
-  assert(_index1 >= _index2);
+  dynamics::BodyNode* bodyNode1 = _node1->getBodyNode();
+  dynamics::BodyNode* bodyNode2 = _node2->getBodyNode();
 
-  if (_collidablePairs.size() > _index1
-      && _collidablePairs[_index1].size() > _index2)
-    return true;
+  double minDistance = _upperBound;
+  for (size_t i = 0; i < bodyNode1->getNumCollisionShapes(); ++i)
+  {
+    const dynamics::ShapePtr& shape1 = bodyNode1->getCollisionShape(i);
+    const Eigen::Isometry3d T1
+        = bodyNode1->getTransform() * shape1->getLocalTransform();
+    const WorldAabb aabb1 = computeWorldAabb(shape1.get(), T1);
+
+    for (size_t j = 0; j < bodyNode2->getNumCollisionShapes(); ++j)
+    {
+      const dynamics::ShapePtr& shape2 = bodyNode2->getCollisionShape(j);
+      const Eigen::Isometry3d T2
+          = bodyNode2->getTransform() * shape2->getLocalTransform();
+      if (computeAabbDistance(aabb1, computeWorldAabb(shape2.get(), T2))
+          >= minDistance)
+      {
+        continue;
+      }
+
+      // Warm start with the separating direction of the last query
+      Eigen::Vector3d& direction = mSeparatingDirections.insert(
+          std::make_pair(std::make_pair(shape1.get(), shape2.get()),
+                         Eigen::Vector3d::Zero().eval())).first->second;
+      const bool hasDirection = !direction.isZero();
+
+      Eigen::Vector3d point1;
+      Eigen::Vector3d point2;
+      Eigen::Vector3d normal;
+      const double distance = collision::computeDistance(
+          shape1, T1, shape2, T2, &point1, &point2, &normal,
+          hasDirection ? &direction : nullptr);
+      if (distance < 0.0 || distance >= minDistance)
+        continue;
+
+      if (distance > 0.0)
+        direction = normal;
+
+      minDistance = distance;
+      if (_result)
+      {
+        _result->distance = distance;
+        _result->point1 = point1;
+        _result->point2 = point2;
+        _result->bodyNode1 = bodyNode1;
+        _result->bodyNode2 = bodyNode2;
+        _result->shape1 = shape1;
+        _result->shape2 = shape2;
+      }
+
+      if (minDistance <= 0.0)
+        return minDistance;
+    }
+  }
+
+  return minDistance;
+}
+
+//==============================================================================
+void CollisionDetector::removeCachedDistances(
+    const dynamics::BodyNode* _bodyNode)
+{
+  for (auto it = mClosestBodyNodes.begin(); it != mClosestBodyNodes.end();)
+  {
+    if (it->first == _bodyNode || it->second == _bodyNode)
+      it = mClosestBodyNodes.erase(it);
+    else
+      ++it;
+  }
+
+  for (size_t i = 0; i < _bodyNode->getNumCollisionShapes(); ++i)
+    removeCachedDistances(_bodyNode->getCollisionShape(i).get());
+}
+
+//==============================================================================
+void CollisionDetector::removeCachedDistances(const dynamics::Shape* _shape)
+{
+  for (auto it = mSeparatingDirections.begin();
+       it != mSeparatingDirections.end();)
+  {
+    if (it->first.first == _shape || it->first.second == _shape)
+      it = mSeparatingDirections.erase(it);
+    else
+      ++it;
+  }
+}
+
+//==============================================================================
+bool CollisionDetector::containSkeleton(const dynamics::SkeletonPtr& _skeleton)
+{
+  for (std::vector<dynamics::SkeletonPtr>::const_iterator it = mSkeletons.begin();
+       it != mSkeletons.end(); ++it)
+  {
+    if ((*it) == _skeleton)
+      return true;
+  }
 
   return false;
 }
@@ -289,21 +1118,19 @@ bool CollisionDetector::getPairCollidable(const CollisionNode* _node1,
 {
   assert(_node1 != _node2);
 
-  size_t index1 = _node1->getIndex();
-  size_t index2 = _node2->getIndex();
-
-  if (index1 < index2)
-    std::swap(index1, index2);
+  const size_t index1 = _node1->getIndex();
+  const size_t index2 = _node2->getIndex();
 
   // Index validity check. The indices are not valid if the body nodes are not
   // completely added to the collision detector yet.
-  if (!isValidIndex(mCollidablePairs, index1, index2))
+  if (index1 >= mCollidablePairs.getSize()
+      || index2 >= mCollidablePairs.getSize())
     return false;
 
   if (index1 == index2)
     return false;
-  
-  return mCollidablePairs[index1][index2];
+
+  return mCollidablePairs.get(index1, index2);
 }
 
 void CollisionDetector::setPairCollidable(const CollisionNode* _node1,
@@ -312,32 +1139,16 @@ void CollisionDetector::setPairCollidable(const CollisionNode* _node1,
 {
   assert(_node1 != _node2);
 
-  size_t index1 = _node1->getIndex();
-  size_t index2 = _node2->getIndex();
-
-  if (index1 < index2)
-    std::swap(index1, index2);
+  const size_t index1 = _node1->getIndex();
+  const size_t index2 = _node2->getIndex();
 
   // Index validity check. The indices are not valid if the body nodes are not
   // completely added to the collision detector yet.
-  if (!isValidIndex(mCollidablePairs, index1, index2))
+  if (index1 >= mCollidablePairs.getSize()
+      || index2 >= mCollidablePairs.getSize())
     return;
 
-  mCollidablePairs[index1][index2] = _val;
-}
-
-bool CollisionDetector::isAdjacentBodies(
-    const dynamics::BodyNode* _bodyNode1,
-    const dynamics::BodyNode* _bodyNode2) const
-{
-  if ((_bodyNode1->getParentBodyNode() == _bodyNode2)
-      || (_bodyNode2->getParentBodyNode() == _bodyNode1))
-  {
-    assert(_bodyNode1->getSkeleton() == _bodyNode2->getSkeleton());
-    return true;
-  }
-
-  return false;
+  mCollidablePairs.set(index1, index2, _val);
 }
 
 CollisionNode* CollisionDetector::getCollisionNode(
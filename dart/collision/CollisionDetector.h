@@ -38,11 +38,15 @@
 #ifndef DART_COLLISION_COLLISIONDETECTOR_H_
 #define DART_COLLISION_COLLISIONDETECTOR_H_
 
+#include <functional>
+#include <limits>
 #include <vector>
 #include <map>
 
 #include <Eigen/Dense>
 
+#include "dart/common/BitMatrix.h"
+#include "dart/common/Signal.h"
 #include "dart/collision/CollisionNode.h"
 #include "dart/dynamics/SmartPointer.h"
 
@@ -94,6 +98,77 @@ struct Contact {
   void* userData;
 };
 
+/// Compact contact information stored by the collision detectors. Unlike
+/// Contact, it refers to the colliding body nodes and shapes through raw
+/// pointers, so that recording and reading contacts involves neither
+/// reference counting nor locking. The body nodes and shapes are kept alive
+/// by the skeletons of the collision detector.
+struct ContactRecord {
+  // To get byte-aligned Eigen vectors
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /// Contact point w.r.t. the world frame
+  Eigen::Vector3d point;
+
+  /// Contact normal vector from bodyNode2 to bodyNode1 w.r.t. the world frame
+  Eigen::Vector3d normal;
+
+  /// Contact force acting on bodyNode1 w.r.t. the world frame
+  Eigen::Vector3d force;
+
+  /// Penetration depth
+  double penetrationDepth;
+
+  /// First colliding body node
+  dynamics::BodyNode* bodyNode1;
+
+  /// Second colliding body node
+  dynamics::BodyNode* bodyNode2;
+
+  /// Colliding shape of the first body node
+  const dynamics::Shape* shape1;
+
+  /// Colliding shape of the second body node
+  const dynamics::Shape* shape2;
+
+  /// Triangle of the first shape, if it is a mesh
+  int triID1;
+
+  /// Triangle of the second shape, if it is a mesh
+  int triID2;
+
+  /// User data
+  void* userData;
+};
+
+/// Result of a distance query
+struct DistanceResult {
+  // To get byte-aligned Eigen vectors
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /// Minimum distance between the body nodes, zero if they intersect
+  double distance;
+
+  /// Closest point on bodyNode1 w.r.t. the world frame. The closest points
+  /// are only meaningful if the distance is positive.
+  Eigen::Vector3d point1;
+
+  /// Closest point on bodyNode2 w.r.t. the world frame
+  Eigen::Vector3d point2;
+
+  /// First body node
+  dynamics::WeakBodyNodePtr bodyNode1;
+
+  /// Second body node
+  dynamics::WeakBodyNodePtr bodyNode2;
+
+  /// Shape of the first body node that contains point1
+  dynamics::ShapePtr shape1;
+
+  /// Shape of the second body node that contains point2
+  dynamics::ShapePtr shape2;
+};
+
 /// \brief class CollisionDetector
 class CollisionDetector
 {
@@ -143,14 +218,38 @@ public:
   bool detectCollision(dynamics::BodyNode* _node1, dynamics::BodyNode* _node2,
                        bool _calculateContactPoints);
 
-  /// \brief
+  /// Return the number of contacts found by the last detection
   size_t getNumContacts();
 
-  /// \brief
+  /// Return a contact as a Contact. The Contacts are built from the contact
+  /// records on the first call after each detection, which locks the body
+  /// nodes and copies the shape pointers, so prefer getContactRecord() in
+  /// scenes with many contacts. Changes of the returned contact are not
+  /// reflected in the records, but the contact force is kept up to date with
+  /// the record.
   Contact& getContact(int _idx);
 
-  /// \brief
-  void clearAllContacts();
+  /// Return the record of a contact
+  ContactRecord& getContactRecord(size_t _idx);
+
+  /// Return the records of all the contacts, stored contiguously
+  const std::vector<ContactRecord>& getContactRecords() const;
+
+  /// Replace the contacts of the last detection with _records, e.g., to
+  /// restore contacts saved with getContactRecords(). The user data of the
+  /// records is cleared, since it may refer to detector data that no longer
+  /// exists.
+  void setContactRecords(const std::vector<ContactRecord>& _records);
+
+  /// Clear the contacts of the last detection. Detectors that carry contact
+  /// information over to the next detection, e.g., the contact forces for
+  /// warm starting, save it here before the records are cleared.
+  virtual void clearAllContacts();
+
+  /// Clear the contacts of the last detection along with the contact
+  /// information that is carried over to the next detection, so that the
+  /// next detection does not depend on the previous ones
+  virtual void clearContactHistory();
 
   /// \brief
   int getNumMaxContacts() const;
@@ -158,16 +257,91 @@ public:
   /// \brief
   void setNumMaxContacs(int _num);
 
-  /// \brief
+  /// Set the number of threads that run the narrow phase of
+  /// detectCollision(). Zero uses as many threads as the hardware supports.
+  /// The contacts do not depend on the number of threads. The default is one.
+  void setNumThreads(size_t _numThreads);
+
+  /// Return the number of threads that run the narrow phase
+  size_t getNumThreads() const;
+
+  /// Reduce the contacts of every colliding body pair to at most
+  /// _maxNumContactsPerPair points. The deepest contact is kept first, and
+  /// the others are picked greedily to maximize the area of the contact
+  /// polygon in the plane of the pair's average contact normal. Zero leaves
+  /// the contacts untouched.
+  void reduceContacts(size_t _maxNumContactsPerPair);
+
+  /// Return true if the pair of collision nodes should be passed to the
+  /// narrow phase. The test consists of the collidable flags and the
+  /// collision category and mask bitfields of the body nodes, the pairs
+  /// disabled in this detector and, for body nodes of the same skeleton, the
+  /// allowed collision matrix of the skeleton.
   bool isCollidable(const CollisionNode* _node1, const CollisionNode* _node2);
 
+  /// Return true if the pair of body nodes should be checked for collision.
+  /// False is returned if either body node is not in this detector.
+  bool isCollidable(const dynamics::BodyNode* _bodyNode1,
+                    const dynamics::BodyNode* _bodyNode2);
+
+  /// Return the minimum distance between the collision shapes of two body
+  /// nodes, or zero if they intersect. The pair is queried even if it is not
+  /// collidable. Shape pairs that are not supported by the distance query,
+  /// i.e., non-convex shapes, are ignored. If the distance is not less than
+  /// _upperBound, the query stops early, _upperBound is returned and _result
+  /// is left unchanged.
+  double computeDistance(
+      dynamics::BodyNode* _bodyNode1, dynamics::BodyNode* _bodyNode2,
+      DistanceResult* _result = nullptr,
+      double _upperBound = std::numeric_limits<double>::infinity());
+
+  /// Return the minimum distance between _bodyNode and every body node it is
+  /// collidable with. The candidates are taken from the sweep-and-prune
+  /// structure of checkCollision(): the static body nodes are visited outwards
+  /// from _bodyNode along the sweep axis, and the search stops as soon as
+  /// none of the remaining ones can be closer than the best distance found so
+  /// far, or than _upperBound. The closest body node and separating
+  /// directions of previous queries are cached, so repeated queries of a
+  /// slowly moving scene are nearly constant time.
+  double computeDistance(
+      dynamics::BodyNode* _bodyNode,
+      DistanceResult* _result = nullptr,
+      double _upperBound = std::numeric_limits<double>::infinity());
+
+  /// Return true if any of _bodyNodes collides with a body node it is
+  /// collidable with. This query is meant for planners, which move a few body
+  /// nodes and test them against the rest of the scene: it stops at the first
+  /// collision and computes no contacts. The bounding boxes of the other body
+  /// nodes are kept across calls in a sweep-and-prune structure, which is
+  /// only updated for the skeletons whose body nodes moved or changed their
+  /// collision shapes since the last call.
+  bool checkCollision(const std::vector<dynamics::BodyNode*>& _bodyNodes);
+
 protected:
   /// \brief
   virtual bool detectCollision(CollisionNode* _node1, CollisionNode* _node2,
                                bool _calculateContactPoints) = 0;
 
-  /// \brief
-  std::vector<Contact> mContacts;
+  /// Pair of collision nodes to be tested by the narrow phase
+  typedef std::pair<CollisionNode*, CollisionNode*> CollisionNodePair;
+
+  /// Narrow phase test of a pair of collision nodes, which appends the
+  /// contacts found to the given buffer. It is called concurrently for
+  /// different pairs, so it must not modify any shared state.
+  typedef std::function<void(CollisionNode*, CollisionNode*,
+                             std::vector<ContactRecord>*)> NarrowPhase;
+
+  /// Run _narrowPhase on every pair of _pairs and append the contacts to
+  /// mContactRecords. The pairs are distributed over the threads set by
+  /// setNumThreads(), each of which collects its contacts in its own buffer.
+  /// The buffers are then merged in the order of _pairs, so the contacts are
+  /// the same as those of a serial run.
+  void runNarrowPhase(const std::vector<CollisionNodePair>& _pairs,
+                      const NarrowPhase& _narrowPhase);
+
+  /// Contacts found by the last detection. The buffer is reused across
+  /// detections.
+  std::vector<ContactRecord> mContactRecords;
 
   /// \brief
   std::vector<CollisionNode*> mCollisionNodes;
@@ -191,18 +365,101 @@ private:
                          const CollisionNode* _node2,
                          bool _val);
 
-  /// \brief Return true if _bodyNode1 and _bodyNode2 are adjacent bodies
-  bool isAdjacentBodies(const dynamics::BodyNode* _bodyNode1,
-                        const dynamics::BodyNode* _bodyNode2) const;
-
   /// \brief
   CollisionNode* getCollisionNode(const dynamics::BodyNode* _bodyNode);
 
+  /// Contacts built from mContactRecords by getContact()
+  std::vector<Contact> mContacts;
+
+  /// Whether mContacts corresponds to mContactRecords
+  bool mAreContactsUpdated;
+
+  /// Number of threads of the narrow phase, zero for the hardware threads
+  size_t mNumThreads;
+
+  /// Contact buffers of the narrow phase threads, reused across detections
+  std::vector<std::vector<ContactRecord>> mThreadContactRecords;
+
   /// \brief
   std::map<const dynamics::BodyNode*, CollisionNode*> mBodyCollisionMap;
 
-  /// \brief
-  std::vector<std::vector<bool> > mCollidablePairs;
+  /// Pairs of collision nodes, by index, that are enabled in this detector
+  common::BitMatrix mCollidablePairs;
+
+  /// Return the minimum distance between two collision nodes if it is less
+  /// than _upperBound, which is returned otherwise
+  double computeDistance(CollisionNode* _node1, CollisionNode* _node2,
+                         DistanceResult* _result, double _upperBound);
+
+  /// Separating directions of the shape pairs found by the distance queries,
+  /// used to warm start the next query of the same pair
+  std::map<std::pair<const dynamics::Shape*, const dynamics::Shape*>,
+           Eigen::Vector3d> mSeparatingDirections;
+
+  /// Closest body node found by the last one-versus-all distance query of
+  /// each body node
+  std::map<const dynamics::BodyNode*, const dynamics::BodyNode*>
+      mClosestBodyNodes;
+
+  /// Connections to the removal of the collision shapes of the body nodes,
+  /// which evict the separating directions of the removed shapes
+  std::map<const dynamics::BodyNode*, common::Connection>
+      mShapeRemovedConnections;
+
+  /// Remove the cached distance results that involve _bodyNode or any of its
+  /// collision shapes
+  void removeCachedDistances(const dynamics::BodyNode* _bodyNode);
+
+  /// Remove the cached separating directions that involve _shape
+  void removeCachedDistances(const dynamics::Shape* _shape);
+
+  /// Bounding box of a collision node w.r.t. the world frame, cached by
+  /// checkCollision()
+  struct BroadPhaseEntry
+  {
+    CollisionNode* mNode;
+    Eigen::Vector3d mMin;
+    Eigen::Vector3d mMax;
+  };
+
+  /// State of a skeleton at the last update of the broad phase
+  struct SkeletonState
+  {
+    const dynamics::Skeleton* mSkeleton;
+
+    /// Sum of the versions of the body nodes and of their collision shapes,
+    /// which changes whenever a body node moves or gains or loses a collision
+    /// shape, or a collision shape changes its geometry
+    size_t mVersion;
+
+    bool mIsStatic;
+  };
+
+  /// Split the collision nodes into the static ones, whose skeletons did not
+  /// change since the last call, and the others. Only the nodes of the
+  /// skeletons that started or stopped moving are moved between the two.
+  void updateBroadPhase();
+
+  /// States of the skeletons of the collision nodes
+  std::vector<SkeletonState> mSkeletonStates;
+
+  /// Static collision nodes sorted by the lower bound of their bounding boxes
+  /// along mSweepAxis
+  std::vector<BroadPhaseEntry> mStaticEntries;
+
+  /// Collision nodes that are tested against every query node, i.e., those
+  /// whose skeletons changed and the unbounded ones
+  std::vector<CollisionNode*> mUnsortedNodes;
+
+  /// Axis along which the static bounding boxes are sorted
+  int mSweepAxis;
+
+  /// Largest extent of the static bounding boxes along mSweepAxis
+  double mMaxSweepExtent;
+
+  /// Whether the broad phase must be rebuilt, e.g., since collision nodes
+  /// were added or removed
+  bool mIsBroadPhaseDirty;
 };
 
 }  // namespace collision
@@ -105,6 +105,101 @@ struct CollisionFilter : public btOverlapFilterCallback
   }
 };
 
+namespace {
+
+//==============================================================================
+/// Collects the contacts found by btCollisionWorld::contactPairTest
+struct ContactPairResultCallback
+    : public btCollisionWorld::ContactResultCallback
+{
+  explicit ContactPairResultCallback(std::vector<ContactRecord>* _contacts)
+    : mContacts(_contacts),
+      mIsColliding(false)
+  {
+  }
+
+  virtual btScalar addSingleResult(
+      btManifoldPoint& _cp,
+      const btCollisionObjectWrapper* _colObj0Wrap, int /*_partId0*/,
+      int /*_index0*/,
+      const btCollisionObjectWrapper* _colObj1Wrap, int /*_partId1*/,
+      int /*_index1*/)
+  {
+    // Points within the contact breaking threshold are reported as well
+    if (_cp.getDistance() > 0.0)
+      return 0;
+
+    mIsColliding = true;
+
+    if (mContacts)
+    {
+      const BulletUserData* userData0 = static_cast<const BulletUserData*>(
+          _colObj0Wrap->getCollisionObject()->getUserPointer());
+      const BulletUserData* userData1 = static_cast<const BulletUserData*>(
+          _colObj1Wrap->getCollisionObject()->getUserPointer());
+
+      ContactRecord contactPair;
+      contactPair.point            = convertVector3(_cp.getPositionWorldOnA());
+      contactPair.normal           = convertVector3(_cp.m_normalWorldOnB);
+      contactPair.force.setZero();
+      contactPair.penetrationDepth = -_cp.m_distance1;
+      contactPair.bodyNode1   = userData0->bodyNode;
+      contactPair.bodyNode2   = userData1->bodyNode;
+      contactPair.shape1      = userData0->shape.get();
+      contactPair.shape2      = userData1->shape.get();
+      contactPair.triID1      = 0;
+      contactPair.triID2      = 0;
+      // The manifold of contactPairTest is temporary
+      contactPair.userData    = nullptr;
+
+      mContacts->push_back(contactPair);
+    }
+
+    return 0;
+  }
+
+  /// Buffer for the contacts, nullptr if the contacts are not needed
+  std::vector<ContactRecord>* mContacts;
+
+  /// Whether any contact was found
+  bool mIsColliding;
+};
+
+//==============================================================================
+/// Store the contact force of a record in its persistent manifold point. The
+/// force is decomposed along the normal and a tangent basis of the normal,
+/// since Bullet keeps these three scalars when the point is refreshed.
+void storeContactForce(const ContactRecord& _record,
+                       btManifoldPoint* _manifoldPoint)
+{
+  const btVector3 normal = convertVector3(_record.normal);
+  const btVector3 force = convertVector3(_record.force);
+  btVector3 tangent1;
+  btVector3 tangent2;
+  btPlaneSpace1(normal, tangent1, tangent2);
+
+  _manifoldPoint->m_appliedImpulse         = force.dot(normal);
+  _manifoldPoint->m_appliedImpulseLateral1 = force.dot(tangent1);
+  _manifoldPoint->m_appliedImpulseLateral2 = force.dot(tangent2);
+}
+
+//==============================================================================
+/// Return the contact force stored in a persistent manifold point by
+/// storeContactForce(), which is zero for a new point
+Eigen::Vector3d loadContactForce(const btManifoldPoint& _manifoldPoint)
+{
+  btVector3 tangent1;
+  btVector3 tangent2;
+  btPlaneSpace1(_manifoldPoint.m_normalWorldOnB, tangent1, tangent2);
+
+  return convertVector3(
+        _manifoldPoint.m_normalWorldOnB * _manifoldPoint.m_appliedImpulse
+        + tangent1 * _manifoldPoint.m_appliedImpulseLateral1
+        + tangent2 * _manifoldPoint.m_appliedImpulseLateral2);
+}
+
+}  // namespace
+
 //==============================================================================
 BulletCollisionDetector::BulletCollisionDetector() : CollisionDetector()
 {
@@ -150,6 +245,59 @@ CollisionNode* BulletCollisionDetector::createCollisionNode(
   return collNode;
 }
 
+//==============================================================================
+void BulletCollisionDetector::removeCollisionSkeletonNode(
+    dynamics::BodyNode* _bodyNode, bool _isRecursive)
+{
+  for (size_t i = 0; i < mCollisionNodes.size(); ++i)
+  {
+    if (mCollisionNodes[i]->getBodyNode() != _bodyNode)
+      continue;
+
+    // The contact records may point to the manifolds destroyed along with
+    // the objects
+    clearAllContacts();
+
+    BulletCollisionNode* collNode
+        = static_cast<BulletCollisionNode*>(mCollisionNodes[i]);
+    for (int j = 0; j < collNode->getNumBulletCollisionObjects(); ++j)
+    {
+      mBulletCollisionWorld->removeCollisionObject(
+          collNode->getBulletCollisionObject(j));
+    }
+    break;
+  }
+
+  // The children are removed through this function as well
+  CollisionDetector::removeCollisionSkeletonNode(_bodyNode, _isRecursive);
+}
+
+//==============================================================================
+void BulletCollisionDetector::clearAllContacts()
+{
+  // Keep the contact forces in their manifold points, which Bullet refreshes
+  // and carries over while the points persist. The records must be cleared
+  // here, since the points they refer to may be removed or reordered by the
+  // next detection.
+  for (const ContactRecord& record : mContactRecords)
+  {
+    if (record.userData)
+      storeContactForce(record, static_cast<btManifoldPoint*>(record.userData));
+  }
+
+  CollisionDetector::clearAllContacts();
+}
+
+//==============================================================================
+void BulletCollisionDetector::clearContactHistory()
+{
+  CollisionDetector::clearAllContacts();
+
+  btDispatcher* dispatcher = mBulletCollisionWorld->getDispatcher();
+  for (int i = 0; i < dispatcher->getNumManifolds(); ++i)
+    dispatcher->getManifoldByIndexInternal(i)->clearManifold();
+}
+
 //==============================================================================
 bool BulletCollisionDetector::detectCollision(bool _checkAllCollisions,
                                               bool _calculateContactPoints)
@@ -165,19 +313,21 @@ bool BulletCollisionDetector::detectCollision(bool _checkAllCollisions,
   dispatchInfo.m_stepCount = 0;
   // dispatchInfo.m_debugDraw = getDebugDrawer();
 
+  // Clear mContactRecords which is the list of old contacts. Their forces are
+  // stored in their manifold points, unless the constraint solver already
+  // did so before this call.
+  clearAllContacts();
+
   // Collision detection
   mBulletCollisionWorld->performDiscreteCollisionDetection();
 //  std::cout << "Number of collision objects: "
 //            << collWorld->getNumCollisionObjects() << std::endl;
 
-  // Clear mContacts which is the list of old contacts
-  clearAllContacts();
-
   // Set all the body nodes are not in colliding
   for (size_t i = 0; i < mCollisionNodes.size(); i++)
     mCollisionNodes[i]->getBodyNode()->setColliding(false);
 
-  // Add all the contacts to mContacts
+  // Add all the contacts to mContactRecords
   int numManifolds = mBulletCollisionWorld->getDispatcher()->getNumManifolds();
   btDispatcher* dispatcher = mBulletCollisionWorld->getDispatcher();
   for (int i = 0; i < numManifolds; ++i)
@@ -197,23 +347,31 @@ bool BulletCollisionDetector::detectCollision(bool _checkAllCollisions,
     {
       btManifoldPoint& cp = contactManifold->getContactPoint(j);
 
-      Contact contactPair;
+      ContactRecord contactPair;
       contactPair.point            = convertVector3(cp.getPositionWorldOnA());
       contactPair.normal           = convertVector3(cp.m_normalWorldOnB);
+      contactPair.force            = loadContactForce(cp);
       contactPair.penetrationDepth = -cp.m_distance1;
       contactPair.bodyNode1   = userDataA->btCollNode->getBodyNode();
       contactPair.bodyNode2   = userDataB->btCollNode->getBodyNode();
+      contactPair.shape1      = userDataA->shape.get();
+      contactPair.shape2      = userDataB->shape.get();
+      contactPair.triID1      = 0;
+      contactPair.triID2      = 0;
+      // The persistent manifold point, which receives the contact force
+      // before the next detection
+      contactPair.userData    = &cp;
 
-      mContacts.push_back(contactPair);
+      mContactRecords.push_back(contactPair);
 
       // Set these two bodies are in colliding
-      contactPair.bodyNode1.lock()->setColliding(true);
-      contactPair.bodyNode2.lock()->setColliding(true);
+      contactPair.bodyNode1->setColliding(true);
+      contactPair.bodyNode2->setColliding(true);
     }
   }
 
   // Return true if there are contacts
-  return !mContacts.empty();
+  return !mContactRecords.empty();
 }
 
 //==============================================================================
@@ -221,8 +379,35 @@ bool BulletCollisionDetector::detectCollision(CollisionNode* _node1,
                                               CollisionNode* _node2,
                                               bool _calculateContactPoints)
 {
-  assert(false);
-  return false;
+  BulletCollisionNode* collNode1 = static_cast<BulletCollisionNode*>(_node1);
+  BulletCollisionNode* collNode2 = static_cast<BulletCollisionNode*>(_node2);
+  collNode1->updateBulletCollisionObjects();
+  collNode2->updateBulletCollisionObjects();
+
+  bool collision = false;
+
+  for (int i = 0; i < collNode1->getNumBulletCollisionObjects(); ++i)
+  {
+    for (int j = 0; j < collNode2->getNumBulletCollisionObjects(); ++j)
+    {
+      ContactPairResultCallback callback(
+          _calculateContactPoints ? &mContactRecords : nullptr);
+      mBulletCollisionWorld->contactPairTest(
+          collNode1->getBulletCollisionObject(i),
+          collNode2->getBulletCollisionObject(j),
+          callback);
+
+      if (callback.mIsColliding)
+      {
+        collision = true;
+
+        if (!_calculateContactPoints)
+          return true;
+      }
+    }
+  }
+
+  return collision;
 }
 
 }  // namespace collision
@@ -64,13 +64,33 @@ public:
   /// \copydoc CollisionDetector::createCollisionNode
   virtual CollisionNode* createCollisionNode(dynamics::BodyNode* _bodyNode);
 
+  /// Remove the Bullet collision objects of _bodyNode from the collision
+  /// world, along with their overlapping pairs and contact manifolds, and
+  /// then the collision node. The other objects are left untouched.
+  virtual void removeCollisionSkeletonNode(dynamics::BodyNode* _bodyNode,
+                                           bool _isRecursive = false);
+
+  /// Store the contact forces in their persistent manifold points, and then
+  /// clear the contacts
+  virtual void clearAllContacts();
+
+  /// Clear the contacts without storing their forces, and empty the
+  /// persistent contact manifolds so that the next detection neither carries
+  /// over contact points nor their forces
+  virtual void clearContactHistory();
+
   /// \copydoc CollisionDetector::detectCollision
+  ///
+  /// The contacts are taken from the persistent contact manifolds of Bullet.
+  /// The force of a contact point that persists from the previous detection
+  /// is carried over to its contact record, and can be used by the
+  /// constraint solver to warm start.
   virtual bool detectCollision(bool _checkAllCollisions,
                                bool _calculateContactPoints);
 
 protected:
-  // TODO(JS): Not implemented yet.
-  /// \copydoc CollisionDetector::detectCollision
+  /// Test the pair with btCollisionWorld::contactPairTest, which runs the
+  /// narrow phase of the pair only
   virtual bool detectCollision(CollisionNode* _node1, CollisionNode* _node2,
                                bool _calculateContactPoints);
 
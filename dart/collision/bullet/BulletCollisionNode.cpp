@@ -45,6 +45,7 @@
 #include "dart/dynamics/BoxShape.h"
 #include "dart/dynamics/EllipsoidShape.h"
 #include "dart/dynamics/CylinderShape.h"
+#include "dart/dynamics/CapsuleShape.h"
 #include "dart/dynamics/PlaneShape.h"
 #include "dart/dynamics/MeshShape.h"
 
@@ -124,6 +125,24 @@ BulletCollisionNode::BulletCollisionNode(dynamics::BodyNode* _bodyNode)
 
         break;
       }
+      case dynamics::Shape::CAPSULE:
+      {
+        const dynamics::CapsuleShape* capsule =
+            static_cast<const dynamics::CapsuleShape*>(shape.get());
+
+        btCapsuleShapeZ* btCapsule =
+            new btCapsuleShapeZ(capsule->getRadius(), capsule->getHeight());
+        btCollisionObject* btCollObj = new btCollisionObject();
+        btCollObj->setCollisionShape(btCapsule);
+        BulletUserData* userData = new BulletUserData;
+        userData->bodyNode = _bodyNode;
+        userData->shape = shape;
+        userData->btCollNode = this;
+        btCollObj->setUserPointer(userData);
+        mbtCollsionObjects.push_back(btCollObj);
+
+        break;
+      }
       case dynamics::Shape::PLANE:
       {
         const dynamics::PlaneShape* plane =
@@ -179,6 +198,22 @@ BulletCollisionNode::BulletCollisionNode(dynamics::BodyNode* _bodyNode)
 //==============================================================================
 BulletCollisionNode::~BulletCollisionNode()
 {
+  for (size_t i = 0; i < mbtCollsionObjects.size(); ++i)
+  {
+    btCollisionShape* shape = mbtCollsionObjects[i]->getCollisionShape();
+
+    // The triangles of a mesh are owned by the object, not by the shape
+    if (shape->getShapeType() == CONVEX_TRIANGLEMESH_SHAPE_PROXYTYPE)
+    {
+      delete static_cast<btConvexTriangleMeshShape*>(
+          shape)->getMeshInterface();
+    }
+
+    delete static_cast<BulletUserData*>(
+        mbtCollsionObjects[i]->getUserPointer());
+    delete shape;
+    delete mbtCollsionObjects[i];
+  }
 }
 
 //==============================================================================
@@ -36,12 +36,19 @@
 
 #include "dart/collision/dart/DARTCollide.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <memory>
 
 #include "dart/math/Helpers.h"
 #include "dart/dynamics/BoxShape.h"
 #include "dart/dynamics/EllipsoidShape.h"
 #include "dart/dynamics/CylinderShape.h"
+#include "dart/dynamics/CapsuleShape.h"
+#include "dart/dynamics/HeightmapShape.h"
+#include "dart/dynamics/MeshShape.h"
+#include "dart/dynamics/PlaneShape.h"
 #include "dart/dynamics/BodyNode.h"
 
 namespace dart {
@@ -1085,273 +1092,1021 @@ int collideSphereSphere(const double& _r0, const Eigen::Isometry3d& c0,
 
 }
 
-int collideCylinderSphere(const double& cyl_rad, const double& half_height, const Eigen::Isometry3d& T0,
-                          const double& sphere_rad, const Eigen::Isometry3d& T1,
-                          std::vector<Contact>* result)
+//==============================================================================
+// Helpers for the exact primitive routines below
+//==============================================================================
+
+namespace {
+
+/// Number of rim points sampled on each cap of an upright cylinder
+const int nCYLINDER_RIM_POINTS = 4;
+
+/// Maximum number of contacts between a convex hull and a plane
+const size_t nHULL_PLANE_CONTACTS = 4;
+
+/// Tilt of the directions used to sample the contact manifold of two convex
+/// shapes around the penetration normal
+const double CONVEX_MANIFOLD_TILT = 0.05;
+
+/// Flip the normals of the contacts appended to _result since _begin
+void flipNormals(std::vector<Contact>* _result, size_t _begin)
+{
+  for (size_t i = _begin; i < _result->size(); ++i)
+    (*_result)[i].normal = -(*_result)[i].normal;
+}
+
+/// Return true if _point is within 1e-3 of the point of a contact in _contacts
+bool hasContactNear(const std::vector<Contact>& _contacts,
+                    const Eigen::Vector3d& _point)
 {
-  Eigen::Vector3d center = T0.inverse() * T1.translation();
+  for (const Contact& contact : _contacts)
+  {
+    if ((contact.point - _point).squaredNorm() < 1e-6)
+      return true;
+  }
+
+  return false;
+}
+
+/// Push a contact whose deepest point _point on shape0 is _depth below the
+/// surface of shape1. The contact point is placed halfway between the
+/// surfaces.
+void pushContact(const Eigen::Vector3d& _point, const Eigen::Vector3d& _normal,
+                 double _depth, std::vector<Contact>* _result)
+{
+  Contact contact;
+  contact.point = _point + 0.5 * _depth * _normal;
+  contact.normal = _normal;
+  contact.penetrationDepth = _depth;
+  _result->push_back(contact);
+}
 
-  double dist = sqrt(center[0] * center[0] + center[1] * center[1]);
+/// Closest point on the segment [_p0, _p1] to _point
+Eigen::Vector3d closestPointOnSegment(const Eigen::Vector3d& _p0,
+                                      const Eigen::Vector3d& _p1,
+                                      const Eigen::Vector3d& _point)
+{
+  const Eigen::Vector3d d = _p1 - _p0;
+  const double dd = d.squaredNorm();
+  if (dd < DART_COLLISION_EPS * DART_COLLISION_EPS)
+    return _p0;
 
-  if ( dist < cyl_rad && std::abs(center[2]) < half_height + sphere_rad )
+  const double t = math::clip((_point - _p0).dot(d) / dd, 0.0, 1.0);
+  return _p0 + t * d;
+}
+
+/// Closest points between the segments [_p0, _p1] and [_q0, _q1] (Ericson,
+/// Real-Time Collision Detection, 5.1.9)
+void closestPointsOnSegments(const Eigen::Vector3d& _p0,
+                             const Eigen::Vector3d& _p1,
+                             const Eigen::Vector3d& _q0,
+                             const Eigen::Vector3d& _q1,
+                             Eigen::Vector3d& _c0, Eigen::Vector3d& _c1)
+{
+  const Eigen::Vector3d d0 = _p1 - _p0;
+  const Eigen::Vector3d d1 = _q1 - _q0;
+  const Eigen::Vector3d r = _p0 - _q0;
+  const double a = d0.squaredNorm();
+  const double e = d1.squaredNorm();
+  const double f = d1.dot(r);
+  const double eps = DART_COLLISION_EPS * DART_COLLISION_EPS;
+
+  double s = 0.0;
+  double t = 0.0;
+  if (a <= eps && e <= eps)
   {
-    Contact contact;
-    contact.penetrationDepth = 0.5 * (half_height + sphere_rad - math::sign(center[2]) * center[2]);
-    contact.point = T0 * Eigen::Vector3d(center[0], center[1], half_height - contact.penetrationDepth);
-    contact.normal = T0.linear() * Eigen::Vector3d(0.0, 0.0, math::sign(center[2]));
-    result->push_back(contact);
-    return 1;
+    // Both segments degenerate into points
+  }
+  else if (a <= eps)
+  {
+    t = math::clip(f / e, 0.0, 1.0);
   }
   else
   {
-    double penetration = 0.5 * (cyl_rad + sphere_rad - dist);
-    if ( penetration > 0.0 )
+    const double c = d0.dot(r);
+    if (e <= eps)
+    {
+      s = math::clip(-c / a, 0.0, 1.0);
+    }
+    else
     {
-      if ( std::abs(center[2]) > half_height )
+      const double b = d0.dot(d1);
+      const double denom = a * e - b * b;
+      if (denom > eps)
+        s = math::clip((b * f - c * e) / denom, 0.0, 1.0);
+
+      t = (b * s + f) / e;
+      if (t < 0.0)
       {
-        Eigen::Vector3d point = (Eigen::Vector3d(center[0], center[1], 0.0).normalized());
-        point *= cyl_rad;
-        point[2] = math::sign(center[2]) * half_height;
-        Eigen::Vector3d normal = point - center;
-        penetration = sphere_rad - normal.norm();
-        normal = (T0.linear() * normal).normalized();
-        point = T0 * point;
-
-        if (penetration > 0.0)
-        {
-          Contact contact;
-          contact.point = point;
-          contact.normal = normal;
-          contact.penetrationDepth = penetration;
-          result->push_back(contact);
-          return 1;
-        }
+        t = 0.0;
+        s = math::clip(-c / a, 0.0, 1.0);
       }
-      else // if( center[2] >= -half_height && center[2] <= half_height )
+      else if (t > 1.0)
       {
-        Eigen::Vector3d point = (Eigen::Vector3d(center[0], center[1], 0.0)).normalized();
-        Eigen::Vector3d normal = -(T0.linear() * point);
-        point *= (cyl_rad - penetration);
-        point[2] = center[2];
-        point = T0 * point;
-
-        Contact contact;
-        contact.point = point;
-        contact.normal = normal;
-        contact.penetrationDepth = penetration;
-        result->push_back(contact);
-        return 1;
+        t = 1.0;
+        s = math::clip((b - c) / a, 0.0, 1.0);
       }
     }
   }
-  return 0;
+
+  _c0 = _p0 + s * d0;
+  _c1 = _q0 + t * d1;
 }
 
-int collideCylinderPlane(const double& cyl_rad, const double& half_height, const Eigen::Isometry3d& T0,
-                         const Eigen::Vector3d& plane_normal, const Eigen::Isometry3d& T1,
-                         std::vector<Contact>* result)
+/// Collide two spheres given by their centers
+int collideSpherePoints(double _r0, const Eigen::Vector3d& _c0,
+                        double _r1, const Eigen::Vector3d& _c1,
+                        std::vector<Contact>* _result)
+{
+  return collideSphereSphere(_r0, Eigen::Isometry3d(Eigen::Translation3d(_c0)),
+                             _r1, Eigen::Isometry3d(Eigen::Translation3d(_c1)),
+                             _result);
+}
+
+/// Describe a convex primitive by its support mapping. Return false for
+/// shapes that are not convex primitives.
+bool getConvexSupport(const dynamics::Shape* _shape,
+                      const Eigen::Isometry3d& _T, ConvexSupport* _support)
 {
-  Eigen::Vector3d normal = T1.linear() * plane_normal;
-  Eigen::Vector3d Rx = T0.linear().rightCols(1);
-  Eigen::Vector3d Ry = normal - normal.dot(Rx) * Rx;
-  double mag = Ry.norm();
-  Ry.normalize();
-  if (mag < DART_COLLISION_EPS)
+  switch (_shape->getShapeType())
   {
-    if (std::abs(Rx[2]) > 1.0 - DART_COLLISION_EPS)
-      Ry = Eigen::Vector3d::UnitX();
-    else
-      Ry = (Eigen::Vector3d(Rx[1], -Rx[0], 0.0)).normalized();
+    case dynamics::Shape::BOX:
+    {
+      const auto* box = static_cast<const dynamics::BoxShape*>(_shape);
+      *_support = ConvexSupport(ConvexSupport::BOX, 0.5 * box->getSize(), _T);
+      return true;
+    }
+    case dynamics::Shape::ELLIPSOID:
+    {
+      const auto* ellipsoid
+          = static_cast<const dynamics::EllipsoidShape*>(_shape);
+      if (ellipsoid->isSphere())
+      {
+        *_support = ConvexSupport(ConvexSupport::POINT,
+                                  Eigen::Vector3d::Zero(), _T,
+                                  0.5 * ellipsoid->getSize()[0]);
+      }
+      else
+      {
+        *_support = ConvexSupport(ConvexSupport::ELLIPSOID,
+                                  0.5 * ellipsoid->getSize(), _T);
+      }
+      return true;
+    }
+    case dynamics::Shape::CYLINDER:
+    {
+      const auto* cylinder = static_cast<const dynamics::CylinderShape*>(_shape);
+      *_support = ConvexSupport(
+          ConvexSupport::CYLINDER,
+          Eigen::Vector3d(cylinder->getRadius(), cylinder->getRadius(),
+                          0.5 * cylinder->getHeight()), _T);
+      return true;
+    }
+    case dynamics::Shape::CAPSULE:
+    {
+      const auto* capsule = static_cast<const dynamics::CapsuleShape*>(_shape);
+      *_support = ConvexSupport(
+          ConvexSupport::SEGMENT,
+          Eigen::Vector3d(0.0, 0.0, 0.5 * capsule->getHeight()), _T,
+          capsule->getRadius());
+      return true;
+    }
+    case dynamics::Shape::MESH:
+    {
+      // Triangle-exact mesh collision is not supported by this detector
+      const auto* mesh = static_cast<const dynamics::MeshShape*>(_shape);
+      if (mesh->getCollisionMode() != dynamics::MeshShape::CONVEX_HULL
+          || mesh->getConvexHullVertices().empty())
+      {
+        return false;
+      }
+
+      *_support = ConvexSupport(mesh->getConvexHullVertices(),
+                                mesh->getConvexHullTriangles(), _T);
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+/// Return true if the core of the shape has flat faces or straight edges
+/// that can carry more than one contact point
+bool hasFlatFeatures(const ConvexSupport& _shape)
+{
+  return _shape.mType == ConvexSupport::BOX
+      || _shape.mType == ConvexSupport::CYLINDER
+      || _shape.mType == ConvexSupport::SEGMENT
+      || _shape.mType == ConvexSupport::HULL;
+}
+
+/// Return the radius of _shape if it is a sphere, or a negative value
+double getSphereRadius(const dynamics::Shape* _shape)
+{
+  if (_shape->getShapeType() != dynamics::Shape::ELLIPSOID)
+    return -1.0;
+
+  const auto* ellipsoid = static_cast<const dynamics::EllipsoidShape*>(_shape);
+  if (!ellipsoid->isSphere())
+    return -1.0;
+
+  return 0.5 * ellipsoid->getSize()[0];
+}
+
+}  // namespace
+
+//==============================================================================
+int collideCylinderSphere(const double& cyl_rad, const double& half_height,
+                          const Eigen::Isometry3d& T0,
+                          const double& sphere_rad, const Eigen::Isometry3d& T1,
+                          std::vector<Contact>* result)
+{
+  const Eigen::Vector3d center = T0.inverse() * T1.translation();
+  const double radial = std::sqrt(center[0] * center[0]
+                                  + center[1] * center[1]);
+
+  // Closest point of the solid cylinder to the center of the sphere
+  Eigen::Vector3d closest = center;
+  if (radial > cyl_rad)
+  {
+    closest[0] *= cyl_rad / radial;
+    closest[1] *= cyl_rad / radial;
   }
+  closest[2] = math::clip(center[2], -half_height, half_height);
+
+  const Eigen::Vector3d diff = closest - center;
+  const double dist = diff.norm();
 
-  Eigen::Vector3d Rz = Rx.cross(Ry);
-  Eigen::Isometry3d T;
-  T.linear().col(0) = Rx;
-  T.linear().col(1) = Ry;
-  T.linear().col(2) = Rz;
-  T.translation() = T0.translation();
+  if (dist > DART_COLLISION_EPS)
+  {
+    // The center of the sphere is outside of the cylinder
+    if (dist >= sphere_rad)
+      return 0;
+
+    const Eigen::Vector3d normal = T0.linear() * (diff / dist);
+    const double depth = sphere_rad - dist;
+    pushContact(T0 * closest, normal, depth, result);
+    return 1;
+  }
 
-  Eigen::Vector3d nn = T.linear().transpose() * normal;
-  Eigen::Vector3d pn = T.inverse() * T1.translation();
+  // The center of the sphere is inside of the cylinder: push it out through
+  // the nearest side or cap
+  Eigen::Vector3d localNormal;
+  double depth;
+  const double sideDepth = cyl_rad - radial;
+  const double capDepth = half_height - std::abs(center[2]);
+  if (sideDepth < capDepth && radial > DART_COLLISION_EPS)
+  {
+    localNormal << -center[0] / radial, -center[1] / radial, 0.0;
+    depth = sphere_rad + sideDepth;
+  }
+  else
+  {
+    localNormal << 0.0, 0.0, -math::sign(center[2]);
+    if (localNormal[2] == 0.0)
+      localNormal[2] = -1.0;
+    depth = sphere_rad + capDepth;
+  }
 
-  // four corners c0 = ( -h/2, -r ), c1 = ( +h/2, -r ), c2 = ( +h/2, +r ), c3 = ( -h/2, +r )
-  Eigen::Vector3d c[4] = {
-    Eigen::Vector3d(-half_height, -cyl_rad, 0.0),
-    Eigen::Vector3d(+half_height, -cyl_rad, 0.0),
-    Eigen::Vector3d(+half_height, +cyl_rad, 0.0),
-    Eigen::Vector3d(-half_height, +cyl_rad, 0.0) };
+  Contact contact;
+  contact.point = T1.translation();
+  contact.normal = T0.linear() * localNormal;
+  contact.penetrationDepth = depth;
+  result->push_back(contact);
+  return 1;
+}
 
-  double depth[4] = { (pn - c[0]).dot(nn), (pn - c[1]).dot(nn), (pn - c[2]).dot(nn), (pn - c[3]).dot(nn) };
+//==============================================================================
+int collideCylinderPlane(const double& cyl_rad, const double& half_height,
+                         const Eigen::Isometry3d& T0,
+                         const Eigen::Vector3d& plane_normal,
+                         const Eigen::Isometry3d& T1,
+                         std::vector<Contact>* result)
+{
+  return collideCylinderPlane(cyl_rad, half_height, T0,
+                              plane_normal, 0.0, T1, result);
+}
 
-  double penetration = -1.0;
-  int found = -1;
-  for (int i = 0; i < 4; i++)
+//==============================================================================
+int collideCylinderPlane(const double& cyl_rad, const double& half_height,
+                         const Eigen::Isometry3d& T0,
+                         const Eigen::Vector3d& plane_normal,
+                         const double& plane_offset,
+                         const Eigen::Isometry3d& T1,
+                         std::vector<Contact>* result)
+{
+  const Eigen::Vector3d normal = T1.linear() * plane_normal;
+  const double offset = plane_offset + normal.dot(T1.translation());
+
+  // Direction of the deepest rim points in the frame of the cylinder
+  const Eigen::Vector3d localNormal = T0.linear().transpose() * normal;
+  const double radial = std::sqrt(localNormal[0] * localNormal[0]
+                                  + localNormal[1] * localNormal[1]);
+
+  std::vector<Eigen::Vector2d> rimPoints;
+  if (radial < DART_COLLISION_EPS)
   {
-    if (depth[i] > penetration)
+    // Upright cylinder: the caps are parallel to the plane
+    for (int i = 0; i < nCYLINDER_RIM_POINTS; ++i)
     {
-      penetration = depth[i];
-      found = i;
+      const double angle = 2.0 * DART_PI * i / nCYLINDER_RIM_POINTS;
+      rimPoints.push_back(cyl_rad * Eigen::Vector2d(std::cos(angle),
+                                                    std::sin(angle)));
     }
   }
+  else
+  {
+    rimPoints.push_back(-cyl_rad / radial
+                        * Eigen::Vector2d(localNormal[0], localNormal[1]));
+  }
 
-  Eigen::Vector3d point;
+  int numContacts = 0;
+  for (int cap = -1; cap <= 1; cap += 2)
+  {
+    for (const Eigen::Vector2d& rim : rimPoints)
+    {
+      const Eigen::Vector3d point
+          = T0 * Eigen::Vector3d(rim[0], rim[1], cap * half_height);
+      const double depth = offset - normal.dot(point);
+      if (depth > 0.0)
+      {
+        pushContact(point, normal, depth, result);
+        ++numContacts;
+      }
+    }
+  }
 
-  if (std::abs(depth[found] - depth[(found+1)%4]) < DART_COLLISION_EPS)
-    point = T * (0.5 * (c[found] + c[(found+1)%4]));
-  else if (std::abs(depth[found] - depth[(found+3)%4]) < DART_COLLISION_EPS)
-    point = T * (0.5 * (c[found] + c[(found+3)%4]));
-  else
-    point = T * c[found];
+  return numContacts;
+}
+
+//==============================================================================
+int collideSpherePlane(const double& r0, const Eigen::Isometry3d& T0,
+                       const Eigen::Vector3d& plane_normal,
+                       const double& plane_offset,
+                       const Eigen::Isometry3d& T1,
+                       std::vector<Contact>* result)
+{
+  const Eigen::Vector3d normal = T1.linear() * plane_normal;
+  const double offset = plane_offset + normal.dot(T1.translation());
+  const double depth = r0 - (normal.dot(T0.translation()) - offset);
+  if (depth <= 0.0)
+    return 0;
+
+  pushContact(T0.translation() - r0 * normal, normal, depth, result);
+  return 1;
+}
+
+//==============================================================================
+int collideBoxPlane(const Eigen::Vector3d& size0, const Eigen::Isometry3d& T0,
+                    const Eigen::Vector3d& plane_normal,
+                    const double& plane_offset,
+                    const Eigen::Isometry3d& T1,
+                    std::vector<Contact>* result)
+{
+  const Eigen::Vector3d normal = T1.linear() * plane_normal;
+  const double offset = plane_offset + normal.dot(T1.translation());
+  const Eigen::Vector3d halfSize = 0.5 * size0;
 
-  if (penetration > 0.0)
+  // Collect the penetrating vertices
+  std::vector<std::pair<double, Eigen::Vector3d>> vertices;
+  for (int i = 0; i < 8; ++i)
   {
-    Contact contact;
-    contact.point = point;
-    contact.normal = normal;
-    contact.penetrationDepth = penetration;
-    result->push_back(contact);
-    return 1;
+    const Eigen::Vector3d vertex = T0 * Eigen::Vector3d(
+        (i & 1) ? halfSize[0] : -halfSize[0],
+        (i & 2) ? halfSize[1] : -halfSize[1],
+        (i & 4) ? halfSize[2] : -halfSize[2]);
+    const double depth = offset - normal.dot(vertex);
+    if (depth > 0.0)
+      vertices.push_back(std::make_pair(depth, vertex));
   }
 
-  return 0;
+  // At most one face of the box can rest on the plane; keep its four
+  // deepest vertices if the box is pushed further in
+  if (vertices.size() > 4)
+  {
+    std::partial_sort(vertices.begin(), vertices.begin() + 4, vertices.end(),
+                      [](const std::pair<double, Eigen::Vector3d>& _a,
+                         const std::pair<double, Eigen::Vector3d>& _b)
+                      { return _a.first > _b.first; });
+    vertices.resize(4);
+  }
+
+  for (const auto& vertex : vertices)
+    pushContact(vertex.second, normal, vertex.first, result);
+
+  return static_cast<int>(vertices.size());
 }
 
-int collide(dynamics::ConstShapePtr _shape0, const Eigen::Isometry3d& _T0,
-            dynamics::ConstShapePtr _shape1, const Eigen::Isometry3d& _T1,
-            std::vector<Contact>* _result)
+//==============================================================================
+int collideCapsulePlane(const double& cap_rad, const double& half_height,
+                        const Eigen::Isometry3d& T0,
+                        const Eigen::Vector3d& plane_normal,
+                        const double& plane_offset,
+                        const Eigen::Isometry3d& T1,
+                        std::vector<Contact>* result)
 {
-  dynamics::Shape::ShapeType LeftType = _shape0->getShapeType();
-  dynamics::Shape::ShapeType RightType = _shape1->getShapeType();
+  const Eigen::Vector3d normal = T1.linear() * plane_normal;
+  const double offset = plane_offset + normal.dot(T1.translation());
 
-  switch(LeftType)
+  int numContacts = 0;
+  for (int end = -1; end <= 1; end += 2)
   {
-    case dynamics::Shape::BOX:
+    const Eigen::Vector3d center
+        = T0 * Eigen::Vector3d(0.0, 0.0, end * half_height);
+    const double depth = cap_rad - (normal.dot(center) - offset);
+    if (depth > 0.0)
     {
-      const dynamics::BoxShape* box0 = static_cast<const dynamics::BoxShape*>(_shape0.get());
+      pushContact(center - cap_rad * normal, normal, depth, result);
+      ++numContacts;
+    }
+  }
 
-      switch(RightType)
-      {
-        case dynamics::Shape::BOX:
-        {
-          const dynamics::BoxShape* box1 = static_cast<const dynamics::BoxShape*>(_shape1.get());
-          return collideBoxBox(box0->getSize(), _T0,
-                               box1->getSize(), _T1, _result);
-        }
-        case dynamics::Shape::ELLIPSOID:
-        {
-          const dynamics::EllipsoidShape* ellipsoid1 = static_cast<const dynamics::EllipsoidShape*>(_shape1.get());
-          return collideBoxSphere(box0->getSize(), _T0,
-                                  ellipsoid1->getSize()[0] * 0.5, _T1,
-              _result);
-        }
-        case dynamics::Shape::CYLINDER:
-        {
-          //----------------------------------------------------------
-          // NOT SUPPORT CYLINDER
-          //----------------------------------------------------------
-          const dynamics::CylinderShape* cylinder1 = static_cast<const dynamics::CylinderShape*>(_shape1.get());
-
-          Eigen::Vector3d dimTemp(cylinder1->getRadius() * sqrt(2.0),
-                                  cylinder1->getRadius() * sqrt(2.0),
-                                  cylinder1->getHeight());
-          return collideBoxBox(box0->getSize(), _T0, dimTemp, _T1, _result);
-        }
-        default:
-          return false;
+  return numContacts;
+}
 
-          break;
-      }
+//==============================================================================
+int collideHullPlane(const std::vector<Eigen::Vector3d>& vertices,
+                     const Eigen::Isometry3d& T0,
+                     const Eigen::Vector3d& plane_normal,
+                     const double& plane_offset,
+                     const Eigen::Isometry3d& T1,
+                     std::vector<Contact>* result)
+{
+  const Eigen::Vector3d normal = T1.linear() * plane_normal;
+  const double offset = plane_offset + normal.dot(T1.translation());
+
+  std::vector<std::pair<double, Eigen::Vector3d>> penetrating;
+  for (const Eigen::Vector3d& vertex : vertices)
+  {
+    const Eigen::Vector3d point = T0 * vertex;
+    const double depth = offset - normal.dot(point);
+    if (depth > 0.0)
+      penetrating.push_back(std::make_pair(depth, point));
+  }
 
+  if (penetrating.empty())
+    return 0;
+
+  // A hull face resting on the plane may have many vertices. Keep the deepest
+  // one and then repeatedly the vertex farthest from the ones already kept.
+  std::vector<std::pair<double, Eigen::Vector3d>> selected;
+  std::vector<double> distances(penetrating.size(),
+                                std::numeric_limits<double>::infinity());
+  size_t next = 0;
+  for (size_t i = 1; i < penetrating.size(); ++i)
+  {
+    if (penetrating[i].first > penetrating[next].first)
+      next = i;
+  }
+  while (selected.size() < nHULL_PLANE_CONTACTS)
+  {
+    selected.push_back(penetrating[next]);
+    double farthest = DART_COLLISION_EPS;
+    bool found = false;
+    for (size_t i = 0; i < penetrating.size(); ++i)
+    {
+      distances[i] = std::min(distances[i],
+          (penetrating[i].second - penetrating[next].second).norm());
+      if (distances[i] > farthest)
+      {
+        farthest = distances[i];
+        next = i;
+        found = true;
+      }
+    }
+    if (!found)
       break;
+  }
+
+  for (const auto& vertex : selected)
+    pushContact(vertex.second, normal, vertex.first, result);
+
+  return static_cast<int>(selected.size());
+}
+
+//==============================================================================
+int collideCapsuleSphere(const double& cap_rad, const double& half_height,
+                         const Eigen::Isometry3d& T0,
+                         const double& sphere_rad, const Eigen::Isometry3d& T1,
+                         std::vector<Contact>* result)
+{
+  const Eigen::Vector3d axis = half_height * T0.linear().col(2);
+  const Eigen::Vector3d closest = closestPointOnSegment(
+      T0.translation() - axis, T0.translation() + axis, T1.translation());
+
+  return collideSpherePoints(cap_rad, closest, sphere_rad, T1.translation(),
+                             result);
+}
+
+//==============================================================================
+int collideCapsuleCapsule(const double& r0, const double& half_height0,
+                          const Eigen::Isometry3d& T0,
+                          const double& r1, const double& half_height1,
+                          const Eigen::Isometry3d& T1,
+                          std::vector<Contact>* result)
+{
+  const Eigen::Vector3d axis0 = half_height0 * T0.linear().col(2);
+  const Eigen::Vector3d axis1 = half_height1 * T1.linear().col(2);
+  const Eigen::Vector3d p0 = T0.translation() - axis0;
+  const Eigen::Vector3d p1 = T0.translation() + axis0;
+  const Eigen::Vector3d q0 = T1.translation() - axis1;
+  const Eigen::Vector3d q1 = T1.translation() + axis1;
+
+  const Eigen::Vector3d dir0 = T0.linear().col(2);
+  const Eigen::Vector3d dir1 = T1.linear().col(2);
+  if (half_height0 > DART_COLLISION_EPS && half_height1 > DART_COLLISION_EPS
+      && dir0.cross(dir1).squaredNorm() < DART_COLLISION_EPS)
+  {
+    // Parallel capsules touch along a line; report the ends of the overlap of
+    // their segments so that they can rest on each other
+    const double s0 = (q0 - T0.translation()).dot(dir0);
+    const double s1 = (q1 - T0.translation()).dot(dir0);
+    const double lo = std::max(-half_height0, std::min(s0, s1));
+    const double hi = std::min(half_height0, std::max(s0, s1));
+    if (hi - lo > DART_COLLISION_EPS)
+    {
+      int numContacts = 0;
+      for (const double s : {lo, hi})
+      {
+        const Eigen::Vector3d c0 = T0.translation() + s * dir0;
+        const Eigen::Vector3d c1 = closestPointOnSegment(q0, q1, c0);
+        numContacts += collideSpherePoints(r0, c0, r1, c1, result);
+      }
+      return numContacts;
     }
-    case dynamics::Shape::ELLIPSOID:
+  }
+
+  Eigen::Vector3d c0;
+  Eigen::Vector3d c1;
+  closestPointsOnSegments(p0, p1, q0, q1, c0, c1);
+
+  return collideSpherePoints(r0, c0, r1, c1, result);
+}
+
+//==============================================================================
+int collideConvexConvex(const ConvexSupport& shape0,
+                        const ConvexSupport& shape1,
+                        std::vector<Contact>* result)
+{
+  Contact deepest;
+  if (!collideConvex(shape0, shape1, &deepest))
+    return 0;
+
+  const Eigen::Vector3d& normal = deepest.normal;
+
+  // Sample the supporting features of both shapes around the penetration
+  // normal. A sampled point becomes a contact if it lies inside the other
+  // shape, which recovers the vertices of a resting face, the rim of a
+  // cylinder cap or the ends of a capsule.
+  std::vector<Contact> manifold;
+  if (hasFlatFeatures(shape0) || hasFlatFeatures(shape1))
+  {
+    Eigen::Vector3d tangent0;
+    int minAxis;
+    normal.cwiseAbs().minCoeff(&minAxis);
+    tangent0 = normal.cross(Eigen::Vector3d::Unit(minAxis)).normalized();
+    const Eigen::Vector3d tangent1 = normal.cross(tangent0);
+
+    // Depths are measured against the supporting planes of both shapes
+    const double top1 = normal.dot(shape1.getSupport(normal));
+    const double bottom0 = normal.dot(shape0.getSupport(-normal));
+
+    for (int i = 0; i < 4; ++i)
     {
-      const dynamics::EllipsoidShape* ellipsoid0 = static_cast<const dynamics::EllipsoidShape*>(_shape0.get());
+      const Eigen::Vector3d tilt = CONVEX_MANIFOLD_TILT
+          * ((i & 1 ? 1.0 : -1.0) * tangent0 + (i & 2 ? 1.0 : -1.0) * tangent1);
 
-      switch(RightType)
+      if (hasFlatFeatures(shape0))
       {
-        case dynamics::Shape::BOX:
+        const Eigen::Vector3d point
+            = shape0.getCoreSupport(-normal + tilt) - shape0.mMargin * normal;
+        const double depth = top1 - normal.dot(point);
+        if (depth > 0.0 && shape1.contains(point, DART_COLLISION_EPS)
+            && !hasContactNear(manifold, point + 0.5 * depth * normal))
         {
-          const dynamics::BoxShape* box1 = static_cast<const dynamics::BoxShape*>(_shape1.get());
-          return collideSphereBox(ellipsoid0->getSize()[0] * 0.5, _T0,
-                                  box1->getSize(), _T1,
-                                  _result);
+          pushContact(point, normal, depth, &manifold);
         }
-        case dynamics::Shape::ELLIPSOID:
-        {
-          const dynamics::EllipsoidShape* ellipsoid1 = static_cast<const dynamics::EllipsoidShape*>(_shape1.get());
-          return collideSphereSphere(ellipsoid0->getSize()[0] * 0.5, _T0,
-                                     ellipsoid1->getSize()[0] * 0.5, _T1,
-                                     _result);
-        }
-        case dynamics::Shape::CYLINDER:
+      }
+
+      if (hasFlatFeatures(shape1))
+      {
+        const Eigen::Vector3d point
+            = shape1.getCoreSupport(normal + tilt) + shape1.mMargin * normal;
+        const double depth = normal.dot(point) - bottom0;
+        if (depth > 0.0 && shape0.contains(point, DART_COLLISION_EPS)
+            && !hasContactNear(manifold, point - 0.5 * depth * normal))
         {
-          //----------------------------------------------------------
-          // NOT SUPPORT CYLINDER
-          //----------------------------------------------------------
-          const dynamics::CylinderShape* cylinder1 = static_cast<const dynamics::CylinderShape*>(_shape1.get());
-
-          Eigen::Vector3d dimTemp1(cylinder1->getRadius() * sqrt(2.0),
-                                   cylinder1->getRadius() * sqrt(2.0),
-                                   cylinder1->getHeight());
-          return collideSphereBox(
-                ellipsoid0->getSize()[0] * 0.5, _T0, dimTemp1, _T1, _result);
+          pushContact(point - depth * normal, normal, depth, &manifold);
         }
-        default:
-          return false;
-
-          break;
       }
-
-      break;
     }
-    case dynamics::Shape::CYLINDER:
+  }
+
+  if (manifold.size() < 2)
+  {
+    result->push_back(deepest);
+    return 1;
+  }
+
+  result->insert(result->end(), manifold.begin(), manifold.end());
+  return static_cast<int>(manifold.size());
+}
+
+//==============================================================================
+int collideConvexHeightmap(const ConvexSupport& shape0,
+                           const dynamics::HeightmapShape* heightmap1,
+                           const Eigen::Isometry3d& T1,
+                           std::vector<Contact>* result)
+{
+  // Bounds of the primitive in the frame of the heightmap
+  Eigen::Vector3d lower;
+  Eigen::Vector3d upper;
+  for (int i = 0; i < 3; ++i)
+  {
+    const Eigen::Vector3d axis = T1.linear().col(i);
+    lower[i] = axis.dot(shape0.getSupport(-axis) - T1.translation());
+    upper[i] = axis.dot(shape0.getSupport(axis) - T1.translation());
+  }
+
+  if (lower[2] > heightmap1->getMaxHeight())
+    return 0;
+
+  // Range of cells below the bounds
+  const Eigen::Vector2d& spacing = heightmap1->getSpacing();
+  const size_t numRows = heightmap1->getNumRows();
+  const size_t numCols = heightmap1->getNumCols();
+  const double originX = -0.5 * (numCols - 1) * spacing[0];
+  const double originY = -0.5 * (numRows - 1) * spacing[1];
+  const double col0 = std::floor((lower[0] - originX) / spacing[0]);
+  const double col1 = std::floor((upper[0] - originX) / spacing[0]);
+  const double row0 = std::floor((lower[1] - originY) / spacing[1]);
+  const double row1 = std::floor((upper[1] - originY) / spacing[1]);
+  if (col1 < 0.0 || row1 < 0.0 || col0 > numCols - 2.0 || row0 > numRows - 2.0)
+    return 0;
+
+  const size_t firstCol = static_cast<size_t>(std::max(col0, 0.0));
+  const size_t lastCol = static_cast<size_t>(std::min(col1, numCols - 2.0));
+  const size_t firstRow = static_cast<size_t>(std::max(row0, 0.0));
+  const size_t lastRow = static_cast<size_t>(std::min(row1, numRows - 2.0));
+
+  // The prisms reach below the primitive so that their top faces are always
+  // the closest features
+  const double bottom = std::min(lower[2], heightmap1->getMinHeight())
+                        - (upper[2] - lower[2]) - DART_COLLISION_EPS;
+
+  static const std::vector<Eigen::Vector3i> prismTriangles = {
+    Eigen::Vector3i(0, 1, 2), Eigen::Vector3i(3, 5, 4),
+    Eigen::Vector3i(0, 3, 4), Eigen::Vector3i(0, 4, 1),
+    Eigen::Vector3i(1, 4, 5), Eigen::Vector3i(1, 5, 2),
+    Eigen::Vector3i(2, 5, 3), Eigen::Vector3i(2, 3, 0)
+  };
+  std::vector<Eigen::Vector3d> prism(6);
+  std::vector<Contact> cellContacts;
+  std::vector<Contact> contacts;
+
+  for (size_t i = firstRow; i <= lastRow; ++i)
+  {
+    for (size_t j = firstCol; j <= lastCol; ++j)
     {
-      //----------------------------------------------------------
-      // NOT SUPPORT CYLINDER
-      //----------------------------------------------------------
-      const dynamics::CylinderShape* cylinder0 = static_cast<const dynamics::CylinderShape*>(_shape0.get());
-
-      Eigen::Vector3d dimTemp0(cylinder0->getRadius() * sqrt(2.0),
-                               cylinder0->getRadius() * sqrt(2.0),
-                               cylinder0->getHeight());
-      switch(RightType)
+      const Eigen::Vector3d v00 = heightmap1->getVertex(i, j);
+      const Eigen::Vector3d v01 = heightmap1->getVertex(i, j + 1);
+      const Eigen::Vector3d v10 = heightmap1->getVertex(i + 1, j);
+      const Eigen::Vector3d v11 = heightmap1->getVertex(i + 1, j + 1);
+
+      // Each cell is split along its diagonal into two counterclockwise
+      // triangles
+      const Eigen::Vector3d* triangles[2][3] = {
+        {&v00, &v01, &v11}, {&v00, &v11, &v10}
+      };
+
+      for (const auto& triangle : triangles)
       {
-        case dynamics::Shape::BOX:
-        {
-          const dynamics::BoxShape* box1 = static_cast<const dynamics::BoxShape*>(_shape1.get());
-          return collideBoxBox(dimTemp0, _T0, box1->getSize(), _T1, _result);
-        }
-        case dynamics::Shape::ELLIPSOID:
-        {
-          const dynamics::EllipsoidShape* ellipsoid1 = static_cast<const dynamics::EllipsoidShape*>(_shape1.get());
-          return collideBoxSphere(dimTemp0, _T0, ellipsoid1->getSize()[0] * 0.5, _T1, _result);
-        }
-        case dynamics::Shape::CYLINDER:
+        const Eigen::Vector3d& a = *triangle[0];
+        const Eigen::Vector3d& b = *triangle[1];
+        const Eigen::Vector3d& c = *triangle[2];
+        if (std::max(std::max(a[2], b[2]), c[2]) < lower[2])
+          continue;
+
+        for (size_t k = 0; k < 3; ++k)
         {
-          //----------------------------------------------------------
-          // NOT SUPPORT CYLINDER
-          //----------------------------------------------------------
-          const dynamics::CylinderShape* cylinder1 = static_cast<const dynamics::CylinderShape*>(_shape1.get());
-
-          Eigen::Vector3d dimTemp1(cylinder1->getRadius() * sqrt(2.0),
-                                   cylinder1->getRadius() * sqrt(2.0),
-                                   cylinder1->getHeight());
-          return collideBoxBox(dimTemp0, _T0, dimTemp1, _T1, _result);
+          prism[k] = *triangle[k];
+          prism[k + 3] = Eigen::Vector3d(prism[k][0], prism[k][1], bottom);
         }
-        default:
+
+        cellContacts.clear();
+        const ConvexSupport support1(prism, prismTriangles, T1);
+        if (collideConvexConvex(shape0, support1, &cellContacts) == 0)
+          continue;
+
+        // The sides of the prisms are not part of the surface, so every
+        // contact is expressed along the normal of the triangle
+        const Eigen::Vector3d normal
+            = T1.linear() * (b - a).cross(c - a).normalized();
+        const double surface = normal.dot(T1 * a);
+        for (const Contact& contact : cellContacts)
         {
-          return false;
+          const Eigen::Vector3d point = contact.point
+              - 0.5 * contact.penetrationDepth * contact.normal;
+          const double depth = surface - normal.dot(point);
+          if (depth > 0.0
+              && !hasContactNear(contacts, point + 0.5 * depth * normal))
+          {
+            pushContact(point, normal, depth, &contacts);
+          }
         }
       }
+    }
+  }
 
-      break;
+  result->insert(result->end(), contacts.begin(), contacts.end());
+  return static_cast<int>(contacts.size());
+}
+
+//==============================================================================
+int collideShapePlane(const dynamics::Shape* shape0,
+                      const Eigen::Isometry3d& T0,
+                      const dynamics::PlaneShape* plane1,
+                      const Eigen::Isometry3d& T1,
+                      std::vector<Contact>* result)
+{
+  const Eigen::Vector3d& normal = plane1->getNormal();
+  const double offset = plane1->getOffset();
+
+  switch (shape0->getShapeType())
+  {
+    case dynamics::Shape::BOX:
+    {
+      const auto* box0 = static_cast<const dynamics::BoxShape*>(shape0);
+      return collideBoxPlane(box0->getSize(), T0, normal, offset, T1, result);
+    }
+    case dynamics::Shape::ELLIPSOID:
+    {
+      const auto* ellipsoid0
+          = static_cast<const dynamics::EllipsoidShape*>(shape0);
+      if (ellipsoid0->isSphere())
+      {
+        return collideSpherePlane(0.5 * ellipsoid0->getSize()[0], T0,
+                                  normal, offset, T1, result);
+      }
+
+      const ConvexSupport support(ConvexSupport::ELLIPSOID,
+                                  0.5 * ellipsoid0->getSize(), T0);
+      const Eigen::Vector3d worldNormal = T1.linear() * normal;
+      const Eigen::Vector3d point = support.getSupport(-worldNormal);
+      const double depth = offset + worldNormal.dot(T1.translation())
+                           - worldNormal.dot(point);
+      if (depth <= 0.0)
+        return 0;
+
+      pushContact(point, worldNormal, depth, result);
+      return 1;
+    }
+    case dynamics::Shape::CYLINDER:
+    {
+      const auto* cylinder0
+          = static_cast<const dynamics::CylinderShape*>(shape0);
+      return collideCylinderPlane(cylinder0->getRadius(),
+                                  0.5 * cylinder0->getHeight(), T0,
+                                  normal, offset, T1, result);
+    }
+    case dynamics::Shape::CAPSULE:
+    {
+      const auto* capsule0 = static_cast<const dynamics::CapsuleShape*>(shape0);
+      return collideCapsulePlane(capsule0->getRadius(),
+                                 0.5 * capsule0->getHeight(), T0,
+                                 normal, offset, T1, result);
+    }
+    case dynamics::Shape::MESH:
+    {
+      const auto* mesh0 = static_cast<const dynamics::MeshShape*>(shape0);
+      if (mesh0->getCollisionMode() != dynamics::MeshShape::CONVEX_HULL)
+        return 0;
+
+      return collideHullPlane(mesh0->getConvexHullVertices(), T0,
+                              normal, offset, T1, result);
     }
     default:
-      return false;
+      return 0;
+  }
+}
 
-      break;
+//==============================================================================
+int collide(dynamics::ConstShapePtr _shape0, const Eigen::Isometry3d& _T0,
+            dynamics::ConstShapePtr _shape1, const Eigen::Isometry3d& _T1,
+            std::vector<Contact>* _result)
+{
+  const dynamics::Shape* shape0 = _shape0.get();
+  const dynamics::Shape* shape1 = _shape1.get();
+  const dynamics::Shape::ShapeType type0 = shape0->getShapeType();
+  const dynamics::Shape::ShapeType type1 = shape1->getShapeType();
+  const size_t begin = _result->size();
+
+  // Heightmaps against convex primitives
+  if (type1 == dynamics::Shape::HEIGHTMAP)
+  {
+    ConvexSupport support0(ConvexSupport::POINT, Eigen::Vector3d::Zero(), _T0);
+    if (!getConvexSupport(shape0, _T0, &support0))
+      return 0;
+
+    return collideConvexHeightmap(
+          support0, static_cast<const dynamics::HeightmapShape*>(shape1), _T1,
+          _result);
+  }
+
+  if (type0 == dynamics::Shape::HEIGHTMAP)
+  {
+    ConvexSupport support1(ConvexSupport::POINT, Eigen::Vector3d::Zero(), _T1);
+    if (!getConvexSupport(shape1, _T1, &support1))
+      return 0;
+
+    const int numContacts = collideConvexHeightmap(
+          support1, static_cast<const dynamics::HeightmapShape*>(shape0), _T0,
+          _result);
+    flipNormals(_result, begin);
+    return numContacts;
+  }
+
+  // Planes
+  if (type0 == dynamics::Shape::PLANE && type1 == dynamics::Shape::PLANE)
+    return 0;
+
+  if (type1 == dynamics::Shape::PLANE)
+  {
+    return collideShapePlane(
+          shape0, _T0, static_cast<const dynamics::PlaneShape*>(shape1), _T1,
+          _result);
+  }
+
+  if (type0 == dynamics::Shape::PLANE)
+  {
+    const int numContacts = collideShapePlane(
+          shape1, _T1, static_cast<const dynamics::PlaneShape*>(shape0), _T0,
+          _result);
+    flipNormals(_result, begin);
+    return numContacts;
+  }
+
+  // Closed-form routines
+  const double sphereRadius0 = getSphereRadius(shape0);
+  const double sphereRadius1 = getSphereRadius(shape1);
+
+  if (type0 == dynamics::Shape::BOX && type1 == dynamics::Shape::BOX)
+  {
+    const auto* box0 = static_cast<const dynamics::BoxShape*>(shape0);
+    const auto* box1 = static_cast<const dynamics::BoxShape*>(shape1);
+    return collideBoxBox(box0->getSize(), _T0, box1->getSize(), _T1, _result);
   }
+
+  if (sphereRadius0 > 0.0 && sphereRadius1 > 0.0)
+    return collideSphereSphere(sphereRadius0, _T0, sphereRadius1, _T1, _result);
+
+  if (type0 == dynamics::Shape::BOX && sphereRadius1 > 0.0)
+  {
+    const auto* box0 = static_cast<const dynamics::BoxShape*>(shape0);
+    return collideBoxSphere(box0->getSize(), _T0, sphereRadius1, _T1, _result);
+  }
+
+  if (sphereRadius0 > 0.0 && type1 == dynamics::Shape::BOX)
+  {
+    const auto* box1 = static_cast<const dynamics::BoxShape*>(shape1);
+    return collideSphereBox(sphereRadius0, _T0, box1->getSize(), _T1, _result);
+  }
+
+  if (type0 == dynamics::Shape::CYLINDER && sphereRadius1 > 0.0)
+  {
+    const auto* cylinder0 = static_cast<const dynamics::CylinderShape*>(shape0);
+    return collideCylinderSphere(cylinder0->getRadius(),
+                                 0.5 * cylinder0->getHeight(), _T0,
+                                 sphereRadius1, _T1, _result);
+  }
+
+  if (sphereRadius0 > 0.0 && type1 == dynamics::Shape::CYLINDER)
+  {
+    const auto* cylinder1 = static_cast<const dynamics::CylinderShape*>(shape1);
+    const int numContacts = collideCylinderSphere(
+          cylinder1->getRadius(), 0.5 * cylinder1->getHeight(), _T1,
+          sphereRadius0, _T0, _result);
+    flipNormals(_result, begin);
+    return numContacts;
+  }
+
+  if (type0 == dynamics::Shape::CAPSULE && sphereRadius1 > 0.0)
+  {
+    const auto* capsule0 = static_cast<const dynamics::CapsuleShape*>(shape0);
+    return collideCapsuleSphere(capsule0->getRadius(),
+                                0.5 * capsule0->getHeight(), _T0,
+                                sphereRadius1, _T1, _result);
+  }
+
+  if (sphereRadius0 > 0.0 && type1 == dynamics::Shape::CAPSULE)
+  {
+    const auto* capsule1 = static_cast<const dynamics::CapsuleShape*>(shape1);
+    const int numContacts = collideCapsuleSphere(
+          capsule1->getRadius(), 0.5 * capsule1->getHeight(), _T1,
+          sphereRadius0, _T0, _result);
+    flipNormals(_result, begin);
+    return numContacts;
+  }
+
+  if (type0 == dynamics::Shape::CAPSULE && type1 == dynamics::Shape::CAPSULE)
+  {
+    const auto* capsule0 = static_cast<const dynamics::CapsuleShape*>(shape0);
+    const auto* capsule1 = static_cast<const dynamics::CapsuleShape*>(shape1);
+    return collideCapsuleCapsule(
+          capsule0->getRadius(), 0.5 * capsule0->getHeight(), _T0,
+          capsule1->getRadius(), 0.5 * capsule1->getHeight(), _T1, _result);
+  }
+
+  // Remaining pairs of convex primitives go through GJK/EPA
+  ConvexSupport support0(ConvexSupport::POINT, Eigen::Vector3d::Zero(), _T0);
+  ConvexSupport support1(ConvexSupport::POINT, Eigen::Vector3d::Zero(), _T1);
+  if (getConvexSupport(shape0, _T0, &support0)
+      && getConvexSupport(shape1, _T1, &support1))
+  {
+    return collideConvexConvex(support0, support1, _result);
+  }
+
+  return 0;
+}
+
+//==============================================================================
+double computeDistance(dynamics::ConstShapePtr _shape0,
+                       const Eigen::Isometry3d& _T0,
+                       dynamics::ConstShapePtr _shape1,
+                       const Eigen::Isometry3d& _T1,
+                       Eigen::Vector3d* _point0, Eigen::Vector3d* _point1,
+                       Eigen::Vector3d* _normal, const Eigen::Vector3d* _guess)
+{
+  const dynamics::Shape* shape0 = _shape0.get();
+  const dynamics::Shape* shape1 = _shape1.get();
+  const dynamics::Shape::ShapeType type0 = shape0->getShapeType();
+  const dynamics::Shape::ShapeType type1 = shape1->getShapeType();
+
+  if (type0 == dynamics::Shape::PLANE)
+  {
+    if (type1 == dynamics::Shape::PLANE)
+      return -1.0;
+
+    Eigen::Vector3d guess;
+    if (_guess)
+      guess = -*_guess;
+    const double distance = computeDistance(_shape1, _T1, _shape0, _T0,
+                                            _point1, _point0, _normal,
+                                            _guess ? &guess : nullptr);
+    if (distance > 0.0 && _normal)
+      *_normal = -*_normal;
+
+    return distance;
+  }
+
+  ConvexSupport support0(ConvexSupport::POINT, Eigen::Vector3d::Zero(), _T0);
+  if (!getConvexSupport(shape0, _T0, &support0))
+    return -1.0;
+
+  // The point of the convex shape closest to a plane is its support point
+  // against the normal of the plane
+  if (type1 == dynamics::Shape::PLANE)
+  {
+    const auto* plane1 = static_cast<const dynamics::PlaneShape*>(shape1);
+    const Eigen::Vector3d normal = _T1.linear() * plane1->getNormal();
+    const double offset = plane1->getOffset() + normal.dot(_T1.translation());
+    const Eigen::Vector3d point = support0.getSupport(-normal);
+    const double distance = normal.dot(point) - offset;
+    if (distance <= 0.0)
+      return 0.0;
+
+    if (_point0)
+      *_point0 = point;
+    if (_point1)
+      *_point1 = point - distance * normal;
+    if (_normal)
+      *_normal = normal;
+
+    return distance;
+  }
+
+  ConvexSupport support1(ConvexSupport::POINT, Eigen::Vector3d::Zero(), _T1);
+  if (!getConvexSupport(shape1, _T1, &support1))
+    return -1.0;
+
+  // GJK works on the cores, so the margins are subtracted afterwards
+  Eigen::Vector3d core0;
+  Eigen::Vector3d core1;
+  const double coreDistance
+      = computeConvexDistance(support0, support1, &core0, &core1, _guess);
+  const double distance = coreDistance - support0.mMargin - support1.mMargin;
+  if (distance <= 0.0)
+    return 0.0;
+
+  const Eigen::Vector3d normal = (core0 - core1) / coreDistance;
+  if (_point0)
+    *_point0 = core0 - support0.mMargin * normal;
+  if (_point1)
+    *_point1 = core1 + support1.mMargin * normal;
+  if (_normal)
+    *_normal = normal;
+
+  return distance;
 }
 
 } // namespace collision
@@ -42,11 +42,14 @@
 #include <Eigen/Dense>
 
 #include "dart/collision/CollisionDetector.h"
+#include "dart/collision/dart/GJK.h"
 #include "dart/dynamics/Shape.h"
 
 namespace dart {
 namespace dynamics {
 class Shape;
+class PlaneShape;
+class HeightmapShape;
 }  // namespace dynamics
 }  // namespace dart
 
@@ -57,6 +60,22 @@ int collide(dart::dynamics::ConstShapePtr _shape0, const Eigen::Isometry3d& _T0,
             dart::dynamics::ConstShapePtr _shape1, const Eigen::Isometry3d& _T1,
             std::vector<Contact>* _result);
 
+/// Compute the distance between two shapes and write their closest points,
+/// expressed in the world frame, to _point0 and _point1 when given. _normal
+/// receives the unit separating direction pointing from _shape1 to _shape0,
+/// which stays accurate when the shapes almost touch. Zero is returned if the
+/// shapes intersect, and a negative value if the pair is not supported, i.e.,
+/// if either shape is not convex or both are planes. Passing the normal of a
+/// previous query of the same pair as _guess warm starts the computation.
+double computeDistance(dart::dynamics::ConstShapePtr _shape0,
+                       const Eigen::Isometry3d& _T0,
+                       dart::dynamics::ConstShapePtr _shape1,
+                       const Eigen::Isometry3d& _T1,
+                       Eigen::Vector3d* _point0 = nullptr,
+                       Eigen::Vector3d* _point1 = nullptr,
+                       Eigen::Vector3d* _normal = nullptr,
+                       const Eigen::Vector3d* _guess = nullptr);
+
 int collideBoxBox(const Eigen::Vector3d& size0, const Eigen::Isometry3d& T0,
                   const Eigen::Vector3d& size1, const Eigen::Isometry3d& T1,
                   std::vector<Contact>* result);
@@ -79,12 +98,84 @@ int collideCylinderSphere(
     const double& sphere_rad, const Eigen::Isometry3d& T1,
     std::vector<Contact>* result);
 
+/// Collide a cylinder with the plane through the origin of T1
 int collideCylinderPlane(
     const double& cyl_rad, const double& half_height,
     const Eigen::Isometry3d& T0,
     const Eigen::Vector3d& plane_normal, const Eigen::Isometry3d& T1,
     std::vector<Contact>* result);
 
+/// Collide a cylinder with the plane {x | plane_normal . x = plane_offset}
+/// given in the frame T1. The solid side of the plane is opposite to
+/// plane_normal.
+int collideCylinderPlane(
+    const double& cyl_rad, const double& half_height,
+    const Eigen::Isometry3d& T0,
+    const Eigen::Vector3d& plane_normal, const double& plane_offset,
+    const Eigen::Isometry3d& T1,
+    std::vector<Contact>* result);
+
+int collideSpherePlane(
+    const double& r0, const Eigen::Isometry3d& T0,
+    const Eigen::Vector3d& plane_normal, const double& plane_offset,
+    const Eigen::Isometry3d& T1,
+    std::vector<Contact>* result);
+
+int collideBoxPlane(
+    const Eigen::Vector3d& size0, const Eigen::Isometry3d& T0,
+    const Eigen::Vector3d& plane_normal, const double& plane_offset,
+    const Eigen::Isometry3d& T1,
+    std::vector<Contact>* result);
+
+int collideCapsulePlane(
+    const double& cap_rad, const double& half_height,
+    const Eigen::Isometry3d& T0,
+    const Eigen::Vector3d& plane_normal, const double& plane_offset,
+    const Eigen::Isometry3d& T1,
+    std::vector<Contact>* result);
+
+/// Collide the convex hull of a set of vertices with a plane. At most four
+/// well spread penetrating vertices are reported.
+int collideHullPlane(
+    const std::vector<Eigen::Vector3d>& vertices, const Eigen::Isometry3d& T0,
+    const Eigen::Vector3d& plane_normal, const double& plane_offset,
+    const Eigen::Isometry3d& T1,
+    std::vector<Contact>* result);
+
+int collideCapsuleSphere(
+    const double& cap_rad, const double& half_height,
+    const Eigen::Isometry3d& T0,
+    const double& sphere_rad, const Eigen::Isometry3d& T1,
+    std::vector<Contact>* result);
+
+int collideCapsuleCapsule(
+    const double& r0, const double& half_height0, const Eigen::Isometry3d& T0,
+    const double& r1, const double& half_height1, const Eigen::Isometry3d& T1,
+    std::vector<Contact>* result);
+
+/// Collide a primitive shape with a plane shape, where the normal of the
+/// contacts points from the plane to the primitive
+int collideShapePlane(
+    const dart::dynamics::Shape* shape0, const Eigen::Isometry3d& T0,
+    const dart::dynamics::PlaneShape* plane1, const Eigen::Isometry3d& T1,
+    std::vector<Contact>* result);
+
+/// Collide two convex primitives with GJK/EPA. Several contacts are reported
+/// when flat faces, cylinder caps or capsule sides rest on each other.
+int collideConvexConvex(
+    const ConvexSupport& shape0, const ConvexSupport& shape1,
+    std::vector<Contact>* result);
+
+/// Collide a convex primitive with a heightmap, where the normal of the
+/// contacts points from the heightmap to the primitive. Only the cells below
+/// the bounds of the primitive are visited, and each of their triangles is
+/// treated as a prism that is solid down to below the primitive.
+int collideConvexHeightmap(
+    const ConvexSupport& shape0,
+    const dart::dynamics::HeightmapShape* heightmap1,
+    const Eigen::Isometry3d& T1,
+    std::vector<Contact>* result);
+
 }  // namespace collision
 }  // namespace dart
 
@@ -45,6 +45,63 @@
 namespace dart {
 namespace collision {
 
+namespace {
+
+/// Append the contacts between the collision shapes of two collision nodes
+/// to _contacts
+void collideCollisionNodes(CollisionNode* _collNode1,
+                           CollisionNode* _collNode2,
+                           std::vector<ContactRecord>* _contacts) {
+  dynamics::BodyNode* BodyNode1 = _collNode1->getBodyNode();
+  dynamics::BodyNode* BodyNode2 = _collNode2->getBodyNode();
+  std::vector<Contact> contacts;
+
+  for (size_t k = 0; k < BodyNode1->getNumCollisionShapes(); k++) {
+    const dynamics::ShapePtr shape1 = BodyNode1->getCollisionShape(k);
+
+    for (size_t l = 0; l < BodyNode2->getNumCollisionShapes(); l++) {
+      const dynamics::ShapePtr shape2 = BodyNode2->getCollisionShape(l);
+      const size_t currContactNum = _contacts->size();
+
+      contacts.clear();
+      collide(shape1,
+              BodyNode1->getTransform() * shape1->getLocalTransform(),
+              shape2,
+              BodyNode2->getTransform() * shape2->getLocalTransform(),
+              &contacts);
+
+      for (const Contact& contact : contacts) {
+        // Skip the points that are repeated within this shape pair
+        bool isDuplicate = false;
+        for (size_t m = currContactNum; m < _contacts->size(); ++m) {
+          if (((*_contacts)[m].point - contact.point).squaredNorm() < 1e-6) {
+            isDuplicate = true;
+            break;
+          }
+        }
+        if (isDuplicate)
+          continue;
+
+        ContactRecord record;
+        record.point = contact.point;
+        record.normal = contact.normal;
+        record.force.setZero();
+        record.penetrationDepth = contact.penetrationDepth;
+        record.bodyNode1 = BodyNode1;
+        record.bodyNode2 = BodyNode2;
+        record.shape1 = shape1.get();
+        record.shape2 = shape2.get();
+        record.triID1 = 0;
+        record.triID2 = 0;
+        record.userData = nullptr;
+        _contacts->push_back(record);
+      }
+    }
+  }
+}
+
+}  // namespace
+
 DARTCollisionDetector::DARTCollisionDetector()
   : CollisionDetector() {
 }
@@ -61,79 +118,32 @@ bool DARTCollisionDetector::detectCollision(bool /*_checkAllCollisions*/,
                                             bool /*_calculateContactPoints*/) {
   clearAllContacts();
 
-  // Set all the body nodes are not in colliding
-  for (size_t i = 0; i < mCollisionNodes.size(); i++)
-    mCollisionNodes[i]->getBodyNode()->setColliding(false);
-
-  std::vector<Contact> contacts;
+  // Set all the body nodes are not in colliding. The transforms are updated
+  // here, since the narrow phase may read them from several threads.
+  for (size_t i = 0; i < mCollisionNodes.size(); i++) {
+    dynamics::BodyNode* bodyNode = mCollisionNodes[i]->getBodyNode();
+    bodyNode->setColliding(false);
+    bodyNode->getTransform();
+  }
 
+  std::vector<CollisionNodePair> pairs;
   for (size_t i = 0; i < mCollisionNodes.size(); i++) {
     for (size_t j = i + 1; j < mCollisionNodes.size(); j++) {
-      CollisionNode* collNode1 = mCollisionNodes[i];
-      CollisionNode* collNode2 = mCollisionNodes[j];
-      dynamics::BodyNode* BodyNode1 = collNode1->getBodyNode();
-      dynamics::BodyNode* BodyNode2 = collNode2->getBodyNode();
-
-      if (!isCollidable(collNode1, collNode2))
-        continue;
-
-      for (size_t k = 0; k < BodyNode1->getNumCollisionShapes(); k++) {
-        for (size_t l = 0; l < BodyNode2->getNumCollisionShapes(); l++) {
-          int currContactNum = mContacts.size();
-
-          contacts.clear();
-          collide(BodyNode1->getCollisionShape(k),
-                  BodyNode1->getTransform()
-                  * BodyNode1->getCollisionShape(k)->getLocalTransform(),
-                  BodyNode2->getCollisionShape(l),
-                  BodyNode2->getTransform()
-                  * BodyNode2->getCollisionShape(l)->getLocalTransform(),
-                  &contacts);
-
-          size_t numContacts = contacts.size();
-
-          for (unsigned int m = 0; m < numContacts; ++m) {
-            Contact contactPair;
-            contactPair = contacts[m];
-            contactPair.bodyNode1 = BodyNode1;
-            contactPair.bodyNode2 = BodyNode2;
-            assert(contactPair.bodyNode1.lock() != nullptr);
-            assert(contactPair.bodyNode2.lock() != nullptr);
-
-            mContacts.push_back(contactPair);
-          }
-
-          std::vector<bool> markForDeletion(numContacts, false);
-          for (size_t m = 0; m < numContacts; m++) {
-            for (size_t n = m + 1; n < numContacts; n++) {
-              Eigen::Vector3d diff =
-                  mContacts[currContactNum + m].point -
-                  mContacts[currContactNum + n].point;
-              if (diff.dot(diff) < 1e-6) {
-                markForDeletion[m] = true;
-                break;
-              }
-            }
-          }
-
-          for (int m = numContacts - 1; m >= 0; m--)
-          {
-            if (markForDeletion[m])
-              mContacts.erase(mContacts.begin() + currContactNum + m);
-          }
-        }
-      }
+      if (isCollidable(mCollisionNodes[i], mCollisionNodes[j]))
+        pairs.push_back(std::make_pair(mCollisionNodes[i], mCollisionNodes[j]));
     }
   }
 
-  for (size_t i = 0; i < mContacts.size(); ++i)
+  runNarrowPhase(pairs, &collideCollisionNodes);
+
+  for (const ContactRecord& record : mContactRecords)
   {
     // Set these two bodies are in colliding
-    mContacts[i].bodyNode1.lock()->setColliding(true);
-    mContacts[i].bodyNode2.lock()->setColliding(true);
+    record.bodyNode1->setColliding(true);
+    record.bodyNode2->setColliding(true);
   }
 
-  return !mContacts.empty();
+  return !mContactRecords.empty();
 }
 
 bool DARTCollisionDetector::detectCollision(CollisionNode* _collNode1,
@@ -144,18 +154,31 @@ bool DARTCollisionDetector::detectCollision(CollisionNode* _collNode1,
   dynamics::BodyNode* BodyNode2 = _collNode2->getBodyNode();
 
   for (size_t i = 0; i < BodyNode1->getNumCollisionShapes(); i++) {
+    const dynamics::ShapePtr shape1 = BodyNode1->getCollisionShape(i);
+    const Eigen::Isometry3d T1
+        = BodyNode1->getTransform() * shape1->getLocalTransform();
+
     for (size_t j = 0; j < BodyNode2->getNumCollisionShapes(); j++) {
-      collide(BodyNode1->getCollisionShape(i),
-              BodyNode1->getTransform()
-              * BodyNode1->getCollisionShape(i)->getLocalTransform(),
-              BodyNode2->getCollisionShape(j),
-              BodyNode2->getTransform()
-              * BodyNode2->getCollisionShape(j)->getLocalTransform(),
-              &contacts);
+      const dynamics::ShapePtr shape2 = BodyNode2->getCollisionShape(j);
+      const Eigen::Isometry3d T2
+          = BodyNode2->getTransform() * shape2->getLocalTransform();
+
+      // The contacts are not reported, so GJK alone decides convex pairs
+      const double distance
+          = collision::computeDistance(shape1, T1, shape2, T2);
+      if (distance >= 0.0) {
+        if (distance == 0.0)
+          return true;
+        continue;
+      }
+
+      contacts.clear();
+      if (collide(shape1, T1, shape2, T2, &contacts) > 0)
+        return true;
     }
   }
 
-  return contacts.size() > 0 ? true : false;
+  return false;
 }
 
 }  // namespace collision
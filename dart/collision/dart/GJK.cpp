@@ -0,0 +1,831 @@
+/*
+ * Copyright (c) 2016, Georgia Tech Research Corporation
+ * All rights reserved.
+ *
+ * Author(s): Jeongseok Lee <jslee02@gmail.com>
+ *
+ * Georgia Tech Graphics Lab and Humanoid Robotics Lab
+ *
+ * Directed by Prof. C. Karen Liu and Prof. Mike Stilman
+ * <karenliu@cc.gatech.edu> <mstilman@cc.gatech.edu>
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dart/collision/dart/GJK.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "dart/math/Helpers.h"
+
+namespace dart {
+namespace collision {
+
+namespace {
+
+/// Maximum number of GJK iterations
+const int GJK_MAX_ITERATIONS = 128;
+
+/// Maximum number of EPA iterations
+const int EPA_MAX_ITERATIONS = 128;
+
+/// Relative tolerance of the GJK distance
+const double GJK_TOLERANCE = 1e-10;
+
+/// Absolute tolerance of the EPA penetration depth
+const double EPA_TOLERANCE = 1e-8;
+
+/// Distances below this are considered as touching or overlapping
+const double GJK_EPS = 1e-12;
+
+/// Vertex of the Minkowski difference together with its witness points
+struct SimplexVertex
+{
+  Eigen::Vector3d w;
+  Eigen::Vector3d p0;
+  Eigen::Vector3d p1;
+};
+
+struct Simplex
+{
+  SimplexVertex v[4];
+  int size;
+};
+
+//==============================================================================
+double signOf(double _x)
+{
+  return _x < 0.0 ? -1.0 : 1.0;
+}
+
+//==============================================================================
+SimplexVertex computeSupport(const ConvexSupport& _shape0,
+                             const ConvexSupport& _shape1,
+                             const Eigen::Vector3d& _dir, bool _useMargin)
+{
+  SimplexVertex vertex;
+  if (_useMargin)
+  {
+    vertex.p0 = _shape0.getSupport(_dir);
+    vertex.p1 = _shape1.getSupport(-_dir);
+  }
+  else
+  {
+    vertex.p0 = _shape0.getCoreSupport(_dir);
+    vertex.p1 = _shape1.getCoreSupport(-_dir);
+  }
+  vertex.w = vertex.p0 - vertex.p1;
+
+  return vertex;
+}
+
+//==============================================================================
+/// Reduce the triangle (_a, _b, _c) to its feature closest to the origin
+/// (Ericson, Real-Time Collision Detection, 5.1.5). The feature is written
+/// to _out with its barycentric coordinates in _lambda.
+Eigen::Vector3d closestOnTriangle(const SimplexVertex& _a,
+                                  const SimplexVertex& _b,
+                                  const SimplexVertex& _c,
+                                  Simplex& _out, double* _lambda)
+{
+  const Eigen::Vector3d& a = _a.w;
+  const Eigen::Vector3d& b = _b.w;
+  const Eigen::Vector3d& c = _c.w;
+  const Eigen::Vector3d ab = b - a;
+  const Eigen::Vector3d ac = c - a;
+
+  const double d1 = -ab.dot(a);
+  const double d2 = -ac.dot(a);
+  if (d1 <= 0.0 && d2 <= 0.0)
+  {
+    _out.v[0] = _a;
+    _out.size = 1;
+    _lambda[0] = 1.0;
+    return a;
+  }
+
+  const double d3 = -ab.dot(b);
+  const double d4 = -ac.dot(b);
+  if (d3 >= 0.0 && d4 <= d3)
+  {
+    _out.v[0] = _b;
+    _out.size = 1;
+    _lambda[0] = 1.0;
+    return b;
+  }
+
+  const double vc = d1 * d4 - d3 * d2;
+  if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0)
+  {
+    const double t = d1 / (d1 - d3);
+    _out.v[0] = _a;
+    _out.v[1] = _b;
+    _out.size = 2;
+    _lambda[0] = 1.0 - t;
+    _lambda[1] = t;
+    return a + t * ab;
+  }
+
+  const double d5 = -ab.dot(c);
+  const double d6 = -ac.dot(c);
+  if (d6 >= 0.0 && d5 <= d6)
+  {
+    _out.v[0] = _c;
+    _out.size = 1;
+    _lambda[0] = 1.0;
+    return c;
+  }
+
+  const double vb = d5 * d2 - d1 * d6;
+  if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0)
+  {
+    const double t = d2 / (d2 - d6);
+    _out.v[0] = _a;
+    _out.v[1] = _c;
+    _out.size = 2;
+    _lambda[0] = 1.0 - t;
+    _lambda[1] = t;
+    return a + t * ac;
+  }
+
+  const double va = d3 * d6 - d5 * d4;
+  if (va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0)
+  {
+    const double t = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+    _out.v[0] = _b;
+    _out.v[1] = _c;
+    _out.size = 2;
+    _lambda[0] = 1.0 - t;
+    _lambda[1] = t;
+    return b + t * (c - b);
+  }
+
+  const double denom = 1.0 / (va + vb + vc);
+  const double v = vb * denom;
+  const double w = vc * denom;
+  _out.v[0] = _a;
+  _out.v[1] = _b;
+  _out.v[2] = _c;
+  _out.size = 3;
+  _lambda[0] = 1.0 - v - w;
+  _lambda[1] = v;
+  _lambda[2] = w;
+  return a + v * ab + w * ac;
+}
+
+//==============================================================================
+/// Return true if the origin and _d are on opposite sides of the plane of
+/// (_a, _b, _c). Degenerate configurations count as opposite.
+bool isOriginOutsideOfPlane(const Eigen::Vector3d& _a,
+                            const Eigen::Vector3d& _b,
+                            const Eigen::Vector3d& _c,
+                            const Eigen::Vector3d& _d)
+{
+  const Eigen::Vector3d n = (_b - _a).cross(_c - _a);
+  const double signOrigin = -n.dot(_a);
+  const double signD = n.dot(_d - _a);
+
+  return signOrigin * signD <= 0.0;
+}
+
+//==============================================================================
+/// Replace _simplex by its sub-simplex closest to the origin, and return the
+/// closest point. _inside is set if the origin is inside the tetrahedron.
+Eigen::Vector3d reduceSimplex(Simplex& _simplex, double* _lambda,
+                              bool& _inside)
+{
+  _inside = false;
+
+  switch (_simplex.size)
+  {
+    case 1:
+    {
+      _lambda[0] = 1.0;
+      return _simplex.v[0].w;
+    }
+    case 2:
+    {
+      const Eigen::Vector3d& a = _simplex.v[0].w;
+      const Eigen::Vector3d ab = _simplex.v[1].w - a;
+      const double denom = ab.squaredNorm();
+      const double t = denom > 0.0 ? -a.dot(ab) / denom : 0.0;
+      if (t <= 0.0)
+      {
+        _simplex.size = 1;
+        _lambda[0] = 1.0;
+        return a;
+      }
+      if (t >= 1.0)
+      {
+        _simplex.v[0] = _simplex.v[1];
+        _simplex.size = 1;
+        _lambda[0] = 1.0;
+        return _simplex.v[0].w;
+      }
+      _lambda[0] = 1.0 - t;
+      _lambda[1] = t;
+      return a + t * ab;
+    }
+    case 3:
+    {
+      const Simplex in = _simplex;
+      return closestOnTriangle(in.v[0], in.v[1], in.v[2], _simplex, _lambda);
+    }
+    case 4:
+    {
+      const Simplex in = _simplex;
+      static const int faces[4][4] = {
+        {0, 1, 2, 3}, {0, 2, 3, 1}, {0, 3, 1, 2}, {1, 3, 2, 0}};
+
+      double bestDist = std::numeric_limits<double>::infinity();
+      Eigen::Vector3d best = Eigen::Vector3d::Zero();
+      bool outside = false;
+      for (int i = 0; i < 4; ++i)
+      {
+        const SimplexVertex& a = in.v[faces[i][0]];
+        const SimplexVertex& b = in.v[faces[i][1]];
+        const SimplexVertex& c = in.v[faces[i][2]];
+        const SimplexVertex& d = in.v[faces[i][3]];
+        if (!isOriginOutsideOfPlane(a.w, b.w, c.w, d.w))
+          continue;
+
+        outside = true;
+        Simplex candidate;
+        double lambda[4];
+        const Eigen::Vector3d p = closestOnTriangle(a, b, c, candidate, lambda);
+        const double dist = p.squaredNorm();
+        if (dist < bestDist)
+        {
+          bestDist = dist;
+          best = p;
+          _simplex = candidate;
+          std::copy(lambda, lambda + 4, _lambda);
+        }
+      }
+
+      if (!outside)
+      {
+        _inside = true;
+        return Eigen::Vector3d::Zero();
+      }
+
+      return best;
+    }
+    default:
+    {
+      assert(false);
+      return Eigen::Vector3d::Zero();
+    }
+  }
+}
+
+//==============================================================================
+/// Run GJK on the Minkowski difference _shape0 - _shape1. Return true if the
+/// shapes overlap. Otherwise _simplex and _lambda describe the closest point
+/// _v of the Minkowski difference to the origin. A separating direction
+/// from a previous query, pointing from _shape1 to _shape0, may be given as
+/// _guess so that GJK starts next to the closest features.
+bool runGJK(const ConvexSupport& _shape0, const ConvexSupport& _shape1,
+            bool _useMargin, Simplex& _simplex, double* _lambda,
+            Eigen::Vector3d& _v, const Eigen::Vector3d* _guess = nullptr)
+{
+  Eigen::Vector3d dir;
+  if (_guess && _guess->squaredNorm() > GJK_EPS)
+  {
+    // The support point against the separating direction is the closest
+    // point of the Minkowski difference if the direction is still exact
+    dir = -*_guess;
+  }
+  else
+  {
+    dir = _shape0.mTransform.translation() - _shape1.mTransform.translation();
+    if (dir.squaredNorm() < GJK_EPS)
+      dir = Eigen::Vector3d::UnitX();
+  }
+
+  _simplex.v[0] = computeSupport(_shape0, _shape1, dir, _useMargin);
+  _simplex.size = 1;
+  _lambda[0] = 1.0;
+  _v = _simplex.v[0].w;
+
+  for (int iter = 0; iter < GJK_MAX_ITERATIONS; ++iter)
+  {
+    const double vv = _v.squaredNorm();
+    if (vv < GJK_EPS * GJK_EPS)
+      return true;
+
+    const SimplexVertex w = computeSupport(_shape0, _shape1, -_v, _useMargin);
+
+    // No more progress towards the origin
+    if (vv - _v.dot(w.w) <= GJK_TOLERANCE * vv)
+      return false;
+
+    bool isDuplicate = false;
+    for (int i = 0; i < _simplex.size; ++i)
+    {
+      if ((_simplex.v[i].w - w.w).squaredNorm() < GJK_EPS * GJK_EPS)
+        isDuplicate = true;
+    }
+    if (isDuplicate)
+      return false;
+
+    const Simplex previous = _simplex;
+    double previousLambda[4];
+    std::copy(_lambda, _lambda + 4, previousLambda);
+
+    _simplex.v[_simplex.size++] = w;
+    bool inside;
+    const Eigen::Vector3d v = reduceSimplex(_simplex, _lambda, inside);
+    if (inside)
+      return true;
+
+    // Guard against cycling due to round-off
+    if (v.squaredNorm() >= vv)
+    {
+      _simplex = previous;
+      std::copy(previousLambda, previousLambda + 4, _lambda);
+      return false;
+    }
+
+    _v = v;
+  }
+
+  return _v.squaredNorm() < GJK_EPS * GJK_EPS;
+}
+
+//==============================================================================
+/// Grow an overlapping GJK simplex into a tetrahedron
+bool completeTetrahedron(const ConvexSupport& _shape0,
+                         const ConvexSupport& _shape1, Simplex& _simplex)
+{
+  static const Eigen::Vector3d axes[6] = {
+    Eigen::Vector3d::UnitX(), -Eigen::Vector3d::UnitX(),
+    Eigen::Vector3d::UnitY(), -Eigen::Vector3d::UnitY(),
+    Eigen::Vector3d::UnitZ(), -Eigen::Vector3d::UnitZ()};
+
+  if (_simplex.size == 1)
+  {
+    for (int i = 0; i < 6 && _simplex.size == 1; ++i)
+    {
+      const SimplexVertex v = computeSupport(_shape0, _shape1, axes[i], true);
+      if ((v.w - _simplex.v[0].w).squaredNorm() > GJK_EPS)
+        _simplex.v[_simplex.size++] = v;
+    }
+  }
+
+  if (_simplex.size == 2)
+  {
+    const Eigen::Vector3d d = _simplex.v[1].w - _simplex.v[0].w;
+    int minAxis;
+    d.cwiseAbs().minCoeff(&minAxis);
+    Eigen::Vector3d dir = d.cross(Eigen::Vector3d::Unit(minAxis));
+    for (int i = 0; i < 6 && _simplex.size == 2; ++i)
+    {
+      const SimplexVertex v = computeSupport(_shape0, _shape1, dir, true);
+      if ((v.w - _simplex.v[0].w).cross(d).squaredNorm() > GJK_EPS)
+        _simplex.v[_simplex.size++] = v;
+      else
+        dir = Eigen::AngleAxisd(DART_PI / 3.0, d.normalized()) * dir;
+    }
+  }
+
+  if (_simplex.size == 3)
+  {
+    const Eigen::Vector3d n = (_simplex.v[1].w - _simplex.v[0].w).cross(
+        _simplex.v[2].w - _simplex.v[0].w);
+    for (int i = 0; i < 2 && _simplex.size == 3; ++i)
+    {
+      const SimplexVertex v = computeSupport(_shape0, _shape1,
+                                             i == 0 ? n : -n, true);
+      if (std::abs(n.dot(v.w - _simplex.v[0].w)) > GJK_EPS)
+        _simplex.v[_simplex.size++] = v;
+    }
+  }
+
+  return _simplex.size == 4;
+}
+
+//==============================================================================
+struct EPAFace
+{
+  int v[3];
+  Eigen::Vector3d normal;
+  double dist;
+  bool valid;
+};
+
+//==============================================================================
+bool makeEPAFace(const std::vector<SimplexVertex>& _vertices,
+                 const Eigen::Vector3d& _interior, int _a, int _b, int _c,
+                 EPAFace& _face)
+{
+  const Eigen::Vector3d& a = _vertices[_a].w;
+  Eigen::Vector3d n = (_vertices[_b].w - a).cross(_vertices[_c].w - a);
+  const double norm = n.norm();
+  if (norm < GJK_EPS)
+    return false;
+
+  n /= norm;
+  _face.v[0] = _a;
+  _face.v[1] = _b;
+  _face.v[2] = _c;
+  if (n.dot(a - _interior) < 0.0)
+  {
+    n = -n;
+    std::swap(_face.v[1], _face.v[2]);
+  }
+  _face.normal = n;
+  _face.dist = n.dot(a);
+  _face.valid = true;
+
+  return true;
+}
+
+//==============================================================================
+/// Run EPA starting from a tetrahedron that contains the origin. Return the
+/// penetration normal (pointing from _shape1 to _shape0), depth and witness
+/// points.
+bool runEPA(const ConvexSupport& _shape0, const ConvexSupport& _shape1,
+            const Simplex& _tetrahedron, Eigen::Vector3d& _normal,
+            double& _depth, Eigen::Vector3d& _point0, Eigen::Vector3d& _point1)
+{
+  std::vector<SimplexVertex> vertices(_tetrahedron.v, _tetrahedron.v + 4);
+  const Eigen::Vector3d interior = 0.25 * (vertices[0].w + vertices[1].w
+                                           + vertices[2].w + vertices[3].w);
+
+  std::vector<EPAFace> faces;
+  static const int tetFaces[4][3] = {{0, 1, 2}, {0, 3, 1}, {0, 2, 3}, {1, 3, 2}};
+  for (int i = 0; i < 4; ++i)
+  {
+    EPAFace face;
+    if (!makeEPAFace(vertices, interior, tetFaces[i][0], tetFaces[i][1],
+                     tetFaces[i][2], face))
+    {
+      return false;
+    }
+    faces.push_back(face);
+  }
+
+  EPAFace* closest = nullptr;
+  for (int iter = 0; iter < EPA_MAX_ITERATIONS; ++iter)
+  {
+    closest = nullptr;
+    for (EPAFace& face : faces)
+    {
+      if (face.valid && (closest == nullptr || face.dist < closest->dist))
+        closest = &face;
+    }
+    if (closest == nullptr)
+      return false;
+
+    const SimplexVertex w
+        = computeSupport(_shape0, _shape1, closest->normal, true);
+    if (closest->normal.dot(w.w) - closest->dist < EPA_TOLERANCE)
+      break;
+
+    // Remove the faces visible from the new vertex and collect the horizon
+    const int newIndex = static_cast<int>(vertices.size());
+    vertices.push_back(w);
+    std::vector<std::pair<int, int>> edges;
+    for (EPAFace& face : faces)
+    {
+      if (!face.valid
+          || face.normal.dot(w.w - vertices[face.v[0]].w) <= GJK_EPS)
+      {
+        continue;
+      }
+
+      face.valid = false;
+      for (int j = 0; j < 3; ++j)
+      {
+        const std::pair<int, int> edge(face.v[j], face.v[(j + 1) % 3]);
+        auto shared = std::find(edges.begin(), edges.end(),
+                                std::make_pair(edge.second, edge.first));
+        if (shared != edges.end())
+          edges.erase(shared);
+        else
+          edges.push_back(edge);
+      }
+    }
+
+    if (edges.empty())
+      break;
+
+    const size_t numFaces = faces.size();
+    for (const auto& edge : edges)
+    {
+      EPAFace face;
+      if (makeEPAFace(vertices, interior, edge.first, edge.second, newIndex,
+                      face))
+      {
+        faces.push_back(face);
+      }
+    }
+    if (faces.size() == numFaces)
+      break;
+
+    // The face pointer may have been invalidated by the insertions
+    closest = nullptr;
+  }
+
+  if (closest == nullptr)
+  {
+    for (EPAFace& face : faces)
+    {
+      if (face.valid && (closest == nullptr || face.dist < closest->dist))
+        closest = &face;
+    }
+    if (closest == nullptr)
+      return false;
+  }
+
+  // Barycentric coordinates of the projection of the origin on the face
+  const SimplexVertex& a = vertices[closest->v[0]];
+  const SimplexVertex& b = vertices[closest->v[1]];
+  const SimplexVertex& c = vertices[closest->v[2]];
+  const Eigen::Vector3d p = closest->dist * closest->normal;
+  const Eigen::Vector3d v0 = b.w - a.w;
+  const Eigen::Vector3d v1 = c.w - a.w;
+  const Eigen::Vector3d v2 = p - a.w;
+  const double d00 = v0.dot(v0);
+  const double d01 = v0.dot(v1);
+  const double d11 = v1.dot(v1);
+  const double d20 = v2.dot(v0);
+  const double d21 = v2.dot(v1);
+  const double denom = d00 * d11 - d01 * d01;
+  double lb = 1.0 / 3.0;
+  double lc = 1.0 / 3.0;
+  if (std::abs(denom) > GJK_EPS * GJK_EPS)
+  {
+    lb = (d11 * d20 - d01 * d21) / denom;
+    lc = (d00 * d21 - d01 * d20) / denom;
+  }
+  const double la = 1.0 - lb - lc;
+
+  _point0 = la * a.p0 + lb * b.p0 + lc * c.p0;
+  _point1 = la * a.p1 + lb * b.p1 + lc * c.p1;
+  _normal = -closest->normal;
+  _depth = closest->dist;
+
+  return true;
+}
+
+}  // namespace
+
+//==============================================================================
+ConvexSupport::ConvexSupport(CoreType _type, const Eigen::Vector3d& _size,
+                             const Eigen::Isometry3d& _transform,
+                             double _margin)
+  : mType(_type),
+    mSize(_size),
+    mTransform(_transform),
+    mMargin(_margin),
+    mVertices(nullptr),
+    mTriangles(nullptr)
+{
+  assert(_type != HULL);
+}
+
+//==============================================================================
+ConvexSupport::ConvexSupport(const std::vector<Eigen::Vector3d>& _vertices,
+                             const std::vector<Eigen::Vector3i>& _triangles,
+                             const Eigen::Isometry3d& _transform,
+                             double _margin)
+  : mType(HULL),
+    mSize(Eigen::Vector3d::Zero()),
+    mTransform(_transform),
+    mMargin(_margin),
+    mVertices(&_vertices),
+    mTriangles(&_triangles)
+{
+  assert(!_vertices.empty());
+}
+
+//==============================================================================
+Eigen::Vector3d ConvexSupport::getCoreSupport(const Eigen::Vector3d& _dir) const
+{
+  const Eigen::Vector3d d = mTransform.linear().transpose() * _dir;
+  Eigen::Vector3d p = Eigen::Vector3d::Zero();
+
+  switch (mType)
+  {
+    case POINT:
+      break;
+    case SEGMENT:
+      p[2] = signOf(d[2]) * mSize[2];
+      break;
+    case BOX:
+      p << signOf(d[0]) * mSize[0],
+           signOf(d[1]) * mSize[1],
+           signOf(d[2]) * mSize[2];
+      break;
+    case ELLIPSOID:
+    {
+      const Eigen::Vector3d scaled = mSize.cwiseProduct(d);
+      const double norm = scaled.norm();
+      if (norm > 0.0)
+        p = mSize.cwiseProduct(scaled) / norm;
+      break;
+    }
+    case CYLINDER:
+    {
+      const double radial = std::sqrt(d[0] * d[0] + d[1] * d[1]);
+      if (radial > 0.0)
+      {
+        p[0] = mSize[0] * d[0] / radial;
+        p[1] = mSize[0] * d[1] / radial;
+      }
+      p[2] = signOf(d[2]) * mSize[2];
+      break;
+    }
+    case HULL:
+    {
+      double maxDot = -std::numeric_limits<double>::infinity();
+      for (const Eigen::Vector3d& vertex : *mVertices)
+      {
+        const double dot = vertex.dot(d);
+        if (dot > maxDot)
+        {
+          maxDot = dot;
+          p = vertex;
+        }
+      }
+      break;
+    }
+  }
+
+  return mTransform * p;
+}
+
+//==============================================================================
+Eigen::Vector3d ConvexSupport::getSupport(const Eigen::Vector3d& _dir) const
+{
+  Eigen::Vector3d p = getCoreSupport(_dir);
+
+  if (mMargin > 0.0)
+  {
+    const double norm = _dir.norm();
+    if (norm > 0.0)
+      p += (mMargin / norm) * _dir;
+  }
+
+  return p;
+}
+
+//==============================================================================
+bool ConvexSupport::contains(const Eigen::Vector3d& _point,
+                             double _tolerance) const
+{
+  const Eigen::Vector3d p = mTransform.inverse() * _point;
+  const double margin = mMargin + _tolerance;
+
+  switch (mType)
+  {
+    case POINT:
+      return p.norm() <= margin;
+    case SEGMENT:
+    {
+      const double z = std::max(-mSize[2], std::min(p[2], mSize[2]));
+      return (p - Eigen::Vector3d(0.0, 0.0, z)).norm() <= margin;
+    }
+    case BOX:
+    {
+      const Eigen::Vector3d excess = (p.cwiseAbs() - mSize).cwiseMax(0.0);
+      return excess.norm() <= margin;
+    }
+    case ELLIPSOID:
+    {
+      // Conservative for inflated ellipsoids: scale the radii by the margin
+      const Eigen::Vector3d radii = mSize.array() + margin;
+      return p.cwiseQuotient(radii).squaredNorm() <= 1.0;
+    }
+    case CYLINDER:
+    {
+      const double radial = std::sqrt(p[0] * p[0] + p[1] * p[1]);
+      const double excessRadial = std::max(radial - mSize[0], 0.0);
+      const double excessAxial = std::max(std::abs(p[2]) - mSize[2], 0.0);
+      return std::sqrt(excessRadial * excessRadial
+                       + excessAxial * excessAxial) <= margin;
+    }
+    case HULL:
+    {
+      // Conservative for inflated hulls: offset the face planes by the margin
+      const std::vector<Eigen::Vector3d>& vertices = *mVertices;
+      for (const Eigen::Vector3i& triangle : *mTriangles)
+      {
+        const Eigen::Vector3d& a = vertices[triangle[0]];
+        const Eigen::Vector3d normal = (vertices[triangle[1]] - a).cross(
+            vertices[triangle[2]] - a).normalized();
+        if (normal.dot(p - a) > margin)
+          return false;
+      }
+      return true;
+    }
+  }
+
+  return false;
+}
+
+//==============================================================================
+double computeConvexDistance(const ConvexSupport& _shape0,
+                             const ConvexSupport& _shape1,
+                             Eigen::Vector3d* _point0,
+                             Eigen::Vector3d* _point1,
+                             const Eigen::Vector3d* _guess)
+{
+  Simplex simplex;
+  double lambda[4];
+  Eigen::Vector3d v;
+  if (runGJK(_shape0, _shape1, false, simplex, lambda, v, _guess))
+    return 0.0;
+
+  if (_point0 || _point1)
+  {
+    Eigen::Vector3d p0 = Eigen::Vector3d::Zero();
+    Eigen::Vector3d p1 = Eigen::Vector3d::Zero();
+    for (int i = 0; i < simplex.size; ++i)
+    {
+      p0 += lambda[i] * simplex.v[i].p0;
+      p1 += lambda[i] * simplex.v[i].p1;
+    }
+    if (_point0)
+      *_point0 = p0;
+    if (_point1)
+      *_point1 = p1;
+  }
+
+  return v.norm();
+}
+
+//==============================================================================
+bool collideConvex(const ConvexSupport& _shape0,
+                   const ConvexSupport& _shape1,
+                   Contact* _contact)
+{
+  const double margin = _shape0.mMargin + _shape1.mMargin;
+
+  Eigen::Vector3d p0;
+  Eigen::Vector3d p1;
+  const double dist = computeConvexDistance(_shape0, _shape1, &p0, &p1);
+  if (dist > 0.0 && dist >= margin)
+    return false;
+
+  if (dist > 1e-9)
+  {
+    // Separated cores: the contact follows from their closest points
+    const Eigen::Vector3d normal = (p0 - p1) / dist;
+    _contact->normal = normal;
+    _contact->penetrationDepth = margin - dist;
+    _contact->point = 0.5 * ((p0 - _shape0.mMargin * normal)
+                             + (p1 + _shape1.mMargin * normal));
+    return true;
+  }
+
+  // Overlapping cores: expand the polytope of the inflated shapes
+  Simplex simplex;
+  double lambda[4];
+  Eigen::Vector3d v;
+  if (!runGJK(_shape0, _shape1, true, simplex, lambda, v))
+    return false;
+
+  Eigen::Vector3d normal;
+  double depth;
+  if (!completeTetrahedron(_shape0, _shape1, simplex)
+      || !runEPA(_shape0, _shape1, simplex, normal, depth, p0, p1))
+  {
+    return false;
+  }
+
+  _contact->normal = normal;
+  _contact->penetrationDepth = depth;
+  _contact->point = 0.5 * (p0 + p1);
+
+  return true;
+}
+
+}  // namespace collision
+}  // namespace dart
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2016, Georgia Tech Research Corporation
+ * All rights reserved.
+ *
+ * Author(s): Jeongseok Lee <jslee02@gmail.com>
+ *
+ * Georgia Tech Graphics Lab and Humanoid Robotics Lab
+ *
+ * Directed by Prof. C. Karen Liu and Prof. Mike Stilman
+ * <karenliu@cc.gatech.edu> <mstilman@cc.gatech.edu>
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DART_COLLISION_DART_GJK_H_
+#define DART_COLLISION_DART_GJK_H_
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "dart/collision/CollisionDetector.h"
+
+namespace dart {
+namespace collision {
+
+/// ConvexSupport describes a convex shape by its support mapping, i.e., the
+/// point of the shape that is farthest along a given direction. The shape is
+/// a core (point, segment, box, ellipsoid, cylinder or convex hull) placed by
+/// a world transform and optionally inflated by a spherical margin, so that
+/// spheres and capsules are a point and a segment with a margin.
+struct ConvexSupport
+{
+  enum CoreType
+  {
+    POINT,
+    SEGMENT,   ///< Segment along the z-axis, mSize[2] is the half length
+    BOX,       ///< mSize holds the half extents
+    ELLIPSOID, ///< mSize holds the radii
+    CYLINDER,  ///< Along the z-axis, mSize = (radius, radius, half height)
+    HULL       ///< Convex hull given by mVertices and mTriangles
+  };
+
+  // To get byte-aligned Eigen vectors
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /// Constructor
+  ConvexSupport(CoreType _type, const Eigen::Vector3d& _size,
+                const Eigen::Isometry3d& _transform, double _margin = 0.0);
+
+  /// Constructor for a convex hull. The vertices and triangles are referenced,
+  /// not copied, so they must outlive this object.
+  ConvexSupport(const std::vector<Eigen::Vector3d>& _vertices,
+                const std::vector<Eigen::Vector3i>& _triangles,
+                const Eigen::Isometry3d& _transform, double _margin = 0.0);
+
+  /// Return the point of the core, in the world frame, that is farthest along
+  /// _dir, which is also expressed in the world frame
+  Eigen::Vector3d getCoreSupport(const Eigen::Vector3d& _dir) const;
+
+  /// Return the point of the inflated shape that is farthest along _dir
+  Eigen::Vector3d getSupport(const Eigen::Vector3d& _dir) const;
+
+  /// Return true if _point, expressed in the world frame, lies inside the
+  /// inflated shape or within _tolerance of its surface
+  bool contains(const Eigen::Vector3d& _point, double _tolerance = 0.0) const;
+
+  /// Type of the core
+  CoreType mType;
+
+  /// Size parameters of the core
+  Eigen::Vector3d mSize;
+
+  /// Transform of the core w.r.t. the world frame
+  Eigen::Isometry3d mTransform;
+
+  /// Radius of the sphere swept over the core
+  double mMargin;
+
+  /// Vertices of the hull in the local frame, only used by HULL
+  const std::vector<Eigen::Vector3d>* mVertices;
+
+  /// Triangles of the hull, only used by HULL
+  const std::vector<Eigen::Vector3i>* mTriangles;
+};
+
+/// Compute the distance between the cores of two convex shapes with GJK.
+/// The closest points are written to _point0 and _point1 when given. Zero is
+/// returned if the cores overlap, in which case the points are meaningless.
+/// _guess optionally warm starts GJK with the separating direction, pointing
+/// from _shape1 to _shape0, found by a previous query of the same pair.
+double computeConvexDistance(const ConvexSupport& _shape0,
+                             const ConvexSupport& _shape1,
+                             Eigen::Vector3d* _point0 = nullptr,
+                             Eigen::Vector3d* _point1 = nullptr,
+                             const Eigen::Vector3d* _guess = nullptr);
+
+/// Collide two (inflated) convex shapes. If they intersect, return true and
+/// write the contact point, the normal pointing from _shape1 to _shape0 and
+/// the penetration depth to _contact. Separated cores are handled exactly
+/// through their closest points; overlapping cores fall back to EPA.
+bool collideConvex(const ConvexSupport& _shape0,
+                   const ConvexSupport& _shape1,
+                   Contact* _contact);
+
+}  // namespace collision
+}  // namespace dart
+
+#endif  // DART_COLLISION_DART_GJK_H_
@@ -146,7 +146,7 @@ bool isClose(const Eigen::Vector3d& _point1, const Eigen::Vector3d& _point2)
 }
 
 //==============================================================================
-bool hasClosePoint(const std::vector<Contact>& _contacts,
+bool hasClosePoint(const std::vector<ContactRecord>& _contacts,
                    const Eigen::Vector3d& _point)
 {
   for (const auto& contact : _contacts)
@@ -192,46 +192,87 @@ bool FCLCollisionDetector::detectCollision(bool /*_checkAllCollisions*/,
 
     Eigen::Vector3d point = FCLTypes::convertVector3(contact.pos);
 
-    if (hasClosePoint(mContacts, point))
+    if (hasClosePoint(mContactRecords, point))
       continue;
 
-    Contact contactPair;
-    contactPair.point = point;
-    contactPair.normal = -FCLTypes::convertVector3(contact.normal);
-    contactPair.bodyNode1 = findCollisionNode(contact.o1)->getBodyNode();
-    contactPair.bodyNode2 = findCollisionNode(contact.o2)->getBodyNode();
-    contactPair.triID1 = contact.b1;
-    contactPair.triID2 = contact.b2;
-    contactPair.penetrationDepth = contact.penetration_depth;
-    assert(contactPair.bodyNode1.lock());
-    assert(contactPair.bodyNode2.lock());
-
-    mContacts.push_back(contactPair);
+    const FCLUserData* userData1 = static_cast<FCLUserData*>(
+        findCollisionObject(contact.o1)->getUserData());
+    const FCLUserData* userData2 = static_cast<FCLUserData*>(
+        findCollisionObject(contact.o2)->getUserData());
+
+    ContactRecord record;
+    record.point = point;
+    record.normal = -FCLTypes::convertVector3(contact.normal);
+    record.force.setZero();
+    record.penetrationDepth = contact.penetration_depth;
+    record.bodyNode1 = userData1->bodyNode;
+    record.bodyNode2 = userData2->bodyNode;
+    record.shape1 = userData1->shape;
+    record.shape2 = userData2->shape;
+    record.triID1 = contact.b1;
+    record.triID2 = contact.b2;
+    record.userData = nullptr;
+    assert(record.bodyNode1);
+    assert(record.bodyNode2);
+
+    mContactRecords.push_back(record);
   }
 
-  for (size_t i = 0; i < mContacts.size(); ++i)
+  for (const ContactRecord& record : mContactRecords)
   {
     // Set these two bodies are in colliding
-    mContacts[i].bodyNode1.lock()->setColliding(true);
-    mContacts[i].bodyNode2.lock()->setColliding(true);
+    record.bodyNode1->setColliding(true);
+    record.bodyNode2->setColliding(true);
   }
 
-  return !mContacts.empty();
+  return !mContactRecords.empty();
 }
 
 //==============================================================================
 bool FCLCollisionDetector::detectCollision(CollisionNode* _node1,
                                            CollisionNode* _node2,
-                                           bool _calculateContactPoints)
+                                           bool /*_calculateContactPoints*/)
 {
-  // TODO(JS): function not implemented
-  assert(false);
+  FCLCollisionNode* collisionNode1 = static_cast<FCLCollisionNode*>(_node1);
+  FCLCollisionNode* collisionNode2 = static_cast<FCLCollisionNode*>(_node2);
+  collisionNode1->updateFCLCollisionObjects();
+  collisionNode2->updateFCLCollisionObjects();
+
+  // Only the existence of a collision is reported, so the first contact is
+  // enough
+  fcl::CollisionRequest request;
+  request.enable_contact = false;
+  request.num_max_contacts = 1;
+
+  for (size_t i = 0; i < collisionNode1->getNumCollisionObjects(); ++i)
+  {
+    for (size_t j = 0; j < collisionNode2->getNumCollisionObjects(); ++j)
+    {
+      fcl::CollisionResult result;
+      fcl::collide(collisionNode1->getCollisionObject(i),
+                   collisionNode2->getCollisionObject(j), request, result);
+      if (result.isCollision())
+        return true;
+    }
+  }
+
   return false;
 }
 
 //==============================================================================
 CollisionNode* FCLCollisionDetector::findCollisionNode(
     const fcl::CollisionGeometry* _fclCollGeom) const
+{
+  const fcl::CollisionObject* collObj = findCollisionObject(_fclCollGeom);
+  if (collObj)
+    return findCollisionNode(collObj);
+
+  return NULL;
+}
+
+//==============================================================================
+fcl::CollisionObject* FCLCollisionDetector::findCollisionObject(
+    const fcl::CollisionGeometry* _fclCollGeom) const
 {
   int numCollNodes = mCollisionNodes.size();
   for (int i = 0; i < numCollNodes; ++i)
@@ -240,14 +281,13 @@ CollisionNode* FCLCollisionDetector::findCollisionNode(
         static_cast<FCLCollisionNode*>(mCollisionNodes[i]);
     for (size_t j = 0; j < collisionNode->getNumCollisionObjects(); j++)
     {
+      fcl::CollisionObject* collObj = collisionNode->getCollisionObject(j);
 #if FCL_VERSION_AT_LEAST(0,3,0)
-      if (collisionNode->getCollisionObject(j)->collisionGeometry().get()
-          == _fclCollGeom)
+      if (collObj->collisionGeometry().get() == _fclCollGeom)
 #else
-      if (collisionNode->getCollisionObject(j)->getCollisionGeometry()
-          == _fclCollGeom)
+      if (collObj->getCollisionGeometry() == _fclCollGeom)
 #endif
-        return mCollisionNodes[i];
+        return collObj;
     }
   }
   return NULL;
@@ -75,6 +75,10 @@ public:
   FCLCollisionNode* findCollisionNode(
       const fcl::CollisionObject* _fclCollObj) const;
 
+  /// Get FCL collision object given FCL collision geometry
+  fcl::CollisionObject* findCollisionObject(
+      const fcl::CollisionGeometry* _fclCollGeom) const;
+
 protected:
   // Documentation inherited
   virtual bool detectCollision(CollisionNode* _node1, CollisionNode* _node2,
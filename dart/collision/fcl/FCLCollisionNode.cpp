@@ -44,6 +44,8 @@
 #include "dart/dynamics/BoxShape.h"
 #include "dart/dynamics/EllipsoidShape.h"
 #include "dart/dynamics/CylinderShape.h"
+#include "dart/dynamics/CapsuleShape.h"
+#include "dart/dynamics/HeightmapShape.h"
 #include "dart/dynamics/PlaneShape.h"
 #include "dart/dynamics/Shape.h"
 #include "dart/dynamics/MeshShape.h"
@@ -296,6 +298,58 @@ fcl::BVHModel<BV>* createMesh(float _scaleX, float _scaleY, float _scaleZ,
   return model;
 }
 
+//==============================================================================
+template<class BV>
+fcl::BVHModel<BV>* createConvexHullMesh(
+    const std::vector<Eigen::Vector3d>& _vertices,
+    const std::vector<Eigen::Vector3i>& _triangles)
+{
+  // Create FCL mesh from the triangles of a convex hull
+
+  fcl::BVHModel<BV>* model = new fcl::BVHModel<BV>;
+  model->beginModel();
+  for (const Eigen::Vector3i& triangle : _triangles)
+  {
+    fcl::Vec3f vertices[3];
+    for (size_t k = 0; k < 3; k++)
+    {
+      const Eigen::Vector3d& vertex = _vertices[triangle[k]];
+      vertices[k] = fcl::Vec3f(vertex[0], vertex[1], vertex[2]);
+    }
+    model->addTriangle(vertices[0], vertices[1], vertices[2]);
+  }
+  model->endModel();
+  return model;
+}
+
+//==============================================================================
+template<class BV>
+fcl::BVHModel<BV>* createHeightmapMesh(
+    const dynamics::HeightmapShape* _heightmap)
+{
+  // Create FCL mesh from the two triangles of each cell of a heightmap
+
+  fcl::BVHModel<BV>* model = new fcl::BVHModel<BV>;
+  model->beginModel();
+  for (size_t i = 0; i + 1 < _heightmap->getNumRows(); i++)
+  {
+    for (size_t j = 0; j + 1 < _heightmap->getNumCols(); j++)
+    {
+      fcl::Vec3f vertices[4];
+      for (size_t k = 0; k < 4; k++)
+      {
+        const Eigen::Vector3d vertex
+            = _heightmap->getVertex(i + k / 2, j + k % 2);
+        vertices[k] = fcl::Vec3f(vertex[0], vertex[1], vertex[2]);
+      }
+      model->addTriangle(vertices[0], vertices[1], vertices[3]);
+      model->addTriangle(vertices[0], vertices[3], vertices[2]);
+    }
+  }
+  model->endModel();
+  return model;
+}
+
 //==============================================================================
 template<class BV>
 fcl::BVHModel<BV>* createSoftMesh(const aiMesh* _mesh,
@@ -343,6 +397,8 @@ FCLCollisionNode::FCLCollisionNode(dynamics::BodyNode* _bodyNode)
   using dynamics::BoxShape;
   using dynamics::EllipsoidShape;
   using dynamics::CylinderShape;
+  using dynamics::CapsuleShape;
+  using dynamics::HeightmapShape;
   using dynamics::PlaneShape;
   using dynamics::MeshShape;
   using dynamics::SoftMeshShape;
@@ -400,6 +456,15 @@ FCLCollisionNode::FCLCollisionNode(dynamics::BodyNode* _bodyNode)
 
         break;
       }
+      case Shape::CAPSULE:
+      {
+        assert(dynamic_cast<CapsuleShape*>(shape.get()));
+        CapsuleShape* capsule = static_cast<CapsuleShape*>(shape.get());
+        fclCollGeom.reset(
+              new fcl::Capsule(capsule->getRadius(), capsule->getHeight()));
+
+        break;
+      }
       case Shape::PLANE:
       {
         assert(dynamic_cast<PlaneShape*>(shape.get()));
@@ -415,12 +480,30 @@ FCLCollisionNode::FCLCollisionNode(dynamics::BodyNode* _bodyNode)
       {
         assert(dynamic_cast<MeshShape*>(shape.get()));
         MeshShape* shapeMesh = static_cast<MeshShape*>(shape.get());
+        if (shapeMesh->getCollisionMode() == MeshShape::CONVEX_HULL
+            && !shapeMesh->getConvexHullTriangles().empty())
+        {
+          fclCollGeom.reset(
+              createConvexHullMesh<fcl::OBBRSS>(
+                shapeMesh->getConvexHullVertices(),
+                shapeMesh->getConvexHullTriangles()));
+
+          break;
+        }
         fclCollGeom.reset(
             createMesh<fcl::OBBRSS>(shapeMesh->getScale()[0],
                                     shapeMesh->getScale()[1],
                                     shapeMesh->getScale()[2],
                                     shapeMesh->getMesh()));
 
+        break;
+      }
+      case Shape::HEIGHTMAP:
+      {
+        assert(dynamic_cast<HeightmapShape*>(shape.get()));
+        HeightmapShape* heightmap = static_cast<HeightmapShape*>(shape.get());
+        fclCollGeom.reset(createHeightmapMesh<fcl::OBBRSS>(heightmap));
+
         break;
       }
 #if 0
@@ -39,11 +39,15 @@
 
 #include <cmath>
 #include <iostream>
+#include <vector>
 
 #include <assimp/scene.h>
+#include <Eigen/Dense>
 
 #include "fcl/BVH/BVH_model.h"
 
+#include "dart/dynamics/HeightmapShape.h"
+
 namespace dart {
 namespace collision {
 
@@ -75,6 +79,53 @@ fcl::BVHModel<BV>* createMesh(float _scaleX, float _scaleY, float _scaleZ,
   return model;
 }
 
+template<class BV>
+fcl::BVHModel<BV>* createConvexHullMesh(
+    const std::vector<Eigen::Vector3d>& _vertices,
+    const std::vector<Eigen::Vector3i>& _triangles,
+    const fcl::Transform3f& _transform) {
+  fcl::BVHModel<BV>* model = new fcl::BVHModel<BV>;
+  model->beginModel();
+
+  for (const Eigen::Vector3i& triangle : _triangles) {
+    fcl::Vec3f vertices[3];
+    for (int k = 0; k < 3; k++) {
+      const Eigen::Vector3d& vertex = _vertices[triangle[k]];
+      vertices[k] = _transform.transform(
+          fcl::Vec3f(vertex[0], vertex[1], vertex[2]));
+    }
+    model->addTriangle(vertices[0], vertices[1], vertices[2]);
+  }
+
+  model->endModel();
+  return model;
+}
+
+template<class BV>
+fcl::BVHModel<BV>* createHeightmapMesh(
+    const dynamics::HeightmapShape* _heightmap,
+    const fcl::Transform3f& _transform) {
+  fcl::BVHModel<BV>* model = new fcl::BVHModel<BV>;
+  model->beginModel();
+
+  for (size_t i = 0; i + 1 < _heightmap->getNumRows(); i++) {
+    for (size_t j = 0; j + 1 < _heightmap->getNumCols(); j++) {
+      fcl::Vec3f vertices[4];
+      for (size_t k = 0; k < 4; k++) {
+        const Eigen::Vector3d vertex
+            = _heightmap->getVertex(i + k / 2, j + k % 2);
+        vertices[k] = _transform.transform(
+            fcl::Vec3f(vertex[0], vertex[1], vertex[2]));
+      }
+      model->addTriangle(vertices[0], vertices[1], vertices[3]);
+      model->addTriangle(vertices[0], vertices[3], vertices[2]);
+    }
+  }
+
+  model->endModel();
+  return model;
+}
+
 template<class BV>
 fcl::BVHModel<BV>* createEllipsoid(float _sizeX, float _sizeY, float _sizeZ,
                                    const fcl::Transform3f& _transform) {
@@ -79,17 +79,56 @@ bool FCLMeshCollisionDetector::detectCollision(bool _checkAllCollisions,
   // Clear previous contact informations
   //----------------------------------------------------------------------------
 
-  // Update the positions of vertices on meshs
+  // Update the positions of vertices on meshs and the transforms
   for (size_t i = 0; i < mCollisionNodes.size(); ++i)
-    static_cast<FCLMeshCollisionNode*>(mCollisionNodes[i])->updateShape();
+  {
+    FCLMeshCollisionNode* collisionNode
+        = static_cast<FCLMeshCollisionNode*>(mCollisionNodes[i]);
+    collisionNode->updateShape();
+    collisionNode->evalRT();
+  }
 
   // Clear previous contacts
-  mContacts.clear();
+  clearAllContacts();
 
   //----------------------------------------------------------------------------
   // Detect collisions
   //----------------------------------------------------------------------------
 
+  // Every pair has to be tested for the contacts, so the narrow phase can be
+  // run in parallel
+  if (_checkAllCollisions && _calculateContactPoints)
+  {
+    std::vector<CollisionNodePair> pairs;
+    for (size_t i = 0; i < mCollisionNodes.size(); i++)
+    {
+      for (size_t j = i + 1; j < mCollisionNodes.size(); j++)
+      {
+        if (isCollidable(mCollisionNodes[i], mCollisionNodes[j]))
+          pairs.push_back(std::make_pair(mCollisionNodes[i],
+                                         mCollisionNodes[j]));
+      }
+    }
+
+    const int numMaxContacts = mNumMaxContacts;
+    runNarrowPhase(pairs, [numMaxContacts](
+                   CollisionNode* _node1, CollisionNode* _node2,
+                   std::vector<ContactRecord>* _contacts)
+    {
+      static_cast<FCLMeshCollisionNode*>(_node1)->detectCollision(
+            static_cast<FCLMeshCollisionNode*>(_node2), _contacts,
+            numMaxContacts);
+    });
+
+    for (const ContactRecord& record : mContactRecords)
+    {
+      record.bodyNode1->setColliding(true);
+      record.bodyNode2->setColliding(true);
+    }
+
+    return !mContactRecords.empty();
+  }
+
   bool collision = false;
 
   FCLMeshCollisionNode* FCLMeshCollisionNode1 = nullptr;
@@ -106,8 +145,8 @@ bool FCLMeshCollisionDetector::detectCollision(bool _checkAllCollisions,
       if (!isCollidable(FCLMeshCollisionNode1, FCLMeshCollisionNode2))
         continue;
 
-      std::vector<Contact>* contactPoints
-          = _calculateContactPoints ? &mContacts : nullptr;
+      std::vector<ContactRecord>* contactPoints
+          = _calculateContactPoints ? &mContactRecords : nullptr;
       if (FCLMeshCollisionNode1->detectCollision(FCLMeshCollisionNode2,
                                                  contactPoints,
                                                  mNumMaxContacts))
@@ -134,9 +173,11 @@ bool FCLMeshCollisionDetector::detectCollision(CollisionNode* _node1,
       static_cast<FCLMeshCollisionNode*>(_node1);
   FCLMeshCollisionNode* collisionNode2 =
       static_cast<FCLMeshCollisionNode*>(_node2);
+  collisionNode1->evalRT();
+  collisionNode2->evalRT();
   return collisionNode1->detectCollision(
         collisionNode2,
-        _calculateContactPoints ? &mContacts : nullptr,
+        _calculateContactPoints ? &mContactRecords : nullptr,
         mNumMaxContacts);
 }
 
@@ -50,6 +50,8 @@
 #include "dart/dynamics/MeshShape.h"
 #include "dart/dynamics/EllipsoidShape.h"
 #include "dart/dynamics/CylinderShape.h"
+#include "dart/dynamics/CapsuleShape.h"
+#include "dart/dynamics/HeightmapShape.h"
 #include "dart/dynamics/SoftMeshShape.h"
 #include "dart/renderer/LoadOpengl.h"
 #include "dart/collision/fcl_mesh/CollisionShapes.h"
@@ -67,6 +69,8 @@ FCLMeshCollisionNode::FCLMeshCollisionNode(dynamics::BodyNode* _bodyNode)
   using dart::dynamics::BoxShape;
   using dart::dynamics::EllipsoidShape;
   using dart::dynamics::CylinderShape;
+  using dart::dynamics::CapsuleShape;
+  using dart::dynamics::HeightmapShape;
   using dart::dynamics::MeshShape;
   using dart::dynamics::SoftMeshShape;
 
@@ -113,9 +117,37 @@ FCLMeshCollisionNode::FCLMeshCollisionNode(dynamics::BodyNode* _bodyNode)
                             radius, radius, height, 16, 16, shapeT));
         break;
       }
+      case dynamics::Shape::CAPSULE:
+      {
+        CapsuleShape* capsule = static_cast<CapsuleShape*>(shape.get());
+        double radius = capsule->getRadius();
+        double height = capsule->getHeight();
+        mMeshes.push_back(createCylinder<fcl::OBBRSS>(
+                            radius, radius, height, 16, 16, shapeT));
+        for (int end = -1; end <= 1; end += 2)
+        {
+          fcl::BVHModel<fcl::OBBRSS>* mesh = new fcl::BVHModel<fcl::OBBRSS>;
+          fcl::generateBVHModel<fcl::OBBRSS>(
+              *mesh, fcl::Sphere(radius),
+              getFclTransform(shape->getLocalTransform()
+                              * Eigen::Translation3d(0.0, 0.0,
+                                                     0.5 * end * height)),
+              10, 10);
+          mMeshes.push_back(mesh);
+        }
+        break;
+      }
       case dynamics::Shape::MESH:
       {
         MeshShape* shapeMesh = static_cast<MeshShape*>(shape.get());
+        if (shapeMesh->getCollisionMode() == MeshShape::CONVEX_HULL
+            && !shapeMesh->getConvexHullTriangles().empty())
+        {
+          mMeshes.push_back(createConvexHullMesh<fcl::OBBRSS>(
+                              shapeMesh->getConvexHullVertices(),
+                              shapeMesh->getConvexHullTriangles(), shapeT));
+          break;
+        }
         mMeshes.push_back(createMesh<fcl::OBBRSS>(shapeMesh->getScale()[0],
                                                   shapeMesh->getScale()[1],
                                                   shapeMesh->getScale()[2],
@@ -123,6 +155,12 @@ FCLMeshCollisionNode::FCLMeshCollisionNode(dynamics::BodyNode* _bodyNode)
                                                   shapeT));
         break;
       }
+      case dynamics::Shape::HEIGHTMAP:
+      {
+        HeightmapShape* heightmap = static_cast<HeightmapShape*>(shape.get());
+        mMeshes.push_back(createHeightmapMesh<fcl::OBBRSS>(heightmap, shapeT));
+        break;
+      }
       case dynamics::Shape::SOFT_MESH:
       {
         SoftMeshShape* softMeshShape = static_cast<SoftMeshShape*>(shape.get());
@@ -148,12 +186,11 @@ FCLMeshCollisionNode::~FCLMeshCollisionNode()
 }
 
 //==============================================================================
-bool FCLMeshCollisionNode::detectCollision(FCLMeshCollisionNode* _otherNode,
-                                           std::vector<Contact>* _contactPoints,
-                                           int _num_max_contact)
+bool FCLMeshCollisionNode::detectCollision(
+    FCLMeshCollisionNode* _otherNode,
+    std::vector<ContactRecord>* _contactPoints,
+    int _num_max_contact)
 {
-  evalRT();
-  _otherNode->evalRT();
   bool collision = false;
 
   for (size_t i = 0; i < mMeshes.size(); i++)
@@ -189,13 +226,13 @@ bool FCLMeshCollisionNode::detectCollision(FCLMeshCollisionNode* _otherNode,
       int numNoContacts = 0;
       int numContacts = 0;
 
-      std::vector<Contact> unfilteredContactPoints;
+      std::vector<ContactRecord> unfilteredContactPoints;
       unfilteredContactPoints.reserve(res.numContacts());
 
       for (size_t k = 0; k < res.numContacts(); k++)
       {
         // for each pair of intersecting triangles, we create two contact points
-        Contact pair1, pair2;
+        ContactRecord pair1, pair2;
         //            pair1.bd1 = mBodyNode;
         //            pair1.bd2 = _otherNode->mBodyNode;
         //            pair1.bdID1 = this->mBodyNodeID;
@@ -206,8 +243,10 @@ bool FCLMeshCollisionNode::detectCollision(FCLMeshCollisionNode* _otherNode,
         pair1.triID1 = res.getContact(k).b1;
         pair1.triID2 = res.getContact(k).b2;
         pair1.penetrationDepth = res.getContact(k).penetration_depth;
-        pair1.shape1 = pair1.bodyNode1.lock()->getCollisionShape(i);
-        pair1.shape2 = pair1.bodyNode2.lock()->getCollisionShape(j);
+        pair1.shape1 = pair1.bodyNode1->getCollisionShape(i).get();
+        pair1.shape2 = pair1.bodyNode2->getCollisionShape(j).get();
+        pair1.force.setZero();
+        pair1.userData = nullptr;
         pair2 = pair1;
         int contactResult =
             evalContactPosition(res.getContact(k), mMeshes[i],
@@ -80,9 +80,11 @@ public:
   ///
   Eigen::Isometry3d mWorldTrans;
 
-  ///
+  /// Return true if this node collides with _otherNode. The world transforms
+  /// of both nodes must have been updated by evalRT(). Only the contact
+  /// buffer is modified, so different pairs can be tested concurrently.
   virtual bool detectCollision(FCLMeshCollisionNode* _otherNode,
-                               std::vector<Contact>* _contactPoints,
+                               std::vector<ContactRecord>* _contactPoints,
                                int _max_num_contact);
   ///
   void updateShape();
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2016, Georgia Tech Research Corporation
+ * All rights reserved.
+ *
+ * Author(s): Jeongseok Lee <jslee02@gmail.com>
+ *
+ * Georgia Tech Graphics Lab and Humanoid Robotics Lab
+ *
+ * Directed by Prof. C. Karen Liu and Prof. Mike Stilman
+ * <karenliu@cc.gatech.edu> <mstilman@cc.gatech.edu>
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dart/common/BitMatrix.h"
+
+#include <algorithm>
+
+namespace dart {
+namespace common {
+
+//==============================================================================
+BitMatrix::BitMatrix(size_t _size, bool _value)
+  : mSize(0),
+    mNumWordsPerRow(0)
+{
+  resize(_size, _value);
+}
+
+//==============================================================================
+size_t BitMatrix::getSize() const
+{
+  return mSize;
+}
+
+//==============================================================================
+void BitMatrix::resize(size_t _size, bool _value)
+{
+  if (_size == mSize)
+    return;
+
+  const uint64_t fill = _value ? ~uint64_t(0) : uint64_t(0);
+  const size_t numWordsPerRow = (_size + 63) / 64;
+  std::vector<uint64_t> words(_size * numWordsPerRow, fill);
+
+  // Copy the block shared by the old and the new matrix word by word. The
+  // bits of the last, partially shared word beyond the block get _value.
+  const size_t common = std::min(mSize, _size);
+  const size_t numCommonWords = common / 64;
+  const uint64_t lowMask = (uint64_t(1) << (common & 63)) - 1;
+  for (size_t i = 0; i < common; ++i)
+  {
+    const uint64_t* oldRow = &mWords[i * mNumWordsPerRow];
+    uint64_t* newRow = &words[i * numWordsPerRow];
+    std::copy(oldRow, oldRow + numCommonWords, newRow);
+    if (lowMask)
+    {
+      newRow[numCommonWords]
+          = (oldRow[numCommonWords] & lowMask) | (fill & ~lowMask);
+    }
+  }
+
+  mSize = _size;
+  mNumWordsPerRow = numWordsPerRow;
+  mWords.swap(words);
+}
+
+//==============================================================================
+void BitMatrix::remove(size_t _index)
+{
+  assert(_index < mSize);
+
+  const size_t size = mSize - 1;
+  const size_t numWordsPerRow = (size + 63) / 64;
+  std::vector<uint64_t> words(size * numWordsPerRow, 0);
+
+  const size_t indexWord = _index / 64;
+  const uint64_t lowMask = (uint64_t(1) << (_index & 63)) - 1;
+  for (size_t i = 0; i < size; ++i)
+  {
+    const size_t oldI = i < _index ? i : i + 1;
+    const uint64_t* oldRow = &mWords[oldI * mNumWordsPerRow];
+    uint64_t* newRow = &words[i * numWordsPerRow];
+
+    // The columns before _index stay in place
+    std::copy(oldRow, oldRow + std::min(indexWord, numWordsPerRow), newRow);
+
+    // The columns after _index move down by one bit
+    for (size_t w = indexWord; w < numWordsPerRow; ++w)
+    {
+      uint64_t word = oldRow[w] >> 1;
+      if (w + 1 < mNumWordsPerRow)
+        word |= oldRow[w + 1] << 63;
+      if (w == indexWord)
+        word = (oldRow[w] & lowMask) | (word & ~lowMask);
+      newRow[w] = word;
+    }
+  }
+
+  mSize = size;
+  mNumWordsPerRow = numWordsPerRow;
+  mWords.swap(words);
+}
+
+//==============================================================================
+void BitMatrix::setAll(bool _value)
+{
+  std::fill(mWords.begin(), mWords.end(), _value ? ~uint64_t(0) : uint64_t(0));
+}
+
+//==============================================================================
+void BitMatrix::set(size_t _i, size_t _j, bool _value)
+{
+  assert(_i < mSize && _j < mSize);
+
+  const uint64_t bitJ = uint64_t(1) << (_j & 63);
+  const uint64_t bitI = uint64_t(1) << (_i & 63);
+  uint64_t& wordIJ = mWords[_i * mNumWordsPerRow + (_j >> 6)];
+  uint64_t& wordJI = mWords[_j * mNumWordsPerRow + (_i >> 6)];
+
+  if (_value)
+  {
+    wordIJ |= bitJ;
+    wordJI |= bitI;
+  }
+  else
+  {
+    wordIJ &= ~bitJ;
+    wordJI &= ~bitI;
+  }
+}
+
+}  // namespace common
+}  // namespace dart
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2016, Georgia Tech Research Corporation
+ * All rights reserved.
+ *
+ * Author(s): Jeongseok Lee <jslee02@gmail.com>
+ *
+ * Georgia Tech Graphics Lab and Humanoid Robotics Lab
+ *
+ * Directed by Prof. C. Karen Liu and Prof. Mike Stilman
+ * <karenliu@cc.gatech.edu> <mstilman@cc.gatech.edu>
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DART_COMMON_BITMATRIX_H_
+#define DART_COMMON_BITMATRIX_H_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dart {
+namespace common {
+
+/// BitMatrix is a symmetric square matrix of bits packed into 64-bit words.
+/// Both (i, j) and (j, i) are stored, so that a lookup is a single bit test
+/// regardless of the order of the indices.
+class BitMatrix
+{
+public:
+  /// Constructor
+  explicit BitMatrix(size_t _size = 0, bool _value = false);
+
+  /// Return the number of rows (and columns)
+  size_t getSize() const;
+
+  /// Change the number of rows and columns. Existing entries are preserved
+  /// and new entries are set to _value.
+  void resize(size_t _size, bool _value = false);
+
+  /// Remove row and column _index. Later indices are shifted down by one.
+  void remove(size_t _index);
+
+  /// Set every entry to _value
+  void setAll(bool _value);
+
+  /// Set entries (_i, _j) and (_j, _i)
+  void set(size_t _i, size_t _j, bool _value);
+
+  /// Return entry (_i, _j)
+  bool get(size_t _i, size_t _j) const
+  {
+    assert(_i < mSize && _j < mSize);
+    return (mWords[_i * mNumWordsPerRow + (_j >> 6)] >> (_j & 63)) & 1u;
+  }
+
+private:
+  /// Number of rows and columns
+  size_t mSize;
+
+  /// Number of words of each row
+  size_t mNumWordsPerRow;
+
+  /// Row-major words of the matrix
+  std::vector<uint64_t> mWords;
+};
+
+}  // namespace common
+}  // namespace dart
+
+#endif  // DART_COMMON_BITMATRIX_H_
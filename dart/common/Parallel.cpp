@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2016, Georgia Tech Research Corporation
+ * All rights reserved.
+ *
+ * Author(s): Jeongseok Lee <jslee02@gmail.com>
+ *
+ * Georgia Tech Graphics Lab and Humanoid Robotics Lab
+ *
+ * Directed by Prof. C. Karen Liu and Prof. Mike Stilman
+ * <karenliu@cc.gatech.edu> <mstilman@cc.gatech.edu>
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dart/common/Parallel.h"
+
+#include <algorithm>
+#include <cassert>
+#include <thread>
+#include <vector>
+
+namespace dart {
+namespace common {
+
+//==============================================================================
+size_t getNumParallelThreads(size_t _numThreads, size_t _numTasks)
+{
+  if (0 == _numThreads)
+    _numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+  return std::min(_numThreads, _numTasks);
+}
+
+//==============================================================================
+void parallelFor(
+    size_t _numTasks, size_t _numThreads,
+    const std::function<void(size_t, size_t, size_t)>& _function)
+{
+  if (0 == _numTasks)
+    return;
+
+  assert(0 < _numThreads && _numThreads <= _numTasks);
+
+  // Thread i takes [i*n/T, (i+1)*n/T), so the sizes of the chunks differ by
+  // at most one and none of them is empty
+  std::vector<std::thread> workers;
+  workers.reserve(_numThreads - 1);
+  for (size_t i = 1; i < _numThreads; ++i)
+  {
+    const size_t begin = i * _numTasks / _numThreads;
+    const size_t end = (i + 1) * _numTasks / _numThreads;
+    workers.push_back(std::thread(_function, i, begin, end));
+  }
+
+  // The calling thread takes care of the first chunk
+  _function(0, 0, _numTasks / _numThreads);
+
+  for (std::thread& worker : workers)
+    worker.join();
+}
+
+}  // namespace common
+}  // namespace dart
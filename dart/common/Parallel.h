@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2016, Georgia Tech Research Corporation
+ * All rights reserved.
+ *
+ * Author(s): Jeongseok Lee <jslee02@gmail.com>
+ *
+ * Georgia Tech Graphics Lab and Humanoid Robotics Lab
+ *
+ * Directed by Prof. C. Karen Liu and Prof. Mike Stilman
+ * <karenliu@cc.gatech.edu> <mstilman@cc.gatech.edu>
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DART_COMMON_PARALLEL_H_
+#define DART_COMMON_PARALLEL_H_
+
+#include <cstddef>
+#include <functional>
+
+namespace dart {
+namespace common {
+
+/// Return the number of threads to use for _numTasks independent tasks when
+/// _numThreads are requested. Zero requests as many threads as the hardware
+/// supports. The result is at least one and at most _numTasks, unless there
+/// are no tasks.
+size_t getNumParallelThreads(size_t _numThreads, size_t _numTasks);
+
+/// Split the tasks [0, _numTasks) into _numThreads contiguous chunks whose
+/// sizes differ by at most one, e.g., 9 tasks on 6 threads give chunks of 1,
+/// 2, 1, 2, 1 and 2 tasks, and call _function(thread, begin, end) for the
+/// chunk [begin, end) of every thread concurrently. The calling thread runs
+/// the chunk of thread 0, so that one thread does not spawn any. The function
+/// returns once every chunk is done. _numThreads must have been resolved by
+/// getNumParallelThreads(), which lets the callers prepare per-thread data,
+/// e.g., clones of a Skeleton, before the threads start.
+void parallelFor(
+    size_t _numTasks, size_t _numThreads,
+    const std::function<void(size_t, size_t, size_t)>& _function);
+
+}  // namespace common
+}  // namespace dart
+
+#endif  // DART_COMMON_PARALLEL_H_
@@ -39,7 +39,7 @@
 
 #include <functional>
 #include <memory>
-#include <set>
+#include <vector>
 
 #include "dart/common/Deprecated.h"
 #include "dart/common/detail/ConnectionBody.h"
@@ -120,9 +120,7 @@ public:
   using SignalType    = Signal<_Res(_ArgTypes...), Combiner>;
 
   using ConnectionBodyType = signal::detail::ConnectionBody<SlotType>;
-  using ConnectionSetType
-    = std::set<std::shared_ptr<ConnectionBodyType>,
-               std::owner_less<std::shared_ptr<ConnectionBodyType>>>;
+  using ConnectionListType = std::vector<std::shared_ptr<ConnectionBodyType>>;
 
   /// Constructor
   Signal();
@@ -161,8 +159,9 @@ public:
   ResultType operator()(ArgTypes&&... _args);
 
 private:
-  /// Connection set
-  ConnectionSetType mConnectionBodies;
+  /// Connection bodies in the order they were connected. Disconnected bodies
+  /// are removed lazily when the signal is raised or cleaned up.
+  ConnectionListType mConnectionBodies;
 };
 
 /// Signal implements a signal/slot mechanism for the slots don't return a value
@@ -174,9 +173,7 @@ public:
   using SignalType = Signal<void(_ArgTypes...)>;
 
   using ConnectionBodyType = signal::detail::ConnectionBody<SlotType>;
-  using ConnectionSetType
-    = std::set<std::shared_ptr<ConnectionBodyType>,
-               std::owner_less<std::shared_ptr<ConnectionBodyType>>>;
+  using ConnectionListType = std::vector<std::shared_ptr<ConnectionBodyType>>;
 
   /// Constructor
   Signal();
@@ -215,8 +212,9 @@ public:
   void operator()(ArgTypes&&... _args);
 
 private:
-  /// Connection set
-  ConnectionSetType mConnectionBodies;
+  /// Connection bodies in the order they were connected. Disconnected bodies
+  /// are removed lazily when the signal is raised or cleaned up.
+  ConnectionListType mConnectionBodies;
 };
 
 /// SlotRegister can be used as a public member for connecting slots to a
@@ -37,6 +37,7 @@
 #ifndef DART_COMMON_DETAIL_SIGNAL_H_
 #define DART_COMMON_DETAIL_SIGNAL_H_
 
+#include <algorithm>
 #include <vector>
 
 namespace dart {
@@ -61,7 +62,7 @@ template <typename _Res, typename... _ArgTypes, template<class> class Combiner>
 Connection Signal<_Res (_ArgTypes...), Combiner>::connect(const SlotType& _slot)
 {
   auto newConnectionBody = std::make_shared<ConnectionBodyType>(_slot);
-  mConnectionBodies.insert(newConnectionBody);
+  mConnectionBodies.push_back(newConnectionBody);
 
   return Connection(std::move(newConnectionBody));
 }
@@ -72,7 +73,7 @@ Connection Signal<_Res (_ArgTypes...), Combiner>::connect(SlotType&& _slot)
 {
   auto newConnectionBody
       = std::make_shared<ConnectionBodyType>(std::forward<SlotType>(_slot));
-  mConnectionBodies.insert(newConnectionBody);
+  mConnectionBodies.push_back(newConnectionBody);
 
   return Connection(std::move(newConnectionBody));
 }
@@ -103,12 +104,11 @@ void Signal<_Res (_ArgTypes...), Combiner>::clenaupConnections()
 template <typename _Res, typename... _ArgTypes, template<class> class Combiner>
 void Signal<_Res (_ArgTypes...), Combiner>::cleanupConnections()
 {
-  // Counts all the connected conection bodies
-  for (const auto& connectionBody : mConnectionBodies)
-  {
-    if (!connectionBody->isConnected())
-      mConnectionBodies.erase(connectionBody);
-  }
+  mConnectionBodies.erase(
+        std::remove_if(mConnectionBodies.begin(), mConnectionBodies.end(),
+                       [](const std::shared_ptr<ConnectionBodyType>& _body)
+                       { return !_body->isConnected(); }),
+        mConnectionBodies.end());
 }
 
 //==============================================================================
@@ -132,23 +132,26 @@ template <typename _Res, typename... _ArgTypes, template<class> class Combiner>
 template <typename... ArgTypes>
 _Res Signal<_Res (_ArgTypes...), Combiner>::raise(ArgTypes&&... _args)
 {
-  std::vector<ResultType> res(mConnectionBodies.size());
-  auto resIt = res.begin();
-
-  for (auto itr = mConnectionBodies.begin(); itr != mConnectionBodies.end(); )
+  std::vector<ResultType> res;
+  res.reserve(mConnectionBodies.size());
+  bool hasDisconnectedBodies = false;
+
+  // Slots may connect other slots while the signal is being raised, which can
+  // reallocate mConnectionBodies, so the connection bodies are accessed by
+  // index
+  for (size_t i = 0; i < mConnectionBodies.size(); ++i)
   {
-    if ((*itr)->isConnected())
-    {
-      *(resIt++) = (*itr)->getSlot()(std::forward<ArgTypes>(_args)...);
-      ++itr;
-    }
+    ConnectionBodyType& connectionBody = *mConnectionBodies[i];
+    if (connectionBody.isConnected())
+      res.push_back(connectionBody.getSlot()(std::forward<ArgTypes>(_args)...));
     else
-    {
-      mConnectionBodies.erase(itr++);
-    }
+      hasDisconnectedBodies = true;
   }
 
-  return Combiner<ResultType>::process(res.begin(), resIt);
+  if (hasDisconnectedBodies)
+    cleanupConnections();
+
+  return Combiner<ResultType>::process(res.begin(), res.end());
 }
 
 //==============================================================================
@@ -178,7 +181,7 @@ template <typename... _ArgTypes>
 Connection Signal<void (_ArgTypes...)>::connect(const SlotType& _slot)
 {
   auto newConnectionBody = std::make_shared<ConnectionBodyType>(_slot);
-  mConnectionBodies.insert(newConnectionBody);
+  mConnectionBodies.push_back(newConnectionBody);
 
   return Connection(std::move(newConnectionBody));
 }
@@ -189,7 +192,7 @@ Connection Signal<void (_ArgTypes...)>::connect(SlotType&& _slot)
 {
   auto newConnectionBody
       = std::make_shared<ConnectionBodyType>(std::forward<SlotType>(_slot));
-  mConnectionBodies.insert(newConnectionBody);
+  mConnectionBodies.push_back(newConnectionBody);
 
   return Connection(std::move(newConnectionBody));
 }
@@ -220,12 +223,11 @@ void Signal<void (_ArgTypes...)>::clenaupConnections()
 template <typename... _ArgTypes>
 void Signal<void (_ArgTypes...)>::cleanupConnections()
 {
-  // Counts all the connected conection bodies
-  for (const auto& connectionBody : mConnectionBodies)
-  {
-    if (!connectionBody->isConnected())
-      mConnectionBodies.erase(connectionBody);
-  }
+  mConnectionBodies.erase(
+        std::remove_if(mConnectionBodies.begin(), mConnectionBodies.end(),
+                       [](const std::shared_ptr<ConnectionBodyType>& _body)
+                       { return !_body->isConnected(); }),
+        mConnectionBodies.end());
 }
 
 //==============================================================================
@@ -249,18 +251,26 @@ template <typename... _ArgTypes>
 template <typename... ArgTypes>
 void Signal<void (_ArgTypes...)>::raise(ArgTypes&&... _args)
 {
-  for (auto itr = mConnectionBodies.begin(); itr != mConnectionBodies.end(); )
+  // Most signals have no slots at all, so return before doing anything else
+  if (mConnectionBodies.empty())
+    return;
+
+  bool hasDisconnectedBodies = false;
+
+  // Slots may connect other slots while the signal is being raised, which can
+  // reallocate mConnectionBodies, so the connection bodies are accessed by
+  // index
+  for (size_t i = 0; i < mConnectionBodies.size(); ++i)
   {
-    if ((*itr)->isConnected())
-    {
-      (*itr)->getSlot()(std::forward<ArgTypes>(_args)...);
-      ++itr;
-    }
+    ConnectionBodyType& connectionBody = *mConnectionBodies[i];
+    if (connectionBody.isConnected())
+      connectionBody.getSlot()(std::forward<ArgTypes>(_args)...);
     else
-    {
-      mConnectionBodies.erase(itr++);
-    }
+      hasDisconnectedBodies = true;
   }
+
+  if (hasDisconnectedBodies)
+    cleanupConnections();
 }
 
 //==============================================================================
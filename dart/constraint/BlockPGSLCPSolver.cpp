@@ -0,0 +1,593 @@
+/*
+ * Copyright (c) 2016, Georgia Tech Research Corporation
+ * All rights reserved.
+ *
+ * Author(s): Jeongseok Lee <jslee02@gmail.com>
+ *
+ * Georgia Tech Graphics Lab and Humanoid Robotics Lab
+ *
+ * Directed by Prof. C. Karen Liu and Prof. Mike Stilman
+ * <karenliu@cc.gatech.edu> <mstilman@cc.gatech.edu>
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dart/constraint/BlockPGSLCPSolver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+#include "dart/common/Console.h"
+#include "dart/constraint/ConstraintBase.h"
+#include "dart/constraint/ConstrainedGroup.h"
+
+#define BLOCK_PGS_DEFAULT_MAX_ITERATIONS 100
+#define BLOCK_PGS_DEFAULT_TOLERANCE      1e-6
+#define BLOCK_PGS_DEFAULT_RELAXATION     1.0
+#define BLOCK_PGS_EPS_DIVIDE             1e-9
+
+namespace dart {
+namespace constraint {
+
+//==============================================================================
+BlockPGSLCPSolver::BlockPGSLCPSolver(double _timestep)
+  : LCPSolver(_timestep),
+    mMaxIterations(BLOCK_PGS_DEFAULT_MAX_ITERATIONS),
+    mTolerance(BLOCK_PGS_DEFAULT_TOLERANCE),
+    mRelaxation(BLOCK_PGS_DEFAULT_RELAXATION),
+    mFrictionModel(FRICTION_CONE),
+    mNNCGEnabled(false),
+    mNumIterations(0),
+    mMaxImpulseChange(0.0)
+{
+}
+
+//==============================================================================
+BlockPGSLCPSolver::~BlockPGSLCPSolver()
+{
+}
+
+//==============================================================================
+void BlockPGSLCPSolver::solve(ConstrainedGroup* _group)
+{
+  mNumIterations = 0;
+  mMaxImpulseChange = 0.0;
+
+  // If there is no constraint, then just return true.
+  const size_t numConstraints = _group->getNumConstraints();
+  if (numConstraints == 0)
+    return;
+
+  buildSystem(_group);
+
+  if (mMaxIterations > 0)
+  {
+    if (mNNCGEnabled)
+    {
+      // Nonsmooth nonlinear conjugate gradient: every PGS sweep is treated as
+      // a (negative) gradient step, and the search direction is restarted
+      // whenever the gradient grows.
+      Eigen::VectorXd xPrev = mX;
+      mMaxImpulseChange = sweep();
+      mNumIterations = 1;
+
+      Eigen::VectorXd grad = xPrev - mX;
+      Eigen::VectorXd dir = -grad;
+      double gradSqNorm = grad.squaredNorm();
+
+      while (mMaxImpulseChange > mTolerance && mNumIterations < mMaxIterations)
+      {
+        xPrev = mX;
+        mMaxImpulseChange = sweep();
+        ++mNumIterations;
+
+        if (mMaxImpulseChange <= mTolerance || mNumIterations >= mMaxIterations)
+          break;
+
+        const Eigen::VectorXd newGrad = xPrev - mX;
+        const double newGradSqNorm = newGrad.squaredNorm();
+        const double beta = gradSqNorm > 0.0 ? newGradSqNorm / gradSqNorm
+                                             : 0.0;
+
+        if (beta > 1.0)
+        {
+          dir.setZero();
+        }
+        else
+        {
+          mX += beta * dir;
+          dir = beta * dir - newGrad;
+        }
+
+        grad = newGrad;
+        gradSqNorm = newGradSqNorm;
+      }
+    }
+    else
+    {
+      do
+      {
+        mMaxImpulseChange = sweep();
+        ++mNumIterations;
+      }
+      while (mMaxImpulseChange > mTolerance && mNumIterations < mMaxIterations);
+    }
+  }
+
+  // Apply constraint impulses
+  for (size_t i = 0; i < numConstraints; ++i)
+  {
+    const ConstraintBasePtr& constraint = _group->getConstraint(i);
+    constraint->applyImpulse(mX.data() + mOffsets[i]);
+    constraint->excite();
+  }
+}
+
+//==============================================================================
+void BlockPGSLCPSolver::setMaxIterations(size_t _maxIterations)
+{
+  mMaxIterations = _maxIterations;
+}
+
+//==============================================================================
+size_t BlockPGSLCPSolver::getMaxIterations() const
+{
+  return mMaxIterations;
+}
+
+//==============================================================================
+void BlockPGSLCPSolver::setTolerance(double _tolerance)
+{
+  mTolerance = _tolerance;
+}
+
+//==============================================================================
+double BlockPGSLCPSolver::getTolerance() const
+{
+  return mTolerance;
+}
+
+//==============================================================================
+void BlockPGSLCPSolver::setRelaxation(double _relaxation)
+{
+  if (_relaxation <= 0.0 || _relaxation >= 2.0)
+  {
+    dtwarn << "[BlockPGSLCPSolver::setRelaxation] Relaxation weight ["
+           << _relaxation << "] is out of the range of (0, 2). Ignoring this "
+           << "request.\n";
+    return;
+  }
+
+  mRelaxation = _relaxation;
+}
+
+//==============================================================================
+double BlockPGSLCPSolver::getRelaxation() const
+{
+  return mRelaxation;
+}
+
+//==============================================================================
+void BlockPGSLCPSolver::setFrictionModel(FrictionModel _model)
+{
+  mFrictionModel = _model;
+}
+
+//==============================================================================
+BlockPGSLCPSolver::FrictionModel BlockPGSLCPSolver::getFrictionModel() const
+{
+  return mFrictionModel;
+}
+
+//==============================================================================
+void BlockPGSLCPSolver::setNNCGEnabled(bool _enabled)
+{
+  mNNCGEnabled = _enabled;
+}
+
+//==============================================================================
+bool BlockPGSLCPSolver::isNNCGEnabled() const
+{
+  return mNNCGEnabled;
+}
+
+//==============================================================================
+size_t BlockPGSLCPSolver::getNumIterations() const
+{
+  return mNumIterations;
+}
+
+//==============================================================================
+double BlockPGSLCPSolver::getMaxImpulseChange() const
+{
+  return mMaxImpulseChange;
+}
+
+//==============================================================================
+void BlockPGSLCPSolver::buildSystem(ConstrainedGroup* _group)
+{
+  const size_t numConstraints = _group->getNumConstraints();
+  const size_t n = _group->getTotalDimension();
+
+  std::vector<ConstraintBase*> constraints(numConstraints);
+  mOffsets.resize(numConstraints);
+  mDims.resize(numConstraints);
+  size_t offset = 0;
+  for (size_t i = 0; i < numConstraints; ++i)
+  {
+    constraints[i] = _group->getConstraint(i).get();
+    mDims[i] = constraints[i]->getDimension();
+    assert(mDims[i] > 0);
+    mOffsets[i] = offset;
+    offset += mDims[i];
+  }
+  assert(offset == n);
+
+  mX.setZero(n);
+  mB.setZero(n);
+  mLo.setZero(n);
+  mHi.setZero(n);
+  mW.setZero(n);
+  mRhs.setZero(n);
+  mFIndex.assign(n, -1);
+
+  // Find the pairs of constraints that can change each other's velocities. Two
+  // constraints are coupled if they share a reactive Skeleton. Constraints
+  // that cannot report their Skeletons are coupled with everything.
+  std::vector<std::vector<size_t>> neighbors(numConstraints);
+  std::unordered_map<dynamics::Skeleton*, std::vector<size_t>> skelConstraints;
+  std::vector<size_t> unknown;
+  std::vector<dynamics::Skeleton*> skeletons;
+  for (size_t i = 0; i < numConstraints; ++i)
+  {
+    skeletons.clear();
+    if (!constraints[i]->getReactiveSkeletons(skeletons))
+    {
+      unknown.push_back(i);
+      continue;
+    }
+
+    for (dynamics::Skeleton* skel : skeletons)
+      skelConstraints[skel].push_back(i);
+  }
+
+  for (const auto& entry : skelConstraints)
+  {
+    const std::vector<size_t>& list = entry.second;
+    for (size_t a = 0; a < list.size(); ++a)
+    {
+      for (size_t b = a + 1; b < list.size(); ++b)
+      {
+        neighbors[list[a]].push_back(list[b]);
+        neighbors[list[b]].push_back(list[a]);
+      }
+    }
+  }
+
+  for (size_t u : unknown)
+  {
+    for (size_t i = 0; i < numConstraints; ++i)
+    {
+      if (i == u)
+        continue;
+
+      neighbors[u].push_back(i);
+      neighbors[i].push_back(u);
+    }
+  }
+
+  // Lay out the block rows: the diagonal block first, followed by the
+  // off-diagonal blocks in ascending column order
+  mRowBegin.resize(numConstraints + 1);
+  mBlocks.clear();
+  size_t dataSize = 0;
+  for (size_t i = 0; i < numConstraints; ++i)
+  {
+    std::vector<size_t>& row = neighbors[i];
+    std::sort(row.begin(), row.end());
+    row.erase(std::unique(row.begin(), row.end()), row.end());
+
+    mRowBegin[i] = mBlocks.size();
+
+    Block diagonal;
+    diagonal.mColumn = i;
+    diagonal.mDataOffset = dataSize;
+    mBlocks.push_back(diagonal);
+    dataSize += mDims[i] * mDims[i];
+
+    for (size_t k : row)
+    {
+      Block block;
+      block.mColumn = k;
+      block.mDataOffset = dataSize;
+      mBlocks.push_back(block);
+      dataSize += mDims[i] * mDims[k];
+    }
+  }
+  mRowBegin[numConstraints] = mBlocks.size();
+  mBlockData.assign(dataSize, 0.0);
+
+  // Next lower (column < row) block of each row that is still to be filled
+  std::vector<size_t> lowerCursor(numConstraints);
+  for (size_t i = 0; i < numConstraints; ++i)
+    lowerCursor[i] = mRowBegin[i] + 1;
+
+  mIsContactBlock.assign(numConstraints, false);
+
+  // Fill the bounds and the blocks by impulse tests. Only the upper blocks are
+  // measured, and the lower blocks are filled by symmetry.
+  ConstraintInfo constInfo;
+  constInfo.invTimeStep = 1.0 / mTimeStep;
+  Eigen::VectorXd velChange(n);
+  for (size_t i = 0; i < numConstraints; ++i)
+  {
+    ConstraintBase* constraint = constraints[i];
+    const size_t oi = mOffsets[i];
+    const size_t di = mDims[i];
+
+    constInfo.x      = mX.data()   + oi;
+    constInfo.lo     = mLo.data()  + oi;
+    constInfo.hi     = mHi.data()  + oi;
+    constInfo.b      = mB.data()   + oi;
+    constInfo.findex = mFIndex.data() + oi;
+    constInfo.w      = mW.data()   + oi;
+
+    // Fill vectors: lo, hi, b, w
+    constraint->getInformation(&constInfo);
+
+    // Adjust findex for global index
+    for (size_t j = 0; j < di; ++j)
+    {
+      if (mFIndex[oi + j] >= 0)
+        mFIndex[oi + j] += oi;
+    }
+
+    mIsContactBlock[i] = (di == 3)
+        && mFIndex[oi] < 0
+        && mFIndex[oi + 1] == static_cast<int>(oi)
+        && mFIndex[oi + 2] == static_cast<int>(oi);
+
+    const size_t rowBegin = mRowBegin[i];
+    const size_t rowEnd = mRowBegin[i + 1];
+
+    constraint->excite();
+    for (size_t j = 0; j < di; ++j)
+    {
+      // Apply impulse for impulse test
+      constraint->applyUnitImpulse(j);
+
+      // Diagonal block: column j
+      constraint->getVelocityChange(velChange.data(), true);
+      double* diag = mBlockData.data() + mBlocks[rowBegin].mDataOffset;
+      for (size_t a = 0; a < di; ++a)
+        diag[a * di + j] = velChange[a];
+
+      // Off-diagonal blocks against the constraints that come after this one
+      for (size_t blockIndex = rowBegin + 1; blockIndex < rowEnd; ++blockIndex)
+      {
+        const size_t k = mBlocks[blockIndex].mColumn;
+        if (k < i)
+          continue;
+
+        const size_t dk = mDims[k];
+        constraints[k]->getVelocityChange(velChange.data(), false);
+
+        // A_ik, row j
+        double* upper = mBlockData.data() + mBlocks[blockIndex].mDataOffset;
+        for (size_t l = 0; l < dk; ++l)
+          upper[j * dk + l] = velChange[l];
+
+        // A_ki, column j
+        const Block& lowerBlock = mBlocks[lowerCursor[k]];
+        assert(lowerBlock.mColumn == i);
+        double* lower = mBlockData.data() + lowerBlock.mDataOffset;
+        for (size_t l = 0; l < dk; ++l)
+          lower[l * di + j] = velChange[l];
+      }
+    }
+
+    // Advance the lower cursors of the rows that were just filled
+    for (size_t blockIndex = rowBegin + 1; blockIndex < rowEnd; ++blockIndex)
+    {
+      const size_t k = mBlocks[blockIndex].mColumn;
+      if (k > i)
+        ++lowerCursor[k];
+    }
+
+    constraint->unexcite();
+  }
+}
+
+//==============================================================================
+double BlockPGSLCPSolver::sweep()
+{
+  const size_t numBlocks = mDims.size();
+  double maxChange = 0.0;
+
+  for (size_t i = 0; i < numBlocks; ++i)
+  {
+    const size_t oi = mOffsets[i];
+    const size_t di = mDims[i];
+
+    // rhs = b_i - sum_{k != i} A_ik x_k
+    for (size_t a = 0; a < di; ++a)
+      mRhs[oi + a] = mB[oi + a];
+
+    for (size_t blockIndex = mRowBegin[i] + 1; blockIndex < mRowBegin[i + 1];
+         ++blockIndex)
+    {
+      const Block& block = mBlocks[blockIndex];
+      const size_t ok = mOffsets[block.mColumn];
+      const size_t dk = mDims[block.mColumn];
+      const double* data = mBlockData.data() + block.mDataOffset;
+
+      for (size_t a = 0; a < di; ++a)
+      {
+        double sum = 0.0;
+        for (size_t l = 0; l < dk; ++l)
+          sum += data[a * dk + l] * mX[ok + l];
+        mRhs[oi + a] -= sum;
+      }
+    }
+
+    const double change = mIsContactBlock[i] ? solveContactBlock(i)
+                                             : solveGenericBlock(i);
+    maxChange = std::max(maxChange, change);
+  }
+
+  return maxChange;
+}
+
+//==============================================================================
+double BlockPGSLCPSolver::solveContactBlock(size_t _block)
+{
+  const size_t o = mOffsets[_block];
+  const double* A = mBlockData.data() + mBlocks[mRowBegin[_block]].mDataOffset;
+  const double w = mRelaxation;
+
+  const double old0 = mX[o];
+  const double old1 = mX[o + 1];
+  const double old2 = mX[o + 2];
+
+  // Normal impulse, given the current tangential impulses
+  if (A[0] < BLOCK_PGS_EPS_DIVIDE)
+  {
+    mX[o] = 0.0;
+    mX[o + 1] = 0.0;
+    mX[o + 2] = 0.0;
+    return std::max(std::abs(old0), std::max(std::abs(old1), std::abs(old2)));
+  }
+
+  double xn = (mRhs[o] - A[1] * mX[o + 1] - A[2] * mX[o + 2]) / A[0];
+  xn = w * xn + (1.0 - w) * mX[o];
+  xn = std::min(std::max(xn, mLo[o]), mHi[o]);
+  mX[o] = xn;
+
+  // Tangential impulses, given the new normal impulse
+  const double r1 = mRhs[o + 1] - A[3] * xn;
+  const double r2 = mRhs[o + 2] - A[6] * xn;
+  const double a11 = A[4];
+  const double a12 = A[5];
+  const double a21 = A[7];
+  const double a22 = A[8];
+
+  double t1;
+  double t2;
+  const double det = a11 * a22 - a12 * a21;
+  if (std::abs(det) > BLOCK_PGS_EPS_DIVIDE)
+  {
+    t1 = ( a22 * r1 - a12 * r2) / det;
+    t2 = (-a21 * r1 + a11 * r2) / det;
+  }
+  else
+  {
+    t1 = a11 > BLOCK_PGS_EPS_DIVIDE ? (r1 - a12 * mX[o + 2]) / a11 : 0.0;
+    t2 = a22 > BLOCK_PGS_EPS_DIVIDE ? (r2 - a21 * t1) / a22 : 0.0;
+  }
+
+  t1 = w * t1 + (1.0 - w) * mX[o + 1];
+  t2 = w * t2 + (1.0 - w) * mX[o + 2];
+
+  // Project onto the friction cone or pyramid. The friction coefficients are
+  // stored in the upper bounds of the friction rows.
+  const double limit1 = mHi[o + 1] * xn;
+  const double limit2 = mHi[o + 2] * xn;
+  if (limit1 <= 0.0 || limit2 <= 0.0)
+  {
+    t1 = 0.0;
+    t2 = 0.0;
+  }
+  else if (mFrictionModel == FRICTION_CONE)
+  {
+    const double u1 = t1 / limit1;
+    const double u2 = t2 / limit2;
+    const double ratio = std::sqrt(u1 * u1 + u2 * u2);
+    if (ratio > 1.0)
+    {
+      t1 /= ratio;
+      t2 /= ratio;
+    }
+  }
+  else
+  {
+    t1 = std::min(std::max(t1, -limit1), limit1);
+    t2 = std::min(std::max(t2, -limit2), limit2);
+  }
+
+  mX[o + 1] = t1;
+  mX[o + 2] = t2;
+
+  return std::max(std::abs(xn - old0),
+                  std::max(std::abs(t1 - old1), std::abs(t2 - old2)));
+}
+
+//==============================================================================
+double BlockPGSLCPSolver::solveGenericBlock(size_t _block)
+{
+  const size_t o = mOffsets[_block];
+  const size_t d = mDims[_block];
+  const double* A = mBlockData.data() + mBlocks[mRowBegin[_block]].mDataOffset;
+  const double w = mRelaxation;
+  double change = 0.0;
+
+  for (size_t a = 0; a < d; ++a)
+  {
+    const size_t idx = o + a;
+    const double diag = A[a * d + a];
+    if (diag < BLOCK_PGS_EPS_DIVIDE)
+    {
+      change = std::max(change, std::abs(mX[idx]));
+      mX[idx] = 0.0;
+      continue;
+    }
+
+    double newX = mRhs[idx];
+    for (size_t c = 0; c < d; ++c)
+    {
+      if (c != a)
+        newX -= A[a * d + c] * mX[o + c];
+    }
+    newX /= diag;
+    newX = w * newX + (1.0 - w) * mX[idx];
+
+    double lo = mLo[idx];
+    double hi = mHi[idx];
+    if (mFIndex[idx] >= 0)
+    {
+      hi = mHi[idx] * mX[mFIndex[idx]];
+      lo = -hi;
+    }
+
+    newX = std::min(std::max(newX, lo), hi);
+    change = std::max(change, std::abs(newX - mX[idx]));
+    mX[idx] = newX;
+  }
+
+  return change;
+}
+
+}  // namespace constraint
+}  // namespace dart
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2016, Georgia Tech Research Corporation
+ * All rights reserved.
+ *
+ * Author(s): Jeongseok Lee <jslee02@gmail.com>
+ *
+ * Georgia Tech Graphics Lab and Humanoid Robotics Lab
+ *
+ * Directed by Prof. C. Karen Liu and Prof. Mike Stilman
+ * <karenliu@cc.gatech.edu> <mstilman@cc.gatech.edu>
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DART_CONSTRAINT_BLOCKPGSLCPSOLVER_H_
+#define DART_CONSTRAINT_BLOCKPGSLCPSOLVER_H_
+
+#include <cstddef>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "dart/constraint/LCPSolver.h"
+
+namespace dart {
+namespace constraint {
+
+/// BlockPGSLCPSolver solves the constraint impulses of a ConstrainedGroup with
+/// a block projected Gauss-Seidel method, optionally accelerated by the
+/// nonsmooth nonlinear conjugate gradient (NNCG) method.
+///
+/// Each constraint is one block of the Delassus matrix, and only the blocks
+/// between constraints that share a reactive Skeleton are stored, so the
+/// memory and the cost of one sweep grow with the number of coupled
+/// constraint pairs instead of quadratically with the number of constraints.
+/// The three rows of a frictional contact are solved together and projected
+/// onto the friction cone (or pyramid) as a block.
+class BlockPGSLCPSolver : public LCPSolver
+{
+public:
+  /// Friction model used for the contact blocks
+  enum FrictionModel
+  {
+    /// Project the tangential impulse onto the (elliptic) Coulomb cone
+    FRICTION_CONE = 0,
+
+    /// Clamp each tangential impulse independently, which matches the boxed
+    /// friction model of the Dantzig and PGS solvers
+    FRICTION_PYRAMID
+  };
+
+  /// Constructor
+  explicit BlockPGSLCPSolver(double _timestep);
+
+  /// Destructor
+  virtual ~BlockPGSLCPSolver();
+
+  // Documentation inherited
+  virtual void solve(ConstrainedGroup* _group);
+
+  /// Set the maximum number of sweeps per solve
+  void setMaxIterations(size_t _maxIterations);
+
+  /// Get the maximum number of sweeps per solve
+  size_t getMaxIterations() const;
+
+  /// Set the convergence tolerance. The iteration terminates early once the
+  /// largest change of any impulse in one sweep drops below this value.
+  void setTolerance(double _tolerance);
+
+  /// Get the convergence tolerance
+  double getTolerance() const;
+
+  /// Set the successive over-relaxation weight in the range of (0, 2)
+  void setRelaxation(double _relaxation);
+
+  /// Get the successive over-relaxation weight
+  double getRelaxation() const;
+
+  /// Set the friction model used for the contact blocks
+  void setFrictionModel(FrictionModel _model);
+
+  /// Get the friction model used for the contact blocks
+  FrictionModel getFrictionModel() const;
+
+  /// Set whether the sweeps should be accelerated by NNCG
+  void setNNCGEnabled(bool _enabled);
+
+  /// Return true if the sweeps are accelerated by NNCG
+  bool isNNCGEnabled() const;
+
+  /// Get the number of sweeps that were performed by the last solve
+  size_t getNumIterations() const;
+
+  /// Get the largest change of any impulse in the last sweep of the last
+  /// solve. This is the quantity compared against the tolerance, not the
+  /// complementarity residual of the LCP.
+  double getMaxImpulseChange() const;
+
+protected:
+  /// Build the block-sparse Delassus matrix and the bounds of _group
+  void buildSystem(ConstrainedGroup* _group);
+
+  /// Perform one block Gauss-Seidel sweep and return the largest change of
+  /// any impulse
+  double sweep();
+
+  /// Solve a contact block (normal row followed by two friction rows) given
+  /// the right hand side in mRhs, and return the largest change of its
+  /// impulses
+  double solveContactBlock(size_t _block);
+
+  /// Solve a generic block row by row given the right hand side in mRhs, and
+  /// return the largest change of its impulses
+  double solveGenericBlock(size_t _block);
+
+  /// One stored block A_ij of the Delassus matrix. The entries are kept in
+  /// mBlockData in row-major order.
+  struct Block
+  {
+    /// Index of the column constraint
+    size_t mColumn;
+
+    /// Offset of the entries in mBlockData
+    size_t mDataOffset;
+  };
+
+  /// Maximum number of sweeps
+  size_t mMaxIterations;
+
+  /// Convergence tolerance
+  double mTolerance;
+
+  /// Successive over-relaxation weight
+  double mRelaxation;
+
+  /// Friction model
+  FrictionModel mFrictionModel;
+
+  /// True if NNCG acceleration is enabled
+  bool mNNCGEnabled;
+
+  /// Number of sweeps of the last solve
+  size_t mNumIterations;
+
+  /// Largest change of any impulse in the last sweep of the last solve
+  double mMaxImpulseChange;
+
+  /// Row offset of each constraint
+  std::vector<size_t> mOffsets;
+
+  /// Dimension of each constraint
+  std::vector<size_t> mDims;
+
+  /// True if the constraint is a frictional contact block
+  std::vector<bool> mIsContactBlock;
+
+  /// First stored block of each block row in mBlocks. The blocks of row i are
+  /// mBlocks[mRowBegin[i]] to mBlocks[mRowBegin[i+1]-1], and the first one is
+  /// always the diagonal block.
+  std::vector<size_t> mRowBegin;
+
+  /// Stored blocks
+  std::vector<Block> mBlocks;
+
+  /// Entries of all the stored blocks
+  std::vector<double> mBlockData;
+
+  /// Impulses
+  Eigen::VectorXd mX;
+
+  /// Bias velocities
+  Eigen::VectorXd mB;
+
+  /// Lower bounds
+  Eigen::VectorXd mLo;
+
+  /// Upper bounds
+  Eigen::VectorXd mHi;
+
+  /// Slack variables (only used to query the constraints)
+  Eigen::VectorXd mW;
+
+  /// Right hand side of the block that is being solved
+  Eigen::VectorXd mRhs;
+
+  /// Friction indices
+  std::vector<int> mFIndex;
+};
+
+} // namespace constraint
+} // namespace dart
+
+#endif  // DART_CONSTRAINT_BLOCKPGSLCPSOLVER_H_
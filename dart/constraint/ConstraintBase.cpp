@@ -63,6 +63,19 @@ size_t ConstraintBase::getDimension() const
   return mDim;
 }
 
+//==============================================================================
+bool ConstraintBase::getReactiveSkeletons(
+    std::vector<dynamics::Skeleton*>& /*_skeletons*/) const
+{
+  return false;
+}
+
+//==============================================================================
+bool ConstraintBase::getErrorReductionGains(double* /*_gains*/) const
+{
+  return false;
+}
+
 //==============================================================================
 dynamics::SkeletonPtr ConstraintBase::compressPath(
     dynamics::SkeletonPtr _skeleton)
@@ -38,6 +38,7 @@
 #define DART_CONSTRAINT_CONSTRAINTBASE_H_
 
 #include <cstddef>
+#include <vector>
 
 #include "dart/dynamics/SmartPointer.h"
 
@@ -111,6 +112,21 @@ public:
   ///
   virtual void uniteSkeletons() {}
 
+  /// Append the Skeletons whose velocities are changed by the impulses of this
+  /// constraint, i.e., the Skeletons that excite() marks as impulse-applied.
+  /// Returns false if the constraint cannot tell, in which case it must be
+  /// treated as coupled with every other constraint of its ConstrainedGroup.
+  virtual bool getReactiveSkeletons(
+      std::vector<dynamics::Skeleton*>& _skeletons) const;
+
+  /// Fill _gains with the derivative of the bias b of each row with respect
+  /// to the displacement J_i * dq along that row, i.e., how the position error
+  /// correction of the row responds to a change of the positions. It is used
+  /// to differentiate the impulses, see DantzigLCPSolver. Returns false if the
+  /// constraint cannot tell, in which case the impulses of its
+  /// ConstrainedGroup are not differentiated. The default returns false.
+  virtual bool getErrorReductionGains(double* _gains) const;
+
   ///
   static dynamics::SkeletonPtr compressPath(dynamics::SkeletonPtr _skeleton);
 
@@ -42,6 +42,7 @@
 #include "dart/dynamics/Joint.h"
 #include "dart/dynamics/Skeleton.h"
 #include "dart/collision/fcl_mesh/FCLMeshCollisionDetector.h"
+#include "dart/collision/dart/DARTCollide.h"
 #include "dart/collision/dart/DARTCollisionDetector.h"
 #ifdef HAVE_BULLET_COLLISION
   #include "dart/collision/bullet/BulletCollisionDetector.h"
@@ -64,7 +65,8 @@ using namespace dynamics;
 ConstraintSolver::ConstraintSolver(double _timeStep)
   : mCollisionDetector(new collision::FCLMeshCollisionDetector()),
     mTimeStep(_timeStep),
-    mLCPSolver(new DantzigLCPSolver(mTimeStep))
+    mLCPSolver(new DantzigLCPSolver(mTimeStep)),
+    mMaxNumContactsPerPair(0)
 {
   assert(_timeStep > 0.0);
 }
@@ -219,6 +221,12 @@ void ConstraintSolver::removeAllConstraints()
   mManualConstraints.clear();
 }
 
+//==============================================================================
+size_t ConstraintSolver::getNumConstraints() const
+{
+  return mManualConstraints.size();
+}
+
 //==============================================================================
 void ConstraintSolver::setTimeStep(double _timeStep)
 {
@@ -258,12 +266,52 @@ collision::CollisionDetector* ConstraintSolver::getCollisionDetector() const
   return mCollisionDetector;
 }
 
+//==============================================================================
+void ConstraintSolver::setLCPSolver(LCPSolver* _lcpSolver)
+{
+  assert(_lcpSolver && "Invalid LCP solver.");
+
+  if (_lcpSolver == mLCPSolver)
+    return;
+
+  _lcpSolver->setTimeStep(mTimeStep);
+
+  // Release the old LCP solver
+  delete mLCPSolver;
+
+  mLCPSolver = _lcpSolver;
+}
+
+//==============================================================================
+LCPSolver* ConstraintSolver::getLCPSolver() const
+{
+  return mLCPSolver;
+}
+
+//==============================================================================
+void ConstraintSolver::setMaxNumContactsPerPair(size_t _maxNumContacts)
+{
+  mMaxNumContactsPerPair = _maxNumContacts;
+}
+
+//==============================================================================
+size_t ConstraintSolver::getMaxNumContactsPerPair() const
+{
+  return mMaxNumContactsPerPair;
+}
+
 //==============================================================================
 void ConstraintSolver::solve()
 {
   for (size_t i = 0; i < mSkeletons.size(); ++i)
     mSkeletons[i]->clearConstraintImpulses();
 
+  // Only keep the LCP records of this solve, so that they do not pile up over
+  // the steps of a simulation
+  DantzigLCPSolver* dantzig = dynamic_cast<DantzigLCPSolver*>(mLCPSolver);
+  if (dantzig)
+    dantzig->clearRecords();
+
   // Update constraints and collect active constraints
   updateConstraints();
 
@@ -352,6 +400,8 @@ void ConstraintSolver::updateConstraints()
   //----------------------------------------------------------------------------
   mCollisionDetector->clearAllContacts();
   mCollisionDetector->detectCollision(true, true);
+  mCollisionDetector->reduceContacts(mMaxNumContactsPerPair);
+  detectSpeculativeContacts();
 
   // Destroy previous contact constraints
   mContactConstraints.clear();
@@ -362,7 +412,7 @@ void ConstraintSolver::updateConstraints()
   // Create new contact constraints
   for (size_t i = 0; i < mCollisionDetector->getNumContacts(); ++i)
   {
-    collision::Contact& ct = mCollisionDetector->getContact(i);
+    collision::ContactRecord& ct = mCollisionDetector->getContactRecord(i);
 
     if (isSoftContact(ct))
     {
@@ -376,6 +426,12 @@ void ConstraintSolver::updateConstraints()
     }
   }
 
+  for (collision::ContactRecord& ct : mSpeculativeContacts)
+  {
+    mContactConstraints.push_back(
+          std::make_shared<ContactConstraint>(ct, mTimeStep));
+  }
+
   // Add the new contact constraints to dynamic constraint list
   for (const auto& contactConstraint : mContactConstraints)
   {
@@ -537,10 +593,98 @@ void ConstraintSolver::solveConstrainedGroups()
 }
 
 //==============================================================================
-bool ConstraintSolver::isSoftContact(const collision::Contact& _contact) const
+void ConstraintSolver::detectSpeculativeContacts()
+{
+  mSpeculativeContacts.clear();
+
+  std::vector<dynamics::BodyNode*> bodyNodes;
+  bool hasCCD = false;
+  for (const auto& skel : mSkeletons)
+  {
+    for (size_t i = 0; i < skel->getNumBodyNodes(); ++i)
+    {
+      dynamics::BodyNode* bodyNode = skel->getBodyNode(i);
+      bodyNodes.push_back(bodyNode);
+      hasCCD = hasCCD || bodyNode->isCCDEnabled();
+    }
+  }
+
+  if (!hasCCD)
+    return;
+
+  for (size_t i = 0; i < bodyNodes.size(); ++i)
+  {
+    dynamics::BodyNode* bodyNode1 = bodyNodes[i];
+    if (!bodyNode1->isCCDEnabled())
+      continue;
+
+    const Eigen::Isometry3d& T1 = bodyNode1->getWorldTransform();
+
+    for (size_t j = 0; j < bodyNodes.size(); ++j)
+    {
+      dynamics::BodyNode* bodyNode2 = bodyNodes[j];
+
+      // Pairs of two CCD body nodes are only visited once
+      if (i == j || (j < i && bodyNode2->isCCDEnabled()))
+        continue;
+
+      if (!mCollisionDetector->isCollidable(bodyNode1, bodyNode2))
+        continue;
+
+      const Eigen::Isometry3d& T2 = bodyNode2->getWorldTransform();
+
+      for (size_t k = 0; k < bodyNode1->getNumCollisionShapes(); ++k)
+      {
+        const dynamics::ShapePtr shape1 = bodyNode1->getCollisionShape(k);
+
+        for (size_t l = 0; l < bodyNode2->getNumCollisionShapes(); ++l)
+        {
+          const dynamics::ShapePtr shape2 = bodyNode2->getCollisionShape(l);
+
+          // Penetrating shapes are handled by the collision detector, and
+          // non-convex shapes are not supported
+          Eigen::Vector3d point1;
+          Eigen::Vector3d point2;
+          Eigen::Vector3d normal;
+          const double distance = collision::computeDistance(
+                shape1, T1 * shape1->getLocalTransform(),
+                shape2, T2 * shape2->getLocalTransform(),
+                &point1, &point2, &normal);
+          if (distance <= 0.0)
+            continue;
+
+          // The velocities are the ones the positions will be integrated with
+          const Eigen::Vector3d relVel
+              = bodyNode1->getLinearVelocity(T1.inverse() * point1)
+                - bodyNode2->getLinearVelocity(T2.inverse() * point2);
+          if (relVel.norm() * mTimeStep <= distance)
+            continue;
+
+          collision::ContactRecord contact;
+          contact.point = 0.5 * (point1 + point2);
+          contact.normal = normal;
+          contact.force.setZero();
+          contact.bodyNode1 = bodyNode1;
+          contact.bodyNode2 = bodyNode2;
+          contact.shape1 = shape1.get();
+          contact.shape2 = shape2.get();
+          contact.penetrationDepth = -distance;
+          contact.triID1 = 0;
+          contact.triID2 = 0;
+          contact.userData = nullptr;
+          mSpeculativeContacts.push_back(contact);
+        }
+      }
+    }
+  }
+}
+
+//==============================================================================
+bool ConstraintSolver::isSoftContact(
+    const collision::ContactRecord& _contact) const
 {
-  if (dynamic_cast<dynamics::SoftBodyNode*>(_contact.bodyNode1.lock().get())
-      || dynamic_cast<dynamics::SoftBodyNode*>(_contact.bodyNode2.lock().get()))
+  if (_contact.bodyNode1->asSoftBodyNode()
+      || _contact.bodyNode2->asSoftBodyNode())
     return true;
 
   return false;
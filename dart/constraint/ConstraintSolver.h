@@ -95,6 +95,9 @@ public:
   /// Remove all constraints
   void removeAllConstraints();
 
+  /// Get the number of constraints that were added with addConstraint()
+  size_t getNumConstraints() const;
+
   /// Set time step
   void setTimeStep(double _timeStep);
 
@@ -107,6 +110,23 @@ public:
   /// Get collision detector
   collision::CollisionDetector* getCollisionDetector() const;
 
+  /// Set LCP solver. The constraint solver takes the ownership of the given
+  /// LCP solver and releases the old one.
+  void setLCPSolver(LCPSolver* _lcpSolver);
+
+  /// Get LCP solver
+  LCPSolver* getLCPSolver() const;
+
+  /// Set the maximum number of contacts kept for each colliding body pair.
+  /// The contacts of a pair are reduced to a manifold of the deepest point
+  /// and the points spanning the largest support area before the contact
+  /// constraints are created. Four is enough for stable stacking; zero (the
+  /// default) keeps every contact the collision detector reports.
+  void setMaxNumContactsPerPair(size_t _maxNumContacts);
+
+  /// Get the maximum number of contacts kept for each colliding body pair
+  size_t getMaxNumContactsPerPair() const;
+
   /// Solve constraint impulses and apply them to the skeletons
   void solve();
 
@@ -133,7 +153,13 @@ private:
   void solveConstrainedGroups();
 
   /// Return true if at least one of colliding body is soft body
-  bool isSoftContact(const collision::Contact& _contact) const;
+  bool isSoftContact(const collision::ContactRecord& _contact) const;
+
+  /// Add speculative contacts for the body nodes that use continuous collision
+  /// detection. A contact with a negative penetration depth is created for
+  /// each pair of shapes whose gap can be closed by the relative velocity of
+  /// their closest points within one time step.
+  void detectSpeculativeContacts();
 
   /// Collision detector
   collision::CollisionDetector* mCollisionDetector;
@@ -144,9 +170,16 @@ private:
   /// LCP solver
   LCPSolver* mLCPSolver;
 
+  /// Maximum number of contacts kept for each colliding body pair. Zero means
+  /// no limit.
+  size_t mMaxNumContactsPerPair;
+
   /// Skeleton list
   std::vector<dynamics::SkeletonPtr> mSkeletons;
 
+  /// Speculative contacts of the current time step
+  std::vector<collision::ContactRecord> mSpeculativeContacts;
+
   /// Contact constraints those are automatically created
   std::vector<ContactConstraintPtr> mContactConstraints;
 
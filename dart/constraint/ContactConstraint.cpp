@@ -36,6 +36,7 @@
 
 #include "dart/constraint/ContactConstraint.h"
 
+#include <algorithm>
 #include <iostream>
 
 #include "dart/common/Console.h"
@@ -65,7 +66,7 @@ double ContactConstraint::mMaxErrorReductionVelocity = DART_MAX_ERV;
 double ContactConstraint::mConstraintForceMixing     = DART_CFM;
 
 //==============================================================================
-ContactConstraint::ContactConstraint(collision::Contact& _contact,
+ContactConstraint::ContactConstraint(collision::ContactRecord& _contact,
                                      double _timeStep)
   : ConstraintBase(),
     mTimeStep(_timeStep),
@@ -79,8 +80,8 @@ ContactConstraint::ContactConstraint(collision::Contact& _contact,
   mContacts.push_back(&_contact);
 
   // TODO(JS):
-  mBodyNode1 = _contact.bodyNode1.lock();
-  mBodyNode2 = _contact.bodyNode2.lock();
+  mBodyNode1 = _contact.bodyNode1;
+  mBodyNode2 = _contact.bodyNode2;
 
   //----------------------------------------------
   // Bounce
@@ -136,7 +137,7 @@ ContactConstraint::ContactConstraint(collision::Contact& _contact,
 
     for (size_t i = 0; i < mContacts.size(); ++i)
     {
-      collision::Contact* ct = mContacts[i];
+      collision::ContactRecord* ct = mContacts[i];
 
       // TODO(JS): Assumed that the number of tangent basis is 2.
       Eigen::MatrixXd D = getTangentBasisMatrixODE(ct->normal);
@@ -227,7 +228,7 @@ ContactConstraint::ContactConstraint(collision::Contact& _contact,
 
     for (size_t i = 0; i < mContacts.size(); ++i)
     {
-      collision::Contact* ct = mContacts[i];
+      collision::ContactRecord* ct = mContacts[i];
 
       bodyDirection1.noalias()
           = mBodyNode1->getTransform().linear().transpose() * ct->normal;
@@ -419,7 +420,12 @@ void ContactConstraint::getInformation(ConstraintInfo* _info)
       // A. Penetration correction
       double bouncingVelocity = mContacts[i]->penetrationDepth
                                 - mErrorAllowance;
-      if (bouncingVelocity < 0.0)
+      if (mContacts[i]->penetrationDepth < 0.0)
+      {
+        // Speculative contact: the bodies may close the gap within this step
+        bouncingVelocity = mContacts[i]->penetrationDepth * _info->invTimeStep;
+      }
+      else if (bouncingVelocity < 0.0)
       {
         bouncingVelocity = 0.0;
       }
@@ -431,7 +437,7 @@ void ContactConstraint::getInformation(ConstraintInfo* _info)
       }
 
       // B. Restitution
-      if (mIsBounceOn)
+      if (mIsBounceOn && mContacts[i]->penetrationDepth >= 0.0)
       {
         double& negativeRelativeVel = _info->b[index];
         double restitutionVel = negativeRelativeVel * mRestitutionCoeff;
@@ -456,11 +462,24 @@ void ContactConstraint::getInformation(ConstraintInfo* _info)
       _info->b[index] += bouncingVelocity;
 //      std::cout << "_lcp->b[_idx]: " << _lcp->b[_idx] << std::endl;
 
-      // TODO(JS): Initial guess
-      // x
-      _info->x[index] = 0.0;
-      _info->x[index + 1] = 0.0;
-      _info->x[index + 2] = 0.0;
+      // Initial guess from the contact force, which is zero unless the
+      // collision detector carried it over from the previous step
+      const Eigen::Vector3d& force = mContacts[i]->force;
+      if (force.isZero(0.0))
+      {
+        _info->x[index] = 0.0;
+        _info->x[index + 1] = 0.0;
+        _info->x[index + 2] = 0.0;
+      }
+      else
+      {
+        const Eigen::MatrixXd D
+            = getTangentBasisMatrixODE(mContacts[i]->normal);
+        _info->x[index]
+            = std::max(0.0, mContacts[i]->normal.dot(force) * mTimeStep);
+        _info->x[index + 1] = D.col(0).dot(force) * mTimeStep;
+        _info->x[index + 2] = D.col(1).dot(force) * mTimeStep;
+      }
 
       // Increase index
       index += 3;
@@ -487,7 +506,12 @@ void ContactConstraint::getInformation(ConstraintInfo* _info)
       // A. Penetration correction
       double bouncingVelocity = mContacts[i]->penetrationDepth
                                 - DART_ERROR_ALLOWANCE;
-      if (bouncingVelocity < 0.0)
+      if (mContacts[i]->penetrationDepth < 0.0)
+      {
+        // Speculative contact: the bodies may close the gap within this step
+        bouncingVelocity = mContacts[i]->penetrationDepth * _info->invTimeStep;
+      }
+      else if (bouncingVelocity < 0.0)
       {
         bouncingVelocity = 0.0;
       }
@@ -499,7 +523,7 @@ void ContactConstraint::getInformation(ConstraintInfo* _info)
       }
 
       // B. Restitution
-      if (mIsBounceOn)
+      if (mIsBounceOn && mContacts[i]->penetrationDepth >= 0.0)
       {
         double& negativeRelativeVel = _info->b[i];
         double restitutionVel = negativeRelativeVel * mRestitutionCoeff;
@@ -522,9 +546,10 @@ void ContactConstraint::getInformation(ConstraintInfo* _info)
       _info->b[i] += bouncingVelocity;
 //      std::cout << "_lcp->b[_idx]: " << _lcp->b[_idx] << std::endl;
 
-      // TODO(JS): Initial guess
-      // x
-      _info->x[i] = 0.0;
+      // Initial guess from the contact force, which is zero unless the
+      // collision detector carried it over from the previous step
+      _info->x[i] = std::max(
+            0.0, mContacts[i]->normal.dot(mContacts[i]->force) * mTimeStep);
 
       // Increase index
     }
@@ -759,6 +784,54 @@ bool ContactConstraint::isActive() const
   return mActive;
 }
 
+//==============================================================================
+bool ContactConstraint::getReactiveSkeletons(
+    std::vector<dynamics::Skeleton*>& _skeletons) const
+{
+  if (mBodyNode1->isReactive())
+    _skeletons.push_back(mBodyNode1->getSkeleton().get());
+
+  if (mBodyNode2->isReactive())
+    _skeletons.push_back(mBodyNode2->getSkeleton().get());
+
+  return true;
+}
+
+//==============================================================================
+bool ContactConstraint::getErrorReductionGains(double* _gains) const
+{
+  const double invTimeStep = 1.0 / mTimeStep;
+  const double allowance = mIsFrictionOn ? mErrorAllowance
+                                         : DART_ERROR_ALLOWANCE;
+  const size_t numRowsPerContact = mIsFrictionOn ? 3 : 1;
+
+  for (size_t i = 0; i < mContacts.size(); ++i)
+  {
+    // The penetration depth shrinks by the displacement along the normal row,
+    // so the gain is the negated slope of the bouncing velocity of
+    // getInformation() with respect to the depth
+    const double depth = mContacts[i]->penetrationDepth;
+    double gain = 0.0;
+    if (depth < 0.0)
+    {
+      gain = -invTimeStep;
+    }
+    else if (depth > allowance
+             && mErrorReductionParameter * (depth - allowance) * invTimeStep
+                < mMaxErrorReductionVelocity)
+    {
+      gain = -mErrorReductionParameter * invTimeStep;
+    }
+
+    const size_t index = i * numRowsPerContact;
+    _gains[index] = gain;
+    for (size_t j = 1; j < numRowsPerContact; ++j)
+      _gains[index + j] = 0.0;
+  }
+
+  return true;
+}
+
 //==============================================================================
 dynamics::SkeletonPtr ContactConstraint::getRootSkeleton() const
 {
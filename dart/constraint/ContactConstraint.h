@@ -56,7 +56,7 @@ class ContactConstraint : public ConstraintBase
 {
 public:
   /// Constructor
-  ContactConstraint(collision::Contact& _contact, double _timeStep);
+  ContactConstraint(collision::ContactRecord& _contact, double _timeStep);
 
   /// Destructor
   virtual ~ContactConstraint();
@@ -137,6 +137,13 @@ protected:
   // Documentation inherited
   virtual bool isActive() const;
 
+  // Documentation inherited
+  virtual bool getReactiveSkeletons(
+      std::vector<dynamics::Skeleton*>& _skeletons) const;
+
+  // Documentation inherited
+  virtual bool getErrorReductionGains(double* _gains) const;
+
 private:
   /// Get change in relative velocity at contact point due to external impulse
   /// \param[out] _relVel Change in relative velocity at contact point of the
@@ -160,7 +167,7 @@ private:
   dynamics::BodyNode* mBodyNode2;
 
   /// Contacts between mBodyNode1 and mBodyNode2
-  std::vector<collision::Contact*> mContacts;
+  std::vector<collision::ContactRecord*> mContacts;
 
   /// First frictional direction
   Eigen::Vector3d mFirstFrictionalDirection;
@@ -36,6 +36,12 @@
 
 #include "dart/constraint/DantzigLCPSolver.h"
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <Eigen/Dense>
+
 #ifndef NDEBUG
 #include <iomanip>
 #include <iostream>
@@ -44,6 +50,7 @@
 #include "dart/common/Console.h"
 #include "dart/constraint/ConstraintBase.h"
 #include "dart/constraint/ConstrainedGroup.h"
+#include "dart/dynamics/Skeleton.h"
 #include "dart/lcpsolver/Lemke.h"
 #include "dart/lcpsolver/lcp.h"
 
@@ -51,7 +58,10 @@ namespace dart {
 namespace constraint {
 
 //==============================================================================
-DantzigLCPSolver::DantzigLCPSolver(double _timestep) : LCPSolver(_timestep)
+DantzigLCPSolver::DantzigLCPSolver(double _timestep)
+  : LCPSolver(_timestep),
+    mBilateralEliminationEnabled(true),
+    mRecordingEnabled(false)
 {
 }
 
@@ -98,6 +108,18 @@ void DantzigLCPSolver::solve(ConstrainedGroup* _group)
 //    std::cout << "offset[" << i << "]: " << offset[i] << std::endl;
   }
 
+  // Prepare the record of this group. The Skeletons that each constraint acts
+  // on are collected so that the velocity changes of the unit impulse tests
+  // can be recorded as well, along with the error reduction gains.
+  LCPRecord* record = nullptr;
+  std::vector<std::vector<size_t>> reactiveSkeletons;
+  if (mRecordingEnabled)
+  {
+    mRecords.push_back(LCPRecord());
+    record = &mRecords.back();
+    initializeRecord(_group, record, reactiveSkeletons);
+  }
+
   // For each constraint
   ConstraintInfo constInfo;
   constInfo.invTimeStep = 1.0 / mTimeStep;
@@ -126,6 +148,17 @@ void DantzigLCPSolver::solve(ConstrainedGroup* _group)
       // Apply impulse for mipulse test
       constraint->applyUnitImpulse(j);
 
+      if (record)
+      {
+        for (const size_t k : reactiveSkeletons[i])
+        {
+          dynamics::Skeleton* skel = record->mSkeletons[k];
+          record->mImpulseResponse.block(
+                record->mDofOffsets[k], offset[i] + j, skel->getNumDofs(), 1)
+              = skel->getVelocityChanges();
+        }
+      }
+
       // Fill upper triangle blocks of A matrix
       int index = nSkip * (offset[i] + j) + offset[i];
       constraint->getVelocityChange(A + index, true);
@@ -156,19 +189,39 @@ void DantzigLCPSolver::solve(ConstrainedGroup* _group)
 
   assert(isSymmetric(n, A));
 
+  // The solver may modify the LCP terms, so they are recorded beforehand
+  if (record)
+  {
+    record->mA.resize(n, n);
+    for (size_t i = 0; i < n; ++i)
+      record->mA.row(i) = Eigen::Map<const Eigen::RowVectorXd>(A + nSkip*i, n);
+    record->mB = Eigen::Map<const Eigen::VectorXd>(b, n);
+    record->mLo = Eigen::Map<const Eigen::VectorXd>(lo, n);
+    record->mHi = Eigen::Map<const Eigen::VectorXd>(hi, n);
+    record->mFindex.assign(findex, findex + n);
+  }
+
   // Print LCP formulation
 //  dtdbg << "Before solve:" << std::endl;
 //  print(n, A, x, lo, hi, b, w, findex);
 //  std::cout << std::endl;
 
-  // Solve LCP using ODE's Dantzig algorithm
-  dSolveLCP(n, A, x, b, w, 0, lo, hi, findex);
+  // Solve LCP using ODE's Dantzig algorithm, after eliminating the bilateral
+  // rows if possible
+  if (!mBilateralEliminationEnabled
+      || !solveWithBilateralElimination(n, A, x, b, w, lo, hi, findex))
+  {
+    dSolveLCP(n, A, x, b, w, 0, lo, hi, findex);
+  }
 
   // Print LCP formulation
 //  dtdbg << "After solve:" << std::endl;
 //  print(n, A, x, lo, hi, b, w, findex);
 //  std::cout << std::endl;
 
+  if (record)
+    completeRecord(record, x);
+
   // Apply constraint impulses
   for (size_t i = 0; i < numConstraints; ++i)
   {
@@ -188,6 +241,311 @@ void DantzigLCPSolver::solve(ConstrainedGroup* _group)
   delete[] findex;
 }
 
+//==============================================================================
+void DantzigLCPSolver::setBilateralEliminationEnabled(bool _enabled)
+{
+  mBilateralEliminationEnabled = _enabled;
+}
+
+//==============================================================================
+bool DantzigLCPSolver::isBilateralEliminationEnabled() const
+{
+  return mBilateralEliminationEnabled;
+}
+
+//==============================================================================
+void DantzigLCPSolver::setRecordingEnabled(bool _enabled)
+{
+  mRecordingEnabled = _enabled;
+}
+
+//==============================================================================
+bool DantzigLCPSolver::isRecordingEnabled() const
+{
+  return mRecordingEnabled;
+}
+
+//==============================================================================
+const std::vector<LCPRecord>& DantzigLCPSolver::getRecords() const
+{
+  return mRecords;
+}
+
+//==============================================================================
+void DantzigLCPSolver::setRecords(const std::vector<LCPRecord>& _records)
+{
+  mRecords = _records;
+}
+
+//==============================================================================
+void DantzigLCPSolver::clearRecords()
+{
+  mRecords.clear();
+}
+
+//==============================================================================
+void DantzigLCPSolver::initializeRecord(
+    ConstrainedGroup* _group, LCPRecord* _record,
+    std::vector<std::vector<size_t>>& _reactiveSkeletons)
+{
+  const size_t numConstraints = _group->getNumConstraints();
+
+  _record->mIsValid = true;
+  _record->mErrorReductionGains.resize(_group->getTotalDimension());
+  _reactiveSkeletons.assign(numConstraints, std::vector<size_t>());
+
+  size_t numDofs = 0;
+  size_t offset = 0;
+  std::vector<dynamics::Skeleton*> skeletons;
+  for (size_t i = 0; i < numConstraints && _record->mIsValid; ++i)
+  {
+    const ConstraintBasePtr& constraint = _group->getConstraint(i);
+
+    skeletons.clear();
+    if (!constraint->getReactiveSkeletons(skeletons)
+        || !constraint->getErrorReductionGains(
+              _record->mErrorReductionGains.data() + offset))
+    {
+      _record->mIsValid = false;
+      break;
+    }
+    offset += constraint->getDimension();
+
+    for (dynamics::Skeleton* skel : skeletons)
+    {
+      const auto it = std::find(_record->mSkeletons.begin(),
+                                _record->mSkeletons.end(), skel);
+      const size_t index = it - _record->mSkeletons.begin();
+      if (it == _record->mSkeletons.end())
+      {
+        _record->mSkeletons.push_back(skel);
+        _record->mDofOffsets.push_back(numDofs);
+        numDofs += skel->getNumDofs();
+      }
+
+      std::vector<size_t>& indices = _reactiveSkeletons[i];
+      if (std::find(indices.begin(), indices.end(), index) == indices.end())
+        indices.push_back(index);
+    }
+  }
+
+  if (!_record->mIsValid)
+  {
+    _record->mSkeletons.clear();
+    _record->mDofOffsets.clear();
+    _record->mErrorReductionGains.setZero();
+    _reactiveSkeletons.assign(numConstraints, std::vector<size_t>());
+    numDofs = 0;
+  }
+
+  _record->mImpulseResponse
+      = Eigen::MatrixXd::Zero(numDofs, _group->getTotalDimension());
+}
+
+//==============================================================================
+void DantzigLCPSolver::completeRecord(LCPRecord* _record, const double* _x)
+{
+  const size_t n = _record->mB.size();
+  _record->mX = Eigen::Map<const Eigen::VectorXd>(_x, n);
+
+  // Classify the rows by comparing the impulses with their bounds, which are
+  // scaled by the normal impulse for the friction rows as in dSolveLCP()
+  _record->mRowStates.resize(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    double lo = _record->mLo[i];
+    double hi = _record->mHi[i];
+    if (_record->mFindex[i] >= 0)
+    {
+      hi = std::abs(hi * _x[_record->mFindex[i]]);
+      lo = -hi;
+    }
+
+    const double x = _x[i];
+    if (x <= lo + 1e-10 * (1.0 + std::abs(lo)))
+      _record->mRowStates[i] = LCPRecord::AT_LOWER;
+    else if (x >= hi - 1e-10 * (1.0 + std::abs(hi)))
+      _record->mRowStates[i] = LCPRecord::AT_UPPER;
+    else
+      _record->mRowStates[i] = LCPRecord::CLAMPED;
+  }
+
+  // Since G = M^-1 * J^T for every Skeleton, J^T = M * G
+  const size_t numDofs = _record->mImpulseResponse.rows();
+  _record->mJacobian.resize(n, numDofs);
+  for (size_t k = 0; k < _record->mSkeletons.size(); ++k)
+  {
+    const dynamics::Skeleton* skel = _record->mSkeletons[k];
+    const size_t offset = _record->mDofOffsets[k];
+    const size_t skelDofs = skel->getNumDofs();
+
+    _record->mJacobian.middleCols(offset, skelDofs).noalias()
+        = (skel->getMassMatrix()
+           * _record->mImpulseResponse.middleRows(offset, skelDofs))
+          .transpose();
+  }
+}
+
+//==============================================================================
+void LCPRecord::computeImpulseDerivatives(
+    Eigen::MatrixXd& _dImpulsedBias, Eigen::VectorXd& _dImpulsedFriction) const
+{
+  const size_t n = mX.size();
+
+  // Linearization of the solution for a fixed active set:
+  //   clamped rows:   A_i * dx = db_i
+  //   bounded rows:   dx_i = dlo_i or dhi_i, which is +-mu * dx_f + x_f * dmu
+  //                   for friction rows whose normal row is f and zero for
+  //                   the others
+  Eigen::MatrixXd S = Eigen::MatrixXd::Zero(n, n);
+  Eigen::MatrixXd E = Eigen::MatrixXd::Zero(n, n);
+  Eigen::VectorXd m = Eigen::VectorXd::Zero(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    if (mRowStates[i] == CLAMPED)
+    {
+      S.row(i) = mA.row(i);
+      E(i, i) = 1.0;
+      continue;
+    }
+
+    S(i, i) = 1.0;
+
+    const int f = mFindex[i];
+    if (f >= 0)
+    {
+      const double sign = (mRowStates[i] == AT_UPPER) ? 1.0 : -1.0;
+      S(i, f) = -sign * std::abs(mHi[i]);
+      m[i] = sign * std::abs(mX[f]);
+    }
+  }
+
+  // Rows without any coupling, e.g., friction directions that no degree of
+  // freedom can move along, make S singular. Their impulses do not change
+  // any velocity, so any solution will do.
+  const Eigen::FullPivLU<Eigen::MatrixXd> lu(S);
+  _dImpulsedBias = lu.solve(E);
+  _dImpulsedFriction = lu.solve(m);
+}
+
+//==============================================================================
+bool DantzigLCPSolver::solveWithBilateralElimination(
+    size_t _n, double* _A, double* _x, double* _b, double* _w,
+    double* _lo, double* _hi, int* _findex)
+{
+  // Rows that friction rows refer to have to stay in the LCP
+  std::vector<bool> isNormalRow(_n, false);
+  for (size_t i = 0; i < _n; ++i)
+  {
+    if (_findex[i] >= 0)
+      isNormalRow[_findex[i]] = true;
+  }
+
+  // Partition the rows into bilateral (E) and unilateral (U) rows
+  std::vector<size_t> bilateral;
+  std::vector<size_t> unilateral;
+  std::vector<int> reducedIndex(_n, -1);
+  for (size_t i = 0; i < _n; ++i)
+  {
+    if (_findex[i] < 0 && !isNormalRow[i]
+        && _lo[i] == -dInfinity && _hi[i] == dInfinity)
+    {
+      bilateral.push_back(i);
+    }
+    else
+    {
+      reducedIndex[i] = static_cast<int>(unilateral.size());
+      unilateral.push_back(i);
+    }
+  }
+
+  const size_t m = bilateral.size();
+  const size_t u = unilateral.size();
+  if (m == 0)
+    return false;
+
+  const size_t nSkip = dPAD(_n);
+
+  Eigen::MatrixXd Aee(m, m);
+  Eigen::MatrixXd Aeu(m, u);
+  Eigen::VectorXd be(m);
+  for (size_t i = 0; i < m; ++i)
+  {
+    const double* row = _A + nSkip * bilateral[i];
+    for (size_t j = 0; j < m; ++j)
+      Aee(i, j) = row[bilateral[j]];
+    for (size_t j = 0; j < u; ++j)
+      Aeu(i, j) = row[unilateral[j]];
+    be[i] = _b[bilateral[i]];
+  }
+
+  // The bilateral block is positive definite unless the constraints are
+  // redundant and no constraint force mixing is applied
+  Eigen::LDLT<Eigen::MatrixXd> ldlt(Aee);
+  if (ldlt.info() != Eigen::Success || !ldlt.isPositive()
+      || ldlt.vectorD().minCoeff() <= 0.0)
+  {
+    return false;
+  }
+
+  // Since w = 0 for the bilateral rows, Aee * xe + Aeu * xu = be
+  const Eigen::VectorXd AeeInvBe = ldlt.solve(be);
+  Eigen::VectorXd xe;
+
+  if (u > 0)
+  {
+    const Eigen::MatrixXd AeeInvAeu = ldlt.solve(Aeu);
+
+    // Reduced LCP on the Schur complement
+    //   (Auu - Aue * Aee^-1 * Aeu) * xu = (bu - Aue * Aee^-1 * be) + wu
+    const int uSkip = dPAD(u);
+    std::vector<double> S(u * uSkip, 0.0);
+    std::vector<double> xu(u);
+    std::vector<double> bu(u);
+    std::vector<double> wu(u, 0.0);
+    std::vector<double> lou(u);
+    std::vector<double> hiu(u);
+    std::vector<int> findexu(u);
+    for (size_t i = 0; i < u; ++i)
+    {
+      const size_t row = unilateral[i];
+      for (size_t j = 0; j < u; ++j)
+      {
+        S[uSkip * i + j] = _A[nSkip * row + unilateral[j]]
+                           - Aeu.col(i).dot(AeeInvAeu.col(j));
+      }
+      xu[i] = _x[row];
+      bu[i] = _b[row] - Aeu.col(i).dot(AeeInvBe);
+      lou[i] = _lo[row];
+      hiu[i] = _hi[row];
+      findexu[i] = _findex[row] >= 0 ? reducedIndex[_findex[row]] : -1;
+    }
+
+    dSolveLCP(static_cast<int>(u), S.data(), xu.data(), bu.data(), wu.data(),
+              0, lou.data(), hiu.data(), findexu.data());
+
+    for (size_t i = 0; i < u; ++i)
+    {
+      _x[unilateral[i]] = xu[i];
+      _w[unilateral[i]] = wu[i];
+    }
+
+    xe = AeeInvBe - AeeInvAeu * Eigen::Map<const Eigen::VectorXd>(xu.data(), u);
+  }
+  else
+  {
+    xe = AeeInvBe;
+  }
+
+  for (size_t i = 0; i < m; ++i)
+  {
+    _x[bilateral[i]] = xe[i];
+    _w[bilateral[i]] = 0.0;
+  }
+
+  return true;
+}
+
 //==============================================================================
 #ifndef NDEBUG
 bool DantzigLCPSolver::isSymmetric(size_t _n, double* _A)
@@ -38,13 +38,107 @@
 #define DART_CONSTRAINT_DANTZIGLCPSOLVER_H_
 
 #include <cstddef>
+#include <vector>
+
+#include <Eigen/Dense>
 
 #include "dart/config.h"
 #include "dart/constraint/LCPSolver.h"
 
 namespace dart {
+
+namespace dynamics {
+class Skeleton;
+}  // namespace dynamics
+
 namespace constraint {
 
+/// Record of a ConstrainedGroup that DantzigLCPSolver solved with the
+/// recording enabled. It holds the LCP A * x = b + w and its active set at the
+/// solution, from which the derivatives of the impulses x follow by the
+/// implicit function theorem, and the terms that relate the LCP to the
+/// generalized velocities of the Skeletons of the group.
+///
+/// The generalized velocities of the Skeletons are stacked in the order of
+/// mSkeletons. The LCP is related to them by
+///   b = -J * v + bias(q)   and   v+ = v + G * x,
+/// where v are the velocities before the impulses are applied. The derivative
+/// of the bias is modelled by the error reduction gains of the constraints
+/// (see ConstraintBase::getErrorReductionGains()), while the dependence of A,
+/// J and G on the positions and the restitution of contacts are not
+/// differentiated.
+struct LCPRecord
+{
+  /// State of a row at the solution
+  enum RowState
+  {
+    /// The impulse is strictly between its bounds, so w = 0
+    CLAMPED = 0,
+
+    /// The impulse is at its lower bound
+    AT_LOWER,
+
+    /// The impulse is at its upper bound
+    AT_UPPER
+  };
+
+  /// False if a constraint of the group could not report the Skeletons it
+  /// acts on (see ConstraintBase::getReactiveSkeletons()) or the error
+  /// reduction gains of its rows (see
+  /// ConstraintBase::getErrorReductionGains()). Only the LCP and its active
+  /// set are recorded then.
+  bool mIsValid;
+
+  /// Skeletons whose velocities are changed by the impulses
+  std::vector<dynamics::Skeleton*> mSkeletons;
+
+  /// Index of the first generalized velocity of each Skeleton in the stacked
+  /// generalized velocities
+  std::vector<size_t> mDofOffsets;
+
+  /// LCP matrix, including the constraint force mixing
+  Eigen::MatrixXd mA;
+
+  /// LCP bias
+  Eigen::VectorXd mB;
+
+  /// Impulses at the solution
+  Eigen::VectorXd mX;
+
+  /// Lower bounds, or the friction coefficients for the rows whose bounds
+  /// scale with the impulse of the row given by mFindex
+  Eigen::VectorXd mLo;
+
+  /// Upper bounds, or the friction coefficients for the rows whose bounds
+  /// scale with the impulse of the row given by mFindex
+  Eigen::VectorXd mHi;
+
+  /// Index of the normal row of each friction row, or -1
+  std::vector<int> mFindex;
+
+  /// State of each row at the solution
+  std::vector<RowState> mRowStates;
+
+  /// Constraint Jacobian J
+  Eigen::MatrixXd mJacobian;
+
+  /// Change of the stacked generalized velocities due to a unit impulse of
+  /// each row, G = M^-1 * J^T
+  Eigen::MatrixXd mImpulseResponse;
+
+  /// Derivative of the bias of each row with respect to the displacement
+  /// J_i * dq along that row
+  Eigen::VectorXd mErrorReductionGains;
+
+  /// Compute the derivatives of the impulses with respect to b
+  /// (_dImpulsedBias) and to a common change of the friction coefficients of
+  /// all the friction rows (_dImpulsedFriction), keeping the active set fixed.
+  /// The clamped rows keep w = 0, while the impulses of the other rows follow
+  /// their bounds.
+  void computeImpulseDerivatives(Eigen::MatrixXd& _dImpulsedBias,
+                                 Eigen::VectorXd& _dImpulsedFriction) const;
+};
+
 /// DantzigLCPSolver is a LCP solver that uses ODE's implementation of Dantzig
 /// algorithm
 class DantzigLCPSolver : public LCPSolver
@@ -59,6 +153,64 @@ public:
   // Documentation inherited
   virtual void solve(ConstrainedGroup* _group);
 
+  /// Set whether purely bilateral rows (unbounded and not referenced by any
+  /// friction row), such as the rows of WeldJointConstraint and
+  /// BallJointConstraint, are eliminated with a Schur complement before the
+  /// LCP is solved. The reduced LCP then only contains the unilateral rows.
+  /// Enabled by default.
+  void setBilateralEliminationEnabled(bool _enabled);
+
+  /// Return whether bilateral rows are eliminated before solving the LCP
+  bool isBilateralEliminationEnabled() const;
+
+  /// Set whether an LCPRecord of every solved ConstrainedGroup is kept for
+  /// differentiation. The records add the cost of a mass matrix per Skeleton
+  /// and the copies of the LCP terms to each solve. Disabled by default.
+  void setRecordingEnabled(bool _enabled);
+
+  /// Return whether an LCPRecord of every solved ConstrainedGroup is kept
+  bool isRecordingEnabled() const;
+
+  /// Return the records of the ConstrainedGroups solved since the last call
+  /// of clearRecords(), in the order in which they were solved. The
+  /// ConstraintSolver clears the records at the start of every solve, so
+  /// these are the records of the last World::step().
+  const std::vector<LCPRecord>& getRecords() const;
+
+  /// Replace the records, e.g., to restore records that were saved before
+  /// stepping a World
+  void setRecords(const std::vector<LCPRecord>& _records);
+
+  /// Discard the records
+  void clearRecords();
+
+protected:
+  /// Solve the LCP defined by the arguments, which are laid out as for
+  /// dSolveLCP(), after eliminating its bilateral rows. Return false without
+  /// touching _x and _w if there is nothing to eliminate or the bilateral
+  /// block cannot be factorized, in which case the full LCP should be solved.
+  bool solveWithBilateralElimination(size_t _n, double* _A, double* _x,
+                                     double* _b, double* _w, double* _lo,
+                                     double* _hi, int* _findex);
+
+  /// Collect the Skeletons of the constraints of _group into _record, and the
+  /// indices of the Skeletons of each constraint into _reactiveSkeletons
+  void initializeRecord(ConstrainedGroup* _group, LCPRecord* _record,
+                        std::vector<std::vector<size_t>>& _reactiveSkeletons);
+
+  /// Store the solution _x and its active set into _record, and compute the
+  /// constraint Jacobian from the recorded impulse responses
+  void completeRecord(LCPRecord* _record, const double* _x);
+
+  /// Whether bilateral rows are eliminated before solving the LCP
+  bool mBilateralEliminationEnabled;
+
+  /// Whether an LCPRecord of every solved ConstrainedGroup is kept
+  bool mRecordingEnabled;
+
+  /// Records of the solved ConstrainedGroups
+  std::vector<LCPRecord> mRecords;
+
 #ifndef NDEBUG
 private:
   /// Return true if the matrix is symmetric
@@ -40,6 +40,8 @@
 #include <iostream>
 
 #include "dart/common/Console.h"
+#include "dart/dynamics/BodyNode.h"
+#include "dart/dynamics/Skeleton.h"
 
 #define DART_ERROR_ALLOWANCE 0.0
 #define DART_ERP     0.01
@@ -185,5 +187,18 @@ dynamics::BodyNode* JointConstraint::getBodyNode2() const
   return mBodyNode2;
 }
 
+//==============================================================================
+bool JointConstraint::getReactiveSkeletons(
+    std::vector<dynamics::Skeleton*>& _skeletons) const
+{
+  if (mBodyNode1->isReactive())
+    _skeletons.push_back(mBodyNode1->getSkeleton().get());
+
+  if (mBodyNode2 && mBodyNode2->isReactive())
+    _skeletons.push_back(mBodyNode2->getSkeleton().get());
+
+  return true;
+}
+
 }  // namespace constraint
 }  // namespace dart
@@ -94,6 +94,10 @@ public:
   /// Get the second BodyNode that this constraint is associated with
   dynamics::BodyNode* getBodyNode2() const;
 
+  // Documentation inherited
+  virtual bool getReactiveSkeletons(
+      std::vector<dynamics::Skeleton*>& _skeletons) const;
+
 protected:
   /// First body node
   dynamics::BodyNode* mBodyNode1;
@@ -290,5 +290,25 @@ bool JointCoulombFrictionConstraint::isActive() const
   return false;
 }
 
+//==============================================================================
+bool JointCoulombFrictionConstraint::getReactiveSkeletons(
+    std::vector<dynamics::Skeleton*>& _skeletons) const
+{
+  _skeletons.push_back(mJoint->getSkeleton().get());
+
+  return true;
+}
+
+//==============================================================================
+bool JointCoulombFrictionConstraint::getErrorReductionGains(
+    double* _gains) const
+{
+  // The friction rows have no position error to correct
+  for (size_t i = 0; i < mDim; ++i)
+    _gains[i] = 0.0;
+
+  return true;
+}
+
 } // namespace constraint
 } // namespace dart
@@ -398,5 +398,25 @@ bool JointLimitConstraint::isActive() const
   return false;
 }
 
+//==============================================================================
+bool JointLimitConstraint::getReactiveSkeletons(
+    std::vector<dynamics::Skeleton*>& _skeletons) const
+{
+  _skeletons.push_back(mJoint->getSkeleton().get());
+
+  return true;
+}
+
+//==============================================================================
+bool JointLimitConstraint::getErrorReductionGains(double* _gains) const
+{
+  // The bouncing velocity of getInformation() only depends on the side of the
+  // limit that is violated, which stays the same while the row is active
+  for (size_t i = 0; i < mDim; ++i)
+    _gains[i] = 0.0;
+
+  return true;
+}
+
 } // namespace constraint
 } // namespace dart
@@ -126,6 +126,13 @@ protected:
   // Documentation inherited
   virtual bool isActive() const;
 
+  // Documentation inherited
+  virtual bool getReactiveSkeletons(
+      std::vector<dynamics::Skeleton*>& _skeletons) const;
+
+  // Documentation inherited
+  virtual bool getErrorReductionGains(double* _gains) const;
+
 private:
   ///
   dynamics::Joint* mJoint;
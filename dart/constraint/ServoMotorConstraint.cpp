@@ -290,5 +290,24 @@ bool ServoMotorConstraint::isActive() const
   return false;
 }
 
+//==============================================================================
+bool ServoMotorConstraint::getReactiveSkeletons(
+    std::vector<dynamics::Skeleton*>& _skeletons) const
+{
+  _skeletons.push_back(mJoint->getSkeleton().get());
+
+  return true;
+}
+
+//==============================================================================
+bool ServoMotorConstraint::getErrorReductionGains(double* _gains) const
+{
+  // The bias is the commanded velocity, which does not depend on the positions
+  for (size_t i = 0; i < mDim; ++i)
+    _gains[i] = 0.0;
+
+  return true;
+}
+
 } // namespace constraint
 } // namespace dart
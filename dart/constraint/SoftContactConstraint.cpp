@@ -70,13 +70,13 @@ double SoftContactConstraint::mConstraintForceMixing     = DART_CFM;
 
 //==============================================================================
 SoftContactConstraint::SoftContactConstraint(
-    collision::Contact& _contact, double _timeStep)
+    collision::ContactRecord& _contact, double _timeStep)
   : ConstraintBase(),
     mTimeStep(_timeStep),
-    mBodyNode1(_contact.bodyNode1.lock()),
-    mBodyNode2(_contact.bodyNode2.lock()),
-    mSoftBodyNode1(dynamic_cast<dynamics::SoftBodyNode*>(mBodyNode1)),
-    mSoftBodyNode2(dynamic_cast<dynamics::SoftBodyNode*>(mBodyNode2)),
+    mBodyNode1(_contact.bodyNode1),
+    mBodyNode2(_contact.bodyNode2),
+    mSoftBodyNode1(mBodyNode1->asSoftBodyNode()),
+    mSoftBodyNode2(mBodyNode2->asSoftBodyNode()),
     mPointMass1(nullptr),
     mPointMass2(nullptr),
     mSoftCollInfo(static_cast<collision::SoftCollisionInfo*>(_contact.userData)),
@@ -173,7 +173,7 @@ SoftContactConstraint::SoftContactConstraint(
 
     for (size_t i = 0; i < mContacts.size(); ++i)
     {
-      collision::Contact* ct = mContacts[i];
+      collision::ContactRecord* ct = mContacts[i];
 
       // TODO(JS): Assumed that the number of tangent basis is 2.
       Eigen::MatrixXd D = getTangentBasisMatrixODE(ct->normal);
@@ -264,7 +264,7 @@ SoftContactConstraint::SoftContactConstraint(
 
     for (size_t i = 0; i < mContacts.size(); ++i)
     {
-      collision::Contact* ct = mContacts[i];
+      collision::ContactRecord* ct = mContacts[i];
 
       bodyDirection1.noalias()
           = mBodyNode1->getTransform().linear().transpose() * ct->normal;
@@ -916,6 +916,19 @@ bool SoftContactConstraint::isActive() const
   return mActive;
 }
 
+//==============================================================================
+bool SoftContactConstraint::getReactiveSkeletons(
+    std::vector<dynamics::Skeleton*>& _skeletons) const
+{
+  if (mBodyNode1->isReactive())
+    _skeletons.push_back(mBodyNode1->getSkeleton().get());
+
+  if (mBodyNode2->isReactive())
+    _skeletons.push_back(mBodyNode2->getSkeleton().get());
+
+  return true;
+}
+
 //==============================================================================
 dynamics::SkeletonPtr SoftContactConstraint::getRootSkeleton() const
 {
@@ -62,7 +62,8 @@ class SoftContactConstraint : public ConstraintBase
 {
 public:
   /// Constructor
-  SoftContactConstraint(collision::Contact& _contact, double _timeStep);
+  SoftContactConstraint(collision::ContactRecord& _contact,
+                        double _timeStep);
 
   /// Destructor
   virtual ~SoftContactConstraint();
@@ -143,6 +144,10 @@ protected:
   // Documentation inherited
   virtual bool isActive() const;
 
+  // Documentation inherited
+  virtual bool getReactiveSkeletons(
+      std::vector<dynamics::Skeleton*>& _skeletons) const;
+
 private:
   /// Get change in relative velocity at contact point due to external impulse
   /// \param[out] _vel Change in relative velocity at contact point of the two
@@ -194,7 +199,7 @@ private:
 
   // TODO(JS): For now, there is only one contact per contact constraint
   /// Contacts between mBodyNode1 and mBodyNode2
-  std::vector<collision::Contact*> mContacts;
+  std::vector<collision::ContactRecord*> mContacts;
 
   /// Soft collision information
   collision::SoftCollisionInfo* mSoftCollInfo;
@@ -238,6 +238,7 @@ void ArrowShape::configureArrow(const Eigen::Vector3d& _tail,
 
   _updateBoundingBoxDim();
   updateVolume();
+  ++mVersion;
 }
 
 //==============================================================================
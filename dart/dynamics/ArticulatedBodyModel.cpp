@@ -0,0 +1,607 @@
+/*
+ * Copyright (c) 2016, Georgia Tech Research Corporation
+ * All rights reserved.
+ *
+ * Author(s): Jeongseok Lee <jslee02@gmail.com>
+ *
+ * Georgia Tech Graphics Lab and Humanoid Robotics Lab
+ *
+ * Directed by Prof. C. Karen Liu and Prof. Mike Stilman
+ * <karenliu@cc.gatech.edu> <mstilman@cc.gatech.edu>
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dart/dynamics/ArticulatedBodyModel.h"
+
+#include <typeinfo>
+
+#include "dart/common/Console.h"
+#include "dart/dynamics/BallJoint.h"
+#include "dart/dynamics/BodyNode.h"
+#include "dart/dynamics/FreeJoint.h"
+#include "dart/dynamics/PrismaticJoint.h"
+#include "dart/dynamics/RevoluteJoint.h"
+#include "dart/dynamics/Skeleton.h"
+#include "dart/dynamics/WeldJoint.h"
+
+#define ARTICULATEDBODYMODEL_CHECK_SIZE( func, arg, numRows, numCols )       \
+  if(static_cast<size_t>(arg .rows()) != numRows                             \
+     || static_cast<size_t>(arg .cols()) != numCols)                         \
+  {                                                                          \
+    dterr << "[ArticulatedBodyModel::" #func "] The size of " #arg " ["      \
+          << arg .rows() << "x" << arg .cols() << "] does not match the "    \
+          << "expected size [" << numRows << "x" << numCols << "].\n";       \
+    assert(false);                                                           \
+    return;                                                                  \
+  }
+
+namespace dart {
+namespace dynamics {
+
+//==============================================================================
+template <typename S>
+ArticulatedBodyModel<S>::ArticulatedBodyModel(const Skeleton& _skeleton)
+  : mGravity(_skeleton.getGravity().cast<S>()),
+    mTimeStep(static_cast<S>(_skeleton.getTimeStep())),
+    mIsValid(true)
+{
+  const size_t numBodyNodes = _skeleton.getNumBodyNodes();
+  const size_t numDofs = _skeleton.getNumDofs();
+
+  mBodies.resize(numBodyNodes);
+  mBodyStates.resize(numBodyNodes);
+  mDampingCoefficients.resize(numDofs);
+  mSpringStiffnesses.resize(numDofs);
+  mRestPositions.resize(numDofs);
+
+  for(size_t i=0; i < numBodyNodes; ++i)
+  {
+    const BodyNode* bodyNode = _skeleton.getBodyNode(i);
+    const Joint* joint = bodyNode->getParentJoint();
+    const std::type_info& jointType = typeid(*joint);
+    Body& body = mBodies[i];
+
+    const BodyNode* parent = bodyNode->getParentBodyNode();
+    body.mParent = parent ? static_cast<int>(parent->getIndexInSkeleton()) : -1;
+
+    if(jointType == typeid(RevoluteJoint))
+    {
+      body.mJointType = JointType::REVOLUTE;
+      body.mAxis = static_cast<const RevoluteJoint*>(joint)->getAxis().cast<S>();
+    }
+    else if(jointType == typeid(PrismaticJoint))
+    {
+      body.mJointType = JointType::PRISMATIC;
+      body.mAxis
+          = static_cast<const PrismaticJoint*>(joint)->getAxis().cast<S>();
+    }
+    else if(jointType == typeid(BallJoint))
+    {
+      body.mJointType = JointType::BALL;
+    }
+    else if(jointType == typeid(FreeJoint))
+    {
+      body.mJointType = JointType::FREE;
+    }
+    else if(jointType == typeid(WeldJoint))
+    {
+      body.mJointType = JointType::WELD;
+    }
+    else
+    {
+      dterr << "[ArticulatedBodyModel::ArticulatedBodyModel] Joint ["
+            << joint->getName() << "] of Skeleton [" << _skeleton.getName()
+            << "] is a [" << joint->getType() << "], which is not supported. "
+            << "Only RevoluteJoint, PrismaticJoint, BallJoint, FreeJoint and "
+            << "WeldJoint are supported.\n";
+      mIsValid = false;
+      body.mJointType = JointType::WELD;
+    }
+
+    if(typeid(*bodyNode) != typeid(BodyNode))
+    {
+      dterr << "[ArticulatedBodyModel::ArticulatedBodyModel] BodyNode ["
+            << bodyNode->getName() << "] of Skeleton [" << _skeleton.getName()
+            << "] is not a rigid BodyNode, which is not supported.\n";
+      mIsValid = false;
+    }
+
+    if(body.mParent >= static_cast<int>(i))
+    {
+      dterr << "[ArticulatedBodyModel::ArticulatedBodyModel] BodyNode ["
+            << bodyNode->getName() << "] of Skeleton [" << _skeleton.getName()
+            << "] comes before its parent, which is not supported.\n";
+      mIsValid = false;
+      body.mParent = -1;
+    }
+
+    const Joint::ActuatorType actuatorType = joint->getActuatorType();
+    if(actuatorType != Joint::FORCE && actuatorType != Joint::PASSIVE)
+    {
+      dterr << "[ArticulatedBodyModel::ArticulatedBodyModel] Joint ["
+            << joint->getName() << "] of Skeleton [" << _skeleton.getName()
+            << "] has a kinematic or servo actuator, which is not supported. "
+            << "Only FORCE and PASSIVE actuators are supported.\n";
+      mIsValid = false;
+    }
+
+    body.mNumDofs = joint->getNumDofs();
+    body.mDofIndex = body.mNumDofs > 0 ? joint->getIndexInSkeleton(0) : 0;
+    body.mT_ParentBodyToJoint
+        = joint->getTransformFromParentBodyNode().cast<S>();
+    body.mT_JointToChildBody
+        = joint->getTransformFromChildBodyNode().inverse().cast<S>();
+    body.mJacobian = joint->getLocalJacobian().cast<S>();
+    body.mInertia = bodyNode->getSpatialInertia().cast<S>();
+    body.mGravityMode = bodyNode->getGravityMode();
+
+    for(size_t j=0; j < body.mNumDofs; ++j)
+    {
+      const size_t index = body.mDofIndex + j;
+      mDampingCoefficients[index]
+          = static_cast<S>(joint->getDampingCoefficient(j));
+      mSpringStiffnesses[index] = static_cast<S>(joint->getSpringStiffness(j));
+      mRestPositions[index] = static_cast<S>(joint->getRestPosition(j));
+    }
+
+    BodyState& state = mBodyStates[i];
+    state.mInvProjArtInertia.resize(body.mNumDofs, body.mNumDofs);
+    state.mTotalForce.resize(body.mNumDofs);
+  }
+}
+
+//==============================================================================
+template <typename S>
+bool ArticulatedBodyModel<S>::isValid() const
+{
+  return mIsValid;
+}
+
+//==============================================================================
+template <typename S>
+size_t ArticulatedBodyModel<S>::getNumBodyNodes() const
+{
+  return mBodies.size();
+}
+
+//==============================================================================
+template <typename S>
+size_t ArticulatedBodyModel<S>::getNumDofs() const
+{
+  return static_cast<size_t>(mRestPositions.size());
+}
+
+//==============================================================================
+template <typename S>
+void ArticulatedBodyModel<S>::setTimeStep(S _timeStep)
+{
+  assert(_timeStep > S(0));
+  mTimeStep = _timeStep;
+}
+
+//==============================================================================
+template <typename S>
+S ArticulatedBodyModel<S>::getTimeStep() const
+{
+  return mTimeStep;
+}
+
+//==============================================================================
+template <typename S>
+void ArticulatedBodyModel<S>::setGravity(const math::Vector3<S>& _gravity)
+{
+  mGravity = _gravity;
+}
+
+//==============================================================================
+template <typename S>
+const math::Vector3<S>& ArticulatedBodyModel<S>::getGravity() const
+{
+  return mGravity;
+}
+
+//==============================================================================
+template <typename S>
+void ArticulatedBodyModel<S>::computeForwardKinematics(
+    const Vector& _positions,
+    Eigen::aligned_vector<Isometry>& _worldTransforms) const
+{
+  ARTICULATEDBODYMODEL_CHECK_SIZE(computeForwardKinematics, _positions,
+                                  getNumDofs(), 1);
+
+  updateTransforms(_positions);
+
+  _worldTransforms.resize(mBodies.size());
+  for(size_t i=0; i < mBodies.size(); ++i)
+    _worldTransforms[i] = mBodyStates[i].mWorldTransform;
+}
+
+//==============================================================================
+template <typename S>
+void ArticulatedBodyModel<S>::computeForwardKinematics(
+    const Matrix& _positions,
+    Eigen::aligned_vector<Isometry>& _worldTransforms) const
+{
+  ARTICULATEDBODYMODEL_CHECK_SIZE(computeForwardKinematics, _positions,
+                                  getNumDofs(),
+                                  static_cast<size_t>(_positions.cols()));
+
+  const size_t numBodyNodes = mBodies.size();
+  _worldTransforms.resize(numBodyNodes * _positions.cols());
+  for(int k=0; k < _positions.cols(); ++k)
+  {
+    updateTransforms(_positions.col(k));
+
+    for(size_t i=0; i < numBodyNodes; ++i)
+      _worldTransforms[k*numBodyNodes + i] = mBodyStates[i].mWorldTransform;
+  }
+}
+
+//==============================================================================
+template <typename S>
+typename ArticulatedBodyModel<S>::Vector
+ArticulatedBodyModel<S>::computeForwardDynamics(const Vector& _positions,
+                                                const Vector& _velocities,
+                                                const Vector& _forces) const
+{
+  Vector accelerations = Vector::Zero(getNumDofs());
+
+  if(static_cast<size_t>(_positions.size()) != getNumDofs()
+     || static_cast<size_t>(_velocities.size()) != getNumDofs()
+     || static_cast<size_t>(_forces.size()) != getNumDofs())
+  {
+    dterr << "[ArticulatedBodyModel::computeForwardDynamics] The sizes of the "
+          << "positions [" << _positions.size() << "], velocities ["
+          << _velocities.size() << "] and forces [" << _forces.size()
+          << "] must all equal the number of DOFs [" << getNumDofs() << "].\n";
+    assert(false);
+    return accelerations;
+  }
+
+  runForwardDynamics(_positions, _velocities, _forces, accelerations);
+
+  return accelerations;
+}
+
+//==============================================================================
+template <typename S>
+typename ArticulatedBodyModel<S>::Matrix
+ArticulatedBodyModel<S>::computeForwardDynamics(const Matrix& _positions,
+                                                const Matrix& _velocities,
+                                                const Matrix& _forces) const
+{
+  Matrix accelerations = Matrix::Zero(getNumDofs(), _positions.cols());
+
+  if(static_cast<size_t>(_positions.rows()) != getNumDofs()
+     || _velocities.rows() != _positions.rows()
+     || _velocities.cols() != _positions.cols()
+     || _forces.rows() != _positions.rows()
+     || _forces.cols() != _positions.cols())
+  {
+    dterr << "[ArticulatedBodyModel::computeForwardDynamics] The positions ["
+          << _positions.rows() << "x" << _positions.cols() << "], velocities ["
+          << _velocities.rows() << "x" << _velocities.cols() << "] and forces ["
+          << _forces.rows() << "x" << _forces.cols() << "] must all have one "
+          << "row per DOF [" << getNumDofs() << "] and the same number of "
+          << "columns.\n";
+    assert(false);
+    return accelerations;
+  }
+
+  for(int k=0; k < _positions.cols(); ++k)
+  {
+    runForwardDynamics(_positions.col(k), _velocities.col(k), _forces.col(k),
+                       accelerations.col(k));
+  }
+
+  return accelerations;
+}
+
+//==============================================================================
+template <typename S>
+void ArticulatedBodyModel<S>::integrate(Vector& _positions,
+                                        Vector& _velocities,
+                                        const Vector& _forces) const
+{
+  const Vector accelerations
+      = computeForwardDynamics(_positions, _velocities, _forces);
+  if(accelerations.size() != _velocities.size())
+    return;
+
+  _velocities += mTimeStep * accelerations;
+  integratePositions(_positions, _velocities);
+}
+
+//==============================================================================
+template <typename S>
+void ArticulatedBodyModel<S>::integrate(Matrix& _positions,
+                                        Matrix& _velocities,
+                                        const Matrix& _forces) const
+{
+  const Matrix accelerations
+      = computeForwardDynamics(_positions, _velocities, _forces);
+  if(accelerations.rows() != _velocities.rows()
+     || accelerations.cols() != _velocities.cols())
+    return;
+
+  _velocities += mTimeStep * accelerations;
+  for(int k=0; k < _positions.cols(); ++k)
+    integratePositions(_positions.col(k), _velocities.col(k));
+}
+
+//==============================================================================
+template <typename S>
+typename ArticulatedBodyModel<S>::Isometry
+ArticulatedBodyModel<S>::computeLocalTransform(
+    size_t _index, const ConstVectorRef& _positions) const
+{
+  const Body& body = mBodies[_index];
+
+  Isometry Q = Isometry::Identity();
+  switch(body.mJointType)
+  {
+    case JointType::REVOLUTE:
+      Q.linear() = math::expMapRot<S>(body.mAxis * _positions[body.mDofIndex]);
+      break;
+    case JointType::PRISMATIC:
+      Q.translation() = body.mAxis * _positions[body.mDofIndex];
+      break;
+    case JointType::BALL:
+      Q.linear() = math::expMapRot<S>(
+            _positions.template segment<3>(body.mDofIndex));
+      break;
+    case JointType::FREE:
+      Q.linear() = math::expMapRot<S>(
+            _positions.template segment<3>(body.mDofIndex));
+      Q.translation() = _positions.template segment<3>(body.mDofIndex + 3);
+      break;
+    case JointType::WELD:
+      break;
+  }
+
+  return body.mT_ParentBodyToJoint * Q * body.mT_JointToChildBody;
+}
+
+//==============================================================================
+template <typename S>
+void ArticulatedBodyModel<S>::updateTransforms(
+    const ConstVectorRef& _positions) const
+{
+  for(size_t i=0; i < mBodies.size(); ++i)
+  {
+    BodyState& state = mBodyStates[i];
+    const int parent = mBodies[i].mParent;
+
+    state.mLocalTransform = computeLocalTransform(i, _positions);
+    if(parent < 0)
+      state.mWorldTransform = state.mLocalTransform;
+    else
+      state.mWorldTransform
+          = mBodyStates[parent].mWorldTransform * state.mLocalTransform;
+  }
+}
+
+//==============================================================================
+template <typename S>
+void ArticulatedBodyModel<S>::runForwardDynamics(
+    const ConstVectorRef& _positions,
+    const ConstVectorRef& _velocities,
+    const ConstVectorRef& _forces,
+    VectorRef _accelerations) const
+{
+  const size_t numBodyNodes = mBodies.size();
+
+  // Forward pass: transforms, velocities, partial accelerations and the
+  // rigid body terms of the articulated inertias and bias forces
+  updateTransforms(_positions);
+  for(size_t i=0; i < numBodyNodes; ++i)
+  {
+    const Body& body = mBodies[i];
+    BodyState& state = mBodyStates[i];
+
+    const math::Vector6<S> relVelocity = body.mJacobian
+        * _velocities.segment(body.mDofIndex, body.mNumDofs);
+
+    if(body.mParent < 0)
+      state.mVelocity = relVelocity;
+    else
+      state.mVelocity = math::AdInvT<S>(state.mLocalTransform,
+                                        mBodyStates[body.mParent].mVelocity)
+                        + relVelocity;
+
+    // The Jacobians of the supported joints are constant, so the partial
+    // acceleration is ad(V, S * dq)
+    state.mPartialAcceleration = math::ad<S>(state.mVelocity, relVelocity);
+
+    state.mArtInertia = body.mInertia;
+    state.mBiasForce = -math::dad<S>(state.mVelocity,
+                                     body.mInertia * state.mVelocity);
+    if(body.mGravityMode)
+    {
+      math::Vector6<S> gravity;
+      gravity.template head<3>().setZero();
+      gravity.template tail<3>().noalias()
+          = state.mWorldTransform.linear().transpose() * mGravity;
+      state.mBiasForce.noalias() -= body.mInertia * gravity;
+    }
+  }
+
+  // Backward pass: articulated inertias and bias forces
+  for(size_t i=numBodyNodes; i-- > 0; )
+  {
+    const Body& body = mBodies[i];
+    BodyState& state = mBodyStates[i];
+    const size_t numDofs = body.mNumDofs;
+
+    math::Matrix6<S> childArtInertia = state.mArtInertia;
+    math::Vector6<S> beta = state.mBiasForce;
+    beta.noalias() += state.mArtInertia * state.mPartialAcceleration;
+
+    if(numDofs == 1)
+    {
+      // Same as below, but with scalar projections for the common single DOF
+      // joints
+      const size_t index = body.mDofIndex;
+      const math::Vector6<S> J = body.mJacobian.col(0);
+      const math::Vector6<S> AIS = state.mArtInertia * J;
+
+      const S invProjArtInertia = S(1) / (J.dot(AIS)
+          + mTimeStep * mDampingCoefficients[index]
+          + mTimeStep * mTimeStep * mSpringStiffnesses[index]);
+      state.mInvProjArtInertia(0, 0) = invProjArtInertia;
+
+      const S totalForce = _forces[index]
+          - mSpringStiffnesses[index] * (_positions[index]
+              - mRestPositions[index] + mTimeStep * _velocities[index])
+          - mDampingCoefficients[index] * _velocities[index]
+          - J.dot(beta);
+      state.mTotalForce[0] = totalForce;
+
+      childArtInertia.noalias() -= (invProjArtInertia * AIS) * AIS.transpose();
+      beta += (invProjArtInertia * totalForce) * AIS;
+    }
+    else if(numDofs > 0)
+    {
+      const JacobianBlock AIS = state.mArtInertia * body.mJacobian;
+
+      // Projected articulated inertia with the implicit damping and spring
+      // terms
+      DofMatrix projArtInertia = body.mJacobian.transpose() * AIS;
+      for(size_t j=0; j < numDofs; ++j)
+      {
+        const size_t index = body.mDofIndex + j;
+        projArtInertia(j, j) += mTimeStep * mDampingCoefficients[index]
+            + mTimeStep * mTimeStep * mSpringStiffnesses[index];
+      }
+      state.mInvProjArtInertia = projArtInertia.inverse();
+
+      // Total force with the implicit damping and spring forces
+      const auto q = _positions.segment(body.mDofIndex, numDofs);
+      const auto dq = _velocities.segment(body.mDofIndex, numDofs);
+      state.mTotalForce = _forces.segment(body.mDofIndex, numDofs);
+      state.mTotalForce.array()
+          -= mSpringStiffnesses.segment(body.mDofIndex, numDofs).array()
+             * (q - mRestPositions.segment(body.mDofIndex, numDofs)
+                + mTimeStep * dq).array()
+             + mDampingCoefficients.segment(body.mDofIndex, numDofs).array()
+             * dq.array();
+      state.mTotalForce.noalias() -= body.mJacobian.transpose() * beta;
+
+      childArtInertia.noalias()
+          -= AIS * state.mInvProjArtInertia * AIS.transpose();
+      beta.noalias()
+          += AIS * (state.mInvProjArtInertia * state.mTotalForce);
+    }
+
+    if(body.mParent < 0)
+      continue;
+
+    BodyState& parentState = mBodyStates[body.mParent];
+    parentState.mArtInertia += math::transformInertia<S>(
+          state.mLocalTransform.inverse(), childArtInertia);
+    parentState.mBiasForce += math::dAdInvT<S>(state.mLocalTransform, beta);
+  }
+
+  // Forward pass: joint and spatial accelerations
+  for(size_t i=0; i < numBodyNodes; ++i)
+  {
+    const Body& body = mBodies[i];
+    BodyState& state = mBodyStates[i];
+
+    if(body.mParent < 0)
+      state.mAcceleration.setZero();
+    else
+      state.mAcceleration = math::AdInvT<S>(
+            state.mLocalTransform, mBodyStates[body.mParent].mAcceleration);
+
+    if(body.mNumDofs == 1)
+    {
+      const math::Vector6<S> J = body.mJacobian.col(0);
+      const S ddq = state.mInvProjArtInertia(0, 0)
+          * (state.mTotalForce[0]
+             - J.dot(state.mArtInertia * state.mAcceleration));
+      _accelerations[body.mDofIndex] = ddq;
+      state.mAcceleration += ddq * J;
+    }
+    else if(body.mNumDofs > 0)
+    {
+      const DofVector ddq = state.mInvProjArtInertia
+          * (state.mTotalForce - body.mJacobian.transpose()
+             * (state.mArtInertia * state.mAcceleration));
+      _accelerations.segment(body.mDofIndex, body.mNumDofs) = ddq;
+      state.mAcceleration.noalias() += body.mJacobian * ddq;
+    }
+
+    state.mAcceleration += state.mPartialAcceleration;
+  }
+}
+
+//==============================================================================
+template <typename S>
+void ArticulatedBodyModel<S>::integratePositions(
+    VectorRef _positions, const ConstVectorRef& _velocities) const
+{
+  for(const Body& body : mBodies)
+  {
+    auto q = _positions.segment(body.mDofIndex, body.mNumDofs);
+    const auto dq = _velocities.segment(body.mDofIndex, body.mNumDofs);
+
+    switch(body.mJointType)
+    {
+      case JointType::REVOLUTE:
+      case JointType::PRISMATIC:
+        q += mTimeStep * dq;
+        break;
+      case JointType::BALL:
+      {
+        const math::Matrix3<S> R = math::expMapRot<S>(q)
+            * math::expMapRot<S>(mTimeStep * dq);
+        q = math::logMap<S>(R);
+        break;
+      }
+      case JointType::FREE:
+      {
+        // Same as FreeJoint::integratePositions()
+        const math::Matrix3<S> R = math::expMapRot<S>(q.template head<3>());
+        const math::Vector3<S> p = q.template tail<3>();
+        const math::Matrix3<S> dR
+            = math::expMapRot<S>(mTimeStep * dq.template head<3>());
+        const math::Vector3<S> dp = mTimeStep * dq.template tail<3>();
+        q.template head<3>() = math::logMap<S>(R * dR);
+        q.template tail<3>() = R * dp + p;
+        break;
+      }
+      case JointType::WELD:
+        break;
+    }
+  }
+}
+
+template class ArticulatedBodyModel<double>;
+template class ArticulatedBodyModel<float>;
+
+} // namespace dynamics
+} // namespace dart
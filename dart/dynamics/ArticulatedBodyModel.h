@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2016, Georgia Tech Research Corporation
+ * All rights reserved.
+ *
+ * Author(s): Jeongseok Lee <jslee02@gmail.com>
+ *
+ * Georgia Tech Graphics Lab and Humanoid Robotics Lab
+ *
+ * Directed by Prof. C. Karen Liu and Prof. Mike Stilman
+ * <karenliu@cc.gatech.edu> <mstilman@cc.gatech.edu>
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DART_DYNAMICS_ARTICULATEDBODYMODEL_H_
+#define DART_DYNAMICS_ARTICULATEDBODYMODEL_H_
+
+#include <vector>
+
+#include "dart/math/MathTypes.h"
+#include "dart/math/SpatialAlgebra.h"
+
+namespace dart {
+namespace dynamics {
+
+class Skeleton;
+
+/// ArticulatedBodyModel is a snapshot of the kinematic structure and the mass
+/// properties of a Skeleton that evaluates forward kinematics and forward
+/// dynamics (the articulated body algorithm) in the scalar type S.
+///
+/// Unlike Skeleton, the model holds no state of its own: positions, velocities
+/// and forces are passed in, either as vectors for a single state or as
+/// matrices with one column per state for batched rollouts. The double
+/// precision model reproduces Skeleton::computeForwardDynamics() (including
+/// the implicit joint damping and spring forces) up to round-off, while the
+/// single precision model trades accuracy for half the memory traffic of the
+/// double precision one.
+///
+/// Only RevoluteJoint, PrismaticJoint, BallJoint, FreeJoint and WeldJoint with
+/// FORCE or PASSIVE actuators and rigid BodyNodes are supported. External
+/// forces and constraints are not part of the model. If the Skeleton contains
+/// anything else, an error is printed and isValid() returns false.
+///
+/// The member functions are defined in ArticulatedBodyModel.cpp, which
+/// explicitly instantiates the model for double and float.
+///
+/// The model keeps scratch buffers for the recursions, so a single model must
+/// not be used from several threads at the same time.
+template <typename S = double>
+class ArticulatedBodyModel
+{
+public:
+
+  using Scalar = S;
+  using Vector = Eigen::Matrix<S, Eigen::Dynamic, 1>;
+  using Matrix = Eigen::Matrix<S, Eigen::Dynamic, Eigen::Dynamic>;
+  using Isometry = math::Isometry3<S>;
+
+  /// Create a model of the current structure, mass properties, gravity and
+  /// time step of _skeleton. Later changes to _skeleton are not reflected in
+  /// the model.
+  explicit ArticulatedBodyModel(const Skeleton& _skeleton);
+
+  /// Returns false if the Skeleton contained joints or bodies that the model
+  /// does not support
+  bool isValid() const;
+
+  /// Number of BodyNodes in the model
+  size_t getNumBodyNodes() const;
+
+  /// Number of degrees of freedom in the model
+  size_t getNumDofs() const;
+
+  /// Set the time step that is used for the implicit joint damping and spring
+  /// forces and by integrate()
+  void setTimeStep(S _timeStep);
+
+  /// Time step of the model
+  S getTimeStep() const;
+
+  /// Set the gravity vector
+  void setGravity(const math::Vector3<S>& _gravity);
+
+  /// Gravity vector of the model
+  const math::Vector3<S>& getGravity() const;
+
+  /// Compute the world transforms of all the BodyNodes for the generalized
+  /// positions _positions. The transforms are ordered by the index of the
+  /// BodyNodes in the Skeleton.
+  void computeForwardKinematics(
+      const Vector& _positions,
+      Eigen::aligned_vector<Isometry>& _worldTransforms) const;
+
+  /// Compute the world transforms of all the BodyNodes for each column of
+  /// _positions. The transforms of state i start at index
+  /// i * getNumBodyNodes() of _worldTransforms.
+  void computeForwardKinematics(
+      const Matrix& _positions,
+      Eigen::aligned_vector<Isometry>& _worldTransforms) const;
+
+  /// Compute the generalized accelerations for the generalized positions,
+  /// velocities and forces of a single state. The forces are applied to every
+  /// degree of freedom, including those of PASSIVE joints.
+  Vector computeForwardDynamics(const Vector& _positions,
+                                const Vector& _velocities,
+                                const Vector& _forces) const;
+
+  /// Compute the generalized accelerations for each column of _positions,
+  /// _velocities and _forces
+  Matrix computeForwardDynamics(const Matrix& _positions,
+                                const Matrix& _velocities,
+                                const Matrix& _forces) const;
+
+  /// Advance a single state by one time step with the semi-implicit Euler
+  /// scheme that World uses, i.e. the velocities are integrated first and the
+  /// positions are then integrated with the new velocities
+  void integrate(Vector& _positions, Vector& _velocities,
+                 const Vector& _forces) const;
+
+  /// Advance each column of _positions and _velocities by one time step
+  void integrate(Matrix& _positions, Matrix& _velocities,
+                 const Matrix& _forces) const;
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+protected:
+
+  enum class JointType : unsigned char
+  {
+    REVOLUTE = 0,
+    PRISMATIC,
+    BALL,
+    FREE,
+    WELD
+  };
+
+  using JacobianBlock = Eigen::Matrix<S, 6, Eigen::Dynamic, 0, 6, 6>;
+  using DofMatrix = Eigen::Matrix<S, Eigen::Dynamic, Eigen::Dynamic, 0, 6, 6>;
+  using DofVector = Eigen::Matrix<S, Eigen::Dynamic, 1, 0, 6, 1>;
+
+  /// Constant properties of a BodyNode and its parent Joint
+  struct Body
+  {
+    /// Index of the parent BodyNode, or -1 for a root BodyNode
+    int mParent;
+
+    JointType mJointType;
+
+    /// Index of the first degree of freedom of the parent Joint
+    size_t mDofIndex;
+
+    /// Number of degrees of freedom of the parent Joint
+    size_t mNumDofs;
+
+    Isometry mT_ParentBodyToJoint;
+
+    Isometry mT_JointToChildBody;
+
+    /// Axis of a RevoluteJoint or PrismaticJoint
+    math::Vector3<S> mAxis;
+
+    /// Local Jacobian of the parent Joint, which is constant for all the
+    /// supported joint types
+    JacobianBlock mJacobian;
+
+    math::Matrix6<S> mInertia;
+
+    bool mGravityMode;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
+  /// Scratch data of the recursions for a BodyNode
+  struct BodyState
+  {
+    Isometry mLocalTransform;
+    Isometry mWorldTransform;
+    math::Vector6<S> mVelocity;
+    math::Vector6<S> mPartialAcceleration;
+    math::Vector6<S> mAcceleration;
+    math::Matrix6<S> mArtInertia;
+    math::Vector6<S> mBiasForce;
+    DofMatrix mInvProjArtInertia;
+    DofVector mTotalForce;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
+  using ConstVectorRef = Eigen::Ref<const Vector>;
+  using VectorRef = Eigen::Ref<Vector>;
+
+  /// Compute the local transform of BodyNode _index for _positions
+  Isometry computeLocalTransform(size_t _index,
+                                 const ConstVectorRef& _positions) const;
+
+  /// Compute the local and world transforms of all the BodyNodes for
+  /// _positions
+  void updateTransforms(const ConstVectorRef& _positions) const;
+
+  /// Articulated body algorithm for a single state
+  void runForwardDynamics(const ConstVectorRef& _positions,
+                          const ConstVectorRef& _velocities,
+                          const ConstVectorRef& _forces,
+                          VectorRef _accelerations) const;
+
+  /// Integrate _positions by _velocities over one time step
+  void integratePositions(VectorRef _positions,
+                          const ConstVectorRef& _velocities) const;
+
+  /// Constant properties of the BodyNodes, with parents before children
+  Eigen::aligned_vector<Body> mBodies;
+
+  /// Damping coefficients of the degrees of freedom
+  Vector mDampingCoefficients;
+
+  /// Spring stiffnesses of the degrees of freedom
+  Vector mSpringStiffnesses;
+
+  /// Rest positions of the degrees of freedom
+  Vector mRestPositions;
+
+  math::Vector3<S> mGravity;
+
+  S mTimeStep;
+
+  bool mIsValid;
+
+  /// Scratch data of the recursions
+  mutable Eigen::aligned_vector<BodyState> mBodyStates;
+};
+
+/// Double precision model; this is the default
+using ArticulatedBodyModeld = ArticulatedBodyModel<double>;
+
+/// Single precision model for large batched rollouts
+using ArticulatedBodyModelf = ArticulatedBodyModel<float>;
+
+} // namespace dynamics
+} // namespace dart
+
+#endif // DART_DYNAMICS_ARTICULATEDBODYMODEL_H_
@@ -128,10 +128,15 @@ BodyNode::UniqueProperties::UniqueProperties(
     const Inertia& _inertia,
     const std::vector<ShapePtr>& _collisionShapes,
     bool _isCollidable, double _frictionCoeff,
-    double _restitutionCoeff, bool _gravityMode)
+    double _restitutionCoeff, bool _gravityMode,
+    uint32_t _collisionCategory, uint32_t _collisionMask,
+    bool _isCCDEnabled)
   : mInertia(_inertia),
     mColShapes(_collisionShapes),
     mIsCollidable(_isCollidable),
+    mCollisionCategory(_collisionCategory),
+    mCollisionMask(_collisionMask),
+    mIsCCDEnabled(_isCCDEnabled),
     mFrictionCoeff(_frictionCoeff),
     mRestitutionCoeff(_restitutionCoeff),
     mGravityMode(_gravityMode)
@@ -178,6 +183,9 @@ void BodyNode::setProperties(const UniqueProperties& _properties)
   setGravityMode(_properties.mGravityMode);
   setFrictionCoeff(_properties.mFrictionCoeff);
   setRestitutionCoeff(_properties.mRestitutionCoeff);
+  setCollisionCategory(_properties.mCollisionCategory);
+  setCollisionMask(_properties.mCollisionMask);
+  setCCDEnabled(_properties.mIsCCDEnabled);
 
   removeAllCollisionShapes();
   for(size_t i=0; i<_properties.mColShapes.size(); ++i)
@@ -225,6 +233,18 @@ BodyNode& BodyNode::operator=(const BodyNode& _otherBodyNode)
   return *this;
 }
 
+//==============================================================================
+SoftBodyNode* BodyNode::asSoftBodyNode()
+{
+  return nullptr;
+}
+
+//==============================================================================
+const SoftBodyNode* BodyNode::asSoftBodyNode() const
+{
+  return nullptr;
+}
+
 //==============================================================================
 const std::string& BodyNode::setName(const std::string& _name)
 {
@@ -287,6 +307,42 @@ void BodyNode::setCollidable(bool _isCollidable)
   mBodyP.mIsCollidable = _isCollidable;
 }
 
+//==============================================================================
+void BodyNode::setCollisionCategory(uint32_t _category)
+{
+  mBodyP.mCollisionCategory = _category;
+}
+
+//==============================================================================
+uint32_t BodyNode::getCollisionCategory() const
+{
+  return mBodyP.mCollisionCategory;
+}
+
+//==============================================================================
+void BodyNode::setCollisionMask(uint32_t _mask)
+{
+  mBodyP.mCollisionMask = _mask;
+}
+
+//==============================================================================
+uint32_t BodyNode::getCollisionMask() const
+{
+  return mBodyP.mCollisionMask;
+}
+
+//==============================================================================
+void BodyNode::setCCDEnabled(bool _isCCDEnabled)
+{
+  mBodyP.mIsCCDEnabled = _isCCDEnabled;
+}
+
+//==============================================================================
+bool BodyNode::isCCDEnabled() const
+{
+  return mBodyP.mIsCCDEnabled;
+}
+
 //==============================================================================
 void BodyNode::setMass(double _mass)
 {
@@ -487,6 +543,7 @@ void BodyNode::addCollisionShape(const ShapePtr& _shape)
   }
 
   mBodyP.mColShapes.push_back(_shape);
+  ++mVersion;
 
   mColShapeAddedSignal.raise(this, _shape);
 }
@@ -500,6 +557,7 @@ void BodyNode::removeCollisionShape(const ShapePtr& _shape)
   mBodyP.mColShapes.erase(std::remove(mBodyP.mColShapes.begin(),
                                       mBodyP.mColShapes.end(), _shape),
                           mBodyP.mColShapes.end());
+  ++mVersion;
 
   mColShapeRemovedSignal.raise(this, _shape);
 }
@@ -533,6 +591,12 @@ ConstShapePtr BodyNode::getCollisionShape(size_t _index) const
   return getVectorObjectIfAvailable<ShapePtr>(_index, mBodyP.mColShapes);
 }
 
+//==============================================================================
+size_t BodyNode::getVersion() const
+{
+  return mVersion;
+}
+
 //==============================================================================
 size_t BodyNode::getIndexInSkeleton() const
 {
@@ -1068,6 +1132,7 @@ BodyNode::BodyNode(BodyNode* _parentBodyNode, Joint* _parentJoint,
     Node(ConstructBodyNode),
     mID(BodyNode::msBodyNodeCount++),
     mIsColliding(false),
+    mVersion(0),
     mParentJoint(_parentJoint),
     mParentBodyNode(nullptr),
     mPartialAcceleration(Eigen::Vector6d::Zero()),
@@ -1259,6 +1324,10 @@ void BodyNode::notifyTransformUpdate()
 {
   notifyVelocityUpdate(); // Global Velocity depends on the Global Transform
 
+  // The transform may be changed again before anyone reads it, so the version
+  // is incremented even if the transform is already dirty
+  ++mVersion;
+
   if(mNeedTransformUpdate)
     return;
 
@@ -1275,6 +1344,9 @@ void BodyNode::notifyTransformUpdate()
     SET_FLAGS(mGravityForces);
     SET_FLAGS(mCoriolisAndGravityForces);
     SET_FLAGS(mExternalForces);
+    SET_FLAGS(mCentroidalMomentumMatrix);
+    SET_FLAGS(mCentroidalMomentumBias);
+    SET_FLAGS(mWorldJointJacobian);
   }
 
   // Child BodyNodes and other generic Entities are notified separately to allow
@@ -1302,6 +1374,7 @@ void BodyNode::notifyVelocityUpdate()
   {
     SET_FLAGS(mCoriolisForces);
     SET_FLAGS(mCoriolisAndGravityForces);
+    SET_FLAGS(mCentroidalMomentumBias);
   }
 
   // Child BodyNodes and other generic Entities are notified separately to allow
@@ -2129,7 +2202,38 @@ void BodyNode::updateBodyJacobian() const
 //==============================================================================
 void BodyNode::updateWorldJacobian() const
 {
-  mWorldJacobian = math::AdRJac(getWorldTransform(), getJacobian());
+  //--------------------------------------------------------------------------
+  // Like the body Jacobian, the World Jacobian is built from the World Jacobian
+  // of the parent BodyNode, which only needs to be moved to the origin of this
+  // BodyNode. This also guarantees that the parent is never dirty while this
+  // BodyNode is clean, which notifyJacobianUpdate() relies on.
+  //--------------------------------------------------------------------------
+
+  if(nullptr == mParentJoint)
+    return;
+
+  const size_t localDof     = mParentJoint->getNumDofs();
+  assert(getNumDependentGenCoords() >= localDof);
+  const size_t ascendantDof = getNumDependentGenCoords() - localDof;
+
+  const Eigen::Isometry3d& T = getWorldTransform();
+
+  // Parent Jacobian
+  if (mParentBodyNode)
+  {
+    const math::Jacobian& parentJacobian = mParentBodyNode->getWorldJacobian();
+    assert(static_cast<size_t>(parentJacobian.cols()) == ascendantDof);
+
+    const Eigen::Vector3d offset =
+        T.translation() - mParentBodyNode->getWorldTransform().translation();
+    mWorldJacobian.leftCols(ascendantDof) = parentJacobian;
+    mWorldJacobian.bottomLeftCorner(3, ascendantDof)
+        += parentJacobian.topRows<3>().colwise().cross(offset);
+  }
+
+  // Local Jacobian
+  mWorldJacobian.rightCols(localDof)
+      = math::AdRJac(T, mParentJoint->getLocalJacobian());
 
   mIsWorldJacobianDirty = false;
 }
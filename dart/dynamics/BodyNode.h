@@ -38,6 +38,7 @@
 #ifndef DART_DYNAMICS_BODYNODE_H_
 #define DART_DYNAMICS_BODYNODE_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -75,6 +76,7 @@ class Joint;
 class DegreeOfFreedom;
 class Shape;
 class Marker;
+class SoftBodyNode;
 
 /// BodyNode class represents a single node of the skeleton.
 ///
@@ -108,6 +110,16 @@ public:
     /// Indicates whether this node is collidable;
     bool mIsCollidable;
 
+    /// Collision groups this node belongs to, one per bit
+    uint32_t mCollisionCategory;
+
+    /// Collision groups this node can collide with, one per bit
+    uint32_t mCollisionMask;
+
+    /// Indicates whether this node is protected from tunneling by continuous
+    /// collision detection
+    bool mIsCCDEnabled;
+
     /// Coefficient of friction
     double mFrictionCoeff;
 
@@ -127,7 +139,10 @@ public:
         bool _isCollidable = true,
         double _frictionCoeff = DART_DEFAULT_FRICTION_COEFF,
         double _restitutionCoeff = DART_DEFAULT_RESTITUTION_COEFF,
-        bool _gravityMode = true);
+        bool _gravityMode = true,
+        uint32_t _collisionCategory = 0x1,
+        uint32_t _collisionMask = 0xFFFFFFFF,
+        bool _isCCDEnabled = false);
 
     virtual ~UniqueProperties() = default;
 
@@ -169,6 +184,15 @@ public:
   /// Same as copy(const BodyNode&)
   BodyNode& operator=(const BodyNode& _otherBodyNode);
 
+  /// Convert this BodyNode pointer into a SoftBodyNode pointer if it is a
+  /// SoftBodyNode, otherwise return nullptr. This is cheaper than a
+  /// dynamic_cast.
+  virtual SoftBodyNode* asSoftBodyNode();
+
+  /// Convert this BodyNode pointer into a SoftBodyNode pointer if it is a
+  /// SoftBodyNode, otherwise return nullptr
+  virtual const SoftBodyNode* asSoftBodyNode() const;
+
   /// Set name. If the name is already taken, this will return an altered
   /// version which will be used by the Skeleton
   const std::string& setName(const std::string& _name) override;
@@ -187,6 +211,30 @@ public:
   /// \param[in] _isCollidable True to enable collisions
   void setCollidable(bool _isCollidable);
 
+  /// Set the collision groups this body node belongs to as a bitfield. Two
+  /// body nodes can only collide if the category of each one overlaps the
+  /// mask of the other. The default category is 0x1.
+  void setCollisionCategory(uint32_t _category);
+
+  /// Return the collision groups this body node belongs to
+  uint32_t getCollisionCategory() const;
+
+  /// Set the collision groups this body node can collide with as a bitfield.
+  /// The default mask is 0xFFFFFFFF, i.e., every group.
+  void setCollisionMask(uint32_t _mask);
+
+  /// Return the collision groups this body node can collide with
+  uint32_t getCollisionMask() const;
+
+  /// Set whether this body node uses continuous collision detection. The
+  /// constraint solver adds speculative contacts for such a body node whenever
+  /// its motion over the next time step can close the gap to another body, so
+  /// that fast moving bodies do not tunnel through thin obstacles.
+  void setCCDEnabled(bool _isCCDEnabled);
+
+  /// Return true if this body node uses continuous collision detection
+  bool isCCDEnabled() const;
+
   /// Set the mass of the bodynode
   void setMass(double _mass);
 
@@ -295,6 +343,12 @@ public:
   /// Return (const) _index-th collision shape
   ConstShapePtr getCollisionShape(size_t _index) const;
 
+  /// Return a counter that is incremented whenever the world transform or the
+  /// collision shapes of this BodyNode change. Collision detectors compare it
+  /// with the value they saw last to find out whether their cached bounding
+  /// boxes are still valid.
+  size_t getVersion() const;
+
   /// Return the index of this BodyNode within its Skeleton
   size_t getIndexInSkeleton() const;
 
@@ -1010,6 +1064,9 @@ protected:
   /// Whether the node is currently in collision with another node.
   bool mIsColliding;
 
+  /// Incremented whenever the world transform or the collision shapes change
+  size_t mVersion;
+
   //--------------------------------------------------------------------------
   // Structural Properties
   //--------------------------------------------------------------------------
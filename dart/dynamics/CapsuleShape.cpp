@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2016, Georgia Tech Research Corporation
+ * All rights reserved.
+ *
+ * Author(s): Jeongseok Lee <jslee02@gmail.com>
+ *
+ * Georgia Tech Graphics Lab and Humanoid Robotics Lab
+ *
+ * Directed by Prof. C. Karen Liu and Prof. Mike Stilman
+ * <karenliu@cc.gatech.edu> <mstilman@cc.gatech.edu>
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dart/dynamics/CapsuleShape.h"
+
+#include <cmath>
+
+#include "dart/renderer/RenderInterface.h"
+
+namespace dart {
+namespace dynamics {
+
+//==============================================================================
+CapsuleShape::CapsuleShape(double _radius, double _height)
+  : Shape(CAPSULE),
+    mRadius(_radius),
+    mHeight(_height)
+{
+  assert(0.0 < _radius);
+  assert(0.0 <= _height);
+  updateBoundingBoxDim();
+  updateVolume();
+}
+
+//==============================================================================
+double CapsuleShape::getRadius() const
+{
+  return mRadius;
+}
+
+//==============================================================================
+void CapsuleShape::setRadius(double _radius)
+{
+  assert(0.0 < _radius);
+  mRadius = _radius;
+  updateBoundingBoxDim();
+  updateVolume();
+  ++mVersion;
+}
+
+//==============================================================================
+double CapsuleShape::getHeight() const
+{
+  return mHeight;
+}
+
+//==============================================================================
+void CapsuleShape::setHeight(double _height)
+{
+  assert(0.0 <= _height);
+  mHeight = _height;
+  updateBoundingBoxDim();
+  updateVolume();
+  ++mVersion;
+}
+
+//==============================================================================
+void CapsuleShape::draw(renderer::RenderInterface* _ri,
+                        const Eigen::Vector4d& _color,
+                        bool _useDefaultColor) const
+{
+  if (!_ri)
+    return;
+
+  if (mHidden)
+    return;
+
+  if (!_useDefaultColor)
+    _ri->setPenColor(_color);
+  else
+    _ri->setPenColor(mColor);
+
+  const Eigen::Vector3d sphereSize = Eigen::Vector3d::Constant(2.0 * mRadius);
+
+  _ri->pushMatrix();
+  _ri->transform(mTransform);
+  _ri->drawCylinder(mRadius, mHeight);
+  _ri->translate(Eigen::Vector3d(0.0, 0.0, 0.5 * mHeight));
+  _ri->drawEllipsoid(sphereSize);
+  _ri->translate(Eigen::Vector3d(0.0, 0.0, -mHeight));
+  _ri->drawEllipsoid(sphereSize);
+  _ri->popMatrix();
+}
+
+//==============================================================================
+double CapsuleShape::computeVolume(double _radius, double _height)
+{
+  return DART_PI * _radius * _radius * (_height + 4.0 * _radius / 3.0);
+}
+
+//==============================================================================
+Eigen::Matrix3d CapsuleShape::computeInertia(
+    double _radius, double _height, double _mass)
+{
+  const double r2 = _radius * _radius;
+  const double cylinderVolume = DART_PI * r2 * _height;
+  const double hemisphereVolume = 2.0 * DART_PI * r2 * _radius / 3.0;
+  const double volume = cylinderVolume + 2.0 * hemisphereVolume;
+
+  const double cylinderMass = _mass * cylinderVolume / volume;
+  const double hemisphereMass = _mass * hemisphereVolume / volume;
+
+  // Each hemisphere has its center of mass 3r/8 away from its flat face, and
+  // a moment of inertia of 83/320 m r^2 about it perpendicular to the axis
+  const double hemisphereOffset = 0.5 * _height + 3.0 * _radius / 8.0;
+
+  Eigen::Matrix3d inertia = Eigen::Matrix3d::Zero();
+  inertia(0, 0) = cylinderMass * (r2 / 4.0 + _height * _height / 12.0)
+      + 2.0 * hemisphereMass * (83.0 / 320.0 * r2
+                                + hemisphereOffset * hemisphereOffset);
+  inertia(1, 1) = inertia(0, 0);
+  inertia(2, 2) = cylinderMass * r2 / 2.0 + 2.0 * hemisphereMass * 0.4 * r2;
+
+  return inertia;
+}
+
+//==============================================================================
+Eigen::Matrix3d CapsuleShape::computeInertia(double _mass) const
+{
+  return computeInertia(mRadius, mHeight, _mass);
+}
+
+//==============================================================================
+void CapsuleShape::updateVolume()
+{
+  mVolume = computeVolume(mRadius, mHeight);
+}
+
+//==============================================================================
+void CapsuleShape::updateBoundingBoxDim()
+{
+  const double halfLength = 0.5 * mHeight + mRadius;
+  mBoundingBox.setMin(Eigen::Vector3d(-mRadius, -mRadius, -halfLength));
+  mBoundingBox.setMax(Eigen::Vector3d(mRadius, mRadius, halfLength));
+}
+
+}  // namespace dynamics
+}  // namespace dart
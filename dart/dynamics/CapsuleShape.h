@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2016, Georgia Tech Research Corporation
+ * All rights reserved.
+ *
+ * Author(s): Jeongseok Lee <jslee02@gmail.com>
+ *
+ * Georgia Tech Graphics Lab and Humanoid Robotics Lab
+ *
+ * Directed by Prof. C. Karen Liu and Prof. Mike Stilman
+ * <karenliu@cc.gatech.edu> <mstilman@cc.gatech.edu>
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DART_DYNAMICS_CAPSULESHAPE_H_
+#define DART_DYNAMICS_CAPSULESHAPE_H_
+
+#include "dart/dynamics/Shape.h"
+
+namespace dart {
+namespace dynamics {
+
+/// CapsuleShape represents a cylinder capped with two hemispheres, i.e., the
+/// set of points within the radius of a segment along the z-axis.
+class CapsuleShape : public Shape
+{
+public:
+  /// Constructor
+  /// \param[in] _radius Radius of the cylinder and the hemispheres
+  /// \param[in] _height Length of the cylindrical part along the z-axis
+  CapsuleShape(double _radius, double _height);
+
+  /// Get the radius of the capsule
+  double getRadius() const;
+
+  /// Set the radius of the capsule
+  void setRadius(double _radius);
+
+  /// Get the length of the cylindrical part of the capsule
+  double getHeight() const;
+
+  /// Set the length of the cylindrical part of the capsule
+  void setHeight(double _height);
+
+  // Documentation inherited.
+  void draw(renderer::RenderInterface* _ri = nullptr,
+            const Eigen::Vector4d& _color = Eigen::Vector4d::Ones(),
+            bool _useDefaultColor = true) const override;
+
+  /// Compute volume from given properties
+  static double computeVolume(double _radius, double _height);
+
+  /// Compute moments of inertia of a capsule
+  static Eigen::Matrix3d computeInertia(
+      double _radius, double _height, double _mass);
+
+  // Documentation inherited.
+  Eigen::Matrix3d computeInertia(double _mass) const override;
+
+protected:
+  // Documentation inherited.
+  void updateVolume() override;
+
+private:
+  /// Update the bounding box
+  void updateBoundingBoxDim();
+
+  /// Radius of the cylinder and the hemispheres
+  double mRadius;
+
+  /// Length of the cylindrical part along the z-axis
+  double mHeight;
+
+public:
+  // To get byte-aligned Eigen vectors
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+}  // namespace dynamics
+}  // namespace dart
+
+#endif  // DART_DYNAMICS_CAPSULESHAPE_H_
@@ -60,6 +60,7 @@ void CylinderShape::setRadius(double _radius) {
   mRadius = _radius;
   _updateBoundingBoxDim();
   updateVolume();
+  ++mVersion;
 }
 
 double CylinderShape::getHeight() const {
@@ -71,6 +72,7 @@ void CylinderShape::setHeight(double _height) {
   mHeight = _height;
   _updateBoundingBoxDim();
   updateVolume();
+  ++mVersion;
 }
 
 void CylinderShape::draw(renderer::RenderInterface* _ri,
@@ -110,6 +110,7 @@ EndEffector::~EndEffector()
   size_t index = mIndexInBodyNode;
   assert(mBodyNode->mEndEffectors[index] == this);
   mBodyNode->mEndEffectors.erase(mBodyNode->mEndEffectors.begin() + index);
+  mBodyNode->mChildJacobianNodes.erase(this);
 
   for(size_t i=index; i<mBodyNode->mEndEffectors.size(); ++i)
   {
@@ -194,6 +195,12 @@ void EndEffector::setRelativeTransform(const Eigen::Isometry3d& _newRelativeTf)
   notifyTransformUpdate();
   notifyJacobianUpdate();
   notifyJacobianDerivUpdate();
+
+  // The operational-space quantities of tasks that include this EndEffector
+  // depend on its offset from the parent BodyNode
+  const SkeletonPtr& skel = getSkeleton();
+  if(skel)
+    skel->notifyOperationalSpaceUpdate(getTreeIndex());
 }
 
 //==============================================================================
@@ -405,6 +412,11 @@ EndEffector::EndEffector(BodyNode* _parent, const Properties& _properties)
 
   _parent->mEndEffectors.push_back(this);
   mIndexInBodyNode = _parent->mEndEffectors.size()-1;
+
+  // BodyNode::processNewEntity() cannot recognize this EndEffector as a
+  // JacobianNode while the Frame base is being constructed, so we register it
+  // here to receive the Jacobian notifications of the parent BodyNode.
+  _parent->mChildJacobianNodes.insert(this);
 }
 
 //==============================================================================
@@ -427,7 +439,13 @@ void EndEffector::updateEffectorJacobian() const
 //==============================================================================
 void EndEffector::updateWorldJacobian() const
 {
-  mWorldJacobian = math::AdRJac(getWorldTransform(), getJacobian());
+  // Move the World Jacobian of the parent BodyNode, which shares the columns of
+  // its ancestors, to the origin of this EndEffector
+  const math::Jacobian& J = mBodyNode->getWorldJacobian();
+  const Eigen::Vector3d offset = mBodyNode->getWorldTransform().linear()
+                                 * getRelativeTransform().translation();
+  mWorldJacobian = J;
+  mWorldJacobian.bottomRows<3>() += J.topRows<3>().colwise().cross(offset);
 
   mIsWorldJacobianDirty = false;
 }
@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2016, Georgia Tech Research Corporation
+ * All rights reserved.
+ *
+ * Author(s): Jeongseok Lee <jslee02@gmail.com>
+ *
+ * Georgia Tech Graphics Lab and Humanoid Robotics Lab
+ *
+ * Directed by Prof. C. Karen Liu and Prof. Mike Stilman
+ * <karenliu@cc.gatech.edu> <mstilman@cc.gatech.edu>
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dart/dynamics/HeightmapShape.h"
+
+#include <algorithm>
+
+#include "dart/dynamics/BoxShape.h"
+#include "dart/renderer/RenderInterface.h"
+
+namespace dart {
+namespace dynamics {
+
+//==============================================================================
+HeightmapShape::HeightmapShape(const Eigen::MatrixXd& _heights,
+                               const Eigen::Vector2d& _spacing)
+  : Shape(HEIGHTMAP),
+    mHeights(_heights),
+    mSpacing(_spacing),
+    mMinHeight(0.0),
+    mMaxHeight(0.0),
+    mTileSize(32),
+    mNumTileCols(0)
+{
+  assert(_heights.rows() >= 2 && _heights.cols() >= 2);
+  assert(_spacing[0] > 0.0 && _spacing[1] > 0.0);
+  resetTiles();
+  updateBoundingBoxDim();
+  updateVolume();
+}
+
+//==============================================================================
+void HeightmapShape::setHeights(const Eigen::MatrixXd& _heights)
+{
+  assert(_heights.rows() >= 2 && _heights.cols() >= 2);
+  const bool resized = _heights.rows() != mHeights.rows()
+                       || _heights.cols() != mHeights.cols();
+  mHeights = _heights;
+
+  if (resized)
+    resetTiles();
+  else
+    markTiles(0, 0, getNumRows() - 1, getNumCols() - 1);
+
+  updateBoundingBoxDim();
+  updateVolume();
+}
+
+//==============================================================================
+void HeightmapShape::setHeights(size_t _row, size_t _col,
+                                const Eigen::MatrixXd& _block)
+{
+  if (_block.size() == 0)
+    return;
+
+  assert(_row + _block.rows() <= getNumRows());
+  assert(_col + _block.cols() <= getNumCols());
+  mHeights.block(_row, _col, _block.rows(), _block.cols()) = _block;
+  markTiles(_row, _col, _row + _block.rows() - 1, _col + _block.cols() - 1);
+  updateBoundingBoxDim();
+  updateVolume();
+}
+
+//==============================================================================
+const Eigen::MatrixXd& HeightmapShape::getHeights() const
+{
+  return mHeights;
+}
+
+//==============================================================================
+void HeightmapShape::setHeight(size_t _row, size_t _col, double _height)
+{
+  assert(_row < getNumRows() && _col < getNumCols());
+  const double oldHeight = mHeights(_row, _col);
+  mHeights(_row, _col) = _height;
+  markTiles(_row, _col, _row, _col);
+
+  // The range only needs to be recomputed if an extreme height was lowered or
+  // raised
+  if (oldHeight == mMinHeight || oldHeight == mMaxHeight
+      || _height < mMinHeight || _height > mMaxHeight)
+  {
+    updateBoundingBoxDim();
+    updateVolume();
+  }
+}
+
+//==============================================================================
+double HeightmapShape::getHeight(size_t _row, size_t _col) const
+{
+  assert(_row < getNumRows() && _col < getNumCols());
+  return mHeights(_row, _col);
+}
+
+//==============================================================================
+size_t HeightmapShape::getNumRows() const
+{
+  return static_cast<size_t>(mHeights.rows());
+}
+
+//==============================================================================
+size_t HeightmapShape::getNumCols() const
+{
+  return static_cast<size_t>(mHeights.cols());
+}
+
+//==============================================================================
+void HeightmapShape::setSpacing(const Eigen::Vector2d& _spacing)
+{
+  assert(_spacing[0] > 0.0 && _spacing[1] > 0.0);
+  mSpacing = _spacing;
+  markTiles(0, 0, getNumRows() - 1, getNumCols() - 1);
+  updateBoundingBoxDim();
+  updateVolume();
+}
+
+//==============================================================================
+const Eigen::Vector2d& HeightmapShape::getSpacing() const
+{
+  return mSpacing;
+}
+
+//==============================================================================
+Eigen::Vector3d HeightmapShape::getVertex(size_t _row, size_t _col) const
+{
+  return Eigen::Vector3d(
+        (static_cast<double>(_col) - 0.5 * (getNumCols() - 1)) * mSpacing[0],
+        (static_cast<double>(_row) - 0.5 * (getNumRows() - 1)) * mSpacing[1],
+        mHeights(_row, _col));
+}
+
+//==============================================================================
+double HeightmapShape::getMinHeight() const
+{
+  return mMinHeight;
+}
+
+//==============================================================================
+double HeightmapShape::getMaxHeight() const
+{
+  return mMaxHeight;
+}
+
+//==============================================================================
+void HeightmapShape::setTileSize(size_t _size)
+{
+  assert(_size > 0);
+  mTileSize = _size;
+  resetTiles();
+}
+
+//==============================================================================
+size_t HeightmapShape::getTileSize() const
+{
+  return mTileSize;
+}
+
+//==============================================================================
+size_t HeightmapShape::getNumTileRows() const
+{
+  return mTileVersions.size() / mNumTileCols;
+}
+
+//==============================================================================
+size_t HeightmapShape::getNumTileCols() const
+{
+  return mNumTileCols;
+}
+
+//==============================================================================
+size_t HeightmapShape::getTileVersion(size_t _tileRow, size_t _tileCol) const
+{
+  assert(_tileRow < getNumTileRows() && _tileCol < mNumTileCols);
+  return mTileVersions[_tileRow * mNumTileCols + _tileCol];
+}
+
+//==============================================================================
+void HeightmapShape::draw(renderer::RenderInterface* _ri,
+                          const Eigen::Vector4d& _color,
+                          bool _useDefaultColor) const
+{
+  if (!_ri)
+    return;
+
+  if (mHidden)
+    return;
+
+  if (!_useDefaultColor)
+    _ri->setPenColor(_color);
+  else
+    _ri->setPenColor(mColor);
+
+  // The render interface has no triangle primitive, so the grid is drawn as a
+  // wireframe
+  const size_t numRows = getNumRows();
+  const size_t numCols = getNumCols();
+  std::vector<Eigen::Vector3d> vertices;
+  vertices.reserve(numRows * numCols);
+  for (size_t i = 0; i < numRows; ++i)
+  {
+    for (size_t j = 0; j < numCols; ++j)
+      vertices.push_back(getVertex(i, j));
+  }
+
+  Eigen::aligned_vector<Eigen::Vector2i> connections;
+  connections.reserve(3 * numRows * numCols);
+  for (size_t i = 0; i < numRows; ++i)
+  {
+    for (size_t j = 0; j < numCols; ++j)
+    {
+      const int index = static_cast<int>(i * numCols + j);
+      if (j + 1 < numCols)
+        connections.push_back(Eigen::Vector2i(index, index + 1));
+      if (i + 1 < numRows)
+        connections.push_back(Eigen::Vector2i(index, index + numCols));
+      if (i + 1 < numRows && j + 1 < numCols)
+        connections.push_back(Eigen::Vector2i(index, index + numCols + 1));
+    }
+  }
+
+  _ri->pushMatrix();
+  _ri->transform(mTransform);
+  _ri->drawLineSegments(vertices, connections);
+  _ri->popMatrix();
+}
+
+//==============================================================================
+Eigen::Matrix3d HeightmapShape::computeInertia(double _mass) const
+{
+  return BoxShape::computeInertia(
+        mBoundingBox.getMax() - mBoundingBox.getMin(), _mass);
+}
+
+//==============================================================================
+void HeightmapShape::updateVolume()
+{
+  const Eigen::Vector3d size = mBoundingBox.getMax() - mBoundingBox.getMin();
+  mVolume = size[0] * size[1] * size[2];
+}
+
+//==============================================================================
+void HeightmapShape::updateBoundingBoxDim()
+{
+  mMinHeight = mHeights.minCoeff();
+  mMaxHeight = mHeights.maxCoeff();
+
+  const double halfX = 0.5 * (getNumCols() - 1) * mSpacing[0];
+  const double halfY = 0.5 * (getNumRows() - 1) * mSpacing[1];
+  mBoundingBox.setMin(Eigen::Vector3d(-halfX, -halfY, mMinHeight));
+  mBoundingBox.setMax(Eigen::Vector3d(halfX, halfY, mMaxHeight));
+}
+
+//==============================================================================
+void HeightmapShape::resetTiles()
+{
+  const size_t numCellRows = getNumRows() - 1;
+  const size_t numCellCols = getNumCols() - 1;
+  const size_t numTileRows = (numCellRows + mTileSize - 1) / mTileSize;
+  mNumTileCols = (numCellCols + mTileSize - 1) / mTileSize;
+
+  ++mVersion;
+  mTileVersions.assign(numTileRows * mNumTileCols, mVersion);
+}
+
+//==============================================================================
+void HeightmapShape::markTiles(size_t _row0, size_t _col0,
+                               size_t _row1, size_t _col1)
+{
+  // The neighbors of the modified vertices are included since their normals
+  // change as well, and a vertex on the border between two tiles belongs to
+  // both
+  const size_t row0 = _row0 > 0 ? _row0 - 1 : 0;
+  const size_t col0 = _col0 > 0 ? _col0 - 1 : 0;
+  const size_t row1 = _row1 + 1;
+  const size_t col1 = _col1 + 1;
+  const size_t tileRow0 = row0 > 0 ? (row0 - 1) / mTileSize : 0;
+  const size_t tileCol0 = col0 > 0 ? (col0 - 1) / mTileSize : 0;
+  const size_t tileRow1 = std::min(row1 / mTileSize, getNumTileRows() - 1);
+  const size_t tileCol1 = std::min(col1 / mTileSize, mNumTileCols - 1);
+
+  ++mVersion;
+  for (size_t i = tileRow0; i <= tileRow1; ++i)
+  {
+    for (size_t j = tileCol0; j <= tileCol1; ++j)
+      mTileVersions[i * mNumTileCols + j] = mVersion;
+  }
+}
+
+}  // namespace dynamics
+}  // namespace dart
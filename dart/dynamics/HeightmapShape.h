@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2016, Georgia Tech Research Corporation
+ * All rights reserved.
+ *
+ * Author(s): Jeongseok Lee <jslee02@gmail.com>
+ *
+ * Georgia Tech Graphics Lab and Humanoid Robotics Lab
+ *
+ * Directed by Prof. C. Karen Liu and Prof. Mike Stilman
+ * <karenliu@cc.gatech.edu> <mstilman@cc.gatech.edu>
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DART_DYNAMICS_HEIGHTMAPSHAPE_H_
+#define DART_DYNAMICS_HEIGHTMAPSHAPE_H_
+
+#include <vector>
+
+#include "dart/dynamics/Shape.h"
+
+namespace dart {
+namespace dynamics {
+
+/// HeightmapShape represents terrain as a regular grid of heights. The entry
+/// (i, j) of the height matrix is the height along the z-axis of the vertex at
+/// row i and column j, where rows advance along the y-axis and columns along
+/// the x-axis. The grid is centered on the origin in the xy-plane, and each
+/// cell is split into two triangles. The volume below the surface is solid.
+///
+/// Modifications are tracked per tile of getTileSize() x getTileSize() cells,
+/// so that renderers only need to rebuild the tiles whose version changed.
+class HeightmapShape : public Shape
+{
+public:
+  /// Constructor
+  /// \param[in] _heights Heights of the vertices, at least 2 x 2
+  /// \param[in] _spacing Distance between neighboring columns (x) and rows (y)
+  HeightmapShape(const Eigen::MatrixXd& _heights,
+                 const Eigen::Vector2d& _spacing);
+
+  /// Replace all the heights. The grid may be resized.
+  void setHeights(const Eigen::MatrixXd& _heights);
+
+  /// Overwrite the block of heights whose top-left entry is (_row, _col)
+  void setHeights(size_t _row, size_t _col, const Eigen::MatrixXd& _block);
+
+  /// Get the heights of all the vertices
+  const Eigen::MatrixXd& getHeights() const;
+
+  /// Set the height of the vertex at (_row, _col)
+  void setHeight(size_t _row, size_t _col, double _height);
+
+  /// Get the height of the vertex at (_row, _col)
+  double getHeight(size_t _row, size_t _col) const;
+
+  /// Get the number of rows of vertices
+  size_t getNumRows() const;
+
+  /// Get the number of columns of vertices
+  size_t getNumCols() const;
+
+  /// Set the distance between neighboring columns (x) and rows (y)
+  void setSpacing(const Eigen::Vector2d& _spacing);
+
+  /// Get the distance between neighboring columns (x) and rows (y)
+  const Eigen::Vector2d& getSpacing() const;
+
+  /// Get the position of the vertex at (_row, _col) in the frame of the shape
+  Eigen::Vector3d getVertex(size_t _row, size_t _col) const;
+
+  /// Get the lowest height of the grid
+  double getMinHeight() const;
+
+  /// Get the highest height of the grid
+  double getMaxHeight() const;
+
+  /// Set the number of cells along each side of a tile. All the tiles are
+  /// marked as modified.
+  void setTileSize(size_t _size);
+
+  /// Get the number of cells along each side of a tile
+  size_t getTileSize() const;
+
+  /// Get the number of rows of tiles
+  size_t getNumTileRows() const;
+
+  /// Get the number of columns of tiles
+  size_t getNumTileCols() const;
+
+  /// Get the version of the tile at (_tileRow, _tileCol). The version changes
+  /// whenever a vertex of the tile or one of its neighbors is modified. It is
+  /// taken from the version of the whole shape, getVersion(), at that time.
+  size_t getTileVersion(size_t _tileRow, size_t _tileCol) const;
+
+  // Documentation inherited.
+  void draw(renderer::RenderInterface* _ri = nullptr,
+            const Eigen::Vector4d& _color = Eigen::Vector4d::Ones(),
+            bool _useDefaultColor = true) const override;
+
+  /// Compute moments of inertia of the bounding box of the terrain
+  Eigen::Matrix3d computeInertia(double _mass) const override;
+
+protected:
+  // Documentation inherited.
+  void updateVolume() override;
+
+private:
+  /// Update the bounding box and the range of heights
+  void updateBoundingBoxDim();
+
+  /// Resize the tile versions after the grid or the tile size changed and mark
+  /// all the tiles as modified
+  void resetTiles();
+
+  /// Mark the tiles containing the vertices from (_row0, _col0) to
+  /// (_row1, _col1), or their neighbors, as modified
+  void markTiles(size_t _row0, size_t _col0, size_t _row1, size_t _col1);
+
+  /// Heights of the vertices
+  Eigen::MatrixXd mHeights;
+
+  /// Distance between neighboring columns (x) and rows (y)
+  Eigen::Vector2d mSpacing;
+
+  /// Lowest height
+  double mMinHeight;
+
+  /// Highest height
+  double mMaxHeight;
+
+  /// Number of cells along each side of a tile
+  size_t mTileSize;
+
+  /// Number of columns of tiles
+  size_t mNumTileCols;
+
+  /// Versions of the tiles, stored row by row
+  std::vector<size_t> mTileVersions;
+
+public:
+  // To get byte-aligned Eigen vectors
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+}  // namespace dynamics
+}  // namespace dart
+
+#endif  // DART_DYNAMICS_HEIGHTMAPSHAPE_H_
@@ -35,7 +35,9 @@
  */
 
 #include "dart/dynamics/InverseKinematics.h"
+#include "dart/common/Parallel.h"
 #include "dart/dynamics/BodyNode.h"
+#include "dart/dynamics/EndEffector.h"
 #include "dart/dynamics/DegreeOfFreedom.h"
 #include "dart/dynamics/SimpleFrame.h"
 
@@ -113,6 +115,126 @@ bool InverseKinematics::solve(Eigen::VectorXd& positions, bool _applySolution)
   return wasSolved;
 }
 
+//==============================================================================
+static JacobianNode* getJacobianNodeClone(const JacobianNode* _node,
+                                          const SkeletonPtr& _skelClone)
+{
+  if(dynamic_cast<const BodyNode*>(_node))
+    return _skelClone->getBodyNode(_node->getName());
+
+  if(dynamic_cast<const EndEffector*>(_node))
+    return _skelClone->getEndEffector(_node->getName());
+
+  return nullptr;
+}
+
+//==============================================================================
+size_t InverseKinematics::solveBatch(
+    const Eigen::aligned_vector<Eigen::Isometry3d>& _targets,
+    std::vector<Eigen::VectorXd>& _solutions,
+    std::vector<bool>& _successes,
+    size_t _numThreads) const
+{
+  _solutions.resize(_targets.size());
+  _successes.assign(_targets.size(), false);
+
+  // std::vector<bool> cannot be written concurrently, so the workers record
+  // their results here instead
+  std::vector<char> solved(_targets.size(), false);
+
+  if(_targets.empty())
+    return 0;
+
+  if(nullptr == mSolver || nullptr == mProblem)
+  {
+    dtwarn << "[InverseKinematics::solveBatch] The Solver or Problem for an "
+           << "InverseKinematics module associated with [" << mNode->getName()
+           << "] is a nullptr. You must reset them before you can use this "
+           << "module.\n";
+    return 0;
+  }
+
+  _numThreads = common::getNumParallelThreads(_numThreads, _targets.size());
+
+  const ConstSkeletonPtr& skel = getNode()->getSkeleton();
+  const Eigen::VectorXd skelPositions = skel->getPositions();
+
+  // Set up one Skeleton clone and IK module clone per worker. This is done
+  // up front on the calling thread, so that the workers only touch their own
+  // copies.
+  std::vector<SkeletonPtr> skelClones;
+  std::vector<InverseKinematicsPtr> ikClones;
+  skelClones.reserve(_numThreads);
+  ikClones.reserve(_numThreads);
+  for(size_t i=0; i < _numThreads; ++i)
+  {
+    SkeletonPtr skelClone = skel->clone();
+    skelClone->setPositions(skelPositions);
+
+    JacobianNode* nodeClone = getJacobianNodeClone(getNode(), skelClone);
+    if(nullptr == nodeClone)
+    {
+      dterr << "[InverseKinematics::solveBatch] Could not find a clone of the "
+            << "JacobianNode [" << mNode->getName() << "]. Only BodyNodes and "
+            << "EndEffectors are supported for batch solving.\n";
+      return 0;
+    }
+
+    InverseKinematicsPtr ik = clone(nodeClone);
+    ik->setTarget(std::make_shared<SimpleFrame>(
+                    Frame::World(), mNode->getName()+"_batch_target"));
+
+    // The Problem only needs to be configured once for the whole batch
+    const SkeletonPtr& cloneSkel = ik->getNode()->getSkeleton();
+    ik->mProblem->setDimension(ik->mDofs.size());
+    Eigen::VectorXd bounds(ik->mDofs.size());
+    for(size_t j=0; j < ik->mDofs.size(); ++j)
+      bounds[j] = cloneSkel->getDof(ik->mDofs[j])->getPositionLowerLimit();
+    ik->mProblem->setLowerBounds(bounds);
+
+    for(size_t j=0; j < ik->mDofs.size(); ++j)
+      bounds[j] = cloneSkel->getDof(ik->mDofs[j])->getPositionUpperLimit();
+    ik->mProblem->setUpperBounds(bounds);
+
+    skelClones.push_back(skelClone);
+    ikClones.push_back(ik);
+  }
+
+  auto solveChunk = [&](size_t _worker, size_t _begin, size_t _end)
+  {
+    InverseKinematics* ik = ikClones[_worker].get();
+    const Eigen::VectorXd initialGuess = ik->getPositions();
+    Eigen::VectorXd seed = initialGuess;
+
+    for(size_t i=_begin; i < _end; ++i)
+    {
+      ik->mTarget->setTransform(_targets[i]);
+      ik->mProblem->setInitialGuess(seed);
+
+      const bool wasSolved = ik->mSolver->solve();
+      _solutions[i] = ik->mProblem->getOptimalSolution();
+      solved[i] = wasSolved;
+
+      // Warm-start the next target from this solution, unless it failed, in
+      // which case we fall back to the original configuration
+      seed = wasSolved? _solutions[i] : initialGuess;
+      ik->setPositions(seed);
+    }
+  };
+
+  common::parallelFor(_targets.size(), _numThreads, solveChunk);
+
+  size_t numSolved = 0;
+  for(size_t i=0; i < solved.size(); ++i)
+  {
+    _successes[i] = solved[i];
+    if(solved[i])
+      ++numSolved;
+  }
+
+  return numSolved;
+}
+
 //==============================================================================
 static std::shared_ptr<optimizer::Function> cloneIkFunc(
     const std::shared_ptr<optimizer::Function>& _function,
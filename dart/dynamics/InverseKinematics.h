@@ -101,6 +101,26 @@ public:
   /// solved positions.
   bool solve(Eigen::VectorXd& positions, bool _applySolution = true);
 
+  /// Solve the IK Problem once for each of the target transforms in _targets,
+  /// which must be expressed in World coordinates. The Skeleton of this module
+  /// will not be modified: each worker thread operates on its own clone of the
+  /// Skeleton and of this IK module, and the Problem of each clone is only set
+  /// up once per batch.
+  ///
+  /// The targets are split into contiguous chunks (one per thread), and each
+  /// solve is warm-started from the solution of the previous target in its
+  /// chunk, so neighboring targets should be placed next to each other in
+  /// _targets. If a target fails, the next one is seeded from the Skeleton's
+  /// current configuration instead.
+  ///
+  /// _solutions and _successes will be resized to match the size of _targets.
+  /// If _numThreads is zero, the number of hardware threads will be used.
+  /// Returns the number of targets that were solved successfully.
+  size_t solveBatch(const Eigen::aligned_vector<Eigen::Isometry3d>& _targets,
+                    std::vector<Eigen::VectorXd>& _solutions,
+                    std::vector<bool>& _successes,
+                    size_t _numThreads = 0) const;
+
   /// Clone this IK module, but targeted at a new Node. Any Functions in the
   /// Problem that inherit InverseKinematics::Function will be adapted to the
   /// new IK module. Any generic optimizer::Function will just be copied over
@@ -98,9 +98,9 @@ void JacobianNode::clearIK()
 //==============================================================================
 void JacobianNode::notifyJacobianUpdate()
 {
-  // mIsWorldJacobianDirty depends on mIsBodyJacobianDirty, so we only need to
-  // check mIsBodyJacobianDirty if we want to terminate.
-  if(mIsBodyJacobianDirty)
+  // The World Jacobian may be updated without the body Jacobian, so we must
+  // check that both are dirty if we want to terminate early.
+  if(mIsBodyJacobianDirty && mIsWorldJacobianDirty)
     return;
 
   mIsBodyJacobianDirty = true;
@@ -109,6 +109,7 @@ size_t LineSegmentShape::addVertex(const Eigen::Vector3d& _v)
     return addVertex(_v, parent-1);
 
   mVertices.push_back(_v);
+  ++mVersion;
   return 0;
 }
 
@@ -136,6 +137,7 @@ size_t LineSegmentShape::addVertex(const Eigen::Vector3d& _v, size_t _parent)
   {
     mConnections.push_back(Eigen::Vector2i(_parent, index));
   }
+  ++mVersion;
 
   return index;
 }
@@ -160,6 +162,7 @@ void LineSegmentShape::removeVertex(size_t _idx)
   }
 
   mVertices.erase(mVertices.begin()+_idx);
+  ++mVersion;
 }
 
 //==============================================================================
@@ -180,6 +183,7 @@ void LineSegmentShape::setVertex(size_t _idx, const Eigen::Vector3d& _v)
     return;
   }
   mVertices[_idx] = _v;
+  ++mVersion;
 }
 
 //==============================================================================
@@ -225,6 +229,7 @@ void LineSegmentShape::addConnection(size_t _idx1, size_t _idx2)
   }
 
   mConnections.push_back(Eigen::Vector2i(_idx1, _idx2));
+  ++mVersion;
 }
 
 //==============================================================================
@@ -245,6 +250,7 @@ void LineSegmentShape::removeConnection(size_t _vertexIdx1, size_t _vertexIdx2)
     else
       ++it;
   }
+  ++mVersion;
 }
 
 //==============================================================================
@@ -267,6 +273,7 @@ void LineSegmentShape::removeConnection(size_t _connectionIdx)
   }
 
   mConnections.erase(mConnections.begin()+_connectionIdx);
+  ++mVersion;
 }
 
 //==============================================================================
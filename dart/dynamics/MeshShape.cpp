@@ -47,6 +47,7 @@
 #include "dart/config.h"
 #include "dart/renderer/RenderInterface.h"
 #include "dart/common/Console.h"
+#include "dart/math/Geometry.h"
 #include "dart/dynamics/AssimpInputResourceAdaptor.h"
 #include "dart/common/LocalResourceRetriever.h"
 #include "dart/common/Uri.h"
@@ -138,15 +139,17 @@ MeshShape::MeshShape(const Eigen::Vector3d& _scale, const aiScene* _mesh,
   : Shape(MESH),
     mResourceRetriever(_resourceRetriever),
     mDisplayList(0),
+    mScale(_scale),
     mColorMode(MATERIAL_COLOR),
-    mColorIndex(0)
+    mColorIndex(0),
+    mCollisionMode(TRIANGLES),
+    mIsConvexHullDirty(true)
 {
   assert(_scale[0] > 0.0);
   assert(_scale[1] > 0.0);
   assert(_scale[2] > 0.0);
 
   setMesh(_mesh, _path, _resourceRetriever);
-  setScale(_scale);
 }
 
 MeshShape::~MeshShape() {
@@ -193,6 +196,8 @@ void MeshShape::setMesh(
     mMeshPath = "";
     mMeshUri = "";
     mResourceRetriever = nullptr;
+    mIsConvexHullDirty = true;
+    ++mVersion;
     return;
   }
 
@@ -215,6 +220,8 @@ void MeshShape::setMesh(
 
   _updateBoundingBoxDim();
   updateVolume();
+  mIsConvexHullDirty = true;
+  ++mVersion;
 }
 
 void MeshShape::setScale(const Eigen::Vector3d& _scale) {
@@ -224,6 +231,8 @@ void MeshShape::setScale(const Eigen::Vector3d& _scale) {
   mScale = _scale;
   updateVolume();
   _updateBoundingBoxDim();
+  mIsConvexHullDirty = true;
+  ++mVersion;
 }
 
 const Eigen::Vector3d& MeshShape::getScale() const {
@@ -250,6 +259,29 @@ int MeshShape::getColorIndex() const
   return mColorIndex;
 }
 
+void MeshShape::setCollisionMode(CollisionMode _mode)
+{
+  mCollisionMode = _mode;
+  ++mVersion;
+}
+
+MeshShape::CollisionMode MeshShape::getCollisionMode() const
+{
+  return mCollisionMode;
+}
+
+const std::vector<Eigen::Vector3d>& MeshShape::getConvexHullVertices() const
+{
+  updateConvexHull();
+  return mConvexHullVertices;
+}
+
+const std::vector<Eigen::Vector3i>& MeshShape::getConvexHullTriangles() const
+{
+  updateConvexHull();
+  return mConvexHullTriangles;
+}
+
 int MeshShape::getDisplayList() const {
   return mDisplayList;
 }
@@ -298,6 +330,36 @@ void MeshShape::updateVolume() {
   mVolume = bounds.x() * bounds.y() * bounds.z();
 }
 
+void MeshShape::updateConvexHull() const {
+  std::lock_guard<std::mutex> lock(mConvexHullMutex);
+  if(!mIsConvexHullDirty)
+    return;
+
+  mIsConvexHullDirty = false;
+  mConvexHullVertices.clear();
+  mConvexHullTriangles.clear();
+
+  if(!mMesh)
+    return;
+
+  std::vector<Eigen::Vector3d> points;
+  for (unsigned int i = 0; i < mMesh->mNumMeshes; i++) {
+    const aiMesh* mesh = mMesh->mMeshes[i];
+    for (unsigned int j = 0; j < mesh->mNumVertices; j++) {
+      const aiVector3D& vertex = mesh->mVertices[j];
+      points.push_back(Eigen::Vector3d(vertex.x, vertex.y, vertex.z)
+                       .cwiseProduct(mScale));
+    }
+  }
+
+  mConvexHullVertices = math::computeConvexHull3D(points, &mConvexHullTriangles);
+  if(mConvexHullVertices.empty() && !points.empty())
+  {
+    dtwarn << "[MeshShape::updateConvexHull] The mesh [" << mMeshUri << "] "
+           << "does not enclose a volume, so it has no convex hull.\n";
+  }
+}
+
 void MeshShape::_updateBoundingBoxDim() {
 
   if(!mMesh)
@@ -38,7 +38,9 @@
 #ifndef DART_DYNAMICS_MESHSHAPE_H_
 #define DART_DYNAMICS_MESHSHAPE_H_
 
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include <assimp/scene.h>
 
@@ -65,6 +67,12 @@ public:
     SHAPE_COLOR,        ///< Use the color specified by the Shape base class
   };
 
+  enum CollisionMode
+  {
+    TRIANGLES = 0, ///< Collide with the triangles of the mesh
+    CONVEX_HULL,   ///< Collide with the convex hull of the vertices
+  };
+
   /// \brief Constructor.
   MeshShape(
     const Eigen::Vector3d& _scale,
@@ -120,6 +128,23 @@ public:
   /// Get the index that will be used when the ColorMode is set to COLOR_INDEX
   int getColorIndex() const;
 
+  /// Set whether collision detectors should use the exact triangles of this
+  /// mesh (the default) or its convex hull. Triangle-exact collision is only
+  /// supported by the FCL based detectors, while the convex hull is much
+  /// cheaper but fills in the concavities of the mesh.
+  void setCollisionMode(CollisionMode _mode);
+
+  /// Get the collision geometry that this mesh is using
+  CollisionMode getCollisionMode() const;
+
+  /// Get the vertices of the convex hull of the scaled mesh. The hull is
+  /// computed on the first call after the mesh or the scale has changed.
+  const std::vector<Eigen::Vector3d>& getConvexHullVertices() const;
+
+  /// Get the triangles of the convex hull of the scaled mesh as indices into
+  /// getConvexHullVertices(), ordered counterclockwise when seen from outside
+  const std::vector<Eigen::Vector3i>& getConvexHullTriangles() const;
+
   /// \brief
   int getDisplayList() const;
 
@@ -148,6 +173,9 @@ protected:
   /// \brief
   void _updateBoundingBoxDim();
 
+  /// Recompute the convex hull of the scaled mesh if it is out of date
+  void updateConvexHull() const;
+
   /// \brief
   const aiScene* mMesh;
 
@@ -172,6 +200,22 @@ protected:
   /// Specifies which color index should be used when mColorMode is COLOR_INDEX
   int mColorIndex;
 
+  /// Specifies which geometry collision detectors should use
+  CollisionMode mCollisionMode;
+
+  /// True if the convex hull needs to be recomputed
+  mutable bool mIsConvexHullDirty;
+
+  /// Protects the lazy update of the convex hull, which may be requested by
+  /// concurrent narrow phase queries
+  mutable std::mutex mConvexHullMutex;
+
+  /// Vertices of the convex hull of the scaled mesh
+  mutable std::vector<Eigen::Vector3d> mConvexHullVertices;
+
+  /// Triangles of the convex hull of the scaled mesh
+  mutable std::vector<Eigen::Vector3i> mConvexHullTriangles;
+
 public:
   // To get byte-aligned Eigen vectors
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -602,6 +602,25 @@ public:
 
   /// \}
 
+  //----------------------------------------------------------------------------
+  /// \{ \name Centroidal Dynamics
+  //----------------------------------------------------------------------------
+
+  /// Get the MetaSkeleton's centroidal momentum matrix in terms of any Frame
+  /// (default is World Frame). The centroidal momentum matrix A_G maps the
+  /// generalized velocities to the centroidal momentum h_G = A_G * dq, which
+  /// stacks the angular momentum about the COM on top of the linear momentum.
+  virtual math::Jacobian getCentroidalMomentumMatrix(
+      const Frame* _inCoordinatesOf = Frame::World()) const = 0;
+
+  /// Get the velocity product term dA_G * dq of the rate of change of the
+  /// centroidal momentum, i.e., dh_G = A_G * ddq + dA_G * dq, in terms of any
+  /// Frame (default is World Frame)
+  virtual Eigen::Vector6d getCentroidalMomentumBias(
+      const Frame* _inCoordinatesOf = Frame::World()) const = 0;
+
+  /// \}
+
 protected:
 
   /// Default constructor
@@ -86,6 +86,7 @@ Eigen::Matrix3d PlaneShape::computeInertia(double /*mass*/) const
 void PlaneShape::setNormal(const Eigen::Vector3d& _normal)
 {
   mNormal = _normal.normalized();
+  ++mVersion;
 }
 
 //==============================================================================
@@ -98,6 +99,7 @@ const Eigen::Vector3d& PlaneShape::getNormal() const
 void PlaneShape::setOffset(double _offset)
 {
   mOffset = _offset;
+  ++mVersion;
 }
 
 //==============================================================================
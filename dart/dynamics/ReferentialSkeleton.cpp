@@ -946,6 +946,78 @@ math::LinearJacobian ReferentialSkeleton::getCOMLinearJacobianDeriv(
         this, _inCoordinatesOf);
 }
 
+//==============================================================================
+math::Jacobian ReferentialSkeleton::getCentroidalMomentumMatrix(
+    const Frame* _inCoordinatesOf) const
+{
+  math::Jacobian A = math::Jacobian::Zero(6, getNumDofs());
+  const Eigen::Vector3d com = getCOM();
+
+  for(const BodyNode* bn : getBodyNodes())
+  {
+    // Momentum of the BodyNode, about its origin and in its own coordinates,
+    // for each dependent DegreeOfFreedom
+    const math::Jacobian bnP = bn->getSpatialInertia() * bn->getJacobian();
+    const Eigen::Isometry3d& T = bn->getWorldTransform();
+
+    const std::vector<const DegreeOfFreedom*>& dofs = bn->getDependentDofs();
+    size_t nDofs = dofs.size();
+    for(size_t i=0; i<nDofs; ++i)
+    {
+      size_t index = getIndexOf(dofs[i], false);
+      if(INVALID_INDEX == index)
+        continue;
+
+      const Eigen::Vector3d l = T.linear() * bnP.col(i).tail<3>();
+      A.col(index).head<3>() += T.linear() * bnP.col(i).head<3>()
+                                + (T.translation() - com).cross(l);
+      A.col(index).tail<3>() += l;
+    }
+  }
+
+  if(_inCoordinatesOf->isWorld())
+    return A;
+
+  return math::AdRInvJac(_inCoordinatesOf->getWorldTransform(), A);
+}
+
+//==============================================================================
+Eigen::Vector6d ReferentialSkeleton::getCentroidalMomentumBias(
+    const Frame* _inCoordinatesOf) const
+{
+  Eigen::Vector6d bias = Eigen::Vector6d::Zero();
+  const Eigen::Vector3d com = getCOM();
+
+  for(const BodyNode* bn : getBodyNodes())
+  {
+    const std::vector<const DegreeOfFreedom*>& dofs = bn->getDependentDofs();
+    Eigen::VectorXd dq(dofs.size());
+    for(size_t i=0; i<dofs.size(); ++i)
+      dq[i] = dofs[i]->getVelocity();
+
+    const Eigen::Matrix6d& G = bn->getSpatialInertia();
+    const Eigen::Vector6d& V = bn->getSpatialVelocity();
+    const Eigen::Vector6d F = G * (bn->getJacobianSpatialDeriv() * dq)
+                              - math::dad(V, G * V);
+
+    const Eigen::Isometry3d& T = bn->getWorldTransform();
+    const Eigen::Vector3d f = T.linear() * F.tail<3>();
+    bias.head<3>() += T.linear() * F.head<3>()
+                      + (T.translation() - com).cross(f);
+    bias.tail<3>() += f;
+  }
+
+  if(_inCoordinatesOf->isWorld())
+    return bias;
+
+  const Eigen::Matrix3d R
+      = _inCoordinatesOf->getWorldTransform().linear().transpose();
+  bias.head<3>() = R * bias.head<3>();
+  bias.tail<3>() = R * bias.tail<3>();
+
+  return bias;
+}
+
 //==============================================================================
 void ReferentialSkeleton::registerComponent(BodyNode* _bn)
 {
@@ -321,6 +321,26 @@ public:
 
   /// \}
 
+  //----------------------------------------------------------------------------
+  /// \{ \name Centroidal Dynamics
+  //----------------------------------------------------------------------------
+
+  /// Get the centroidal momentum matrix of the BodyNodes in this
+  /// ReferentialSkeleton. Like getCOMJacobian(), this sums the Jacobians of the
+  /// individual BodyNodes and ignores the columns of DegreesOfFreedom that do
+  /// not belong to this ReferentialSkeleton.
+  math::Jacobian getCentroidalMomentumMatrix(
+      const Frame* _inCoordinatesOf = Frame::World()) const override;
+
+  /// Get the velocity product term of the rate of change of the centroidal
+  /// momentum of the BodyNodes in this ReferentialSkeleton. The velocities of
+  /// all the DegreesOfFreedom that the BodyNodes depend on are taken into
+  /// account.
+  Eigen::Vector6d getCentroidalMomentumBias(
+      const Frame* _inCoordinatesOf = Frame::World()) const override;
+
+  /// \}
+
 protected:
 
   /// Default constructor. Protected to avoid blank and useless instantiations
@@ -50,6 +50,7 @@ Shape::Shape(ShapeType _type)
     mTransform(Eigen::Isometry3d::Identity()),
     mVariance(STATIC),
     mHidden(false),
+    mVersion(0),
     mType(_type)
 {
 }
@@ -117,6 +118,7 @@ Eigen::Vector3d Shape::getBoundingBoxDim() const
 void Shape::setLocalTransform(const Eigen::Isometry3d& _Transform)
 {
   mTransform = _Transform;
+  ++mVersion;
 }
 
 //==============================================================================
@@ -129,6 +131,7 @@ const Eigen::Isometry3d& Shape::getLocalTransform() const
 void Shape::setOffset(const Eigen::Vector3d& _offset)
 {
   mTransform.translation() = _offset;
+  ++mVersion;
 }
 
 //==============================================================================
@@ -149,6 +152,12 @@ int Shape::getID() const
   return mID;
 }
 
+//==============================================================================
+size_t Shape::getVersion() const
+{
+  return mVersion;
+}
+
 //==============================================================================
 Shape::ShapeType Shape::getShapeType() const
 {
@@ -69,7 +69,9 @@ public:
     PLANE,
     MESH,
     SOFT_MESH,
-    LINE_SEGMENT
+    LINE_SEGMENT,
+    CAPSULE,
+    HEIGHTMAP
   };
 
   /// DataVariance can be used by renderers to determine whether it should
@@ -166,6 +168,12 @@ public:
   /// \brief
   int getID() const;
 
+  /// Return a counter that is incremented whenever the geometry of this shape
+  /// changes, i.e., its dimensions, vertices or local transform. Collision
+  /// detectors compare it with the value they saw last to find out whether
+  /// their cached bounding boxes are still valid.
+  size_t getVersion() const;
+
   /// \brief
   ShapeType getShapeType() const;
 
@@ -235,6 +243,9 @@ protected:
   /// True if this shape should be kept from rendering
   bool mHidden;
 
+  /// Incremented by every function that changes the geometry
+  size_t mVersion;
+
   /// \brief
   static int mCounter;
 
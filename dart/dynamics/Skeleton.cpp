@@ -40,9 +40,11 @@
 #include <algorithm>
 #include <queue>
 #include <string>
+#include <typeinfo>
 #include <vector>
 
 #include "dart/common/Console.h"
+#include "dart/common/Parallel.h"
 #include "dart/math/Geometry.h"
 #include "dart/math/Helpers.h"
 #include "dart/dynamics/BodyNode.h"
@@ -53,6 +55,12 @@
 #include "dart/dynamics/Marker.h"
 #include "dart/dynamics/PointMass.h"
 #include "dart/dynamics/SoftBodyNode.h"
+#include "dart/dynamics/RevoluteJoint.h"
+#include "dart/dynamics/PrismaticJoint.h"
+#include "dart/dynamics/ScrewJoint.h"
+#include "dart/dynamics/BallJoint.h"
+#include "dart/dynamics/FreeJoint.h"
+#include "dart/dynamics/WeldJoint.h"
 
 namespace dart {
 namespace dynamics {
@@ -65,6 +73,31 @@ namespace dynamics {
 
 #define ON_ALL_TREES( X ) for(size_t i=0; i < mTreeCache.size(); ++i) X (i);
 
+// Call FUNC on JOINT, bound statically to the Joint type recorded as KERNEL in
+// the compiled dynamics program
+#define DISPATCH_JOINT( KERNEL, JOINT, FUNC, ... )                             \
+  switch( KERNEL )                                                             \
+  {                                                                            \
+    case JointKernel::REVOLUTE:                                                \
+      static_cast<RevoluteJoint*>( JOINT )->RevoluteJoint:: FUNC (__VA_ARGS__);\
+      break;                                                                   \
+    case JointKernel::PRISMATIC:                                               \
+      static_cast<PrismaticJoint*>( JOINT )->PrismaticJoint::                  \
+          FUNC (__VA_ARGS__);                                                  \
+      break;                                                                   \
+    case JointKernel::BALL:                                                    \
+      static_cast<BallJoint*>( JOINT )->BallJoint:: FUNC (__VA_ARGS__);        \
+      break;                                                                   \
+    case JointKernel::FREE:                                                    \
+      static_cast<FreeJoint*>( JOINT )->FreeJoint:: FUNC (__VA_ARGS__);        \
+      break;                                                                   \
+    case JointKernel::WELD:                                                    \
+      static_cast<WeldJoint*>( JOINT )->WeldJoint:: FUNC (__VA_ARGS__);        \
+      break;                                                                   \
+    default:                                                                   \
+      ( JOINT )-> FUNC (__VA_ARGS__);                                          \
+  }
+
 //==============================================================================
 Skeleton::Properties::Properties(
     const std::string& _name,
@@ -182,6 +215,12 @@ SkeletonPtr Skeleton::clone() const
   }
 
   skelClone->setProperties(getSkeletonProperties());
+  for(const auto& pair : mDisabledCollisionPairs)
+  {
+    skelClone->setCollisionAllowed(
+          skelClone->getBodyNode(pair.first->getIndexInSkeleton()),
+          skelClone->getBodyNode(pair.second->getIndexInSkeleton()), false);
+  }
 
   return skelClone;
 }
@@ -305,6 +344,7 @@ void Skeleton::enableSelfCollision(bool _enableAdjacentBodyCheck)
 {
   mSkeletonP.mEnabledSelfCollisionCheck = true;
   mSkeletonP.mEnabledAdjacentBodyCheck = _enableAdjacentBodyCheck;
+  updateAllowedCollisionMatrix();
 }
 
 //==============================================================================
@@ -312,6 +352,7 @@ void Skeleton::disableSelfCollision()
 {
   mSkeletonP.mEnabledSelfCollisionCheck = false;
   mSkeletonP.mEnabledAdjacentBodyCheck = false;
+  updateAllowedCollisionMatrix();
 }
 
 //==============================================================================
@@ -326,6 +367,52 @@ bool Skeleton::isEnabledAdjacentBodyCheck() const
   return mSkeletonP.mEnabledAdjacentBodyCheck;
 }
 
+//==============================================================================
+void Skeleton::setCollisionAllowed(const BodyNode* _bodyNode1,
+                                   const BodyNode* _bodyNode2,
+                                   bool _allowed)
+{
+  if (_bodyNode1->getSkeleton().get() != this
+      || _bodyNode2->getSkeleton().get() != this)
+  {
+    dtwarn << "[Skeleton::setCollisionAllowed] BodyNodes ["
+           << _bodyNode1->getName() << "] and [" << _bodyNode2->getName()
+           << "] do not both belong to the Skeleton named [" << getName()
+           << "]. Nothing will be changed.\n";
+    return;
+  }
+
+  const auto pair = std::minmax(_bodyNode1, _bodyNode2);
+  if (_allowed)
+    mDisabledCollisionPairs.erase(pair);
+  else
+    mDisabledCollisionPairs.insert(pair);
+
+  if (!mSkeletonP.mEnabledSelfCollisionCheck)
+    return;
+
+  // A BodyNode never collides with itself, and neither does it with its
+  // parent unless the adjacent body check is enabled
+  const bool isAdjacent = _bodyNode1->getParentBodyNode() == _bodyNode2
+                          || _bodyNode2->getParentBodyNode() == _bodyNode1;
+  mAllowedCollisionMatrix.set(
+        _bodyNode1->getIndexInSkeleton(), _bodyNode2->getIndexInSkeleton(),
+        _allowed && _bodyNode1 != _bodyNode2
+        && (!isAdjacent || mSkeletonP.mEnabledAdjacentBodyCheck));
+}
+
+//==============================================================================
+bool Skeleton::isCollisionAllowed(size_t _index1, size_t _index2) const
+{
+  return getAllowedCollisionMatrix().get(_index1, _index2);
+}
+
+//==============================================================================
+const common::BitMatrix& Skeleton::getAllowedCollisionMatrix() const
+{
+  return mAllowedCollisionMatrix;
+}
+
 //==============================================================================
 void Skeleton::setMobile(bool _isMobile)
 {
@@ -1382,6 +1469,8 @@ void Skeleton::drawMarkers(renderer::RenderInterface* _ri,
 //==============================================================================
 Skeleton::Skeleton(const Properties& _properties)
   : mSkeletonP(""),
+    mIsDynamicsProgramDirty(true),
+    mIsDynamicsProgramEnabled(true),
     mTotalMass(0.0),
     mIsImpulseApplied(false),
     mUnionSize(1)
@@ -1396,6 +1485,185 @@ void Skeleton::setPtr(const SkeletonPtr& _ptr)
   resetUnion();
 }
 
+//==============================================================================
+void Skeleton::updateAllowedCollisionMatrix()
+{
+  const size_t numBodyNodes = getNumBodyNodes();
+  const bool selfCollision = mSkeletonP.mEnabledSelfCollisionCheck;
+
+  mAllowedCollisionMatrix.resize(numBodyNodes);
+  mAllowedCollisionMatrix.setAll(selfCollision);
+
+  if (selfCollision)
+  {
+    for (size_t i = 0; i < numBodyNodes; ++i)
+    {
+      mAllowedCollisionMatrix.set(i, i, false);
+
+      const BodyNode* parent = mSkelCache.mBodyNodes[i]->getParentBodyNode();
+      if (parent && !mSkeletonP.mEnabledAdjacentBodyCheck)
+        mAllowedCollisionMatrix.set(i, parent->getIndexInSkeleton(), false);
+    }
+
+    for (const auto& pair : mDisabledCollisionPairs)
+    {
+      mAllowedCollisionMatrix.set(pair.first->getIndexInSkeleton(),
+                                  pair.second->getIndexInSkeleton(), false);
+    }
+  }
+}
+
+//==============================================================================
+void Skeleton::compileDynamicsProgram() const
+{
+  const std::vector<BodyNode*>& bodyNodes = mSkelCache.mBodyNodes;
+  mDynamicsProgram.resize(bodyNodes.size());
+
+  for (size_t i = 0; i < bodyNodes.size(); ++i)
+  {
+    const BodyNode* bodyNode = bodyNodes[i];
+    const std::type_info& jointType = typeid(*bodyNode->getParentJoint());
+    DynamicsStep& step = mDynamicsProgram[i];
+
+    if (jointType == typeid(RevoluteJoint))
+      step.mJointKernel = JointKernel::REVOLUTE;
+    else if (jointType == typeid(PrismaticJoint))
+      step.mJointKernel = JointKernel::PRISMATIC;
+    else if (jointType == typeid(BallJoint))
+      step.mJointKernel = JointKernel::BALL;
+    else if (jointType == typeid(FreeJoint))
+      step.mJointKernel = JointKernel::FREE;
+    else if (jointType == typeid(WeldJoint))
+      step.mJointKernel = JointKernel::WELD;
+    else
+      step.mJointKernel = JointKernel::GENERIC;
+
+    step.mIsGenericBodyNode = (typeid(*bodyNode) != typeid(BodyNode));
+  }
+
+  mIsDynamicsProgramDirty = false;
+}
+
+//==============================================================================
+void Skeleton::runArtInertiaStep(BodyNode* _bodyNode) const
+{
+  const DynamicsStep& step = mDynamicsProgram[_bodyNode->mIndexInSkeleton];
+  if (step.mIsGenericBodyNode)
+  {
+    _bodyNode->updateArtInertia(mSkeletonP.mTimeStep);
+    return;
+  }
+
+  // Same as BodyNode::updateArtInertia()
+  const Eigen::Matrix6d& mI = _bodyNode->mBodyP.mInertia.getSpatialTensor();
+  Eigen::Matrix6d& artInertia = _bodyNode->mArtInertia;
+  Eigen::Matrix6d& artInertiaImplicit = _bodyNode->mArtInertiaImplicit;
+  artInertia = mI;
+  artInertiaImplicit = mI;
+
+  for (BodyNode* child : _bodyNode->mChildBodyNodes)
+  {
+    const JointKernel kernel
+        = mDynamicsProgram[child->mIndexInSkeleton].mJointKernel;
+    Joint* childJoint = child->mParentJoint;
+
+    DISPATCH_JOINT(kernel, childJoint, addChildArtInertiaTo,
+                   artInertia, child->mArtInertia);
+    DISPATCH_JOINT(kernel, childJoint, addChildArtInertiaImplicitTo,
+                   artInertiaImplicit, child->mArtInertiaImplicit);
+  }
+
+  assert(!math::isNan(artInertiaImplicit));
+
+  Joint* joint = _bodyNode->mParentJoint;
+  DISPATCH_JOINT(step.mJointKernel, joint, updateInvProjArtInertia,
+                 artInertia);
+  DISPATCH_JOINT(step.mJointKernel, joint, updateInvProjArtInertiaImplicit,
+                 artInertiaImplicit, mSkeletonP.mTimeStep);
+}
+
+//==============================================================================
+void Skeleton::runBiasForceStep(BodyNode* _bodyNode)
+{
+  const DynamicsStep& step = mDynamicsProgram[_bodyNode->mIndexInSkeleton];
+  if (step.mIsGenericBodyNode)
+  {
+    _bodyNode->updateBiasForce(mSkeletonP.mGravity, mSkeletonP.mTimeStep);
+    return;
+  }
+
+  // Same as BodyNode::updateBiasForce()
+  const Eigen::Matrix6d& mI = _bodyNode->mBodyP.mInertia.getSpatialTensor();
+  if (_bodyNode->mBodyP.mGravityMode == true)
+  {
+    _bodyNode->mFgravity.noalias() = mI * math::AdInvRLinear(
+          _bodyNode->getWorldTransform(), mSkeletonP.mGravity);
+  }
+  else
+  {
+    _bodyNode->mFgravity.setZero();
+  }
+
+  const Eigen::Vector6d& V = _bodyNode->getSpatialVelocity();
+  Eigen::Vector6d& biasForce = _bodyNode->mBiasForce;
+  biasForce = -math::dad(V, mI * V) - _bodyNode->mFext - _bodyNode->mFgravity;
+
+  for (BodyNode* child : _bodyNode->mChildBodyNodes)
+  {
+    const JointKernel kernel
+        = mDynamicsProgram[child->mIndexInSkeleton].mJointKernel;
+
+    DISPATCH_JOINT(kernel, child->mParentJoint, addChildBiasForceTo,
+                   biasForce, child->mArtInertiaImplicit, child->mBiasForce,
+                   child->getPartialAcceleration());
+  }
+
+  assert(!math::isNan(biasForce));
+
+  DISPATCH_JOINT(step.mJointKernel, _bodyNode->mParentJoint, updateTotalForce,
+                 _bodyNode->mArtInertiaImplicit
+                 * _bodyNode->getPartialAcceleration() + biasForce,
+                 mSkeletonP.mTimeStep);
+}
+
+//==============================================================================
+void Skeleton::runForwardDynamicsStep(BodyNode* _bodyNode)
+{
+  const DynamicsStep& step = mDynamicsProgram[_bodyNode->mIndexInSkeleton];
+  if (step.mIsGenericBodyNode)
+  {
+    _bodyNode->updateAccelerationFD();
+    _bodyNode->updateTransmittedForceFD();
+    _bodyNode->updateJointForceFD(mSkeletonP.mTimeStep, true, true);
+    return;
+  }
+
+  // Same as BodyNode::updateAccelerationFD()
+  Joint* joint = _bodyNode->mParentJoint;
+  if (_bodyNode->mParentBodyNode)
+  {
+    DISPATCH_JOINT(step.mJointKernel, joint, updateAcceleration,
+                   _bodyNode->mArtInertiaImplicit,
+                   _bodyNode->mParentBodyNode->getSpatialAcceleration());
+  }
+  else
+  {
+    DISPATCH_JOINT(step.mJointKernel, joint, updateAcceleration,
+                   _bodyNode->mArtInertiaImplicit, Eigen::Vector6d::Zero());
+  }
+
+  // Same as BodyNode::updateTransmittedForceFD()
+  _bodyNode->mF = _bodyNode->mBiasForce;
+  _bodyNode->mF.noalias()
+      += _bodyNode->mArtInertiaImplicit * _bodyNode->getSpatialAcceleration();
+
+  assert(!math::isNan(_bodyNode->mF));
+
+  // Same as BodyNode::updateJointForceFD()
+  DISPATCH_JOINT(step.mJointKernel, joint, updateForceFD,
+                 _bodyNode->mF, mSkeletonP.mTimeStep, true, true);
+}
+
 //==============================================================================
 void Skeleton::registerBodyNode(BodyNode* _newBodyNode)
 {
@@ -1433,6 +1701,17 @@ void Skeleton::registerBodyNode(BodyNode* _newBodyNode)
 
   _newBodyNode->mSkeleton = getPtr();
   _newBodyNode->mIndexInSkeleton = mSkelCache.mBodyNodes.size()-1;
+
+  // A new BodyNode has no disabled pairs yet, so only its parent may be
+  // excluded from its row
+  const size_t index = _newBodyNode->mIndexInSkeleton;
+  mAllowedCollisionMatrix.resize(mSkelCache.mBodyNodes.size(),
+                                 mSkeletonP.mEnabledSelfCollisionCheck);
+  mAllowedCollisionMatrix.set(index, index, false);
+  const BodyNode* parent = _newBodyNode->getParentBodyNode();
+  if (parent && !mSkeletonP.mEnabledAdjacentBodyCheck)
+    mAllowedCollisionMatrix.set(index, parent->getIndexInSkeleton(), false);
+
   addEntryToBodyNodeNameMgr(_newBodyNode);
   registerJoint(_newBodyNode->getParentJoint());
 
@@ -1511,6 +1790,8 @@ void Skeleton::registerJoint(Joint* _newJoint)
   addEntryToJointNameMgr(_newJoint);
   _newJoint->registerDofs();
 
+  mIsDynamicsProgramDirty = true;
+
   size_t tree = _newJoint->getChildBodyNode()->getTreeIndex();
   std::vector<DegreeOfFreedom*>& treeDofs = mTreeCache[tree].mDofs;
   for(size_t i = 0; i < _newJoint->getNumDofs(); ++i)
@@ -1569,6 +1850,17 @@ void Skeleton::unregisterBodyNode(BodyNode* _oldBodyNode)
     BodyNode* bn = mSkelCache.mBodyNodes[i];
     bn->mIndexInSkeleton = i;
   }
+  // Forget the disabled pairs of the BodyNode, which may be deleted next.
+  // moveBodyNodeTree() carries them over to wherever the BodyNode goes.
+  for(auto it = mDisabledCollisionPairs.begin();
+      it != mDisabledCollisionPairs.end(); )
+  {
+    if(it->first == _oldBodyNode || it->second == _oldBodyNode)
+      it = mDisabledCollisionPairs.erase(it);
+    else
+      ++it;
+  }
+  mAllowedCollisionMatrix.remove(index);
 
   if(nullptr == _oldBodyNode->getParentBodyNode())
   {
@@ -1636,6 +1928,8 @@ void Skeleton::unregisterJoint(Joint* _oldJoint)
 
   mNameMgrForJoints.removeName(_oldJoint->getName());
 
+  mIsDynamicsProgramDirty = true;
+
   size_t tree = _oldJoint->getChildBodyNode()->getTreeIndex();
   std::vector<DegreeOfFreedom*>& treeDofs = mTreeCache[tree].mDofs;
   std::vector<DegreeOfFreedom*>& skelDofs = mSkelCache.mDofs;
@@ -1765,6 +2059,22 @@ bool Skeleton::moveBodyNodeTree(Joint* _parentJoint, BodyNode* _bodyNode,
     return false;
   }
 
+  // The disabled collision pairs of the moved BodyNodes stay disabled as long
+  // as both BodyNodes of a pair end up in the same Skeleton
+  const std::vector<const BodyNode*> movedBodyNodes
+      = constructBodyNodeTree(static_cast<const BodyNode*>(_bodyNode));
+  const std::set<const BodyNode*> movedSet(movedBodyNodes.begin(),
+                                           movedBodyNodes.end());
+  std::vector<std::pair<const BodyNode*, const BodyNode*>> disabledPairs;
+  for(const auto& pair : mDisabledCollisionPairs)
+  {
+    const bool isFirstMoved = movedSet.count(pair.first) > 0;
+    const bool isSecondMoved = movedSet.count(pair.second) > 0;
+    if((isFirstMoved && isSecondMoved)
+       || ((isFirstMoved || isSecondMoved) && _newSkeleton.get() == this))
+      disabledPairs.push_back(pair);
+  }
+
   std::vector<BodyNode*> tree = extractBodyNodeTree(_bodyNode);
 
   Joint* originalParent = _bodyNode->getParentJoint();
@@ -1790,6 +2100,9 @@ bool Skeleton::moveBodyNodeTree(Joint* _parentJoint, BodyNode* _bodyNode,
   }
   _newSkeleton->receiveBodyNodeTree(tree);
 
+  for(const auto& pair : disabledPairs)
+    _newSkeleton->setCollisionAllowed(pair.first, pair.second, false);
+
   return true;
 }
 
@@ -1911,6 +2224,9 @@ void Skeleton::updateCacheDimensions(Skeleton::DataCache& _cache)
   _cache.mCg       = Eigen::VectorXd::Zero(dof);
   _cache.mFext     = Eigen::VectorXd::Zero(dof);
   _cache.mFc       = Eigen::VectorXd::Zero(dof);
+  _cache.mCentroidalMomentumMatrix = math::Jacobian::Zero(6, dof);
+  _cache.mCOMJacobian              = math::Jacobian::Zero(6, dof);
+  _cache.mWorldJointJacobian       = math::Jacobian::Zero(6, dof);
 }
 
 //==============================================================================
@@ -1919,6 +2235,7 @@ void Skeleton::updateCacheDimensions(size_t _treeIdx)
   updateCacheDimensions(mTreeCache[_treeIdx]);
   updateCacheDimensions(mSkelCache);
 
+  SET_FLAG(_treeIdx, mWorldJointJacobian);
   notifyArticulatedInertiaUpdate(_treeIdx);
 }
 
@@ -1926,10 +2243,24 @@ void Skeleton::updateCacheDimensions(size_t _treeIdx)
 void Skeleton::updateArticulatedInertia(size_t _tree) const
 {
   DataCache& cache = mTreeCache[_tree];
-  for (std::vector<BodyNode*>::const_reverse_iterator it = cache.mBodyNodes.rbegin();
-       it != cache.mBodyNodes.rend(); ++it)
+  if (mIsDynamicsProgramEnabled)
   {
-    (*it)->updateArtInertia(mSkeletonP.mTimeStep);
+    if (mIsDynamicsProgramDirty)
+      compileDynamicsProgram();
+
+    for (auto it = cache.mBodyNodes.rbegin(); it != cache.mBodyNodes.rend();
+         ++it)
+    {
+      runArtInertiaStep(*it);
+    }
+  }
+  else
+  {
+    for (std::vector<BodyNode*>::const_reverse_iterator it
+         = cache.mBodyNodes.rbegin(); it != cache.mBodyNodes.rend(); ++it)
+    {
+      (*it)->updateArtInertia(mSkeletonP.mTimeStep);
+    }
   }
 
   cache.mDirty.mArticulatedInertia = false;
@@ -2578,6 +2909,188 @@ void Skeleton::updateExternalForces() const
   mSkelCache.mDirty.mExternalForces = false;
 }
 
+//==============================================================================
+void Skeleton::updateCentroidalMomentumMatrix() const
+{
+  // The columns of the centroidal momentum matrix that belong to a Joint are
+  // the momenta, about the COM of the Skeleton, of the rigid subtree below that
+  // Joint moving along the Joint's motion subspace. The mass, first moment and
+  // rotational inertia of every subtree are accumulated from the leaves to the
+  // roots, so each column costs O(1) regardless of the depth of the tree.
+  DataCache& cache = mSkelCache;
+  const size_t numBodies = cache.mBodyNodes.size();
+  const size_t dof = cache.mDofs.size();
+
+  cache.mSubtreeMasses.resize(numBodies);
+  cache.mSubtreeMoments.resize(3, numBodies);
+  cache.mSubtreeInertias.resize(numBodies);
+  cache.mCentroidalMomentumMatrix.setZero(6, dof);
+  cache.mCOMJacobian.setZero(6, dof);
+
+  // mSubtreeMoments temporarily holds the COM of each BodyNode
+  Eigen::Vector3d com = Eigen::Vector3d::Zero();
+  for (size_t i = 0; i < numBodies; ++i)
+  {
+    const BodyNode* bn = cache.mBodyNodes[i];
+    cache.mSubtreeMoments.col(i) = bn->getWorldTransform() * bn->getLocalCOM();
+    com += bn->getMass() * cache.mSubtreeMoments.col(i);
+  }
+
+  if (mTotalMass > 0.0)
+    com /= mTotalMass;
+
+  for (size_t i = 0; i < numBodies; ++i)
+  {
+    const BodyNode* bn = cache.mBodyNodes[i];
+    const double mass = bn->getMass();
+    const Eigen::Matrix3d& R = bn->getWorldTransform().linear();
+    const Eigen::Vector3d r = cache.mSubtreeMoments.col(i) - com;
+    const Eigen::Matrix3d rx = math::makeSkewSymmetric(r);
+
+    cache.mSubtreeMasses[i] = mass;
+    cache.mSubtreeMoments.col(i) = mass * r;
+    cache.mSubtreeInertias[i] = R * bn->getInertia().getMoment() * R.transpose()
+                                - mass * rx * rx;
+  }
+
+  for (const DataCache& tree : mTreeCache)
+  {
+    for (std::vector<BodyNode*>::const_reverse_iterator it =
+         tree.mBodyNodes.rbegin(); it != tree.mBodyNodes.rend(); ++it)
+    {
+      const BodyNode* bn = *it;
+      const size_t index = bn->getIndexInSkeleton();
+      const double mass = cache.mSubtreeMasses[index];
+      const Eigen::Vector3d h = cache.mSubtreeMoments.col(index);
+      const Eigen::Matrix3d& I = cache.mSubtreeInertias[index];
+
+      const Joint* joint = bn->getParentJoint();
+      const size_t numJointDofs = joint->getNumDofs();
+      if (numJointDofs > 0)
+      {
+        const Eigen::Isometry3d& T = bn->getWorldTransform();
+        const Eigen::Vector3d offset = com - T.translation();
+        const math::Jacobian S = joint->getLocalJacobian();
+
+        for (size_t k = 0; k < numJointDofs; ++k)
+        {
+          // Angular velocity and the linear velocity of the point coinciding
+          // with the COM that this DOF induces in the subtree
+          const Eigen::Vector3d w = T.linear() * S.col(k).head<3>();
+          const Eigen::Vector3d v = T.linear() * S.col(k).tail<3>()
+                                    + w.cross(offset);
+          const Eigen::Vector3d l = mass * v + w.cross(h);
+
+          const size_t col = joint->getIndexInSkeleton(k);
+          cache.mCentroidalMomentumMatrix.col(col).head<3>() = I * w
+                                                               + h.cross(v);
+          cache.mCentroidalMomentumMatrix.col(col).tail<3>() = l;
+
+          if (mTotalMass > 0.0)
+          {
+            cache.mCOMJacobian.col(col).head<3>() = (mass / mTotalMass) * w;
+            cache.mCOMJacobian.col(col).tail<3>() = l / mTotalMass;
+          }
+        }
+      }
+
+      const BodyNode* parent = bn->getParentBodyNode();
+      if (parent)
+      {
+        const size_t parentIndex = parent->getIndexInSkeleton();
+        cache.mSubtreeMasses[parentIndex] += mass;
+        cache.mSubtreeMoments.col(parentIndex) += h;
+        cache.mSubtreeInertias[parentIndex] += I;
+      }
+    }
+  }
+
+  cache.mDirty.mCentroidalMomentumMatrix = false;
+}
+
+//==============================================================================
+const math::Jacobian& Skeleton::getWorldJointJacobian() const
+{
+  if (mSkelCache.mDirty.mWorldJointJacobian)
+    updateWorldJointJacobian();
+
+  return mSkelCache.mWorldJointJacobian;
+}
+
+//==============================================================================
+void Skeleton::updateWorldJointJacobian() const
+{
+  DataCache& cache = mSkelCache;
+  cache.mWorldJointJacobian.resize(6, cache.mDofs.size());
+
+  for (const BodyNode* bn : cache.mBodyNodes)
+  {
+    const Joint* joint = bn->getParentJoint();
+    const size_t numJointDofs = joint->getNumDofs();
+    if (0 == numJointDofs)
+      continue;
+
+    const Eigen::Isometry3d& T = bn->getWorldTransform();
+    const math::Jacobian S = joint->getLocalJacobian();
+
+    for (size_t k = 0; k < numJointDofs; ++k)
+    {
+      // Move the motion of the child BodyNode's origin to the World origin
+      const Eigen::Vector3d w = T.linear() * S.col(k).head<3>();
+      const size_t col = joint->getIndexInSkeleton(k);
+      cache.mWorldJointJacobian.col(col).head<3>() = w;
+      cache.mWorldJointJacobian.col(col).tail<3>()
+          = T.linear() * S.col(k).tail<3>() + T.translation().cross(w);
+    }
+  }
+
+  cache.mDirty.mWorldJointJacobian = false;
+}
+
+//==============================================================================
+void Skeleton::updateCentroidalMomentumBias() const
+{
+  // With zero generalized accelerations, the rate of change of the centroidal
+  // momentum is the sum of the inertial wrenches of the BodyNodes moved to the
+  // COM. Since the COM moves along the total linear momentum, moving the
+  // reference point does not contribute to the rate.
+  DataCache& cache = mSkelCache;
+  cache.mBiasAccelerations.resize(6, cache.mBodyNodes.size());
+  cache.mCentroidalMomentumBias.setZero();
+
+  const Eigen::Vector3d com = getCOM();
+
+  for (const DataCache& tree : mTreeCache)
+  {
+    for (const BodyNode* bn : tree.mBodyNodes)
+    {
+      const size_t index = bn->getIndexInSkeleton();
+
+      Eigen::Vector6d dV = bn->getPartialAcceleration();
+      const BodyNode* parent = bn->getParentBodyNode();
+      if (parent)
+      {
+        dV += math::AdInvT(bn->getParentJoint()->getLocalTransform(),
+                           cache.mBiasAccelerations.col(
+                             parent->getIndexInSkeleton()));
+      }
+      cache.mBiasAccelerations.col(index) = dV;
+
+      const Eigen::Matrix6d& G = bn->getSpatialInertia();
+      const Eigen::Vector6d& V = bn->getSpatialVelocity();
+      const Eigen::Vector6d F = G * dV - math::dad(V, G * V);
+
+      const Eigen::Isometry3d& T = bn->getWorldTransform();
+      const Eigen::Vector3d f = T.linear() * F.tail<3>();
+      cache.mCentroidalMomentumBias.head<3>()
+          += T.linear() * F.head<3>() + (T.translation() - com).cross(f);
+      cache.mCentroidalMomentumBias.tail<3>() += f;
+    }
+  }
+
+  cache.mDirty.mCentroidalMomentumBias = false;
+}
+
 //==============================================================================
 const Eigen::VectorXd& Skeleton::computeConstraintForces(DataCache& cache) const
 {
@@ -2801,6 +3314,26 @@ void Skeleton::computeForwardKinematics(bool _updateTransforms,
 //==============================================================================
 void Skeleton::computeForwardDynamics()
 {
+  if (mIsDynamicsProgramEnabled)
+  {
+    if (mIsDynamicsProgramDirty)
+      compileDynamicsProgram();
+
+    // The program reads the articulated inertias directly, so they need to be
+    // brought up to date beforehand
+    updateArticulatedInertia();
+
+    for (auto it = mSkelCache.mBodyNodes.rbegin();
+         it != mSkelCache.mBodyNodes.rend(); ++it)
+      runBiasForceStep(*it);
+
+    // Forward recursion
+    for (auto& bodyNode : mSkelCache.mBodyNodes)
+      runForwardDynamicsStep(bodyNode);
+
+    return;
+  }
+
   // Note: Articulated Inertias will be updated automatically when
   // getArtInertiaImplicit() is called in BodyNode::updateBiasForce()
 
@@ -2817,6 +3350,18 @@ void Skeleton::computeForwardDynamics()
   }
 }
 
+//==============================================================================
+void Skeleton::setDynamicsProgramEnabled(bool _enabled)
+{
+  mIsDynamicsProgramEnabled = _enabled;
+}
+
+//==============================================================================
+bool Skeleton::isDynamicsProgramEnabled() const
+{
+  return mIsDynamicsProgramEnabled;
+}
+
 //==============================================================================
 void Skeleton::computeInverseDynamics(bool _withExternalForces,
                                       bool _withDampingForces,
@@ -2837,6 +3382,333 @@ void Skeleton::computeInverseDynamics(bool _withExternalForces,
   }
 }
 
+//==============================================================================
+Eigen::MatrixXd Skeleton::computeInverseDynamics(
+    const Eigen::MatrixXd& _positions,
+    const Eigen::MatrixXd& _velocities,
+    const Eigen::MatrixXd& _accelerations,
+    bool _withExternalForces,
+    bool _withDampingForces,
+    bool _withSpringForces,
+    size_t _numThreads) const
+{
+  const size_t numDofs = getNumDofs();
+  const size_t numSamples = static_cast<size_t>(_positions.cols());
+  Eigen::MatrixXd forces = Eigen::MatrixXd::Zero(numDofs, numSamples);
+
+  if(static_cast<size_t>(_positions.rows()) != numDofs
+     || _velocities.rows() != _positions.rows()
+     || _velocities.cols() != _positions.cols()
+     || _accelerations.rows() != _positions.rows()
+     || _accelerations.cols() != _positions.cols())
+  {
+    dterr << "[Skeleton::computeInverseDynamics] The positions ["
+          << _positions.rows() << "x" << _positions.cols() << "], velocities ["
+          << _velocities.rows() << "x" << _velocities.cols()
+          << "] and accelerations [" << _accelerations.rows() << "x"
+          << _accelerations.cols() << "] of Skeleton [" << getName()
+          << "] must all have one row per DOF [" << numDofs << "] and the "
+          << "same number of columns.\n";
+    assert(false);
+    return forces;
+  }
+
+  if(0 == numDofs || 0 == numSamples)
+    return forces;
+
+  _numThreads = common::getNumParallelThreads(_numThreads, numSamples);
+
+  // Set up one clone per worker up front on the calling thread, so that the
+  // workers only touch their own copies
+  std::vector<SkeletonPtr> skelClones;
+  skelClones.reserve(_numThreads);
+  for(size_t i=0; i < _numThreads; ++i)
+  {
+    SkeletonPtr skelClone = clone();
+
+    if(_withExternalForces)
+    {
+      for(size_t j=0; j < getNumBodyNodes(); ++j)
+      {
+        const Eigen::Vector6d& Fext = getBodyNode(j)->getExternalForceLocal();
+        BodyNode* bodyNodeClone = skelClone->getBodyNode(j);
+        bodyNodeClone->setExtForce(Fext.tail<3>(), Eigen::Vector3d::Zero(),
+                                   true, true);
+        bodyNodeClone->setExtTorque(Fext.head<3>(), true);
+      }
+    }
+
+    skelClones.push_back(skelClone);
+  }
+
+  auto computeChunk = [&](size_t _worker, size_t _begin, size_t _end)
+  {
+    Skeleton* skel = skelClones[_worker].get();
+
+    // Reused for every sample of the chunk to avoid allocations
+    Eigen::VectorXd q(numDofs);
+    Eigen::VectorXd dq(numDofs);
+    Eigen::VectorXd ddq(numDofs);
+
+    for(size_t i=_begin; i < _end; ++i)
+    {
+      q = _positions.col(i);
+      dq = _velocities.col(i);
+      ddq = _accelerations.col(i);
+
+      skel->setPositions(q);
+      skel->setVelocities(dq);
+      skel->setAccelerations(ddq);
+      skel->computeInverseDynamics(_withExternalForces, _withDampingForces,
+                                   _withSpringForces);
+
+      for(size_t j=0; j < numDofs; ++j)
+        forces(j, i) = skel->mSkelCache.mDofs[j]->getForce();
+    }
+  };
+
+  common::parallelFor(numSamples, _numThreads, computeChunk);
+
+  return forces;
+}
+
+//==============================================================================
+bool Skeleton::hasAnalyticDynamicsDerivatives() const
+{
+  if (getNumSoftBodyNodes() > 0)
+    return false;
+
+  for (const auto& bodyNode : mSkelCache.mBodyNodes)
+  {
+    const Joint* joint = bodyNode->getParentJoint();
+
+    if (dynamic_cast<const WeldJoint*>(joint))
+      continue;
+
+    if (!dynamic_cast<const RevoluteJoint*>(joint)
+        && !dynamic_cast<const PrismaticJoint*>(joint)
+        && !dynamic_cast<const ScrewJoint*>(joint))
+      return false;
+
+    if (joint->getActuatorType() != Joint::FORCE
+        && joint->getActuatorType() != Joint::PASSIVE)
+      return false;
+
+    if (joint->getCoulombFriction(0) != 0.0)
+      return false;
+  }
+
+  return true;
+}
+
+//==============================================================================
+bool Skeleton::computeForwardDynamicsDerivatives(Eigen::MatrixXd& _dAccdPos,
+                                                 Eigen::MatrixXd& _dAccdVel,
+                                                 Eigen::MatrixXd& _dAccdForce)
+{
+  if (!hasAnalyticDynamicsDerivatives())
+    return false;
+
+  const size_t numDofs = getNumDofs();
+  const size_t numBodyNodes = getNumBodyNodes();
+  const double timeStep = mSkeletonP.mTimeStep;
+
+  computeForwardDynamics();
+
+  // Every supported Joint has at most one degree of freedom and a constant
+  // local Jacobian J expressed in the child BodyNode, and the derivative of
+  // its local transform T is T * [J]. Perturbing the coordinate of the Joint
+  // therefore changes AdInvT(T, X) by ad(AdInvT(T, X), J) and dAdInvT(T, F)
+  // by -dAdInvT(T, dad(J, F)).
+  std::vector<int> parents(numBodyNodes);
+  std::vector<int> dofIndices(numBodyNodes);
+  Eigen::aligned_vector<Eigen::Isometry3d> T(numBodyNodes);
+  Eigen::aligned_vector<Eigen::Vector6d> J(numBodyNodes);
+
+  // Nominal velocities, accelerations, gravitational accelerations and body
+  // forces of the inverse dynamics at the current state
+  Eigen::aligned_vector<Eigen::Vector6d> V(numBodyNodes);
+  Eigen::aligned_vector<Eigen::Vector6d> A(numBodyNodes);
+  Eigen::aligned_vector<Eigen::Vector6d> G(numBodyNodes);
+  Eigen::aligned_vector<Eigen::Vector6d> F(numBodyNodes);
+
+  Eigen::Vector6d gravity = Eigen::Vector6d::Zero();
+  gravity.tail<3>() = mSkeletonP.mGravity;
+
+  for (size_t i = 0; i < numBodyNodes; ++i)
+  {
+    const BodyNode* bodyNode = mSkelCache.mBodyNodes[i];
+    const Joint* joint = bodyNode->getParentJoint();
+    const BodyNode* parent = bodyNode->getParentBodyNode();
+
+    parents[i] = parent ? static_cast<int>(parent->getIndexInSkeleton()) : -1;
+    assert(parents[i] < static_cast<int>(i));
+    T[i] = joint->getLocalTransform();
+
+    const Eigen::Vector6d& parentV
+        = parent ? V[parents[i]] : Eigen::Vector6d::Zero().eval();
+    const Eigen::Vector6d& parentA
+        = parent ? A[parents[i]] : Eigen::Vector6d::Zero().eval();
+    const Eigen::Vector6d& parentG = parent ? G[parents[i]] : gravity;
+
+    V[i] = math::AdInvT(T[i], parentV);
+    A[i] = math::AdInvT(T[i], parentA);
+    G[i] = math::AdInvT(T[i], parentG);
+
+    if (joint->getNumDofs() == 0)
+    {
+      dofIndices[i] = -1;
+      J[i].setZero();
+      continue;
+    }
+
+    dofIndices[i] = static_cast<int>(joint->getIndexInSkeleton(0));
+    J[i] = joint->getLocalJacobian().col(0);
+
+    const double velocity = joint->getVelocity(0);
+    V[i].noalias() += J[i] * velocity;
+    A[i].noalias() += J[i] * joint->getAcceleration(0);
+    A[i] += math::ad(V[i], J[i] * velocity);
+  }
+
+  for (size_t i = 0; i < numBodyNodes; ++i)
+  {
+    const BodyNode* bodyNode = mSkelCache.mBodyNodes[i];
+    const Eigen::Matrix6d& I = bodyNode->getSpatialInertia();
+
+    F[i].noalias() = I * A[i];
+    if (bodyNode->getGravityMode())
+      F[i].noalias() -= I * G[i];
+    F[i] -= math::dad(V[i], I * V[i]);
+    F[i] -= bodyNode->getExternalForceLocal();
+  }
+
+  for (size_t i = numBodyNodes; i-- > 0;)
+  {
+    if (parents[i] >= 0)
+      F[parents[i]] += math::dAdInvT(T[i], F[i]);
+  }
+
+  // Derivatives of the inverse dynamics with respect to the positions
+  // (columns [0, n)) and velocities (columns [n, 2n))
+  Eigen::MatrixXd dTau = Eigen::MatrixXd::Zero(numDofs, 2*numDofs);
+
+  Eigen::aligned_vector<Eigen::Vector6d> dV(numBodyNodes);
+  Eigen::aligned_vector<Eigen::Vector6d> dA(numBodyNodes);
+  Eigen::aligned_vector<Eigen::Vector6d> dG(numBodyNodes);
+  Eigen::aligned_vector<Eigen::Vector6d> dF(numBodyNodes);
+  std::vector<bool> isAffected(numBodyNodes);
+
+  for (size_t k = 0; k < 2*numDofs; ++k)
+  {
+    const bool isPosition = k < numDofs;
+    const size_t perturbed = mSkelCache.mDofs[isPosition ? k : k - numDofs]
+                                 ->getChildBodyNode()->getIndexInSkeleton();
+
+    // Forward recursion; only the subtree of the perturbed Joint is affected
+    for (size_t i = 0; i < numBodyNodes; ++i)
+    {
+      const int parent = parents[i];
+      isAffected[i] = (i == perturbed) || (parent >= 0 && isAffected[parent]);
+      dF[i].setZero();
+
+      if (!isAffected[i])
+        continue;
+
+      if (parent >= 0 && isAffected[parent])
+      {
+        dV[i] = math::AdInvT(T[i], dV[parent]);
+        dA[i] = math::AdInvT(T[i], dA[parent]);
+        dG[i] = math::AdInvT(T[i], dG[parent]);
+      }
+      else
+      {
+        dV[i].setZero();
+        dA[i].setZero();
+        dG[i].setZero();
+      }
+
+      if (i == perturbed)
+      {
+        if (isPosition)
+        {
+          // ad(J, J) vanishes, so the joint velocity can be left in V
+          dV[i] += math::ad(V[i], J[i]);
+          if (parent >= 0)
+          {
+            dA[i] += math::ad(math::AdInvT(T[i], A[parent]), J[i]);
+            dG[i] += math::ad(math::AdInvT(T[i], G[parent]), J[i]);
+          }
+          else
+          {
+            dG[i] += math::ad(math::AdInvT(T[i], gravity), J[i]);
+          }
+        }
+        else
+        {
+          dV[i] += J[i];
+          dA[i] += math::ad(V[i], J[i]);
+        }
+      }
+
+      if (dofIndices[i] >= 0)
+      {
+        dA[i] += math::ad(dV[i], J[i] * mSkelCache.mDofs[dofIndices[i]]
+                                            ->getVelocity());
+      }
+    }
+
+    // Backward recursion
+    for (size_t i = numBodyNodes; i-- > 0;)
+    {
+      if (isAffected[i])
+      {
+        const BodyNode* bodyNode = mSkelCache.mBodyNodes[i];
+        const Eigen::Matrix6d& I = bodyNode->getSpatialInertia();
+
+        dF[i].noalias() += I * dA[i];
+        if (bodyNode->getGravityMode())
+          dF[i].noalias() -= I * dG[i];
+        dF[i] -= math::dad(dV[i], I * V[i]);
+        dF[i] -= math::dad(V[i], I * dV[i]);
+      }
+
+      if (dofIndices[i] >= 0)
+        dTau(dofIndices[i], k) = J[i].dot(dF[i]);
+
+      const int parent = parents[i];
+      if (parent < 0)
+        continue;
+
+      dF[parent] += math::dAdInvT(T[i], dF[i]);
+      if (isPosition && i == perturbed)
+        dF[parent] -= math::dAdInvT(T[i], math::dad(J[i], F[i]));
+    }
+  }
+
+  // The forward dynamics solve
+  //   (M + h*D + h^2*K) ddq = tau - C(q, dq) - D*dq - K*(q + h*dq - q0),
+  // so the derivatives follow from those of the inverse dynamics through the
+  // inverse of the augmented mass matrix
+  for (size_t i = 0; i < numDofs; ++i)
+  {
+    const DegreeOfFreedom* dof = mSkelCache.mDofs[i];
+    const double stiffness = dof->getSpringStiffness();
+    const double damping = dof->getDampingCoefficient();
+
+    dTau(i, i) += stiffness;
+    dTau(i, numDofs + i) += damping + timeStep*stiffness;
+  }
+
+  const Eigen::MatrixXd& invAugMassMatrix = getInvAugMassMatrix();
+
+  _dAccdPos.noalias() = -invAugMassMatrix * dTau.leftCols(numDofs);
+  _dAccdVel.noalias() = -invAugMassMatrix * dTau.rightCols(numDofs);
+  _dAccdForce = invAugMassMatrix;
+
+  return true;
+}
+
 //==============================================================================
 void Skeleton::clearExternalForces()
 {
@@ -2862,6 +3734,9 @@ void Skeleton::notifyArticulatedInertiaUpdate(size_t _treeIdx)
   SET_FLAG(_treeIdx, mCoriolisForces);
   SET_FLAG(_treeIdx, mGravityForces);
   SET_FLAG(_treeIdx, mCoriolisAndGravityForces);
+  SET_FLAG(_treeIdx, mCentroidalMomentumMatrix);
+  SET_FLAG(_treeIdx, mCentroidalMomentumBias);
+  SET_FLAG(_treeIdx, mOperationalSpace);
 }
 
 //==============================================================================
@@ -2870,6 +3745,12 @@ void Skeleton::notifySupportUpdate(size_t _treeIdx)
   SET_FLAG(_treeIdx, mSupport);
 }
 
+//==============================================================================
+void Skeleton::notifyOperationalSpaceUpdate(size_t _treeIdx)
+{
+  SET_FLAG(_treeIdx, mOperationalSpace);
+}
+
 //==============================================================================
 void Skeleton::clearConstraintImpulses()
 {
@@ -3180,8 +4061,8 @@ Eigen::Vector3d Skeleton::getCOMLinearAcceleration(const Frame* _relativeTo,
 }
 
 //==============================================================================
-// Templated function for computing different kinds of COM Jacobians and their
-// derivatives
+// Templated function for computing the time derivatives of the COM Jacobians
+// by summing the Jacobians of the individual BodyNodes
 template <
     typename JacType, // JacType is the type of Jacobian we're computing
     JacType (TemplatedJacobianNode<BodyNode>::*getJacFn)(
@@ -3220,18 +4101,30 @@ JacType getCOMJacobianTemplate(const Skeleton* _skel,
 //==============================================================================
 math::Jacobian Skeleton::getCOMJacobian(const Frame* _inCoordinatesOf) const
 {
-  return getCOMJacobianTemplate<math::Jacobian,
-          &TemplatedJacobianNode<BodyNode>::getJacobian>(
-        this, _inCoordinatesOf);
+  if (mSkelCache.mDirty.mCentroidalMomentumMatrix)
+    updateCentroidalMomentumMatrix();
+
+  assert(mTotalMass != 0.0);
+  if (_inCoordinatesOf->isWorld())
+    return mSkelCache.mCOMJacobian;
+
+  return math::AdRInvJac(_inCoordinatesOf->getWorldTransform(),
+                         mSkelCache.mCOMJacobian);
 }
 
 //==============================================================================
 math::LinearJacobian Skeleton::getCOMLinearJacobian(
     const Frame* _inCoordinatesOf) const
 {
-  return getCOMJacobianTemplate<math::LinearJacobian,
-           &TemplatedJacobianNode<BodyNode>::getLinearJacobian>(
-              this, _inCoordinatesOf);
+  if (mSkelCache.mDirty.mCentroidalMomentumMatrix)
+    updateCentroidalMomentumMatrix();
+
+  assert(mTotalMass != 0.0);
+  if (_inCoordinatesOf->isWorld())
+    return mSkelCache.mCOMJacobian.bottomRows<3>();
+
+  return _inCoordinatesOf->getWorldTransform().linear().transpose()
+         * mSkelCache.mCOMJacobian.bottomRows<3>();
 }
 
 //==============================================================================
@@ -3252,6 +4145,391 @@ math::LinearJacobian Skeleton::getCOMLinearJacobianDeriv(
               this, _inCoordinatesOf);
 }
 
+//==============================================================================
+math::Jacobian Skeleton::getCentroidalMomentumMatrix(
+    const Frame* _inCoordinatesOf) const
+{
+  if (mSkelCache.mDirty.mCentroidalMomentumMatrix)
+    updateCentroidalMomentumMatrix();
+
+  if (_inCoordinatesOf->isWorld())
+    return mSkelCache.mCentroidalMomentumMatrix;
+
+  return math::AdRInvJac(_inCoordinatesOf->getWorldTransform(),
+                         mSkelCache.mCentroidalMomentumMatrix);
+}
+
+//==============================================================================
+Eigen::Vector6d Skeleton::getCentroidalMomentumBias(
+    const Frame* _inCoordinatesOf) const
+{
+  if (mSkelCache.mDirty.mCentroidalMomentumBias)
+    updateCentroidalMomentumBias();
+
+  if (_inCoordinatesOf->isWorld())
+    return mSkelCache.mCentroidalMomentumBias;
+
+  const Eigen::Matrix3d R
+      = _inCoordinatesOf->getWorldTransform().linear().transpose();
+  Eigen::Vector6d bias;
+  bias << R * mSkelCache.mCentroidalMomentumBias.head<3>(),
+          R * mSkelCache.mCentroidalMomentumBias.tail<3>();
+
+  return bias;
+}
+
+//==============================================================================
+// Templated function for stacking the World Jacobians, or only their bottom
+// rows, of several JacobianNodes
+template <int Rows>
+void stackWorldJacobians(const Skeleton* _skel,
+                         const math::Jacobian& _jointJacobian,
+                         const std::vector<const JacobianNode*>& _nodes,
+                         const std::vector<Eigen::Vector3d>& _offsets,
+                         Eigen::MatrixXd& _J)
+{
+  const size_t numNodes = _nodes.size();
+  const size_t rows = Rows * numNodes;
+  const size_t cols = _skel->getNumDofs();
+  if (static_cast<size_t>(_J.rows()) != rows
+      || static_cast<size_t>(_J.cols()) != cols)
+  {
+    _J.resize(rows, cols);
+  }
+  _J.setZero();
+
+  if (!_offsets.empty() && _offsets.size() != numNodes)
+  {
+    dterr << "[Skeleton::getWorldJacobians] The number of offsets ("
+          << _offsets.size() << ") does not match the number of nodes ("
+          << numNodes << ")!\n";
+    assert(false);
+    return;
+  }
+
+  for (size_t i = 0; i < numNodes; ++i)
+  {
+    const JacobianNode* node = _nodes[i];
+    if (nullptr == node || node->getSkeleton().get() != _skel)
+    {
+      dterr << "[Skeleton::getWorldJacobians] Node #" << i << " does not "
+            << "belong to Skeleton [" << _skel->getName() << "]!\n";
+      assert(false);
+      continue;
+    }
+
+    Eigen::Vector3d point = node->getWorldTransform().translation();
+    if (!_offsets.empty())
+      point += node->getWorldTransform().linear() * _offsets[i];
+
+    const std::vector<size_t>& indices = node->getDependentGenCoordIndices();
+    for (const size_t index : indices)
+    {
+      const Eigen::Vector3d w = _jointJacobian.col(index).head<3>();
+      _J.block<3, 1>(Rows*i + Rows-3, index)
+          = _jointJacobian.col(index).tail<3>() + w.cross(point);
+
+      if (6 == Rows)
+        _J.block<3, 1>(Rows*i, index) = w;
+    }
+  }
+}
+
+//==============================================================================
+void Skeleton::getWorldJacobians(const std::vector<const JacobianNode*>& _nodes,
+                                 const std::vector<Eigen::Vector3d>& _offsets,
+                                 Eigen::MatrixXd& _J) const
+{
+  stackWorldJacobians<6>(this, getWorldJointJacobian(), _nodes, _offsets, _J);
+}
+
+//==============================================================================
+void Skeleton::getWorldLinearJacobians(
+    const std::vector<const JacobianNode*>& _nodes,
+    const std::vector<Eigen::Vector3d>& _offsets,
+    Eigen::MatrixXd& _J) const
+{
+  stackWorldJacobians<3>(this, getWorldJointJacobian(), _nodes, _offsets, _J);
+}
+
+//==============================================================================
+const Eigen::MatrixXd& Skeleton::getInvOperationalSpaceInertia(
+    const std::vector<const JacobianNode*>& _nodes,
+    const std::vector<Eigen::Vector3d>& _offsets,
+    bool _linearOnly) const
+{
+  prepareOperationalSpace(_nodes, _offsets, _linearOnly);
+  return mOperationalSpace.mInvInertia;
+}
+
+//==============================================================================
+const Eigen::MatrixXd& Skeleton::getOperationalSpaceInertia(
+    const std::vector<const JacobianNode*>& _nodes,
+    const std::vector<Eigen::Vector3d>& _offsets,
+    bool _linearOnly) const
+{
+  prepareOperationalSpace(_nodes, _offsets, _linearOnly);
+  return mOperationalSpace.mInertia;
+}
+
+//==============================================================================
+const Eigen::MatrixXd& Skeleton::getDynamicallyConsistentInverse(
+    const std::vector<const JacobianNode*>& _nodes,
+    const std::vector<Eigen::Vector3d>& _offsets,
+    bool _linearOnly) const
+{
+  prepareOperationalSpace(_nodes, _offsets, _linearOnly);
+  return mOperationalSpace.mDynamicallyConsistentInverse;
+}
+
+//==============================================================================
+const Eigen::MatrixXd& Skeleton::getNullSpaceProjector(
+    const std::vector<const JacobianNode*>& _nodes,
+    const std::vector<Eigen::Vector3d>& _offsets,
+    bool _linearOnly) const
+{
+  prepareOperationalSpace(_nodes, _offsets, _linearOnly);
+
+  OperationalSpaceCache& cache = mOperationalSpace;
+  if (cache.mNeedNullSpaceProjectorUpdate)
+  {
+    if (cache.mLinearOnly)
+      getWorldLinearJacobians(cache.mNodes, cache.mOffsets, cache.mJacobian);
+    else
+      getWorldJacobians(cache.mNodes, cache.mOffsets, cache.mJacobian);
+
+    const size_t dof = getNumDofs();
+    cache.mNullSpaceProjector.setIdentity(dof, dof);
+    cache.mNullSpaceProjector.noalias()
+        -= cache.mJacobian.transpose()
+           * cache.mDynamicallyConsistentInverse.transpose();
+
+    cache.mNeedNullSpaceProjectorUpdate = false;
+  }
+
+  return cache.mNullSpaceProjector;
+}
+
+//==============================================================================
+void Skeleton::prepareOperationalSpace(
+    const std::vector<const JacobianNode*>& _nodes,
+    const std::vector<Eigen::Vector3d>& _offsets,
+    bool _linearOnly) const
+{
+  OperationalSpaceCache& cache = mOperationalSpace;
+  if (!mSkelCache.mDirty.mOperationalSpace && cache.mLinearOnly == _linearOnly
+      && cache.mNodes == _nodes && cache.mOffsets == _offsets)
+    return;
+
+  cache.mNodes = _nodes;
+  cache.mOffsets = _offsets;
+  cache.mLinearOnly = _linearOnly;
+
+  bool valid = true;
+  if (!_offsets.empty() && _offsets.size() != _nodes.size())
+  {
+    dterr << "[Skeleton::prepareOperationalSpace] The number of offsets ("
+          << _offsets.size() << ") does not match the number of nodes ("
+          << _nodes.size() << ")!\n";
+    assert(false);
+    valid = false;
+  }
+
+  for (size_t i = 0; i < _nodes.size(); ++i)
+  {
+    if (nullptr == _nodes[i] || _nodes[i]->getSkeleton().get() != this)
+    {
+      dterr << "[Skeleton::prepareOperationalSpace] Node #" << i << " does "
+            << "not belong to Skeleton [" << getName() << "]!\n";
+      assert(false);
+      valid = false;
+    }
+  }
+
+  if (!valid)
+  {
+    // Leave everything empty, and try again on the next request
+    cache.mNodes.clear();
+    cache.mOffsets.clear();
+    cache.mInvInertia.resize(0, 0);
+    cache.mInertia.resize(0, 0);
+    cache.mInvMassJacobianT.resize(0, 0);
+    cache.mDynamicallyConsistentInverse.resize(0, 0);
+    cache.mNullSpaceProjector.resize(0, 0);
+    cache.mNeedNullSpaceProjectorUpdate = false;
+    mSkelCache.mDirty.mOperationalSpace = true;
+    return;
+  }
+
+  updateOperationalSpace();
+}
+
+//==============================================================================
+void Skeleton::updateOperationalSpace() const
+{
+  // Every row of the task is a unit force applied to the task point. Its effect
+  // is computed with the articulated body algorithm for a Skeleton at rest,
+  // without gravity and without any other force: the task forces are carried
+  // from the JacobianNodes to the roots through the articulated body inertias,
+  // and the resulting accelerations are then carried back to the leaves. The
+  // accelerations of the task points give J * M^-1 * J^T, and the
+  // accelerations of the DegreesOfFreedom give M^-1 * J^T. All the rows are
+  // handled together, so the cost is O(n) per JacobianNode.
+  OperationalSpaceCache& cache = mOperationalSpace;
+  const size_t numBodies = mSkelCache.mBodyNodes.size();
+  const size_t dof = mSkelCache.mDofs.size();
+  const size_t numNodes = cache.mNodes.size();
+  const size_t taskDim = cache.mLinearOnly? 3 : 6;
+  const size_t rows = taskDim * numNodes;
+
+  cache.mArtInertias.resize(numBodies);
+  cache.mMotionSubspaces.resize(numBodies);
+  cache.mInvProjArtInertias.resize(numBodies);
+  cache.mTaskForces.resize(numBodies);
+  cache.mTaskAccelerations.resize(numBodies);
+  std::vector<bool> hasTaskForces(numBodies, false);
+  for (size_t i = 0; i < numBodies; ++i)
+  {
+    cache.mArtInertias[i] = mSkelCache.mBodyNodes[i]->getSpatialInertia();
+    cache.mTaskForces[i].setZero(6, rows);
+  }
+  cache.mInvMassJacobianT.setZero(dof, rows);
+
+  // Map from the spatial velocity of the BodyNode of each JacobianNode to the
+  // velocity of the task point in coordinates of the World Frame. The task
+  // forces act on the BodyNode through the transpose of this map.
+  Eigen::aligned_vector<Eigen::Matrix6d> taskMaps(numNodes);
+  std::vector<size_t> taskBodies(numNodes);
+  for (size_t k = 0; k < numNodes; ++k)
+  {
+    const JacobianNode* node = cache.mNodes[k];
+    const BodyNode* bn = dynamic_cast<const BodyNode*>(node);
+    if (nullptr == bn)
+      bn = node->getBodyNodePtr().get();
+
+    Eigen::Vector3d point = node->getWorldTransform().translation();
+    if (!cache.mOffsets.empty())
+      point += node->getWorldTransform().linear() * cache.mOffsets[k];
+
+    const Eigen::Isometry3d& T = bn->getWorldTransform();
+    const Eigen::Vector3d r = T.inverse() * point;
+
+    Eigen::Matrix6d& W = taskMaps[k];
+    W.topLeftCorner<3, 3>() = T.linear();
+    W.topRightCorner<3, 3>().setZero();
+    W.bottomLeftCorner<3, 3>() = -T.linear() * math::makeSkewSymmetric(r);
+    W.bottomRightCorner<3, 3>() = T.linear();
+
+    const size_t index = bn->getIndexInSkeleton();
+    taskBodies[k] = index;
+    cache.mTaskForces[index].middleCols(taskDim * k, taskDim)
+        = W.bottomRows(taskDim).transpose();
+    hasTaskForces[index] = true;
+  }
+
+  for (const DataCache& tree : mTreeCache)
+  {
+    // Backward recursion: articulated body inertias and transmitted forces
+    for (std::vector<BodyNode*>::const_reverse_iterator it =
+         tree.mBodyNodes.rbegin(); it != tree.mBodyNodes.rend(); ++it)
+    {
+      const BodyNode* bn = *it;
+      const size_t i = bn->getIndexInSkeleton();
+      const Joint* joint = bn->getParentJoint();
+
+      math::Jacobian& S = cache.mMotionSubspaces[i];
+      Eigen::MatrixXd& Psi = cache.mInvProjArtInertias[i];
+      S = joint->getLocalJacobian();
+
+      // Articulated inertia and forces that pass through the parent Joint
+      Eigen::Matrix6d AI = cache.mArtInertias[i];
+      Eigen::MatrixXd F;
+      if (hasTaskForces[i])
+        F = cache.mTaskForces[i];
+
+      if (S.cols() > 0)
+      {
+        const math::Jacobian U = cache.mArtInertias[i] * S;
+        Psi = (S.transpose() * U).ldlt().solve(
+              Eigen::MatrixXd::Identity(S.cols(), S.cols()));
+        AI.noalias() -= U * Psi * U.transpose();
+
+        if (hasTaskForces[i])
+          F.noalias() -= U * (Psi * (S.transpose() * cache.mTaskForces[i]));
+      }
+
+      const BodyNode* parent = bn->getParentBodyNode();
+      if (parent)
+      {
+        const size_t p = parent->getIndexInSkeleton();
+        const Eigen::Matrix6d X
+            = math::getAdTMatrix(joint->getLocalTransform().inverse());
+        cache.mArtInertias[p].noalias() += X.transpose() * AI * X;
+
+        if (hasTaskForces[i])
+        {
+          cache.mTaskForces[p].noalias() += X.transpose() * F;
+          hasTaskForces[p] = true;
+        }
+      }
+    }
+
+    // Forward recursion: accelerations of the BodyNodes and the DOFs
+    for (const BodyNode* bn : tree.mBodyNodes)
+    {
+      const size_t i = bn->getIndexInSkeleton();
+      const Joint* joint = bn->getParentJoint();
+      const math::Jacobian& S = cache.mMotionSubspaces[i];
+      Eigen::MatrixXd& A = cache.mTaskAccelerations[i];
+
+      const BodyNode* parent = bn->getParentBodyNode();
+      if (parent)
+      {
+        const Eigen::Matrix6d X
+            = math::getAdTMatrix(joint->getLocalTransform().inverse());
+        const size_t p = parent->getIndexInSkeleton();
+        A.noalias() = X * cache.mTaskAccelerations[p];
+      }
+      else
+      {
+        A.setZero(6, rows);
+      }
+
+      if (S.cols() > 0)
+      {
+        const math::Jacobian U = cache.mArtInertias[i] * S;
+        Eigen::MatrixXd ddq = -U.transpose() * A;
+        if (hasTaskForces[i])
+          ddq.noalias() += S.transpose() * cache.mTaskForces[i];
+        ddq = cache.mInvProjArtInertias[i] * ddq;
+
+        A.noalias() += S * ddq;
+        for (int k = 0; k < S.cols(); ++k)
+        {
+          cache.mInvMassJacobianT.row(joint->getIndexInSkeleton(k))
+              = ddq.row(k);
+        }
+      }
+    }
+  }
+
+  cache.mInvInertia.resize(rows, rows);
+  for (size_t k = 0; k < numNodes; ++k)
+  {
+    cache.mInvInertia.middleRows(taskDim * k, taskDim).noalias()
+        = taskMaps[k].bottomRows(taskDim)
+          * cache.mTaskAccelerations[taskBodies[k]];
+  }
+
+  cache.mInertia = cache.mInvInertia.ldlt().solve(
+        Eigen::MatrixXd::Identity(rows, rows));
+  cache.mDynamicallyConsistentInverse.noalias()
+      = cache.mInvMassJacobianT * cache.mInertia;
+  cache.mNeedNullSpaceProjectorUpdate = true;
+
+  mSkelCache.mDirty.mOperationalSpace = false;
+}
+
 //==============================================================================
 Skeleton::DirtyFlags::DirtyFlags()
   : mArticulatedInertia(true),
@@ -3264,11 +4542,23 @@ Skeleton::DirtyFlags::DirtyFlags()
     mCoriolisAndGravityForces(true),
     mExternalForces(true),
     mDampingForces(true),
+    mCentroidalMomentumMatrix(true),
+    mCentroidalMomentumBias(true),
+    mWorldJointJacobian(true),
+    mOperationalSpace(true),
     mSupport(true),
     mSupportVersion(0)
 {
   // Do nothing
 }
 
+//==============================================================================
+Skeleton::OperationalSpaceCache::OperationalSpaceCache()
+  : mLinearOnly(false),
+    mNeedNullSpaceProjectorUpdate(false)
+{
+  // Do nothing
+}
+
 }  // namespace dynamics
 }  // namespace dart
@@ -39,6 +39,8 @@
 #define DART_DYNAMICS_SKELETON_H_
 
 #include <mutex>
+#include <set>
+#include "dart/common/BitMatrix.h"
 #include "dart/common/NameManager.h"
 #include "dart/dynamics/MetaSkeleton.h"
 #include "dart/dynamics/SmartPointer.h"
@@ -158,6 +160,22 @@ public:
   /// bodies
   bool isEnabledAdjacentBodyCheck() const;
 
+  /// Set whether the BodyNodes _bodyNode1 and _bodyNode2 of this Skeleton are
+  /// allowed to collide with each other when self collision check is enabled
+  void setCollisionAllowed(const BodyNode* _bodyNode1,
+                           const BodyNode* _bodyNode2,
+                           bool _allowed);
+
+  /// Return true if the BodyNodes with the indices _index1 and _index2 in this
+  /// Skeleton are allowed to collide with each other
+  bool isCollisionAllowed(size_t _index1, size_t _index2) const;
+
+  /// Return the allowed collision matrix of this Skeleton, indexed by the
+  /// indices of the BodyNodes in the Skeleton. It combines the self collision
+  /// flags, the adjacency of the BodyNodes and the pairs that were disabled by
+  /// setCollisionAllowed().
+  const common::BitMatrix& getAllowedCollisionMatrix() const;
+
   /// Set whether this skeleton will be updated by forward dynamics.
   /// \param[in] _isMobile True if this skeleton is mobile.
   void setMobile(bool _isMobile);
@@ -508,11 +526,66 @@ public:
   /// Compute forward dynamics
   void computeForwardDynamics();
 
+  /// Enable or disable the compiled dynamics program. When enabled (the
+  /// default), the articulated inertia and forward dynamics recursions record
+  /// the exact type of each BodyNode and parent Joint whenever the structure
+  /// of the Skeleton changes, and then call the routines of RevoluteJoint,
+  /// PrismaticJoint, BallJoint, FreeJoint, and WeldJoint without virtual
+  /// dispatch. Other types are always called virtually.
+  void setDynamicsProgramEnabled(bool _enabled);
+
+  /// Return true if the compiled dynamics program is enabled
+  bool isDynamicsProgramEnabled() const;
+
   /// Compute inverse dynamics
   void computeInverseDynamics(bool _withExternalForces = false,
                               bool _withDampingForces = false,
                               bool _withSpringForces = false);
 
+  /// Compute inverse dynamics for every sample of a trajectory. Column i of
+  /// _positions, _velocities and _accelerations is the state of sample i, and
+  /// column i of the returned matrix holds the joint forces of that sample.
+  ///
+  /// The samples are split into contiguous chunks across _numThreads workers,
+  /// each of which works on its own clone of this Skeleton, so the state of
+  /// this Skeleton is left untouched. The external forces currently applied
+  /// to this Skeleton are used for every sample when _withExternalForces is
+  /// true. If _numThreads is zero, the number of hardware threads will be
+  /// used.
+  Eigen::MatrixXd computeInverseDynamics(
+      const Eigen::MatrixXd& _positions,
+      const Eigen::MatrixXd& _velocities,
+      const Eigen::MatrixXd& _accelerations,
+      bool _withExternalForces = false,
+      bool _withDampingForces = false,
+      bool _withSpringForces = false,
+      size_t _numThreads = 0) const;
+
+  /// Return true if computeForwardDynamicsDerivatives() can differentiate the
+  /// forward dynamics of this Skeleton. This requires every Joint to be a
+  /// RevoluteJoint, PrismaticJoint, ScrewJoint or WeldJoint with a FORCE or
+  /// PASSIVE actuator and without Coulomb friction, and no SoftBodyNodes.
+  bool hasAnalyticDynamicsDerivatives() const;
+
+  /// Compute the derivatives of the generalized accelerations given by
+  /// computeForwardDynamics() with respect to the generalized positions
+  /// (_dAccdPos), velocities (_dAccdVel) and forces (_dAccdForce) at the
+  /// current state. Gravity, the external forces and the implicit joint
+  /// damping and spring forces are taken into account, constraint forces are
+  /// not.
+  ///
+  /// The derivatives of the inverse dynamics are propagated through the
+  /// recursive Newton-Euler algorithm for each coordinate, and the derivatives
+  /// of the forward dynamics then follow from the augmented mass matrix, so
+  /// the cost is O(n^2) in the number of degrees of freedom. As a side
+  /// effect, the generalized accelerations of this Skeleton are updated.
+  ///
+  /// Returns false, leaving the matrices untouched, if
+  /// hasAnalyticDynamicsDerivatives() is false.
+  bool computeForwardDynamicsDerivatives(Eigen::MatrixXd& _dAccdPos,
+                                         Eigen::MatrixXd& _dAccdVel,
+                                         Eigen::MatrixXd& _dAccdForce);
+
   //----------------------------------------------------------------------------
   // Impulse-based dynamics algorithms
   //----------------------------------------------------------------------------
@@ -738,6 +811,10 @@ public:
   /// Notify that the support polygon of a tree needs to be updated
   void notifySupportUpdate(size_t _treeIdx);
 
+  /// Notify that the operational-space quantities need to be updated, e.g.,
+  /// because the relative transform of an EndEffector of a tree changed
+  void notifyOperationalSpaceUpdate(size_t _treeIdx);
+
   // Documentation inherited
   double getKineticEnergy() const override;
 
@@ -808,6 +885,102 @@ public:
 
   /// \}
 
+  //----------------------------------------------------------------------------
+  /// \{ \name Centroidal Dynamics
+  //----------------------------------------------------------------------------
+
+  /// Get the Skeleton's centroidal momentum matrix in terms of any Frame
+  /// (default is World Frame). The matrix is computed with a single recursive
+  /// pass over the composite inertias of the subtrees, i.e., in O(n) time, and
+  /// is cached until the configuration or the inertia of the Skeleton changes.
+  math::Jacobian getCentroidalMomentumMatrix(
+      const Frame* _inCoordinatesOf = Frame::World()) const override;
+
+  /// Get the velocity product term dA_G * dq of the rate of change of the
+  /// Skeleton's centroidal momentum in terms of any Frame (default is World
+  /// Frame). This is computed in O(n) time from the velocity product
+  /// accelerations of the BodyNodes, and is cached until the state of the
+  /// Skeleton changes.
+  Eigen::Vector6d getCentroidalMomentumBias(
+      const Frame* _inCoordinatesOf = Frame::World()) const override;
+
+  /// \}
+
+  //----------------------------------------------------------------------------
+  /// \{ \name Task Jacobians
+  //----------------------------------------------------------------------------
+
+  /// Fill _J with the Jacobians of several JacobianNodes of this Skeleton,
+  /// stacked on top of each other and expressed in the World Frame. Each block
+  /// of six rows targets the point at the corresponding entry of _offsets,
+  /// given in coordinates of the JacobianNode's Frame, and has a column for
+  /// every DegreeOfFreedom of the Skeleton. Leave _offsets empty to target the
+  /// origins of the JacobianNodes. The columns of the Joints are computed once
+  /// per configuration and shared by all the JacobianNodes, so this is cheaper
+  /// than stacking getWorldJacobian(offset) of each JacobianNode. _J is only
+  /// resized if it does not already have 6*_nodes.size() rows and getNumDofs()
+  /// columns.
+  void getWorldJacobians(const std::vector<const JacobianNode*>& _nodes,
+                         const std::vector<Eigen::Vector3d>& _offsets,
+                         Eigen::MatrixXd& _J) const;
+
+  /// Same as getWorldJacobians(), except that only the linear part of each
+  /// Jacobian is filled, so that _J has three rows per JacobianNode.
+  void getWorldLinearJacobians(const std::vector<const JacobianNode*>& _nodes,
+                               const std::vector<Eigen::Vector3d>& _offsets,
+                               Eigen::MatrixXd& _J) const;
+
+  /// \}
+
+  //----------------------------------------------------------------------------
+  /// \{ \name Operational Space
+  //----------------------------------------------------------------------------
+
+  // The functions below describe the task whose Jacobian J stacks the World
+  // Jacobians of _nodes at _offsets, exactly as getWorldJacobians() does, or
+  // only their linear parts, as getWorldLinearJacobians() does, if _linearOnly
+  // is true. They are computed by propagating the task forces through the
+  // articulated body inertias, in O(n) time per JacobianNode, without ever
+  // forming the mass matrix or its inverse. The results for the most recently
+  // requested task are cached until the configuration or the inertia of the
+  // Skeleton changes, so the references returned are only valid until another
+  // task is requested.
+
+  /// Get the inverse of the operational-space inertia, J * M^-1 * J^T
+  const Eigen::MatrixXd& getInvOperationalSpaceInertia(
+      const std::vector<const JacobianNode*>& _nodes,
+      const std::vector<Eigen::Vector3d>& _offsets
+          = std::vector<Eigen::Vector3d>(),
+      bool _linearOnly = false) const;
+
+  /// Get the operational-space inertia, (J * M^-1 * J^T)^-1. The task must
+  /// not be singular, i.e., J must have full row rank.
+  const Eigen::MatrixXd& getOperationalSpaceInertia(
+      const std::vector<const JacobianNode*>& _nodes,
+      const std::vector<Eigen::Vector3d>& _offsets
+          = std::vector<Eigen::Vector3d>(),
+      bool _linearOnly = false) const;
+
+  /// Get the dynamically consistent pseudo-inverse of J, which is
+  /// M^-1 * J^T * Lambda, where Lambda is the operational-space inertia
+  const Eigen::MatrixXd& getDynamicallyConsistentInverse(
+      const std::vector<const JacobianNode*>& _nodes,
+      const std::vector<Eigen::Vector3d>& _offsets
+          = std::vector<Eigen::Vector3d>(),
+      bool _linearOnly = false) const;
+
+  /// Get the dynamically consistent null-space projector of the task for
+  /// generalized forces, I - J^T * Jbar^T, where Jbar is the dynamically
+  /// consistent pseudo-inverse of J. Generalized forces projected by it do not
+  /// accelerate the task.
+  const Eigen::MatrixXd& getNullSpaceProjector(
+      const std::vector<const JacobianNode*>& _nodes,
+      const std::vector<Eigen::Vector3d>& _offsets
+          = std::vector<Eigen::Vector3d>(),
+      bool _linearOnly = false) const;
+
+  /// \}
+
   //----------------------------------------------------------------------------
   // Rendering
   //----------------------------------------------------------------------------
@@ -971,6 +1144,33 @@ protected:
   /// update external force vector to generalized forces.
   void updateExternalForces() const;
 
+  /// Update the centroidal momentum matrix and the COM Jacobian of the
+  /// skeleton
+  void updateCentroidalMomentumMatrix() const;
+
+  /// Get the World Jacobian of the Joints, whose i-th column is the spatial
+  /// velocity, in coordinates of the World Frame and taken at its origin, that
+  /// a unit velocity of the i-th DegreeOfFreedom gives to the BodyNodes that
+  /// depend on it. The World Jacobian of any JacobianNode consists of these
+  /// columns moved to the origin of the JacobianNode.
+  const math::Jacobian& getWorldJointJacobian() const;
+
+  /// Update the World Jacobian of the Joints of the skeleton
+  void updateWorldJointJacobian() const;
+
+  /// Update the velocity product term of the centroidal momentum rate of the
+  /// skeleton
+  void updateCentroidalMomentumBias() const;
+
+  /// Make sure that mOperationalSpace describes the requested task, updating
+  /// it if the task or the state of the skeleton has changed
+  void prepareOperationalSpace(const std::vector<const JacobianNode*>& _nodes,
+                               const std::vector<Eigen::Vector3d>& _offsets,
+                               bool _linearOnly) const;
+
+  /// Update the operational-space inertia of the task in mOperationalSpace
+  void updateOperationalSpace() const;
+
   /// Compute the constraint force vector for a tree
   const Eigen::VectorXd& computeConstraintForces(DataCache& cache) const;
 
@@ -998,11 +1198,40 @@ protected:
   /// Add a Marker entry
   const std::string& addEntryToMarkerNameMgr(Marker* _newMarker);
 
+  /// Rebuild the allowed collision matrix
+  void updateAllowedCollisionMatrix();
+
+  /// Record the exact type of every BodyNode and parent Joint in
+  /// mDynamicsProgram
+  void compileDynamicsProgram() const;
+
+  /// Update the articulated inertia of a BodyNode from those of its children
+  /// using the compiled dynamics program
+  void runArtInertiaStep(BodyNode* _bodyNode) const;
+
+  /// Update the bias force of a BodyNode and the total force of its parent
+  /// Joint using the compiled dynamics program
+  void runBiasForceStep(BodyNode* _bodyNode);
+
+  /// Update the acceleration, the transmitted force, and the parent Joint force
+  /// of a BodyNode using the compiled dynamics program
+  void runForwardDynamicsStep(BodyNode* _bodyNode);
+
 protected:
 
   /// Properties of this Skeleton
   Properties mSkeletonP;
 
+  /// BodyNode pairs whose collisions were disabled by setCollisionAllowed(),
+  /// each ordered by address. The pairs are kept by BodyNode rather than by
+  /// index, so that they survive the reindexing when BodyNodes are moved.
+  std::set<std::pair<const BodyNode*, const BodyNode*>>
+      mDisabledCollisionPairs;
+
+  /// Allowed collision matrix, kept up to date by every function that changes
+  /// it so that the const getters are safe to call from several threads
+  common::BitMatrix mAllowedCollisionMatrix;
+
   /// The resource-managing pointer to this Skeleton
   std::weak_ptr<Skeleton> mPtr;
 
@@ -1068,6 +1297,18 @@ protected:
     /// Dirty flag for the damping force vector.
     bool mDampingForces;
 
+    /// Dirty flag for the centroidal momentum matrix and the COM Jacobian
+    bool mCentroidalMomentumMatrix;
+
+    /// Dirty flag for the velocity product term of the centroidal momentum rate
+    bool mCentroidalMomentumBias;
+
+    /// Dirty flag for the World Jacobian of the Joints
+    bool mWorldJointJacobian;
+
+    /// Dirty flag for the operational-space quantities
+    bool mOperationalSpace;
+
     /// Dirty flag for the support polygon
     bool mSupport;
 
@@ -1120,6 +1361,35 @@ protected:
     /// Constraint force vector.
     Eigen::VectorXd mFc;
 
+    /// Centroidal momentum matrix in terms of the World Frame
+    math::Jacobian mCentroidalMomentumMatrix;
+
+    /// COM Jacobian in terms of the World Frame
+    math::Jacobian mCOMJacobian;
+
+    /// World Jacobian of the Joints, taken at the origin of the World Frame
+    math::Jacobian mWorldJointJacobian;
+
+    /// Velocity product term of the centroidal momentum rate in terms of the
+    /// World Frame
+    Eigen::Vector6d mCentroidalMomentumBias;
+
+    /// Mass of the subtree rooted at each BodyNode -- only used for temporary
+    /// storage purposes
+    Eigen::VectorXd mSubtreeMasses;
+
+    /// First moment of mass about the COM of the subtree rooted at each
+    /// BodyNode -- only used for temporary storage purposes
+    Eigen::Matrix3Xd mSubtreeMoments;
+
+    /// Rotational inertia about the COM of the subtree rooted at each BodyNode
+    /// -- only used for temporary storage purposes
+    std::vector<Eigen::Matrix3d> mSubtreeInertias;
+
+    /// Velocity product acceleration of each BodyNode -- only used for
+    /// temporary storage purposes
+    Eigen::Matrix<double, 6, Eigen::Dynamic> mBiasAccelerations;
+
     /// Support polygon
     math::SupportPolygon mSupportPolygon;
 
@@ -1145,6 +1415,97 @@ protected:
 
   mutable DataCache mSkelCache;
 
+  struct OperationalSpaceCache
+  {
+    /// Default constructor
+    OperationalSpaceCache();
+
+    /// JacobianNodes of the task
+    std::vector<const JacobianNode*> mNodes;
+
+    /// Offsets of the task points in the Frames of the JacobianNodes
+    std::vector<Eigen::Vector3d> mOffsets;
+
+    /// True if the task only has the linear part of each Jacobian
+    bool mLinearOnly;
+
+    /// Inverse of the operational-space inertia, J * M^-1 * J^T
+    Eigen::MatrixXd mInvInertia;
+
+    /// Operational-space inertia
+    Eigen::MatrixXd mInertia;
+
+    /// M^-1 * J^T
+    Eigen::MatrixXd mInvMassJacobianT;
+
+    /// Dynamically consistent pseudo-inverse of J
+    Eigen::MatrixXd mDynamicallyConsistentInverse;
+
+    /// Null-space projector of the task for generalized forces
+    Eigen::MatrixXd mNullSpaceProjector;
+
+    /// Dirty flag for mNullSpaceProjector, which is only computed on request
+    bool mNeedNullSpaceProjectorUpdate;
+
+    /// Stacked Jacobian of the task -- only used for temporary storage purposes
+    Eigen::MatrixXd mJacobian;
+
+    /// Articulated body inertia of each BodyNode -- only used for temporary
+    /// storage purposes
+    Eigen::aligned_vector<Eigen::Matrix6d> mArtInertias;
+
+    /// Motion subspace of each parent Joint -- only used for temporary storage
+    /// purposes
+    std::vector<math::Jacobian> mMotionSubspaces;
+
+    /// Inverse of the projected articulated inertia of each parent Joint --
+    /// only used for temporary storage purposes
+    std::vector<Eigen::MatrixXd> mInvProjArtInertias;
+
+    /// Task forces transmitted to each BodyNode, one column per row of the
+    /// task -- only used for temporary storage purposes
+    std::vector<Eigen::MatrixXd> mTaskForces;
+
+    /// Accelerations of each BodyNode caused by the task forces -- only used
+    /// for temporary storage purposes
+    std::vector<Eigen::MatrixXd> mTaskAccelerations;
+  };
+
+  mutable OperationalSpaceCache mOperationalSpace;
+
+  /// Exact type of a parent Joint whose dynamics routines can be called
+  /// without virtual dispatch
+  enum class JointKernel : unsigned char
+  {
+    GENERIC = 0,
+    REVOLUTE,
+    PRISMATIC,
+    BALL,
+    FREE,
+    WELD
+  };
+
+  /// Entry of the compiled dynamics program for one BodyNode
+  struct DynamicsStep
+  {
+    /// Exact type of the parent Joint
+    JointKernel mJointKernel;
+
+    /// True if the BodyNode is not exactly a BodyNode (e.g., a SoftBodyNode),
+    /// so its own recursive routines must be called virtually
+    bool mIsGenericBodyNode;
+  };
+
+  /// Compiled dynamics program, indexed by the index of the BodyNode in the
+  /// Skeleton
+  mutable std::vector<DynamicsStep> mDynamicsProgram;
+
+  /// Dirty flag for mDynamicsProgram
+  mutable bool mIsDynamicsProgramDirty;
+
+  /// True if the dynamics recursions use mDynamicsProgram
+  bool mIsDynamicsProgramEnabled;
+
   /// Total mass.
   double mTotalMass;
 
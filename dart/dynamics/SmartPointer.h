@@ -83,8 +83,10 @@ DART_COMMON_MAKE_SHARED_WEAK(Chain)
 DART_COMMON_MAKE_SHARED_WEAK(Shape)
 DART_COMMON_MAKE_SHARED_WEAK(ArrowShape)
 DART_COMMON_MAKE_SHARED_WEAK(BoxShape)
+DART_COMMON_MAKE_SHARED_WEAK(CapsuleShape)
 DART_COMMON_MAKE_SHARED_WEAK(CylinderShape)
 DART_COMMON_MAKE_SHARED_WEAK(EllipsoidShape)
+DART_COMMON_MAKE_SHARED_WEAK(HeightmapShape)
 DART_COMMON_MAKE_SHARED_WEAK(LineSegmentShape)
 DART_COMMON_MAKE_SHARED_WEAK(MeshShape)
 DART_COMMON_MAKE_SHARED_WEAK(PlaneShape)
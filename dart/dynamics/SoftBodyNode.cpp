@@ -255,6 +255,18 @@ SoftBodyNode& SoftBodyNode::operator=(const SoftBodyNode& _otherSoftBodyNode)
   return *this;
 }
 
+//==============================================================================
+SoftBodyNode* SoftBodyNode::asSoftBodyNode()
+{
+  return this;
+}
+
+//==============================================================================
+const SoftBodyNode* SoftBodyNode::asSoftBodyNode() const
+{
+  return this;
+}
+
 //==============================================================================
 size_t SoftBodyNode::getNumPointMasses() const
 {
@@ -146,6 +146,12 @@ public:
   /// Copy the Properties of another SoftBodyNode
   SoftBodyNode& operator=(const SoftBodyNode& _otherSoftBodyNode);
 
+  // Documentation inherited
+  SoftBodyNode* asSoftBodyNode() override;
+
+  // Documentation inherited
+  const SoftBodyNode* asSoftBodyNode() const override;
+
   /// Get the update notifier for the PointMasses of this SoftBodyNode
   PointMassNotifier* getNotifier();
 
@@ -141,6 +141,7 @@ void SoftMeshShape::update()
     itAIVector3d.Set(vertex[0], vertex[1], vertex[2]);
     mAssimpMesh->mVertices[i] = itAIVector3d;
   }
+  ++mVersion;
 }
 
 }  // namespace dynamics
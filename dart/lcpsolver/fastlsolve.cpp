@@ -12,7 +12,7 @@
  * if this is in the factorizer source file, n must be a multiple of 4.
  */
 
-void _dSolveL1 (const dReal *L, dReal *B, int n, int lskip1)
+void _dSolveL1Scalar (const dReal *L, dReal *B, int n, int lskip1)
 {  
   /* declare variables - Z matrix, p and q vectors, etc */
   dReal Z11,Z21,Z31,Z41,p1,q1,p2,p3,p4,*ex;
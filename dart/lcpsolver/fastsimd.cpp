@@ -0,0 +1,324 @@
+/*************************************************************************
+ *                                                                       *
+ * Open Dynamics Engine, Copyright (C) 2001,2002 Russell L. Smith.       *
+ * All rights reserved.  Email: russ@q12.org   Web: www.q12.org          *
+ *                                                                       *
+ * This library is free software; you can redistribute it and/or         *
+ * modify it under the terms of EITHER:                                  *
+ *   (1) The GNU Lesser General Public License as published by the Free  *
+ *       Software Foundation; either version 2.1 of the License, or (at  *
+ *       your option) any later version. The text of the GNU Lesser      *
+ *       General Public License is included with this library in the     *
+ *       file LICENSE.TXT.                                               *
+ *   (2) The BSD-style license that is included with this library in     *
+ *       the file LICENSE-BSD.TXT.                                       *
+ *                                                                       *
+ * This library is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the files    *
+ * LICENSE.TXT and LICENSE-BSD.TXT for more details.                     *
+ *                                                                       *
+ *************************************************************************/
+
+/* runtime dispatch of the dot product, LDLT factorization and triangular
+ * solve kernels to AVX2/FMA or AVX-512 implementations.
+ *
+ * the SIMD variants work row by row: every inner loop of the factorizer and
+ * of the L*X=B solve is a dot product against a contiguous row of L, and the
+ * L^T*X=B solve is a sequence of contiguous axpy updates. they are only used
+ * for systems of at least SIMD_MIN_SIZE rows; the blocked scalar code in
+ * fastldlt.cpp, fastlsolve.cpp and fastltsolve.cpp is used for smaller
+ * systems, on other architectures and in single precision builds.
+ */
+
+#include "dart/lcpsolver/matrix.h"
+
+#if defined(dDOUBLE) && (defined(__GNUC__) || defined(__clang__)) \
+    && (defined(__x86_64__) || defined(__i386__))
+  #define dSIMD_X86
+  #include <immintrin.h>
+#endif
+
+/* below this size the blocked scalar kernels are at least as fast */
+#define SIMD_MIN_SIZE 8
+
+
+#ifdef dSIMD_X86
+
+#define dTARGET_AVX2 __attribute__((target("avx2,fma")))
+#define dTARGET_AVX512 __attribute__((target("avx512f")))
+
+struct dKernelsAVX2
+{
+  /* return a.b over n elements */
+  dTARGET_AVX2 static dReal dot (const dReal *a, const dReal *b, int n)
+  {
+    __m256d s0 = _mm256_setzero_pd();
+    __m256d s1 = _mm256_setzero_pd();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+      s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a+i), _mm256_loadu_pd(b+i), s0);
+      s1 = _mm256_fmadd_pd(_mm256_loadu_pd(a+i+4), _mm256_loadu_pd(b+i+4), s1);
+    }
+    if (i + 4 <= n) {
+      s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a+i), _mm256_loadu_pd(b+i), s0);
+      i += 4;
+    }
+    s0 = _mm256_add_pd(s0, s1);
+    __m128d h = _mm_add_pd(_mm256_castpd256_pd128(s0),
+                           _mm256_extractf128_pd(s0, 1));
+    h = _mm_add_sd(h, _mm_unpackhi_pd(h, h));
+    dReal sum = _mm_cvtsd_f64(h);
+    for (; i < n; i++) sum += a[i] * b[i];
+    return sum;
+  }
+
+  /* b -= s*a over n elements */
+  dTARGET_AVX2 static void subScaled (dReal *b, const dReal *a, dReal s, int n)
+  {
+    const __m256d vs = _mm256_set1_pd(s);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+      _mm256_storeu_pd(b+i, _mm256_fnmadd_pd(vs, _mm256_loadu_pd(a+i),
+                                             _mm256_loadu_pd(b+i)));
+    }
+    for (; i < n; i++) b[i] -= s * a[i];
+  }
+
+  /* ell *= d elementwise over n elements and return sum(old_ell * new_ell) */
+  dTARGET_AVX2 static dReal scaleAndDot (dReal *ell, const dReal *d, int n)
+  {
+    __m256d s0 = _mm256_setzero_pd();
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+      const __m256d p = _mm256_loadu_pd(ell+i);
+      const __m256d q = _mm256_mul_pd(p, _mm256_loadu_pd(d+i));
+      _mm256_storeu_pd(ell+i, q);
+      s0 = _mm256_fmadd_pd(p, q, s0);
+    }
+    __m128d h = _mm_add_pd(_mm256_castpd256_pd128(s0),
+                           _mm256_extractf128_pd(s0, 1));
+    h = _mm_add_sd(h, _mm_unpackhi_pd(h, h));
+    dReal sum = _mm_cvtsd_f64(h);
+    for (; i < n; i++) {
+      const dReal q = ell[i] * d[i];
+      sum += ell[i] * q;
+      ell[i] = q;
+    }
+    return sum;
+  }
+};
+
+struct dKernelsAVX512
+{
+  /* return the sum of the eight lanes of v. _mm512_reduce_add_pd, the
+     unmasked _mm512_extractf64x4_pd and _mm512_castpd512_pd256 are avoided
+     because GCC 12 reports their undefined pass-through operand as
+     -Wuninitialized. */
+  dTARGET_AVX512 static dReal hsum (__m512d v)
+  {
+    const __m256d q = _mm256_add_pd(_mm512_maskz_extractf64x4_pd(0xFF, v, 0),
+                                    _mm512_maskz_extractf64x4_pd(0xFF, v, 1));
+    __m128d h = _mm_add_pd(_mm256_castpd256_pd128(q),
+                           _mm256_extractf128_pd(q, 1));
+    h = _mm_add_sd(h, _mm_unpackhi_pd(h, h));
+    return _mm_cvtsd_f64(h);
+  }
+
+  dTARGET_AVX512 static dReal dot (const dReal *a, const dReal *b, int n)
+  {
+    __m512d s0 = _mm512_setzero_pd();
+    __m512d s1 = _mm512_setzero_pd();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+      s0 = _mm512_fmadd_pd(_mm512_loadu_pd(a+i), _mm512_loadu_pd(b+i), s0);
+      s1 = _mm512_fmadd_pd(_mm512_loadu_pd(a+i+8), _mm512_loadu_pd(b+i+8), s1);
+    }
+    if (i < n) {
+      /* masked loads cover the remaining (at most 15) elements */
+      const int rest = n - i;
+      if (rest >= 8) {
+        s0 = _mm512_fmadd_pd(_mm512_loadu_pd(a+i), _mm512_loadu_pd(b+i), s0);
+        i += 8;
+      }
+      const __mmask8 m = (__mmask8)((1u << (n - i)) - 1u);
+      s1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, a+i),
+                           _mm512_maskz_loadu_pd(m, b+i), s1);
+    }
+    return hsum(_mm512_add_pd(s0, s1));
+  }
+
+  dTARGET_AVX512 static void subScaled (dReal *b, const dReal *a, dReal s, int n)
+  {
+    const __m512d vs = _mm512_set1_pd(s);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+      _mm512_storeu_pd(b+i, _mm512_fnmadd_pd(vs, _mm512_loadu_pd(a+i),
+                                             _mm512_loadu_pd(b+i)));
+    }
+    if (i < n) {
+      const __mmask8 m = (__mmask8)((1u << (n - i)) - 1u);
+      _mm512_mask_storeu_pd(b+i, m,
+          _mm512_fnmadd_pd(vs, _mm512_maskz_loadu_pd(m, a+i),
+                           _mm512_maskz_loadu_pd(m, b+i)));
+    }
+  }
+
+  dTARGET_AVX512 static dReal scaleAndDot (dReal *ell, const dReal *d, int n)
+  {
+    __m512d s0 = _mm512_setzero_pd();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+      const __m512d p = _mm512_loadu_pd(ell+i);
+      const __m512d q = _mm512_mul_pd(p, _mm512_loadu_pd(d+i));
+      _mm512_storeu_pd(ell+i, q);
+      s0 = _mm512_fmadd_pd(p, q, s0);
+    }
+    if (i < n) {
+      const __mmask8 m = (__mmask8)((1u << (n - i)) - 1u);
+      const __m512d p = _mm512_maskz_loadu_pd(m, ell+i);
+      const __m512d q = _mm512_mul_pd(p, _mm512_maskz_loadu_pd(m, d+i));
+      _mm512_mask_storeu_pd(ell+i, m, q);
+      s0 = _mm512_fmadd_pd(p, q, s0);
+    }
+    return hsum(s0);
+  }
+};
+
+
+/* solve L*X=B for a single right hand side, one dot product per row */
+template <class K>
+static void solveL1 (const dReal *L, dReal *B, int n, int lskip1)
+{
+  for (int i = 1; i < n; i++) B[i] -= K::dot(L + i*lskip1, B, i);
+}
+
+
+/* solve L^T*X=B for a single right hand side. once X(i) is known its
+ * contribution is removed from B(0..i-1) using row i of L.
+ */
+template <class K>
+static void solveL1T (const dReal *L, dReal *B, int n, int lskip1)
+{
+  for (int i = n-1; i > 0; i--) K::subScaled(B, L + i*lskip1, B[i], i);
+}
+
+
+/* same storage and results (up to rounding) as _dFactorLDLTScalar: the
+ * strictly lower triangle of A is overwritten with L and d receives the
+ * reciprocals of the diagonal of D.
+ */
+template <class K>
+static void factorLDLT (dReal *A, dReal *d, int n, int nskip1)
+{
+  for (int i = 0; i < n; i++) {
+    dReal *ell = A + i*nskip1;
+    /* solve L*(D*l)=a for row i, then scale by D^-1 */
+    solveL1<K>(A, ell, i, nskip1);
+    const dReal sum = K::scaleAndDot(ell, d, i);
+    d[i] = dRecip(ell[i] - sum);
+  }
+}
+
+#endif // dSIMD_X86
+
+
+static int detectSIMDLevel (void)
+{
+#ifdef dSIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) return dSIMD_AVX512;
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    return dSIMD_AVX2;
+#endif
+  return dSIMD_NONE;
+}
+
+static const int maxSIMDLevel = detectSIMDLevel();
+static int simdLevel = maxSIMDLevel;
+
+
+int _dGetSIMDLevel (void)
+{
+  return simdLevel;
+}
+
+
+int _dSetSIMDLevel (int level)
+{
+  if (level < dSIMD_NONE) level = dSIMD_NONE;
+  simdLevel = level < maxSIMDLevel ? level : maxSIMDLevel;
+  return simdLevel;
+}
+
+
+int _dGetMaxSIMDLevel (void)
+{
+  return maxSIMDLevel;
+}
+
+
+dReal _dDot (const dReal *a, const dReal *b, int n)
+{
+#ifdef dSIMD_X86
+  if (n >= SIMD_MIN_SIZE) {
+    if (simdLevel == dSIMD_AVX512) return dKernelsAVX512::dot(a, b, n);
+    if (simdLevel == dSIMD_AVX2) return dKernelsAVX2::dot(a, b, n);
+  }
+#endif
+  return _dDotScalar(a, b, n);
+}
+
+
+void _dFactorLDLT (dReal *A, dReal *d, int n, int nskip1)
+{
+#ifdef dSIMD_X86
+  if (n >= SIMD_MIN_SIZE) {
+    if (simdLevel == dSIMD_AVX512) {
+      factorLDLT<dKernelsAVX512>(A, d, n, nskip1);
+      return;
+    }
+    if (simdLevel == dSIMD_AVX2) {
+      factorLDLT<dKernelsAVX2>(A, d, n, nskip1);
+      return;
+    }
+  }
+#endif
+  _dFactorLDLTScalar(A, d, n, nskip1);
+}
+
+
+void _dSolveL1 (const dReal *L, dReal *B, int n, int lskip1)
+{
+#ifdef dSIMD_X86
+  if (n >= SIMD_MIN_SIZE) {
+    if (simdLevel == dSIMD_AVX512) {
+      solveL1<dKernelsAVX512>(L, B, n, lskip1);
+      return;
+    }
+    if (simdLevel == dSIMD_AVX2) {
+      solveL1<dKernelsAVX2>(L, B, n, lskip1);
+      return;
+    }
+  }
+#endif
+  _dSolveL1Scalar(L, B, n, lskip1);
+}
+
+
+void _dSolveL1T (const dReal *L, dReal *B, int n, int lskip1)
+{
+#ifdef dSIMD_X86
+  if (n >= SIMD_MIN_SIZE) {
+    if (simdLevel == dSIMD_AVX512) {
+      solveL1T<dKernelsAVX512>(L, B, n, lskip1);
+      return;
+    }
+    if (simdLevel == dSIMD_AVX2) {
+      solveL1T<dKernelsAVX2>(L, B, n, lskip1);
+      return;
+    }
+  }
+#endif
+  _dSolveL1TScalar(L, B, n, lskip1);
+}
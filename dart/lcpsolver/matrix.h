@@ -208,6 +208,35 @@ void _dLDLTAddTL (dReal *L, dReal *d, const dReal *a, int n, int nskip, void *tm
 void _dLDLTRemove (dReal **A, const int *p, dReal *L, dReal *d, int n1, int n2, int r, int nskip, void *tmpbuf);
 void _dRemoveRowCol (dReal *A, int n, int nskip, int r);
 
+/* portable reference implementations of the kernels above. _dDot,
+ * _dFactorLDLT, _dSolveL1 and _dSolveL1T dispatch at runtime to SIMD
+ * variants when the CPU supports them and fall back to these otherwise.
+ */
+dReal _dDotScalar (const dReal *a, const dReal *b, int n);
+void _dFactorLDLTScalar (dReal *A, dReal *d, int n, int nskip);
+void _dSolveL1Scalar (const dReal *L, dReal *b, int n, int nskip);
+void _dSolveL1TScalar (const dReal *L, dReal *b, int n, int nskip);
+
+/* instruction sets the LDLT/solve/dot kernels can be dispatched to */
+enum {
+  dSIMD_NONE = 0,
+  dSIMD_AVX2,
+  dSIMD_AVX512
+};
+
+/* get the instruction set currently used by the dispatched kernels. */
+int _dGetSIMDLevel (void);
+
+/* select the instruction set used by the dispatched kernels (e.g. to compare
+ * against the scalar code). requests above what the CPU supports are clamped
+ * to the best supported level; the level actually selected is returned. not
+ * thread safe with respect to concurrently running solvers.
+ */
+int _dSetSIMDLevel (int level);
+
+/* the best instruction set supported by this CPU and build. */
+int _dGetMaxSIMDLevel (void);
+
 PURE_INLINE size_t _dEstimateFactorCholeskyTmpbufSize(int n)
 {
   return dPAD(n) * sizeof(dReal);
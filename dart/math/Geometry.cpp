@@ -40,15 +40,356 @@
 #include <cmath>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <vector>
 
 #include "dart/common/Console.h"
 #include "dart/math/Geometry.h"
 #include "dart/math/Helpers.h"
 
+#if (defined(__GNUC__) || defined(__clang__)) \
+    && (defined(__x86_64__) || defined(__i386__))
+  #define DART_MATH_SIMD_X86
+  #include <immintrin.h>
+#endif
+
 namespace dart {
 namespace math {
 
+namespace {
+
+#ifdef DART_MATH_SIMD_X86
+
+#define DART_TARGET_AVX2 __attribute__((target("avx2,fma")))
+
+//==============================================================================
+/// AVX2/FMA versions of the spatial algebra kernels. A 3-vector occupies the
+/// lower three lanes of a 4-wide register. The columns of the rotation and
+/// the translation are loaded straight from the 4x4 storage of
+/// Eigen::Isometry3d, so the fourth lane may hold anything (the bottom row is
+/// not always initialized). None of the shuffles below moves the fourth lane
+/// into the lower three, and the fourth lane is never stored.
+struct KernelsAVX2
+{
+  /// Load three doubles; the fourth lane is zero and nothing past _x + 2 is
+  /// read
+  DART_TARGET_AVX2 static inline __m256d load3(const double* _x)
+  {
+    return _mm256_maskload_pd(_x, _mm256_set_epi64x(0, -1, -1, -1));
+  }
+
+  /// Store the lower three lanes of _v
+  DART_TARGET_AVX2 static inline void store3(double* _x, __m256d _v)
+  {
+    _mm_storeu_pd(_x, _mm256_castpd256_pd128(_v));
+    _mm_store_sd(_x + 2, _mm256_extractf128_pd(_v, 1));
+  }
+
+  /// (x, y, z) -> (y, z, x)
+  DART_TARGET_AVX2 static inline __m256d yzx(__m256d _v)
+  {
+    return _mm256_permute4x64_pd(_v, _MM_SHUFFLE(3, 0, 2, 1));
+  }
+
+  /// _a x _b + _c x _d, using a x b = (a * b.yzx - a.yzx * b).yzx
+  DART_TARGET_AVX2 static inline __m256d crossSum(
+      __m256d _a, __m256d _b, __m256d _c, __m256d _d)
+  {
+    __m256d tmp = _mm256_mul_pd(_a, yzx(_b));
+    tmp = _mm256_fnmadd_pd(yzx(_a), _b, tmp);
+    tmp = _mm256_fmadd_pd(_c, yzx(_d), tmp);
+    tmp = _mm256_fnmadd_pd(yzx(_c), _d, tmp);
+    return yzx(tmp);
+  }
+
+  /// _a x _b
+  DART_TARGET_AVX2 static inline __m256d cross(__m256d _a, __m256d _b)
+  {
+    return yzx(_mm256_fmsub_pd(_a, yzx(_b), _mm256_mul_pd(yzx(_a), _b)));
+  }
+
+  /// _c[0] * _x[0] + _c[1] * _x[1] + _c[2] * _x[2], i.e., the product of the
+  /// matrix whose columns are _c with the 3-vector _x in memory
+  DART_TARGET_AVX2 static inline __m256d mul(const __m256d* _c,
+                                              const double* _x)
+  {
+    __m256d res = _mm256_mul_pd(_c[0], _mm256_broadcast_sd(_x));
+    res = _mm256_fmadd_pd(_c[1], _mm256_broadcast_sd(_x + 1), res);
+    return _mm256_fmadd_pd(_c[2], _mm256_broadcast_sd(_x + 2), res);
+  }
+
+  /// Same as mul() for a 3-vector held in a register
+  DART_TARGET_AVX2 static inline __m256d mul(const __m256d* _c, __m256d _x)
+  {
+    __m256d res = _mm256_mul_pd(_c[0], _mm256_permute4x64_pd(_x, 0x00));
+    res = _mm256_fmadd_pd(_c[1], _mm256_permute4x64_pd(_x, 0x55), res);
+    return _mm256_fmadd_pd(_c[2], _mm256_permute4x64_pd(_x, 0xAA), res);
+  }
+
+  /// Load the rotation columns and the translation of _T
+  DART_TARGET_AVX2 static inline void load(const Eigen::Isometry3d& _T,
+                                           __m256d* _R, __m256d& _p)
+  {
+    const double* t = _T.data();
+    _R[0] = _mm256_loadu_pd(t);
+    _R[1] = _mm256_loadu_pd(t + 4);
+    _R[2] = _mm256_loadu_pd(t + 8);
+    _p = _mm256_loadu_pd(t + 12);
+  }
+
+  /// Write the transpose of the 3x3 matrix whose columns are _c to _ct
+  DART_TARGET_AVX2 static inline void transpose(const __m256d* _c,
+                                                __m256d* _ct)
+  {
+    const __m256d t0 = _mm256_unpacklo_pd(_c[0], _c[1]);
+    const __m256d t1 = _mm256_unpackhi_pd(_c[0], _c[1]);
+    const __m256d t2 = _mm256_unpacklo_pd(_c[2], _c[2]);
+    const __m256d t3 = _mm256_unpackhi_pd(_c[2], _c[2]);
+    _ct[0] = _mm256_permute2f128_pd(t0, t2, 0x20);
+    _ct[1] = _mm256_permute2f128_pd(t1, t3, 0x20);
+    _ct[2] = _mm256_permute2f128_pd(t0, t2, 0x31);
+  }
+
+  /// Store a spatial vector. The head is stored with four lanes first and
+  /// its spill into _x[3] is then overwritten by the tail.
+  DART_TARGET_AVX2 static inline void store6(double* _x, __m256d _head,
+                                             __m256d _tail)
+  {
+    _mm256_storeu_pd(_x, _head);
+    store3(_x + 3, _tail);
+  }
+
+  DART_TARGET_AVX2 static void AdT(const Eigen::Isometry3d& _T,
+                                   const double* _V, double* _res)
+  {
+    __m256d R[3], p;
+    load(_T, R, p);
+    const __m256d w = mul(R, _V);
+    const __m256d v = _mm256_add_pd(mul(R, _V + 3), cross(p, w));
+    store6(_res, w, v);
+  }
+
+  DART_TARGET_AVX2 static void AdTColumns(const Eigen::Isometry3d& _T,
+                                          const double* _J, int _stride,
+                                          int _numCols, double* _res)
+  {
+    __m256d R[3], p;
+    load(_T, R, p);
+    for (int i = 0; i < _numCols; ++i)
+    {
+      const double* V = _J + i * _stride;
+      const __m256d w = mul(R, V);
+      const __m256d v = _mm256_add_pd(mul(R, V + 3), cross(p, w));
+      store6(_res + 6 * i, w, v);
+    }
+  }
+
+  DART_TARGET_AVX2 static void AdInvT(const Eigen::Isometry3d& _T,
+                                      const double* _V, double* _res)
+  {
+    __m256d R[3], Rt[3], p;
+    load(_T, R, p);
+    transpose(R, Rt);
+    const __m256d w = load3(_V);
+    const __m256d u = _mm256_add_pd(load3(_V + 3), cross(w, p));
+    store6(_res, mul(Rt, _V), mul(Rt, u));
+  }
+
+  DART_TARGET_AVX2 static void dAdInvT(const Eigen::Isometry3d& _T,
+                                       const double* _F, double* _res)
+  {
+    __m256d R[3], p;
+    load(_T, R, p);
+    const __m256d f = mul(R, _F + 3);
+    const __m256d m = _mm256_add_pd(mul(R, _F), cross(p, f));
+    store6(_res, m, f);
+  }
+
+  DART_TARGET_AVX2 static void ad(const double* _X, const double* _Y,
+                                  double* _res)
+  {
+    const __m256d w1 = load3(_X);
+    const __m256d v1 = load3(_X + 3);
+    const __m256d w2 = load3(_Y);
+    const __m256d v2 = load3(_Y + 3);
+    store6(_res, cross(w1, w2), crossSum(w1, v2, v1, w2));
+  }
+
+  DART_TARGET_AVX2 static void dad(const double* _s, const double* _t,
+                                   double* _res)
+  {
+    const __m256d w = load3(_s);
+    const __m256d v = load3(_s + 3);
+    const __m256d m = load3(_t);
+    const __m256d f = load3(_t + 3);
+    store6(_res, crossSum(m, w, f, v), cross(f, w));
+  }
+
+  /// The 3x3 product A * B, where the columns of A are held in registers and
+  /// the columns of B are stored four doubles apart
+  DART_TARGET_AVX2 static inline void mul3x3(
+      const __m256d* _A, const double* _B, __m256d* _res)
+  {
+    for (int j = 0; j < 3; ++j)
+      _res[j] = mul(_A, _B + 4 * j);
+  }
+
+  /// A * B + C * D, see mul3x3()
+  DART_TARGET_AVX2 static inline void mulAdd3x3(
+      const __m256d* _A, const double* _B, const __m256d* _C,
+      const double* _D, __m256d* _res)
+  {
+    for (int j = 0; j < 3; ++j)
+    {
+      const double* b = _B + 4 * j;
+      const double* d = _D + 4 * j;
+      __m256d res = _mm256_mul_pd(_A[0], _mm256_broadcast_sd(b));
+      res = _mm256_fmadd_pd(_A[1], _mm256_broadcast_sd(b + 1), res);
+      res = _mm256_fmadd_pd(_A[2], _mm256_broadcast_sd(b + 2), res);
+      res = _mm256_fmadd_pd(_C[0], _mm256_broadcast_sd(d), res);
+      res = _mm256_fmadd_pd(_C[1], _mm256_broadcast_sd(d + 1), res);
+      _res[j] = _mm256_fmadd_pd(_C[2], _mm256_broadcast_sd(d + 2), res);
+    }
+  }
+
+  /// Store three columns four doubles apart so their entries can be
+  /// broadcast by mul3x3()
+  DART_TARGET_AVX2 static inline void store3x3(double* _x, const __m256d* _c)
+  {
+    _mm256_store_pd(_x, _c[0]);
+    _mm256_store_pd(_x + 4, _c[1]);
+    _mm256_store_pd(_x + 8, _c[2]);
+  }
+
+  /// Ad(T)^T * I * Ad(T), where Ad(T) = [R 0; [p]R R]. Like the scalar
+  /// version only the diagonal blocks and the upper right block of I are
+  /// read, and the result is made exactly symmetric.
+  DART_TARGET_AVX2 static void transformInertia(const Eigen::Isometry3d& _T,
+                                                const double* _I,
+                                                double* _res)
+  {
+    alignas(32) double q[12];
+    alignas(32) double c11[12], c12[12], c21[12], c22[12];
+
+    __m256d R[3], Rt[3], Q[3], Qt[3], p;
+    load(_T, R, p);
+    transpose(R, Rt);
+    for (int j = 0; j < 3; ++j)
+      Q[j] = cross(p, R[j]);
+    transpose(Q, Qt);
+    store3x3(q, Q);
+
+    // Blocks of the inertia in columns; I21 = I12^T
+    const __m256d I11[3] = { _mm256_loadu_pd(_I),
+                             _mm256_loadu_pd(_I + 6),
+                             _mm256_loadu_pd(_I + 12) };
+    const __m256d I12[3] = { _mm256_loadu_pd(_I + 18),
+                             _mm256_loadu_pd(_I + 24),
+                             _mm256_loadu_pd(_I + 30) };
+    const __m256d I22[3] = { _mm256_loadu_pd(_I + 21),
+                             _mm256_loadu_pd(_I + 27),
+                             load3(_I + 33) };
+    __m256d I21[3];
+    transpose(I12, I21);
+
+    // C = I * Ad(T)
+    const double* r = _T.data();
+    __m256d C[3];
+    mulAdd3x3(I11, r, I12, q, C);
+    store3x3(c11, C);
+    mul3x3(I12, r, C);
+    store3x3(c12, C);
+    mulAdd3x3(I21, r, I22, q, C);
+    store3x3(c21, C);
+    mul3x3(I22, r, C);
+    store3x3(c22, C);
+
+    // Ad(T)^T * C
+    __m256d J11[3], J12[3], J22[3];
+    mulAdd3x3(Rt, c11, Qt, c21, J11);
+    mulAdd3x3(Rt, c12, Qt, c22, J12);
+    mul3x3(Rt, c22, J22);
+
+    for (int j = 0; j < 3; ++j)
+    {
+      _mm256_storeu_pd(_res + 6 * j, J11[j]);
+      store6(_res + 6 * (j + 3), J12[j], J22[j]);
+    }
+
+    // Lower triangle from the upper one, which also overwrites the spill of
+    // J11 into the fourth row
+    for (int i = 1; i < 6; ++i)
+      for (int j = 0; j < i; ++j)
+        _res[6 * j + i] = _res[6 * i + j];
+  }
+
+  /// Assemble exp(S) from the coefficients computed by the scalar code:
+  /// R = cos_t * I + beta * w * w^T + alpha * [w],
+  /// p = alpha * v + beta * (w x v) + gamma * w
+  DART_TARGET_AVX2 static void expMap(const double* _S, double _alpha,
+                                      double _beta, double _gamma,
+                                      double _cos, double* _res)
+  {
+    const __m256d w = load3(_S);
+    const __m256d v = load3(_S + 3);
+    const __m256d bw = _mm256_mul_pd(_mm256_set1_pd(_beta), w);
+    const double a0 = _alpha * _S[0];
+    const double a1 = _alpha * _S[1];
+    const double a2 = _alpha * _S[2];
+
+    _mm256_storeu_pd(_res, _mm256_fmadd_pd(bw, _mm256_broadcast_sd(_S),
+                                           _mm256_set_pd(0.0, -a1, a2, _cos)));
+    _mm256_storeu_pd(_res + 4,
+                     _mm256_fmadd_pd(bw, _mm256_broadcast_sd(_S + 1),
+                                     _mm256_set_pd(0.0, a0, _cos, -a2)));
+    _mm256_storeu_pd(_res + 8,
+                     _mm256_fmadd_pd(bw, _mm256_broadcast_sd(_S + 2),
+                                     _mm256_set_pd(0.0, _cos, -a0, a1)));
+
+    __m256d t = _mm256_mul_pd(_mm256_set1_pd(_alpha), v);
+    t = _mm256_fmadd_pd(_mm256_set1_pd(_beta), cross(w, v), t);
+    t = _mm256_fmadd_pd(_mm256_set1_pd(_gamma), w, t);
+    _mm256_storeu_pd(_res + 12, _mm256_blend_pd(t, _mm256_set1_pd(1.0), 0x8));
+  }
+};
+
+#endif // DART_MATH_SIMD_X86
+
+//==============================================================================
+SimdLevel detectSimdLevel()
+{
+#ifdef DART_MATH_SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    return SimdLevel::AVX2;
+#endif
+  return SimdLevel::NONE;
+}
+
+const SimdLevel gMaxSimdLevel = detectSimdLevel();
+SimdLevel gSimdLevel = gMaxSimdLevel;
+
+}  // anonymous namespace
+
+//==============================================================================
+SimdLevel getSimdLevel()
+{
+  return gSimdLevel;
+}
+
+//==============================================================================
+SimdLevel setSimdLevel(SimdLevel _level)
+{
+  gSimdLevel = _level < gMaxSimdLevel ? _level : gMaxSimdLevel;
+  return gSimdLevel;
+}
+
+//==============================================================================
+SimdLevel getMaxSimdLevel()
+{
+  return gMaxSimdLevel;
+}
+
 Eigen::Quaterniond expToQuat(const Eigen::Vector3d& _v) {
   double mag = _v.norm();
 
@@ -629,12 +970,37 @@ Eigen::Vector6d AdT(const Eigen::Isometry3d& _T, const Eigen::Vector6d& _V) {
   // v' = p x R*w + R*v
   //--------------------------------------------------------------------------
   Eigen::Vector6d res;
+#ifdef DART_MATH_SIMD_X86
+  if (gSimdLevel == SimdLevel::AVX2)
+  {
+    KernelsAVX2::AdT(_T, _V.data(), res.data());
+    return res;
+  }
+#endif
   res.head<3>().noalias() = _T.linear() * _V.head<3>();
   res.tail<3>().noalias() = _T.linear() * _V.tail<3>() +
                             _T.translation().cross(res.head<3>());
   return res;
 }
 
+//==============================================================================
+void AdTColumns(const Eigen::Isometry3d& _T, const double* _J, int _stride,
+                int _numCols, double* _result)
+{
+#ifdef DART_MATH_SIMD_X86
+  if (gSimdLevel == SimdLevel::AVX2)
+  {
+    KernelsAVX2::AdTColumns(_T, _J, _stride, _numCols, _result);
+    return;
+  }
+#endif
+  for (int i = 0; i < _numCols; ++i)
+  {
+    Eigen::Map<Eigen::Vector6d>(_result + 6 * i)
+        = AdT(_T, Eigen::Map<const Eigen::Vector6d>(_J + i * _stride));
+  }
+}
+
 //==============================================================================
 Eigen::Matrix6d getAdTMatrix(const Eigen::Isometry3d& T)
 {
@@ -715,6 +1081,13 @@ Eigen::Vector6d AdTLinear(const Eigen::Isometry3d& _T,
 // re = Inv(T)*s*T
 Eigen::Vector6d AdInvT(const Eigen::Isometry3d& _T, const Eigen::Vector6d& _V) {
   Eigen::Vector6d res;
+#ifdef DART_MATH_SIMD_X86
+  if (gSimdLevel == SimdLevel::AVX2)
+  {
+    KernelsAVX2::AdInvT(_T, _V.data(), res.data());
+    return res;
+  }
+#endif
   res.head<3>().noalias() = _T.linear().transpose() * _V.head<3>();
   res.tail<3>().noalias() =
       _T.linear().transpose()
@@ -752,6 +1125,13 @@ Eigen::Vector6d ad(const Eigen::Vector6d& _X, const Eigen::Vector6d& _Y) {
   //              | [v1]w2 + [w1]v2 |
   //--------------------------------------------------------------------------
   Eigen::Vector6d res;
+#ifdef DART_MATH_SIMD_X86
+  if (gSimdLevel == SimdLevel::AVX2)
+  {
+    KernelsAVX2::ad(_X.data(), _Y.data(), res.data());
+    return res;
+  }
+#endif
   res.head<3>() = _X.head<3>().cross(_Y.head<3>());
   res.tail<3>() = _X.head<3>().cross(_Y.tail<3>()) +
                   _X.tail<3>().cross(_Y.head<3>());
@@ -786,6 +1166,13 @@ Eigen::Vector6d dAdT(const Eigen::Isometry3d& _T, const Eigen::Vector6d& _F) {
 Eigen::Vector6d dAdInvT(const Eigen::Isometry3d& _T,
                         const Eigen::Vector6d& _F) {
   Eigen::Vector6d res;
+#ifdef DART_MATH_SIMD_X86
+  if (gSimdLevel == SimdLevel::AVX2)
+  {
+    KernelsAVX2::dAdInvT(_T, _F.data(), res.data());
+    return res;
+  }
+#endif
   res.tail<3>().noalias() = _T.linear() * _F.tail<3>();
   res.head<3>().noalias() = _T.linear() * _F.head<3>();
   res.head<3>() += _T.translation().cross(res.tail<3>());
@@ -1194,6 +1581,14 @@ Eigen::Isometry3d expMap(const Eigen::Vector6d& _S) {
     gamma = (_S[0]*_S[3] + _S[1]*_S[4] + _S[2]*_S[5])/6.0 - theta*theta/120.0;
   }
 
+#ifdef DART_MATH_SIMD_X86
+  if (gSimdLevel == SimdLevel::AVX2)
+  {
+    KernelsAVX2::expMap(_S.data(), alpha, beta, gamma, cos_t, ret.data());
+    return ret;
+  }
+#endif
+
   ret(0, 0) = beta*s2[0] + cos_t;
   ret(1, 0) = beta*s3[0] + alpha*_S[2];
   ret(2, 0) = beta*s3[2] - alpha*_S[1];
@@ -1304,6 +1699,13 @@ Eigen::Isometry3d expAngular(const Eigen::Vector3d& _s) {
 
 Eigen::Vector6d dad(const Eigen::Vector6d& _s, const Eigen::Vector6d& _t) {
   Eigen::Vector6d res;
+#ifdef DART_MATH_SIMD_X86
+  if (gSimdLevel == SimdLevel::AVX2)
+  {
+    KernelsAVX2::dad(_s.data(), _t.data(), res.data());
+    return res;
+  }
+#endif
   res.head<3>() = _t.head<3>().cross(_s.head<3>())
                   + _t.tail<3>().cross(_s.tail<3>());
   res.tail<3>() = _t.tail<3>().cross(_s.head<3>());
@@ -1313,6 +1715,15 @@ Eigen::Vector6d dad(const Eigen::Vector6d& _s, const Eigen::Vector6d& _t) {
 Inertia transformInertia(const Eigen::Isometry3d& _T, const Inertia& _I) {
   // operation count: multiplication = 186, addition = 117, subtract = 21
 
+#ifdef DART_MATH_SIMD_X86
+  if (gSimdLevel == SimdLevel::AVX2)
+  {
+    Inertia ret;
+    KernelsAVX2::transformInertia(_T, _I.data(), ret.data());
+    return ret;
+  }
+#endif
+
   Inertia ret = Inertia::Identity();
 
   double d0 = _I(0, 3) + _T(2, 3) * _I(3, 4) - _T(1, 3) * _I(3, 5);
@@ -1759,6 +2170,265 @@ SupportPolygon computeConvexHull(std::vector<size_t>& _originalIndices,
   return polygon;
 }
 
+//==============================================================================
+// HullFace is an internal struct used to facilitate the computation of 3D
+// convex hulls
+struct HullFace
+{
+  int mVertices[3];
+  Eigen::Vector3d mNormal;
+  double mOffset;
+  std::vector<int> mOutside;
+  bool mValid;
+};
+
+//==============================================================================
+// Create the face (_a, _b, _c) of a 3D hull oriented away from _interior
+static bool makeHullFace(const std::vector<Eigen::Vector3d>& _points,
+                         const Eigen::Vector3d& _interior,
+                         int _a, int _b, int _c, HullFace& _face)
+{
+  Eigen::Vector3d normal
+      = (_points[_b] - _points[_a]).cross(_points[_c] - _points[_a]);
+  const double norm = normal.norm();
+  if(norm <= 0.0)
+    return false;
+
+  normal /= norm;
+  _face.mVertices[0] = _a;
+  _face.mVertices[1] = _b;
+  _face.mVertices[2] = _c;
+  if(normal.dot(_points[_a] - _interior) < 0.0)
+  {
+    normal = -normal;
+    std::swap(_face.mVertices[1], _face.mVertices[2]);
+  }
+  _face.mNormal = normal;
+  _face.mOffset = normal.dot(_points[_a]);
+  _face.mOutside.clear();
+  _face.mValid = true;
+
+  return true;
+}
+
+//==============================================================================
+// Give each point of _candidates to the first face it is outside of; points
+// that are inside of all the faces are dropped
+static void assignOutsidePoints(const std::vector<Eigen::Vector3d>& _points,
+                                const std::vector<int>& _candidates,
+                                std::vector<HullFace>& _faces,
+                                size_t _firstFace, double _tolerance)
+{
+  for(const int index : _candidates)
+  {
+    for(size_t i=_firstFace; i < _faces.size(); ++i)
+    {
+      HullFace& face = _faces[i];
+      if(face.mValid
+         && face.mNormal.dot(_points[index]) - face.mOffset > _tolerance)
+      {
+        face.mOutside.push_back(index);
+        break;
+      }
+    }
+  }
+}
+
+//==============================================================================
+std::vector<Eigen::Vector3d> computeConvexHull3D(
+    const std::vector<Eigen::Vector3d>& _points,
+    std::vector<Eigen::Vector3i>* _triangles)
+{
+  std::vector<Eigen::Vector3d> hull;
+  if(_triangles)
+    _triangles->clear();
+
+  if(_points.size() < 4)
+    return hull;
+
+  // Scale the tolerance with the size of the point set
+  Eigen::Vector3d lower = _points[0];
+  Eigen::Vector3d upper = _points[0];
+  for(const Eigen::Vector3d& point : _points)
+  {
+    lower = lower.cwiseMin(point);
+    upper = upper.cwiseMax(point);
+  }
+  const double tolerance = 1e-10 * std::max((upper - lower).norm(), 1.0);
+
+  // Initial tetrahedron: the two most distant axis-extreme points, then the
+  // point farthest from their line and the point farthest from their plane
+  int extremes[6] = {0, 0, 0, 0, 0, 0};
+  for(size_t i=0; i < _points.size(); ++i)
+  {
+    for(int axis=0; axis < 3; ++axis)
+    {
+      if(_points[i][axis] < _points[extremes[2*axis]][axis])
+        extremes[2*axis] = static_cast<int>(i);
+      if(_points[i][axis] > _points[extremes[2*axis+1]][axis])
+        extremes[2*axis+1] = static_cast<int>(i);
+    }
+  }
+
+  int v0 = 0;
+  int v1 = 0;
+  double maxDistance = -1.0;
+  for(int i=0; i < 6; ++i)
+  {
+    for(int j=i+1; j < 6; ++j)
+    {
+      const double distance
+          = (_points[extremes[i]] - _points[extremes[j]]).squaredNorm();
+      if(distance > maxDistance)
+      {
+        maxDistance = distance;
+        v0 = extremes[i];
+        v1 = extremes[j];
+      }
+    }
+  }
+
+  const Eigen::Vector3d axis = (_points[v1] - _points[v0]).normalized();
+  int v2 = -1;
+  maxDistance = tolerance;
+  for(size_t i=0; i < _points.size(); ++i)
+  {
+    const double distance
+        = (_points[i] - _points[v0]).cross(axis).norm();
+    if(distance > maxDistance)
+    {
+      maxDistance = distance;
+      v2 = static_cast<int>(i);
+    }
+  }
+  if(v2 < 0)
+    return hull;
+
+  const Eigen::Vector3d normal
+      = (_points[v1] - _points[v0]).cross(_points[v2] - _points[v0])
+        .normalized();
+  int v3 = -1;
+  maxDistance = tolerance;
+  for(size_t i=0; i < _points.size(); ++i)
+  {
+    const double distance = std::abs(normal.dot(_points[i] - _points[v0]));
+    if(distance > maxDistance)
+    {
+      maxDistance = distance;
+      v3 = static_cast<int>(i);
+    }
+  }
+  if(v3 < 0)
+    return hull;
+
+  const Eigen::Vector3d interior
+      = 0.25 * (_points[v0] + _points[v1] + _points[v2] + _points[v3]);
+
+  std::vector<HullFace> faces(4);
+  makeHullFace(_points, interior, v0, v1, v2, faces[0]);
+  makeHullFace(_points, interior, v0, v1, v3, faces[1]);
+  makeHullFace(_points, interior, v0, v2, v3, faces[2]);
+  makeHullFace(_points, interior, v1, v2, v3, faces[3]);
+
+  std::vector<int> candidates;
+  candidates.reserve(_points.size());
+  for(size_t i=0; i < _points.size(); ++i)
+  {
+    const int index = static_cast<int>(i);
+    if(index != v0 && index != v1 && index != v2 && index != v3)
+      candidates.push_back(index);
+  }
+  assignOutsidePoints(_points, candidates, faces, 0, tolerance);
+
+  // Grow the hull by the farthest outside point of each face in turn
+  std::vector<std::pair<int, int>> horizon;
+  for(size_t f=0; f < faces.size(); ++f)
+  {
+    if(!faces[f].mValid || faces[f].mOutside.empty())
+      continue;
+
+    int apex = -1;
+    maxDistance = -std::numeric_limits<double>::infinity();
+    for(const int index : faces[f].mOutside)
+    {
+      const double distance
+          = faces[f].mNormal.dot(_points[index]) - faces[f].mOffset;
+      if(distance > maxDistance)
+      {
+        maxDistance = distance;
+        apex = index;
+      }
+    }
+    const Eigen::Vector3d& p = _points[apex];
+
+    // Remove the faces that can see the apex and find the horizon around them
+    horizon.clear();
+    candidates.clear();
+    for(HullFace& face : faces)
+    {
+      if(!face.mValid || face.mNormal.dot(p) - face.mOffset <= tolerance)
+        continue;
+
+      face.mValid = false;
+      for(const int index : face.mOutside)
+      {
+        if(index != apex)
+          candidates.push_back(index);
+      }
+      face.mOutside.clear();
+
+      for(int j=0; j < 3; ++j)
+      {
+        const std::pair<int, int> edge(face.mVertices[j],
+                                       face.mVertices[(j+1)%3]);
+        const auto shared = std::find(horizon.begin(), horizon.end(),
+                                      std::make_pair(edge.second, edge.first));
+        if(shared != horizon.end())
+          horizon.erase(shared);
+        else
+          horizon.push_back(edge);
+      }
+    }
+
+    const size_t firstNewFace = faces.size();
+    for(const std::pair<int, int>& edge : horizon)
+    {
+      HullFace face;
+      if(makeHullFace(_points, interior, edge.first, edge.second, apex, face))
+        faces.push_back(face);
+    }
+
+    assignOutsidePoints(_points, candidates, faces, firstNewFace, tolerance);
+
+    // Revisit the new faces, which are appended to the end of the list
+  }
+
+  // Collect the vertices that are used by the remaining faces
+  std::vector<int> newIndices(_points.size(), -1);
+  for(const HullFace& face : faces)
+  {
+    if(!face.mValid)
+      continue;
+
+    Eigen::Vector3i triangle;
+    for(int j=0; j < 3; ++j)
+    {
+      int& newIndex = newIndices[face.mVertices[j]];
+      if(newIndex < 0)
+      {
+        newIndex = static_cast<int>(hull.size());
+        hull.push_back(_points[face.mVertices[j]]);
+      }
+      triangle[j] = newIndex;
+    }
+
+    if(_triangles)
+      _triangles->push_back(triangle);
+  }
+
+  return hull;
+}
+
 //==============================================================================
 Intersection_t computeIntersection(Eigen::Vector2d& _intersectionPoint,
                                    const Eigen::Vector2d& a1,
@@ -203,6 +203,11 @@ Eigen::Vector6d AdT(const Eigen::Isometry3d& _T, const Eigen::Vector6d& _V);
 /// \brief Get linear transformation matrix of Adjoint mapping
 Eigen::Matrix6d getAdTMatrix(const Eigen::Isometry3d& T);
 
+/// Apply AdT to the _numCols spatial vectors in _J, whose columns are _stride
+/// doubles apart, and write the results contiguously to _result
+void AdTColumns(const Eigen::Isometry3d& _T, const double* _J, int _stride,
+                int _numCols, double* _result);
+
 /// Adjoint mapping for dynamic size Jacobian
 template<typename Derived>
 typename Derived::PlainObject AdTJac(const Eigen::Isometry3d& _T,
@@ -214,9 +219,11 @@ typename Derived::PlainObject AdTJac(const Eigen::Isometry3d& _T,
 
   typename Derived::PlainObject ret(_J.rows(), _J.cols());
 
-  // Compute AdT column by column
-  for (int i = 0; i < _J.cols(); ++i)
-    ret.col(i) = AdT(_T, _J.col(i));
+  // Compute AdT column by column. Expressions without direct access are
+  // evaluated into a temporary by the Ref.
+  const Eigen::Ref<const Eigen::Matrix<double, 6, Eigen::Dynamic>> J(_J);
+  AdTColumns(_T, J.data(), static_cast<int>(J.outerStride()),
+             static_cast<int>(J.cols()), ret.data());
 
   return ret;
 }
@@ -411,6 +418,26 @@ Eigen::Vector6d dad(const Eigen::Vector6d& _s, const Eigen::Vector6d& _t);
 /// \brief
 Inertia transformInertia(const Eigen::Isometry3d& _T, const Inertia& _AI);
 
+/// Instruction sets that the spatial algebra kernels (AdT, AdInvT, dAdInvT,
+/// ad, dad, transformInertia, AdTJac and expMap) can be dispatched to
+enum class SimdLevel
+{
+  NONE = 0,
+  AVX2
+};
+
+/// Return the instruction set currently used by the spatial algebra kernels
+SimdLevel getSimdLevel();
+
+/// Select the instruction set used by the spatial algebra kernels, e.g., to
+/// compare against the portable implementation. Requests above what the CPU
+/// supports are clamped; the level actually selected is returned. This is not
+/// thread safe with respect to concurrent callers of the kernels.
+SimdLevel setSimdLevel(SimdLevel _level);
+
+/// Return the best instruction set supported by this CPU and build
+SimdLevel getMaxSimdLevel();
+
 /// Use the Parallel Axis Theorem to compute the moment of inertia of a body
 /// whose center of mass has been shifted from the origin
 Eigen::Matrix3d parallelAxisTheorem(const Eigen::Matrix3d& _original,
@@ -513,6 +540,15 @@ SupportPolygon computeConvexHull(const SupportPolygon& _points);
 SupportPolygon computeConvexHull(std::vector<size_t>& _originalIndices,
                                  const SupportPolygon& _points);
 
+/// Computes the convex hull of a set of 3D points with the quickhull algorithm
+/// and returns its vertices. The faces of the hull are written to _triangles
+/// as triples of indices into the returned vertices, ordered counterclockwise
+/// when seen from the outside. Fewer than four points, or points that are all
+/// coplanar, do not span a volume and yield an empty hull.
+std::vector<Eigen::Vector3d> computeConvexHull3D(
+    const std::vector<Eigen::Vector3d>& _points,
+    std::vector<Eigen::Vector3i>* _triangles = nullptr);
+
 /// Compute the centroid of a polygon, assuming the polygon is a convex hull
 Eigen::Vector2d computeCentroidOfHull(const SupportPolygon& _convexHull);
 
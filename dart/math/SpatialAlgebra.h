@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2016, Georgia Tech Research Corporation
+ * All rights reserved.
+ *
+ * Author(s): Jeongseok Lee <jslee02@gmail.com>
+ *
+ * Georgia Tech Graphics Lab and Humanoid Robotics Lab
+ *
+ * Directed by Prof. C. Karen Liu and Prof. Mike Stilman
+ * <karenliu@cc.gatech.edu> <mstilman@cc.gatech.edu>
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DART_MATH_SPATIALALGEBRA_H_
+#define DART_MATH_SPATIALALGEBRA_H_
+
+#include <cmath>
+
+#include <Eigen/Dense>
+
+// The functions in this header are templated on the scalar type so that the
+// articulated-body recursions can be evaluated in single precision as well as
+// in double precision. The double precision functions of Geometry.h remain the
+// ones used by BodyNode and Joint; these templates are only ever selected when
+// the scalar type is given explicitly (e.g. math::AdT<float>(T, V)) or when the
+// arguments are not double precision.
+
+namespace dart {
+namespace math {
+
+template <typename S> using Vector3 = Eigen::Matrix<S, 3, 1>;
+template <typename S> using Vector6 = Eigen::Matrix<S, 6, 1>;
+template <typename S> using Matrix3 = Eigen::Matrix<S, 3, 3>;
+template <typename S> using Matrix6 = Eigen::Matrix<S, 6, 6>;
+template <typename S> using Isometry3 = Eigen::Transform<S, 3, Eigen::Isometry>;
+
+//==============================================================================
+template <typename S>
+Matrix3<S> makeSkewSymmetric(const Vector3<S>& _v)
+{
+  Matrix3<S> result;
+
+  result << S(0), -_v(2),  _v(1),
+            _v(2),  S(0), -_v(0),
+           -_v(1),  _v(0),  S(0);
+
+  return result;
+}
+
+//==============================================================================
+/// Rotation matrix of the exponential coordinates _q
+template <typename S>
+Matrix3<S> expMapRot(const Vector3<S>& _q)
+{
+  const S theta = _q.norm();
+  const Matrix3<S> qss = makeSkewSymmetric<S>(_q);
+  const Matrix3<S> qss2 = qss*qss;
+
+  // Same threshold as the double precision version in Geometry.cpp
+  if (theta < S(1.0e-3))
+    return Matrix3<S>::Identity() + qss + S(0.5)*qss2;
+
+  return Matrix3<S>::Identity()
+      + (std::sin(theta)/theta)*qss
+      + ((S(1) - std::cos(theta))/(theta*theta))*qss2;
+}
+
+//==============================================================================
+/// Exponential coordinates of the rotation matrix _R
+template <typename S>
+Vector3<S> logMap(const Matrix3<S>& _R)
+{
+  const Eigen::AngleAxis<S> aa(_R);
+  return aa.angle()*aa.axis();
+}
+
+//==============================================================================
+/// Adjoint mapping: (R w, p x R w + R v)
+template <typename S>
+Vector6<S> AdT(const Isometry3<S>& _T, const Vector6<S>& _V)
+{
+  Vector6<S> res;
+  res.template head<3>().noalias() = _T.linear() * _V.template head<3>();
+  res.template tail<3>().noalias() = _T.linear() * _V.template tail<3>();
+  res.template tail<3>() += _T.translation().cross(res.template head<3>());
+  return res;
+}
+
+//==============================================================================
+/// Adjoint mapping of the inverse of _T
+template <typename S>
+Vector6<S> AdInvT(const Isometry3<S>& _T, const Vector6<S>& _V)
+{
+  const Vector3<S> w = _V.template head<3>();
+  const Vector3<S> v = _V.template tail<3>() + w.cross(_T.translation());
+
+  Vector6<S> res;
+  res.template head<3>().noalias() = _T.linear().transpose() * w;
+  res.template tail<3>().noalias() = _T.linear().transpose() * v;
+  return res;
+}
+
+//==============================================================================
+/// Dual adjoint mapping of the inverse of _T
+template <typename S>
+Vector6<S> dAdInvT(const Isometry3<S>& _T, const Vector6<S>& _F)
+{
+  Vector6<S> res;
+  res.template tail<3>().noalias() = _T.linear() * _F.template tail<3>();
+  res.template head<3>().noalias() = _T.linear() * _F.template head<3>();
+  res.template head<3>() += _T.translation().cross(res.template tail<3>());
+  return res;
+}
+
+//==============================================================================
+/// Adjoint mapping: (w_X x w_Y, w_X x v_Y + v_X x w_Y)
+template <typename S>
+Vector6<S> ad(const Vector6<S>& _X, const Vector6<S>& _Y)
+{
+  const Vector3<S> wX = _X.template head<3>();
+  const Vector3<S> vX = _X.template tail<3>();
+  const Vector3<S> wY = _Y.template head<3>();
+  const Vector3<S> vY = _Y.template tail<3>();
+
+  Vector6<S> res;
+  res << wX.cross(wY), wX.cross(vY) + vX.cross(wY);
+  return res;
+}
+
+//==============================================================================
+/// Dual adjoint mapping: (m x w + f x v, f x w), where _s = (w, v) and
+/// _t = (m, f)
+template <typename S>
+Vector6<S> dad(const Vector6<S>& _s, const Vector6<S>& _t)
+{
+  const Vector3<S> w = _s.template head<3>();
+  const Vector3<S> v = _s.template tail<3>();
+  const Vector3<S> m = _t.template head<3>();
+  const Vector3<S> f = _t.template tail<3>();
+
+  Vector6<S> res;
+  res << m.cross(w) + f.cross(v), f.cross(w);
+  return res;
+}
+
+//==============================================================================
+/// Spatial inertia _I transformed by _T, i.e. Ad(T)^T * I * Ad(T)
+template <typename S>
+Matrix6<S> transformInertia(const Isometry3<S>& _T, const Matrix6<S>& _I)
+{
+  // With Ad(T) = | R    0 |  and  I = | A    B |,
+  //              | [p]R R |           | B^T  C |
+  //
+  // Ad(T)^T * I * Ad(T) = | R^T X R    R^T Y R |
+  //                       | R^T Y^T R  R^T C R |
+  //
+  // where X = A + B[p] - [p]B^T - [p]C[p] and Y = B - [p]C.
+  const Matrix3<S> R = _T.linear();
+  const Matrix3<S> P = makeSkewSymmetric<S>(_T.translation());
+  const Matrix3<S> B = _I.template topRightCorner<3, 3>();
+  const Matrix3<S> C = _I.template bottomRightCorner<3, 3>();
+
+  const Matrix3<S> Y = B - P*C;
+  const Matrix3<S> X = _I.template topLeftCorner<3, 3>() + B*P - P*Y.transpose();
+
+  Matrix6<S> res;
+  res.template topLeftCorner<3, 3>().noalias() = R.transpose() * X * R;
+  res.template topRightCorner<3, 3>().noalias() = R.transpose() * Y * R;
+  res.template bottomLeftCorner<3, 3>()
+      = res.template topRightCorner<3, 3>().transpose();
+  res.template bottomRightCorner<3, 3>().noalias() = R.transpose() * C * R;
+  return res;
+}
+
+}  // namespace math
+}  // namespace dart
+
+#endif  // DART_MATH_SPATIALALGEBRA_H_
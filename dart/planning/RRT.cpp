@@ -44,7 +44,10 @@
 #include "RRT.h"
 #include "dart/simulation/World.h"
 #include "dart/dynamics/Skeleton.h"
+#include "dart/dynamics/BodyNode.h"
+#include "dart/dynamics/DegreeOfFreedom.h"
 #include <flann/flann.hpp>
+#include <set>
 
 using namespace std;
 using namespace Eigen;
@@ -55,6 +58,27 @@ using namespace dynamics;
 namespace dart {
 namespace planning {
 
+/* ********************************************************************************************* */
+/// Returns the body nodes of the robot whose transforms depend on the given dofs, which are the
+/// only ones collision checking needs to test when the planner changes these dofs
+static vector<BodyNode*> findMovingBodyNodes(const SkeletonPtr& robot, const vector<size_t>& dofs) {
+	set<const Joint*> joints;
+	for(size_t i = 0; i < dofs.size(); i++)
+		joints.insert(robot->getDof(dofs[i])->getJoint());
+
+	vector<BodyNode*> bodyNodes;
+	for(size_t i = 0; i < robot->getNumBodyNodes(); i++) {
+		BodyNode* bodyNode = robot->getBodyNode(i);
+		for(BodyNode* bn = bodyNode; bn != nullptr; bn = bn->getParentBodyNode()) {
+			if(joints.count(bn->getParentJoint())) {
+				bodyNodes.push_back(bodyNode);
+				break;
+			}
+		}
+	}
+	return bodyNodes;
+}
+
 /* ********************************************************************************************* */
 RRT::RRT(WorldPtr world, SkeletonPtr robot, const std::vector<size_t> &dofs,
   const VectorXd &root, double stepSize) :
@@ -63,6 +87,7 @@ RRT::RRT(WorldPtr world, SkeletonPtr robot, const std::vector<size_t> &dofs,
 	world(world),
 	robot(robot),
 	dofs(dofs),
+	movingBodyNodes(findMovingBodyNodes(robot, dofs)),
   index(new flann::Index<flann::L2<double> >(flann::KDTreeSingleIndexParams()))
 {
 	// Reset the random number generator and add the given start configuration to the flann structure
@@ -77,6 +102,7 @@ RRT::RRT(WorldPtr world, SkeletonPtr robot, const std::vector<size_t> &dofs, con
 	world(world),
 	robot(robot),
 	dofs(dofs),
+	movingBodyNodes(findMovingBodyNodes(robot, dofs)),
 	index(new flann::Index<flann::L2<double> >(flann::KDTreeSingleIndexParams()))
 {
 	// Reset the random number generator and add the given start configurations to the flann structure
@@ -223,7 +249,7 @@ void RRT::tracePath(int node, std::list<VectorXd> &path, bool reverse) {
 /* ********************************************************************************************* */
 bool RRT::checkCollisions(const VectorXd &c) {
   robot->setPositions(dofs, c);
-	return world->checkCollision();
+	return world->checkCollision(movingBodyNodes);
 }
 
 /* ********************************************************************************************* */
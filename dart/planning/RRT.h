@@ -149,6 +149,7 @@ protected:
   simulation::WorldPtr world;                 ///< The world that the robot is in
   dynamics::SkeletonPtr robot;        ///< The ID of the robot for which a plan is generated
 	std::vector<size_t> dofs;                    ///< The dofs of the robot the planner can manipulate
+	std::vector<dynamics::BodyNode*> movingBodyNodes; ///< The body nodes moved by the dofs
 
 	/// The underlying flann data structure for fast nearest neighbor searches 
 	flann::Index<flann::L2<double> >* index;
@@ -43,7 +43,9 @@
 #include "dart/dynamics/Shape.h"
 #include "dart/dynamics/BoxShape.h"
 #include "dart/dynamics/CylinderShape.h"
+#include "dart/dynamics/CapsuleShape.h"
 #include "dart/dynamics/EllipsoidShape.h"
+#include "dart/dynamics/HeightmapShape.h"
 #include "dart/dynamics/MeshShape.h"
 #include "dart/dynamics/LineSegmentShape.h"
 #include "dart/renderer/LoadOpengl.h"
@@ -419,6 +421,8 @@ void OpenGLRenderInterface::compileList(dynamics::Shape* _shape) {
             break;
         case dynamics::Shape::CYLINDER:
             break;
+        case dynamics::Shape::CAPSULE:
+            break;
         case dynamics::Shape::ELLIPSOID:
             break;
         case dynamics::Shape::PLANE:
@@ -443,6 +447,9 @@ void OpenGLRenderInterface::compileList(dynamics::Shape* _shape) {
         case dynamics::Shape::LINE_SEGMENT:
             // Do nothing
             break;
+        case dynamics::Shape::HEIGHTMAP:
+            // Do nothing
+            break;
     }
 }
 
@@ -532,6 +539,18 @@ void OpenGLRenderInterface::draw(dynamics::Shape* _shape) {
             drawCylinder(cylinder->getRadius(), cylinder->getHeight());
             break;
         }
+        case dynamics::Shape::CAPSULE: {
+            dynamics::CapsuleShape* capsule = static_cast<dynamics::CapsuleShape*>(_shape);
+            const double radius = capsule->getRadius();
+            const double height = capsule->getHeight();
+            const Eigen::Vector3d sphereSize = Eigen::Vector3d::Constant(2.0 * radius);
+            drawCylinder(radius, height);
+            glTranslated(0.0, 0.0, 0.5 * height);
+            drawEllipsoid(sphereSize);
+            glTranslated(0.0, 0.0, -height);
+            drawEllipsoid(sphereSize);
+            break;
+        }
         case dynamics::Shape::ELLIPSOID: {
             //FIXME: We are not in a glut instance
             dynamics::EllipsoidShape* ellipsoid = static_cast<dynamics::EllipsoidShape*>(_shape);
@@ -565,6 +584,31 @@ void OpenGLRenderInterface::draw(dynamics::Shape* _shape) {
           static_cast<dynamics::LineSegmentShape*>(_shape);
         drawLineSegments(lineSegments->getVertices(),
                          lineSegments->getConnections());
+        break;
+      }
+      case dynamics::Shape::HEIGHTMAP: {
+        dynamics::HeightmapShape* heightmap =
+          static_cast<dynamics::HeightmapShape*>(_shape);
+        glBegin(GL_TRIANGLES);
+        for(size_t i = 0; i + 1 < heightmap->getNumRows(); ++i) {
+          for(size_t j = 0; j + 1 < heightmap->getNumCols(); ++j) {
+            const Eigen::Vector3d v00 = heightmap->getVertex(i, j);
+            const Eigen::Vector3d v01 = heightmap->getVertex(i, j + 1);
+            const Eigen::Vector3d v10 = heightmap->getVertex(i + 1, j);
+            const Eigen::Vector3d v11 = heightmap->getVertex(i + 1, j + 1);
+            const Eigen::Vector3d* triangles[2][3] = {
+              {&v00, &v01, &v11}, {&v00, &v11, &v10}};
+            for(const auto& triangle : triangles) {
+              const Eigen::Vector3d normal = (*triangle[1] - *triangle[0]).cross(
+                  *triangle[2] - *triangle[0]).normalized();
+              glNormal3d(normal[0], normal[1], normal[2]);
+              for(const Eigen::Vector3d* v : triangle)
+                glVertex3d((*v)[0], (*v)[1], (*v)[2]);
+            }
+          }
+        }
+        glEnd();
+        break;
       }
     }
 
@@ -42,14 +42,22 @@
 
 #include "dart/simulation/World.h"
 
+#include <algorithm>
 #include <iostream>
 #include <string>
+#include <typeinfo>
 #include <vector>
 
 #include "dart/common/Console.h"
+#include "dart/common/Parallel.h"
 #include "dart/integration/SemiImplicitEulerIntegrator.h"
+#include "dart/dynamics/BodyNode.h"
+#include "dart/dynamics/Joint.h"
 #include "dart/dynamics/Skeleton.h"
 #include "dart/constraint/ConstraintSolver.h"
+#include "dart/constraint/DantzigLCPSolver.h"
+#include "dart/constraint/LCPSolver.h"
+#include "dart/collision/CollisionDetector.h"
 
 namespace dart {
 namespace simulation {
@@ -210,6 +218,379 @@ int World::getSimFrames() const
   return mFrame;
 }
 
+//==============================================================================
+World::State World::getState() const
+{
+  State state;
+  state.mTime = mTime;
+  state.mFrame = mFrame;
+
+  const size_t numSkeletons = mSkeletons.size();
+  state.mPositions.reserve(numSkeletons);
+  state.mVelocities.reserve(numSkeletons);
+  state.mForces.reserve(numSkeletons);
+  state.mCommands.reserve(numSkeletons);
+  state.mExternalForces.resize(numSkeletons);
+
+  for (size_t i = 0; i < numSkeletons; ++i)
+  {
+    const dynamics::SkeletonPtr& skel = mSkeletons[i];
+
+    state.mPositions.push_back(skel->getPositions());
+    state.mVelocities.push_back(skel->getVelocities());
+    state.mForces.push_back(skel->getForces());
+    state.mCommands.push_back(skel->getCommands());
+
+    const size_t numBodyNodes = skel->getNumBodyNodes();
+    state.mExternalForces[i].reserve(numBodyNodes);
+    for (size_t j = 0; j < numBodyNodes; ++j)
+    {
+      state.mExternalForces[i].push_back(
+            skel->getBodyNode(j)->getExternalForceLocal());
+    }
+  }
+
+  return state;
+}
+
+//==============================================================================
+void World::setState(const State& _state)
+{
+  if (_state.mPositions.size() != mSkeletons.size())
+  {
+    dterr << "[World::setState] The State holds "
+          << _state.mPositions.size() << " Skeletons, but World [" << mName
+          << "] has " << mSkeletons.size() << ".\n";
+    return;
+  }
+
+  mTime = _state.mTime;
+  mFrame = _state.mFrame;
+
+  for (size_t i = 0; i < mSkeletons.size(); ++i)
+  {
+    const dynamics::SkeletonPtr& skel = mSkeletons[i];
+
+    skel->setPositions(_state.mPositions[i]);
+    skel->setVelocities(_state.mVelocities[i]);
+    skel->setForces(_state.mForces[i]);
+    skel->setCommands(_state.mCommands[i]);
+
+    const Eigen::aligned_vector<Eigen::Vector6d>& externalForces
+        = _state.mExternalForces[i];
+    assert(externalForces.size() == skel->getNumBodyNodes());
+    for (size_t j = 0; j < externalForces.size(); ++j)
+    {
+      dynamics::BodyNode* bodyNode = skel->getBodyNode(j);
+      bodyNode->setExtForce(externalForces[j].tail<3>(),
+                            Eigen::Vector3d::Zero(), true, true);
+      bodyNode->setExtTorque(externalForces[j].head<3>(), true);
+    }
+  }
+}
+
+//==============================================================================
+World::LinearizationMethod World::linearize(
+    const dynamics::SkeletonPtr& _skeleton,
+    Eigen::MatrixXd& _A, Eigen::MatrixXd& _B,
+    size_t _numThreads, double _perturbation)
+{
+  return computeLinearization(_skeleton, _A, _B, nullptr, _numThreads,
+                              _perturbation);
+}
+
+//==============================================================================
+World::LinearizationMethod World::linearize(
+    const dynamics::SkeletonPtr& _skeleton,
+    Eigen::MatrixXd& _A, Eigen::MatrixXd& _B,
+    Eigen::VectorXd& _dNextdFriction,
+    size_t _numThreads, double _perturbation)
+{
+  return computeLinearization(_skeleton, _A, _B, &_dNextdFriction,
+                              _numThreads, _perturbation);
+}
+
+//==============================================================================
+World::LinearizationMethod World::computeLinearization(
+    const dynamics::SkeletonPtr& _skeleton,
+    Eigen::MatrixXd& _A, Eigen::MatrixXd& _B,
+    Eigen::VectorXd* _dNextdFriction,
+    size_t _numThreads, double _perturbation)
+{
+  const auto it = std::find(mSkeletons.begin(), mSkeletons.end(), _skeleton);
+  if (it == mSkeletons.end())
+  {
+    dterr << "[World::linearize] The Skeleton is not in World [" << mName
+          << "].\n";
+    return LINEARIZATION_FAILED;
+  }
+
+  const size_t skelIndex = it - mSkeletons.begin();
+  const size_t numDofs = _skeleton->getNumDofs();
+  if (numDofs == 0)
+  {
+    dtwarn << "[World::linearize] The Skeleton [" << _skeleton->getName()
+           << "] has no degrees of freedom.\n";
+    return LINEARIZATION_FAILED;
+  }
+
+  _A.resize(2*numDofs, 2*numDofs);
+  _B.resize(2*numDofs, numDofs);
+  if (_dNextdFriction)
+    _dNextdFriction->resize(2*numDofs);
+
+  //----------------------------------------------------------------------------
+  // Analytic derivatives
+  //----------------------------------------------------------------------------
+  bool isConstrained = mConstraintSolver->getNumConstraints() > 0;
+
+  for (size_t i = 0; i < _skeleton->getNumBodyNodes() && !isConstrained; ++i)
+    isConstrained = _skeleton->getBodyNode(i)->isCCDEnabled();
+
+  for (size_t i = 0; i < _skeleton->getNumJoints() && !isConstrained; ++i)
+  {
+    const dynamics::Joint* joint = _skeleton->getJoint(i);
+    if (!joint->isPositionLimitEnforced())
+      continue;
+
+    for (size_t j = 0; j < joint->getNumDofs(); ++j)
+    {
+      if (joint->getPosition(j) <= joint->getPositionLowerLimit(j)
+          || joint->getPosition(j) >= joint->getPositionUpperLimit(j))
+        isConstrained = true;
+    }
+  }
+
+  if (!isConstrained)
+    isConstrained = checkCollision(_skeleton->getBodyNodes());
+
+  constraint::DantzigLCPSolver* dantzig
+      = dynamic_cast<constraint::DantzigLCPSolver*>(
+        mConstraintSolver->getLCPSolver());
+  const bool isRecording = dantzig && dantzig->isRecordingEnabled();
+
+  // The contacts of the last step belong to the user, and the information
+  // that the collision detector carries over from one step to the next, e.g.,
+  // the contact forces for warm starting, must not leak out of the steps
+  // below. It is cleared before each of them so that they all start alike,
+  // and in the end, when the contacts are restored.
+  collision::CollisionDetector* detector
+      = mConstraintSolver->getCollisionDetector();
+  const std::vector<collision::ContactRecord> contacts
+      = detector->getContactRecords();
+
+  Eigen::MatrixXd dAccdPos;
+  Eigen::MatrixXd dAccdVel;
+  Eigen::MatrixXd dAccdForce;
+  if (_skeleton->isMobile() && (!isConstrained || isRecording)
+      && _skeleton->computeForwardDynamicsDerivatives(
+        dAccdPos, dAccdVel, dAccdForce))
+  {
+    const Eigen::MatrixXd I = Eigen::MatrixXd::Identity(numDofs, numDofs);
+
+    // Derivatives of the velocities after step() integrates dq' = dq + h*ddq
+    Eigen::MatrixXd dVeldPos = mTimeStep * dAccdPos;
+    Eigen::MatrixXd dVeldVel = I + mTimeStep * dAccdVel;
+    Eigen::MatrixXd dVeldForce = mTimeStep * dAccdForce;
+    Eigen::VectorXd dVeldFriction = Eigen::VectorXd::Zero(numDofs);
+
+    bool isDifferentiable = true;
+    if (isConstrained)
+    {
+      // Step once to record the active sets of the LCPs. The impulses change
+      // the velocities by G * x, where x depends on the velocities before the
+      // impulses through b = -J * dq' + bias(q).
+      Eigen::MatrixXd P = I;
+      Eigen::MatrixXd Q = Eigen::MatrixXd::Zero(numDofs, numDofs);
+
+      const State state = getState();
+      const std::vector<constraint::LCPRecord> userRecords
+          = dantzig->getRecords();
+      detector->clearContactHistory();
+      step();
+
+      for (const constraint::LCPRecord& record : dantzig->getRecords())
+      {
+        if (!record.mIsValid)
+        {
+          isDifferentiable = false;
+          break;
+        }
+
+        const auto it = std::find(record.mSkeletons.begin(),
+                                  record.mSkeletons.end(), _skeleton.get());
+        if (it == record.mSkeletons.end())
+          continue;
+
+        const size_t offset
+            = record.mDofOffsets[it - record.mSkeletons.begin()];
+
+        Eigen::MatrixXd dImpulsedBias;
+        Eigen::VectorXd dImpulsedFriction;
+        record.computeImpulseDerivatives(dImpulsedBias, dImpulsedFriction);
+
+        const auto G = record.mImpulseResponse.middleRows(offset, numDofs);
+        const Eigen::MatrixXd GX = G * dImpulsedBias;
+        const auto J = record.mJacobian.middleCols(offset, numDofs);
+
+        P.noalias() -= GX * J;
+        Q.noalias() += GX * record.mErrorReductionGains.asDiagonal() * J;
+        dVeldFriction.noalias() += G * dImpulsedFriction;
+      }
+
+      dantzig->setRecords(userRecords);
+      setState(state);
+      detector->clearContactHistory();
+      detector->setContactRecords(contacts);
+
+      dVeldPos = P * dVeldPos + Q;
+      dVeldVel = P * dVeldVel;
+      dVeldForce = P * dVeldForce;
+    }
+
+    if (isDifferentiable)
+    {
+      // step() then integrates q' = q + h*dq'
+      _A.bottomLeftCorner(numDofs, numDofs) = dVeldPos;
+      _A.bottomRightCorner(numDofs, numDofs) = dVeldVel;
+      _A.topLeftCorner(numDofs, numDofs) = I + mTimeStep * dVeldPos;
+      _A.topRightCorner(numDofs, numDofs) = mTimeStep * dVeldVel;
+
+      _B.bottomRows(numDofs) = dVeldForce;
+      _B.topRows(numDofs) = mTimeStep * dVeldForce;
+
+      if (_dNextdFriction)
+      {
+        _dNextdFriction->tail(numDofs) = dVeldFriction;
+        _dNextdFriction->head(numDofs) = mTimeStep * dVeldFriction;
+      }
+
+      return ANALYTIC_DERIVATIVES;
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // Finite differences
+  //----------------------------------------------------------------------------
+  // The last direction perturbs the friction coefficients, if requested
+  const size_t numDirections = 3*numDofs + (_dNextdFriction ? 1 : 0);
+
+  _numThreads = common::getNumParallelThreads(_numThreads, numDirections);
+
+  if (mConstraintSolver->getNumConstraints() > 0)
+    _numThreads = 1;
+
+  const State state = getState();
+
+  std::vector<constraint::LCPRecord> userRecords;
+  if (isRecording)
+    userRecords = dantzig->getRecords();
+
+  // Friction coefficients of the BodyNodes of each Skeleton, which the
+  // clones share
+  std::vector<std::vector<double>> frictionCoeffs(mSkeletons.size());
+  for (size_t i = 0; i < mSkeletons.size() && _dNextdFriction; ++i)
+  {
+    for (size_t k = 0; k < mSkeletons[i]->getNumBodyNodes(); ++k)
+    {
+      frictionCoeffs[i].push_back(
+            mSkeletons[i]->getBodyNode(k)->getFrictionCoeff());
+    }
+  }
+
+  auto setFrictionCoeffs = [&](World* _world, double _delta)
+  {
+    for (size_t i = 0; i < _world->mSkeletons.size(); ++i)
+    {
+      for (size_t k = 0; k < frictionCoeffs[i].size(); ++k)
+      {
+        _world->mSkeletons[i]->getBodyNode(k)->setFrictionCoeff(
+              std::max(frictionCoeffs[i][k] + _delta, 0.0));
+      }
+    }
+  };
+
+  std::vector<WorldPtr> clones;
+  clones.reserve(_numThreads - 1);
+  for (size_t i = 1; i < _numThreads; ++i)
+  {
+    WorldPtr clone = this->clone();
+    constraint::ConstraintSolver* solver = clone->getConstraintSolver();
+
+    if (typeid(*solver->getCollisionDetector())
+          != typeid(*mConstraintSolver->getCollisionDetector())
+        || !solver->getLCPSolver() || !mConstraintSolver->getLCPSolver()
+        || typeid(*solver->getLCPSolver())
+          != typeid(*mConstraintSolver->getLCPSolver()))
+    {
+      clones.clear();
+      _numThreads = 1;
+      break;
+    }
+
+    solver->setMaxNumContactsPerPair(
+          mConstraintSolver->getMaxNumContactsPerPair());
+    clone->setState(state);
+    clones.push_back(clone);
+  }
+
+  // The first thread differentiates this World, and the others their clones
+  auto differentiate = [&](size_t _thread, size_t _begin, size_t _end)
+  {
+    World* world = (_thread == 0) ? this : clones[_thread - 1].get();
+    const dynamics::SkeletonPtr& skel = world->mSkeletons[skelIndex];
+    Eigen::VectorXd next[2] = { Eigen::VectorXd(2*numDofs),
+                                Eigen::VectorXd(2*numDofs) };
+
+    for (size_t j = _begin; j < _end; ++j)
+    {
+      for (size_t s = 0; s < 2; ++s)
+      {
+        const double delta = (s == 0) ? _perturbation : -_perturbation;
+
+        world->setState(state);
+        if (j < numDofs)
+          skel->setPosition(j, state.mPositions[skelIndex][j] + delta);
+        else if (j < 2*numDofs)
+          skel->setVelocity(j - numDofs,
+                            state.mVelocities[skelIndex][j - numDofs] + delta);
+        else if (j < 3*numDofs)
+          skel->setForce(j - 2*numDofs,
+                         state.mForces[skelIndex][j - 2*numDofs] + delta);
+        else
+          setFrictionCoeffs(world, delta);
+
+        world->getConstraintSolver()->getCollisionDetector()
+            ->clearContactHistory();
+        world->step();
+
+        next[s].head(numDofs) = skel->getPositions();
+        next[s].tail(numDofs) = skel->getVelocities();
+      }
+
+      if (j < 2*numDofs)
+        _A.col(j) = (next[0] - next[1]) / (2.0 * _perturbation);
+      else if (j < 3*numDofs)
+        _B.col(j - 2*numDofs) = (next[0] - next[1]) / (2.0 * _perturbation);
+      else
+      {
+        *_dNextdFriction = (next[0] - next[1]) / (2.0 * _perturbation);
+        setFrictionCoeffs(world, 0.0);
+      }
+    }
+  };
+
+  common::parallelFor(numDirections, _numThreads, differentiate);
+
+  setState(state);
+  if (isRecording)
+    dantzig->setRecords(userRecords);
+  detector->clearContactHistory();
+  detector->setContactRecords(contacts);
+
+  return FINITE_DIFFERENCES;
+}
+
 //==============================================================================
 const std::string& World::setName(const std::string& _newName)
 {
@@ -494,6 +875,13 @@ bool World::checkCollision(bool _checkAllCollisions)
         _checkAllCollisions, false);
 }
 
+//==============================================================================
+bool World::checkCollision(const std::vector<dynamics::BodyNode*>& _bodyNodes)
+{
+  return mConstraintSolver->getCollisionDetector()->checkCollision(
+        _bodyNodes);
+}
+
 //==============================================================================
 constraint::ConstraintSolver* World::getConstraintSolver() const
 {
@@ -516,8 +904,9 @@ void World::bake()
   for (int i = 0; i < nContacts; i++)
   {
     int begin = getIndex(nSkeletons) + i * 6;
-    state.segment(begin, 3)     = cd->getContact(i).point;
-    state.segment(begin + 3, 3) = cd->getContact(i).force;
+    const collision::ContactRecord& contact = cd->getContactRecord(i);
+    state.segment(begin, 3)     = contact.point;
+    state.segment(begin + 3, 3) = contact.force;
   }
   mRecording->addState(state);
 }
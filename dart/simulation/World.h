@@ -81,6 +81,47 @@ public:
       = common::Signal<void(const std::string& _oldName,
                             const std::string& _newName)>;
 
+  /// Snapshot of the time and of the dynamic state of every Skeleton in a
+  /// World. A State can be restored into the World it was taken from or into
+  /// a clone of that World.
+  struct State
+  {
+    /// Simulation time
+    double mTime;
+
+    /// Simulation frame number
+    int mFrame;
+
+    /// Generalized positions of each Skeleton
+    std::vector<Eigen::VectorXd> mPositions;
+
+    /// Generalized velocities of each Skeleton
+    std::vector<Eigen::VectorXd> mVelocities;
+
+    /// Generalized forces of each Skeleton
+    std::vector<Eigen::VectorXd> mForces;
+
+    /// Commands of each Skeleton
+    std::vector<Eigen::VectorXd> mCommands;
+
+    /// External forces of the BodyNodes of each Skeleton, expressed in the
+    /// BodyNode frames
+    std::vector<Eigen::aligned_vector<Eigen::Vector6d>> mExternalForces;
+  };
+
+  /// How linearize() computed the Jacobians
+  enum LinearizationMethod
+  {
+    /// Nothing was computed because of an error
+    LINEARIZATION_FAILED = 0,
+
+    /// The derivatives were computed analytically
+    ANALYTIC_DERIVATIVES,
+
+    /// The derivatives were approximated by central finite differences
+    FINITE_DIFFERENCES
+  };
+
   //--------------------------------------------------------------------------
   // Constructor and Destructor
   //--------------------------------------------------------------------------
@@ -174,6 +215,12 @@ public:
   /// Return whether there is any collision between bodies
   bool checkCollision(bool _checkAllCollisions = false);
 
+  /// Return whether any of _bodyNodes collides with another body. Only the
+  /// given body nodes are tested, against every other body, and no contacts
+  /// are computed, which makes this query much cheaper than the full
+  /// checkCollision() when a planner moves a few body nodes at a time.
+  bool checkCollision(const std::vector<dynamics::BodyNode*>& _bodyNodes);
+
   //--------------------------------------------------------------------------
   // Simulation
   //--------------------------------------------------------------------------
@@ -198,6 +245,78 @@ public:
   /// getSimpleFrame()
   int getSimFrames() const;
 
+  /// Take a snapshot of the time and of the state of the Skeletons
+  State getState() const;
+
+  /// Restore a snapshot that was taken with getState(). The State must come
+  /// from this World or from a World with the same Skeletons.
+  void setState(const State& _state);
+
+  /// Compute the linearization of step() for _skeleton around the current
+  /// state, i.e., the Jacobians _A and _B of x_{k+1} = f(x_k, u_k), where
+  /// x = [q; dq] are the generalized positions and velocities of _skeleton
+  /// and u are its generalized forces. The other Skeletons are held fixed.
+  ///
+  /// If _skeleton has analytic dynamics derivatives (see
+  /// Skeleton::hasAnalyticDynamicsDerivatives()) and is not affected by any
+  /// constraint, i.e., it is not in contact, no BodyNode uses continuous
+  /// collision detection, no enforced joint limit is reached and no
+  /// constraints were added to the constraint solver, the derivatives are
+  /// computed analytically and ANALYTIC_DERIVATIVES is returned.
+  ///
+  /// If the LCP solver of the constraint solver is a DantzigLCPSolver with the
+  /// recording enabled, a constrained _skeleton with analytic dynamics
+  /// derivatives is differentiated analytically as well, and
+  /// ANALYTIC_DERIVATIVES is returned. This World is stepped once to record
+  /// the active sets of the LCPs, and the derivatives of the impulses (see
+  /// LCPRecord) are chained with those of the unconstrained dynamics. The
+  /// contact geometry is held fixed apart from the penetration depths, so the
+  /// derivatives with respect to the positions are approximate. A group of
+  /// constraints whose error reduction gains are unknown (see
+  /// ConstraintBase::getErrorReductionGains()), e.g., one with a ball or weld
+  /// joint constraint, falls back to finite differences.
+  ///
+  /// Otherwise, the derivatives are computed by central finite differences
+  /// with the step _perturbation, and FINITE_DIFFERENCES is returned. The 3n
+  /// perturbed pairs of steps are distributed across _numThreads workers: the
+  /// calling thread steps this World and every other worker steps its own
+  /// clone of it, and the snapshot of the current state is restored before
+  /// every perturbed step. Clones lack the constraints that were added to the
+  /// constraint solver and use the default collision detector and LCP solver,
+  /// so a single worker is used if this World has any of those. If
+  /// _numThreads is zero, the number of hardware threads will be used. The
+  /// state of this World is restored in the end.
+  ///
+  /// LINEARIZATION_FAILED is returned if _skeleton is not in this World or
+  /// has no degrees of freedom.
+  ///
+  /// If the LCP solver records the LCPs, the records of the last step() are
+  /// saved before the World is stepped and restored in the end. So are the
+  /// contacts of the collision detector. The information that the collision
+  /// detector carries over to the next detection, e.g., the contact forces
+  /// that BulletCollisionDetector keeps for warm starting, is cleared (see
+  /// CollisionDetector::clearContactHistory()) before each of the steps, so
+  /// that they all start alike, and in the end, so that none of them leaks
+  /// into the next step(). That step() starts without warm start.
+  LinearizationMethod linearize(const dynamics::SkeletonPtr& _skeleton,
+                                Eigen::MatrixXd& _A, Eigen::MatrixXd& _B,
+                                size_t _numThreads = 0,
+                                double _perturbation = 1e-6);
+
+  /// Same as the linearize() above, but also compute the derivative
+  /// _dNextdFriction of x_{k+1} with respect to a common change of the
+  /// friction coefficients of all the contacts. Analytically, the derivatives
+  /// of the impulses of every recorded LCP that involves _skeleton (see
+  /// LCPRecord::computeImpulseDerivatives()) are used. The finite differences
+  /// perturb the friction coefficients of all the BodyNodes of this World
+  /// instead, which changes the coefficient of each contact, the minimum of
+  /// those of its two BodyNodes, by the same amount.
+  LinearizationMethod linearize(const dynamics::SkeletonPtr& _skeleton,
+                                Eigen::MatrixXd& _A, Eigen::MatrixXd& _B,
+                                Eigen::VectorXd& _dNextdFriction,
+                                size_t _numThreads = 0,
+                                double _perturbation = 1e-6);
+
   //--------------------------------------------------------------------------
   // Constraint
   //--------------------------------------------------------------------------
@@ -213,6 +332,14 @@ public:
 
 protected:
 
+  /// Implementation of linearize(), which skips the derivative with respect
+  /// to the friction coefficients if _dNextdFriction is nullptr
+  LinearizationMethod computeLinearization(
+      const dynamics::SkeletonPtr& _skeleton,
+      Eigen::MatrixXd& _A, Eigen::MatrixXd& _B,
+      Eigen::VectorXd* _dNextdFriction,
+      size_t _numThreads, double _perturbation);
+
   /// Register when a Skeleton's name is changed
   void handleSkeletonNameChange(dynamics::ConstMetaSkeletonPtr _skeleton);
 
@@ -53,6 +53,7 @@
 #include "dart/dynamics/SoftBodyNode.h"
 #include "dart/dynamics/BoxShape.h"
 #include "dart/dynamics/CylinderShape.h"
+#include "dart/dynamics/CapsuleShape.h"
 #include "dart/dynamics/EllipsoidShape.h"
 #include "dart/dynamics/PlaneShape.h"
 #include "dart/dynamics/MeshShape.h"
@@ -840,6 +841,13 @@ dynamics::ShapePtr SkelParser::readShape(
     double                height       = getValueDouble(cylinderEle, "height");
     newShape = dynamics::ShapePtr(new dynamics::CylinderShape(radius, height));
   }
+  else if (hasElement(geometryEle, "capsule"))
+  {
+    tinyxml2::XMLElement* capsuleEle = getElement(geometryEle, "capsule");
+    double                radius     = getValueDouble(capsuleEle, "radius");
+    double                height     = getValueDouble(capsuleEle, "height");
+    newShape = dynamics::ShapePtr(new dynamics::CapsuleShape(radius, height));
+  }
   else if (hasElement(geometryEle, "plane"))
   {
     tinyxml2::XMLElement* planeEle = getElement(geometryEle, "plane");
@@ -39,6 +39,8 @@
 #include "osgDart/render/BoxShapeNode.h"
 #include "osgDart/render/EllipsoidShapeNode.h"
 #include "osgDart/render/CylinderShapeNode.h"
+#include "osgDart/render/CapsuleShapeNode.h"
+#include "osgDart/render/HeightmapShapeNode.h"
 #include "osgDart/render/PlaneShapeNode.h"
 #include "osgDart/render/MeshShapeNode.h"
 #include "osgDart/render/SoftMeshShapeNode.h"
@@ -50,6 +52,8 @@
 #include "dart/dynamics/BoxShape.h"
 #include "dart/dynamics/EllipsoidShape.h"
 #include "dart/dynamics/CylinderShape.h"
+#include "dart/dynamics/CapsuleShape.h"
+#include "dart/dynamics/HeightmapShape.h"
 #include "dart/dynamics/PlaneShape.h"
 #include "dart/dynamics/MeshShape.h"
 #include "dart/dynamics/SoftMeshShape.h"
@@ -204,6 +208,28 @@ void EntityNode::createShapeNode(std::shared_ptr<dart::dynamics::Shape> shape)
       break;
     }
 
+    case Shape::CAPSULE:
+    {
+      std::shared_ptr<CapsuleShape> cs =
+          std::dynamic_pointer_cast<CapsuleShape>(shape);
+      if(cs)
+        node = new render::CapsuleShapeNode(cs, this);
+      else
+        warnAboutUnsuccessfulCast("CapsuleShape", mEntity->getName());
+      break;
+    }
+
+    case Shape::HEIGHTMAP:
+    {
+      std::shared_ptr<HeightmapShape> hs =
+          std::dynamic_pointer_cast<HeightmapShape>(shape);
+      if(hs)
+        node = new render::HeightmapShapeNode(hs, this);
+      else
+        warnAboutUnsuccessfulCast("HeightmapShape", mEntity->getName());
+      break;
+    }
+
     case Shape::PLANE:
     {
       std::shared_ptr<PlaneShape> ps =
@@ -0,0 +1,363 @@
+/*
+ * Copyright (c) 2016, Georgia Tech Research Corporation
+ * All rights reserved.
+ *
+ * Author(s): Michael X. Grey <mxgrey@gatech.edu>
+ *
+ * Georgia Tech Graphics Lab and Humanoid Robotics Lab
+ *
+ * Directed by Prof. C. Karen Liu and Prof. Mike Stilman
+ * <karenliu@cc.gatech.edu> <mstilman@cc.gatech.edu>
+ *
+ * This file is provided under the following "BSD-style" License:
+ *   Redistribution and use in source and binary forms, with or
+ *   without modification, are permitted provided that the following
+ *   conditions are met:
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *   CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *   USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *   AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *   LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *   ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *   POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+
+#include <osg/Geode>
+#include <osg/Geometry>
+
+#include "osgDart/render/HeightmapShapeNode.h"
+#include "osgDart/Utils.h"
+
+#include "dart/dynamics/HeightmapShape.h"
+
+namespace osgDart {
+namespace render {
+
+class HeightmapShapeGeode : public ShapeNode, public osg::Geode
+{
+public:
+
+  HeightmapShapeGeode(dart::dynamics::HeightmapShape* shape,
+                      EntityNode* parentEntity,
+                      HeightmapShapeNode* parentNode);
+
+  void refresh();
+  void extractData(bool firstTime);
+
+protected:
+
+  virtual ~HeightmapShapeGeode();
+
+  dart::dynamics::HeightmapShape* mHeightmapShape;
+
+  /// One drawable per tile of the heightmap, stored row by row
+  std::vector<HeightmapTileDrawable*> mTiles;
+
+  /// Layout of the grid that the tiles were created for
+  size_t mNumRows;
+  size_t mNumCols;
+  size_t mTileSize;
+
+  /// Version of the heightmap that the tiles were last refreshed against
+  size_t mVersion;
+
+};
+
+//==============================================================================
+class HeightmapTileDrawable : public osg::Geometry
+{
+public:
+
+  HeightmapTileDrawable(dart::dynamics::HeightmapShape* shape,
+                        size_t tileRow, size_t tileCol);
+
+  void refresh(bool firstTime);
+
+protected:
+
+  virtual ~HeightmapTileDrawable();
+
+  dart::dynamics::HeightmapShape* mHeightmapShape;
+
+  /// First vertex of the tile
+  size_t mRow;
+  size_t mCol;
+
+  /// Number of vertices of the tile along each side
+  size_t mNumRows;
+  size_t mNumCols;
+
+  /// Index of the tile
+  size_t mTileRow;
+  size_t mTileCol;
+
+  /// Version of the tile that the vertices were built from
+  size_t mVersion;
+
+  osg::ref_ptr<osg::Vec3Array> mVertices;
+  osg::ref_ptr<osg::Vec3Array> mNormals;
+  osg::ref_ptr<osg::Vec4Array> mColors;
+
+};
+
+//==============================================================================
+HeightmapShapeNode::HeightmapShapeNode(
+    std::shared_ptr<dart::dynamics::HeightmapShape> shape,
+    EntityNode* parent)
+  : ShapeNode(shape, parent, this),
+    mHeightmapShape(shape),
+    mGeode(nullptr)
+{
+  extractData(true);
+  setNodeMask(mShape->isHidden()? 0x0 : ~0x0);
+}
+
+//==============================================================================
+void HeightmapShapeNode::refresh()
+{
+  mUtilized = true;
+
+  setNodeMask(mShape->isHidden()? 0x0 : ~0x0);
+
+  if(mShape->getDataVariance() == dart::dynamics::Shape::STATIC)
+    return;
+
+  extractData(false);
+}
+
+//==============================================================================
+void HeightmapShapeNode::extractData(bool firstTime)
+{
+  if(mShape->checkDataVariance(dart::dynamics::Shape::DYNAMIC_TRANSFORM)
+     || firstTime)
+    setMatrix(eigToOsgMatrix(mShape->getLocalTransform()));
+
+  if(nullptr == mGeode)
+  {
+    mGeode = new HeightmapShapeGeode(mHeightmapShape.get(), mParentEntity,
+                                     this);
+    addChild(mGeode);
+    return;
+  }
+
+  mGeode->refresh();
+}
+
+//==============================================================================
+HeightmapShapeNode::~HeightmapShapeNode()
+{
+  // Do nothing
+}
+
+//==============================================================================
+HeightmapShapeGeode::HeightmapShapeGeode(
+    dart::dynamics::HeightmapShape* shape,
+    EntityNode* parentEntity,
+    HeightmapShapeNode* parentNode)
+  : ShapeNode(parentNode->getShape(), parentEntity, this),
+    mHeightmapShape(shape),
+    mNumRows(0),
+    mNumCols(0),
+    mTileSize(0),
+    mVersion(0)
+{
+  getOrCreateStateSet()->setMode(GL_BLEND, osg::StateAttribute::ON);
+  getOrCreateStateSet()->setRenderingHint(osg::StateSet::TRANSPARENT_BIN);
+  extractData(true);
+}
+
+//==============================================================================
+void HeightmapShapeGeode::refresh()
+{
+  mUtilized = true;
+
+  extractData(false);
+}
+
+//==============================================================================
+void HeightmapShapeGeode::extractData(bool firstTime)
+{
+  // The tiles are only recreated if the layout of the grid changed
+  if(   mHeightmapShape->getNumRows() != mNumRows
+     || mHeightmapShape->getNumCols() != mNumCols
+     || mHeightmapShape->getTileSize() != mTileSize)
+  {
+    removeDrawables(0, getNumDrawables());
+    mTiles.clear();
+
+    for(size_t i=0; i < mHeightmapShape->getNumTileRows(); ++i)
+    {
+      for(size_t j=0; j < mHeightmapShape->getNumTileCols(); ++j)
+      {
+        HeightmapTileDrawable* tile =
+            new HeightmapTileDrawable(mHeightmapShape, i, j);
+        addDrawable(tile);
+        mTiles.push_back(tile);
+      }
+    }
+
+    mNumRows = mHeightmapShape->getNumRows();
+    mNumCols = mHeightmapShape->getNumCols();
+    mTileSize = mHeightmapShape->getTileSize();
+    mVersion = mHeightmapShape->getVersion();
+    return;
+  }
+
+  if(   mHeightmapShape->getVersion() == mVersion
+     && !mHeightmapShape->checkDataVariance(
+          dart::dynamics::Shape::DYNAMIC_COLOR)
+     && !firstTime)
+    return;
+
+  for(HeightmapTileDrawable* tile : mTiles)
+    tile->refresh(false);
+
+  mVersion = mHeightmapShape->getVersion();
+}
+
+//==============================================================================
+HeightmapShapeGeode::~HeightmapShapeGeode()
+{
+  // Do nothing
+}
+
+//==============================================================================
+HeightmapTileDrawable::HeightmapTileDrawable(
+    dart::dynamics::HeightmapShape* shape, size_t tileRow, size_t tileCol)
+  : mHeightmapShape(shape),
+    mTileRow(tileRow),
+    mTileCol(tileCol),
+    mVersion(0),
+    mVertices(new osg::Vec3Array),
+    mNormals(new osg::Vec3Array),
+    mColors(new osg::Vec4Array)
+{
+  const size_t tileSize = shape->getTileSize();
+  mRow = tileRow * tileSize;
+  mCol = tileCol * tileSize;
+  mNumRows = std::min(tileSize, shape->getNumRows() - 1 - mRow) + 1;
+  mNumCols = std::min(tileSize, shape->getNumCols() - 1 - mCol) + 1;
+
+  refresh(true);
+}
+
+//==============================================================================
+void HeightmapTileDrawable::refresh(bool firstTime)
+{
+  if(mHeightmapShape->getDataVariance() == dart::dynamics::Shape::STATIC)
+    setDataVariance(osg::Object::STATIC);
+  else
+    setDataVariance(osg::Object::DYNAMIC);
+
+  if(firstTime)
+  {
+    osg::ref_ptr<osg::DrawElementsUInt> elements =
+        new osg::DrawElementsUInt(GL_TRIANGLES);
+    elements->reserve(6*(mNumRows-1)*(mNumCols-1));
+
+    for(size_t i=0; i+1 < mNumRows; ++i)
+    {
+      for(size_t j=0; j+1 < mNumCols; ++j)
+      {
+        const unsigned int v00 = i*mNumCols + j;
+        const unsigned int v01 = v00 + 1;
+        const unsigned int v10 = v00 + mNumCols;
+        const unsigned int v11 = v10 + 1;
+
+        elements->push_back(v00);
+        elements->push_back(v01);
+        elements->push_back(v11);
+        elements->push_back(v00);
+        elements->push_back(v11);
+        elements->push_back(v10);
+      }
+    }
+
+    addPrimitiveSet(elements);
+  }
+
+  const size_t version = mHeightmapShape->getTileVersion(mTileRow, mTileCol);
+  if(version != mVersion || firstTime)
+  {
+    if(mVertices->size() != mNumRows*mNumCols)
+      mVertices->resize(mNumRows*mNumCols);
+
+    if(mNormals->size() != mNumRows*mNumCols)
+      mNormals->resize(mNumRows*mNumCols);
+
+    // Normals come from central differences over the whole grid so that they
+    // match across the borders of the tiles
+    const Eigen::MatrixXd& heights = mHeightmapShape->getHeights();
+    const Eigen::Vector2d& spacing = mHeightmapShape->getSpacing();
+    const size_t lastRow = mHeightmapShape->getNumRows() - 1;
+    const size_t lastCol = mHeightmapShape->getNumCols() - 1;
+
+    for(size_t i=0; i < mNumRows; ++i)
+    {
+      const size_t row = mRow + i;
+      const size_t up = std::min(row + 1, lastRow);
+      const size_t down = row > 0 ? row - 1 : 0;
+
+      for(size_t j=0; j < mNumCols; ++j)
+      {
+        const size_t col = mCol + j;
+        const size_t right = std::min(col + 1, lastCol);
+        const size_t left = col > 0 ? col - 1 : 0;
+
+        const double dzdx = (heights(row, right) - heights(row, left))
+            / ((right - left) * spacing[0]);
+        const double dzdy = (heights(up, col) - heights(down, col))
+            / ((up - down) * spacing[1]);
+
+        const size_t index = i*mNumCols + j;
+        (*mVertices)[index] = eigToOsgVec3(
+              mHeightmapShape->getVertex(row, col));
+        (*mNormals)[index] = eigToOsgVec3(
+              Eigen::Vector3d(-dzdx, -dzdy, 1.0).normalized());
+      }
+    }
+
+    setVertexArray(mVertices);
+    setNormalArray(mNormals, osg::Array::BIND_PER_VERTEX);
+    mVertices->dirty();
+    mNormals->dirty();
+    dirtyBound();
+    dirtyDisplayList();
+
+    mVersion = version;
+  }
+
+  if(   mHeightmapShape->checkDataVariance(dart::dynamics::Shape::DYNAMIC_COLOR)
+     || firstTime)
+  {
+    if(mColors->size() != 1)
+      mColors->resize(1);
+
+    (*mColors)[0] = eigToOsgVec4(mHeightmapShape->getRGBA());
+
+    setColorArray(mColors, osg::Array::BIND_OVERALL);
+  }
+}
+
+//==============================================================================
+HeightmapTileDrawable::~HeightmapTileDrawable()
+{
+  // Do nothing
+}
+
+} // namespace render
+} // namespace osgDart
@@ -35,6 +35,7 @@
  */
 
 #include <iostream>
+#include <set>
 #include <gtest/gtest.h>
 
 #include <fcl/collision.h>
@@ -45,6 +46,11 @@
 #include "dart/common/common.h"
 #include "dart/math/math.h"
 #include "dart/dynamics/dynamics.h"
+#include "dart/collision/dart/DARTCollide.h"
+#include "dart/collision/dart/DARTCollisionDetector.h"
+#ifdef HAVE_BULLET_COLLISION
+  #include "dart/collision/bullet/BulletCollisionDetector.h"
+#endif
 //#include "dart/collision/unc/UNCCollisionDetector.h"
 #include "dart/simulation/simulation.h"
 #include "dart/utils/utils.h"
@@ -504,6 +510,1125 @@ TEST_F(COLLISION, FCL_BOX_BOX)
 
 //}
 
+//==============================================================================
+TEST_F(COLLISION, DARTCollidePlane)
+{
+  const double tol = 1e-9;
+  std::vector<collision::Contact> contacts;
+
+  // Plane z = 0.1 expressed in a frame that is shifted by 0.2 along z
+  PlaneShapePtr plane(new PlaneShape(Eigen::Vector3d::UnitZ(), 0.1));
+  Eigen::Isometry3d planeT = Eigen::Isometry3d::Identity();
+  planeT.translation() = Eigen::Vector3d(0.3, -0.4, 0.2);
+
+  // Sphere of radius 0.5 whose bottom is 0.05 below the plane
+  EllipsoidShapePtr sphere(new EllipsoidShape(Eigen::Vector3d::Constant(1.0)));
+  Eigen::Isometry3d sphereT = Eigen::Isometry3d::Identity();
+  sphereT.translation() = Eigen::Vector3d(1.0, 2.0, 0.3 + 0.45);
+  EXPECT_EQ(collision::collide(sphere, sphereT, plane, planeT, &contacts), 1);
+  ASSERT_EQ(contacts.size(), 1u);
+  EXPECT_NEAR(contacts[0].penetrationDepth, 0.05, tol);
+  EXPECT_TRUE(contacts[0].normal.isApprox(Eigen::Vector3d::UnitZ()));
+
+  // The normal always points from the second shape to the first one
+  contacts.clear();
+  EXPECT_EQ(collision::collide(plane, planeT, sphere, sphereT, &contacts), 1);
+  ASSERT_EQ(contacts.size(), 1u);
+  EXPECT_TRUE(contacts[0].normal.isApprox(-Eigen::Vector3d::UnitZ()));
+
+  // Box resting on the plane touches it with a whole face
+  BoxShapePtr box(new BoxShape(Eigen::Vector3d(0.4, 0.6, 0.2)));
+  Eigen::Isometry3d boxT = Eigen::Isometry3d::Identity();
+  boxT.translation() = Eigen::Vector3d(0.0, 0.0, 0.3 + 0.1 - 0.01);
+  contacts.clear();
+  EXPECT_EQ(collision::collide(box, boxT, plane, planeT, &contacts), 4);
+  for (const collision::Contact& contact : contacts)
+    EXPECT_NEAR(contact.penetrationDepth, 0.01, tol);
+
+  // Capsule lying on the plane touches it at both ends of its axis
+  CapsuleShapePtr capsule(new CapsuleShape(0.1, 0.8));
+  Eigen::Isometry3d capsuleT = Eigen::Isometry3d::Identity();
+  capsuleT.linear() = Eigen::AngleAxisd(0.5 * DART_PI,
+                                        Eigen::Vector3d::UnitX()).matrix();
+  capsuleT.translation() = Eigen::Vector3d(0.0, 0.0, 0.3 + 0.1 - 0.02);
+  contacts.clear();
+  EXPECT_EQ(collision::collide(capsule, capsuleT, plane, planeT, &contacts), 2);
+  ASSERT_EQ(contacts.size(), 2u);
+  EXPECT_NEAR(contacts[0].penetrationDepth, 0.02, tol);
+  EXPECT_NEAR(std::abs(contacts[0].point[1] - contacts[1].point[1]), 0.8, tol);
+
+  // Upright cylinder touches the plane with the rim of its bottom cap
+  CylinderShapePtr cylinder(new CylinderShape(0.2, 0.6));
+  Eigen::Isometry3d cylinderT = Eigen::Isometry3d::Identity();
+  cylinderT.translation() = Eigen::Vector3d(0.0, 0.0, 0.3 + 0.3 - 0.03);
+  contacts.clear();
+  EXPECT_GE(collision::collide(cylinder, cylinderT, plane, planeT, &contacts),
+            3);
+  for (const collision::Contact& contact : contacts)
+  {
+    EXPECT_NEAR(contact.penetrationDepth, 0.03, tol);
+    EXPECT_NEAR(contact.point[2], 0.3 - 0.015, tol);
+  }
+
+  // Tilted cylinder touches it with the lowest point of its bottom rim
+  const double angle = 0.3;
+  cylinderT.linear() = Eigen::AngleAxisd(angle,
+                                         Eigen::Vector3d::UnitY()).matrix();
+  const double lowest = 0.3 * std::cos(angle) + 0.2 * std::sin(angle);
+  cylinderT.translation() = Eigen::Vector3d(0.0, 0.0, 0.3 + lowest - 0.02);
+  contacts.clear();
+  EXPECT_EQ(collision::collide(cylinder, cylinderT, plane, planeT, &contacts),
+            1);
+  ASSERT_EQ(contacts.size(), 1u);
+  EXPECT_NEAR(contacts[0].penetrationDepth, 0.02, tol);
+
+  // Ellipsoid penetrates with its support point along the plane normal
+  EllipsoidShapePtr ellipsoid(
+        new EllipsoidShape(Eigen::Vector3d(0.8, 0.4, 0.2)));
+  Eigen::Isometry3d ellipsoidT = Eigen::Isometry3d::Identity();
+  ellipsoidT.linear() = Eigen::AngleAxisd(angle,
+                                          Eigen::Vector3d::UnitY()).matrix();
+  const double a = 0.4 * std::sin(angle);
+  const double c = 0.1 * std::cos(angle);
+  const double extent = std::sqrt(a * a + c * c);
+  ellipsoidT.translation() = Eigen::Vector3d(0.0, 0.0, 0.3 + extent - 0.01);
+  contacts.clear();
+  EXPECT_EQ(collision::collide(ellipsoid, ellipsoidT, plane, planeT,
+                               &contacts), 1);
+  ASSERT_EQ(contacts.size(), 1u);
+  EXPECT_NEAR(contacts[0].penetrationDepth, 0.01, tol);
+}
+
+//==============================================================================
+TEST_F(COLLISION, DARTCollideCapsule)
+{
+  const double tol = 1e-9;
+  std::vector<collision::Contact> contacts;
+
+  CapsuleShapePtr capsule0(new CapsuleShape(0.1, 1.0));
+  CapsuleShapePtr capsule1(new CapsuleShape(0.2, 0.5));
+  EllipsoidShapePtr sphere(new EllipsoidShape(Eigen::Vector3d::Constant(0.6)));
+
+  // Sphere touching the side of the capsule
+  Eigen::Isometry3d T0 = Eigen::Isometry3d::Identity();
+  Eigen::Isometry3d T1 = Eigen::Isometry3d::Identity();
+  T1.translation() = Eigen::Vector3d(0.35, 0.0, 0.2);
+  EXPECT_EQ(collision::collide(capsule0, T0, sphere, T1, &contacts), 1);
+  ASSERT_EQ(contacts.size(), 1u);
+  EXPECT_NEAR(contacts[0].penetrationDepth, 0.05, tol);
+  EXPECT_TRUE(contacts[0].normal.isApprox(-Eigen::Vector3d::UnitX()));
+
+  // Sphere touching the hemispherical end of the capsule
+  T1.translation() = Eigen::Vector3d(0.0, 0.0, 0.5 + 0.35);
+  contacts.clear();
+  EXPECT_EQ(collision::collide(sphere, T1, capsule0, T0, &contacts), 1);
+  ASSERT_EQ(contacts.size(), 1u);
+  EXPECT_NEAR(contacts[0].penetrationDepth, 0.05, tol);
+  EXPECT_TRUE(contacts[0].normal.isApprox(Eigen::Vector3d::UnitZ()));
+
+  // Crossed capsules
+  T1.linear() = Eigen::AngleAxisd(0.5 * DART_PI,
+                                  Eigen::Vector3d::UnitX()).matrix();
+  T1.translation() = Eigen::Vector3d(0.25, 0.1, 0.1);
+  contacts.clear();
+  EXPECT_EQ(collision::collide(capsule0, T0, capsule1, T1, &contacts), 1);
+  ASSERT_EQ(contacts.size(), 1u);
+  EXPECT_NEAR(contacts[0].penetrationDepth, 0.05, tol);
+  EXPECT_TRUE(contacts[0].normal.isApprox(-Eigen::Vector3d::UnitX()));
+
+  // Parallel capsules report both ends of the overlap of their axes
+  T1.linear().setIdentity();
+  T1.translation() = Eigen::Vector3d(0.28, 0.0, 0.4);
+  contacts.clear();
+  EXPECT_EQ(collision::collide(capsule0, T0, capsule1, T1, &contacts), 2);
+  ASSERT_EQ(contacts.size(), 2u);
+  for (const collision::Contact& contact : contacts)
+  {
+    EXPECT_NEAR(contact.penetrationDepth, 0.02, tol);
+    EXPECT_TRUE(contact.normal.isApprox(-Eigen::Vector3d::UnitX()));
+  }
+  EXPECT_NEAR(std::abs(contacts[0].point[2] - contacts[1].point[2]), 0.35, tol);
+
+  // Capsule lying on a box is supported at both ends
+  BoxShapePtr box(new BoxShape(Eigen::Vector3d(2.0, 2.0, 0.2)));
+  T0.linear() = Eigen::AngleAxisd(0.5 * DART_PI,
+                                  Eigen::Vector3d::UnitY()).matrix();
+  T0.translation() = Eigen::Vector3d(0.0, 0.0, 0.1 + 0.1 - 0.01);
+  T1.setIdentity();
+  contacts.clear();
+  EXPECT_EQ(collision::collide(capsule0, T0, box, T1, &contacts), 2);
+  for (const collision::Contact& contact : contacts)
+  {
+    EXPECT_NEAR(contact.penetrationDepth, 0.01, 1e-6);
+    EXPECT_TRUE(contact.normal.isApprox(Eigen::Vector3d::UnitZ(), 1e-6));
+  }
+}
+
+//==============================================================================
+TEST_F(COLLISION, DARTCollideCylinder)
+{
+  const double tol = 1e-9;
+  std::vector<collision::Contact> contacts;
+
+  CylinderShapePtr cylinder(new CylinderShape(0.2, 0.6));
+  EllipsoidShapePtr sphere(new EllipsoidShape(Eigen::Vector3d::Constant(0.2)));
+
+  // Sphere touching the side, the cap and the rim of the cylinder. The first
+  // one is missed by the box that used to approximate the cylinder.
+  Eigen::Isometry3d T0 = Eigen::Isometry3d::Identity();
+  Eigen::Isometry3d T1 = Eigen::Isometry3d::Identity();
+  T1.translation() = Eigen::Vector3d(0.0, 0.28, 0.1);
+  EXPECT_EQ(collision::collide(cylinder, T0, sphere, T1, &contacts), 1);
+  ASSERT_EQ(contacts.size(), 1u);
+  EXPECT_NEAR(contacts[0].penetrationDepth, 0.02, tol);
+  EXPECT_TRUE(contacts[0].normal.isApprox(-Eigen::Vector3d::UnitY()));
+  EXPECT_TRUE(contacts[0].point.isApprox(Eigen::Vector3d(0.0, 0.19, 0.1), tol));
+
+  T1.translation() = Eigen::Vector3d(0.05, 0.0, 0.37);
+  contacts.clear();
+  EXPECT_EQ(collision::collide(cylinder, T0, sphere, T1, &contacts), 1);
+  ASSERT_EQ(contacts.size(), 1u);
+  EXPECT_NEAR(contacts[0].penetrationDepth, 0.03, tol);
+  EXPECT_TRUE(contacts[0].normal.isApprox(-Eigen::Vector3d::UnitZ()));
+  EXPECT_TRUE(contacts[0].point.isApprox(Eigen::Vector3d(0.05, 0.0, 0.285),
+                                         tol));
+
+  T1.translation() = Eigen::Vector3d(0.25, 0.0, 0.35);
+  contacts.clear();
+  EXPECT_EQ(collision::collide(sphere, T1, cylinder, T0, &contacts), 1);
+  ASSERT_EQ(contacts.size(), 1u);
+  EXPECT_NEAR(contacts[0].penetrationDepth, 0.1 - std::sqrt(0.005), tol);
+  EXPECT_TRUE(contacts[0].normal.isApprox(
+                Eigen::Vector3d(1.0, 0.0, 1.0).normalized()));
+
+  // The contact point is halfway between the rim and the surface of the sphere
+  const Eigen::Vector3d rim(0.2, 0.0, 0.3);
+  EXPECT_TRUE(contacts[0].point.isApprox(
+                rim - 0.5 * contacts[0].penetrationDepth * contacts[0].normal,
+                tol));
+
+  // Sphere close to the rim without touching it
+  T1.translation() = Eigen::Vector3d(0.22, 0.22, 0.36);
+  contacts.clear();
+  EXPECT_EQ(collision::collide(cylinder, T0, sphere, T1, &contacts), 0);
+
+  // Cylinder standing on a box is supported by the rim of its bottom cap
+  BoxShapePtr box(new BoxShape(Eigen::Vector3d(2.0, 2.0, 0.2)));
+  T0.translation() = Eigen::Vector3d(0.0, 0.0, 0.1 + 0.3 - 0.01);
+  T1.setIdentity();
+  contacts.clear();
+  EXPECT_GE(collision::collide(cylinder, T0, box, T1, &contacts), 3);
+  for (const collision::Contact& contact : contacts)
+  {
+    EXPECT_NEAR(contact.penetrationDepth, 0.01, 1e-6);
+    EXPECT_TRUE(contact.normal.isApprox(Eigen::Vector3d::UnitZ(), 1e-6));
+    EXPECT_NEAR(Eigen::Vector2d(contact.point[0], contact.point[1]).norm(),
+                0.2, 1e-6);
+  }
+
+  // Cylinder lying on its side on another cylinder, crossed
+  CylinderShapePtr cylinder1(new CylinderShape(0.3, 2.0));
+  T0.linear() = Eigen::AngleAxisd(0.5 * DART_PI,
+                                  Eigen::Vector3d::UnitX()).matrix();
+  T0.translation() = Eigen::Vector3d(0.0, 0.0, 0.2 + 0.3 - 0.04);
+  T1.linear() = Eigen::AngleAxisd(0.5 * DART_PI,
+                                  Eigen::Vector3d::UnitY()).matrix();
+  T1.translation().setZero();
+  contacts.clear();
+  EXPECT_EQ(collision::collide(cylinder, T0, cylinder1, T1, &contacts), 1);
+  ASSERT_EQ(contacts.size(), 1u);
+  EXPECT_NEAR(contacts[0].penetrationDepth, 0.04, 1e-6);
+  EXPECT_TRUE(contacts[0].normal.isApprox(Eigen::Vector3d::UnitZ(), 1e-6));
+}
+
+//==============================================================================
+TEST_F(COLLISION, DARTCollideEllipsoid)
+{
+  std::vector<collision::Contact> contacts;
+
+  // Ellipsoids are no longer approximated by the sphere of their first axis
+  EllipsoidShapePtr ellipsoid(
+        new EllipsoidShape(Eigen::Vector3d(0.2, 0.2, 1.0)));
+  BoxShapePtr box(new BoxShape(Eigen::Vector3d(1.0, 1.0, 1.0)));
+
+  Eigen::Isometry3d T0 = Eigen::Isometry3d::Identity();
+  Eigen::Isometry3d T1 = Eigen::Isometry3d::Identity();
+  T0.translation() = Eigen::Vector3d(0.0, 0.0, 0.5 + 0.5 - 0.05);
+  EXPECT_EQ(collision::collide(ellipsoid, T0, box, T1, &contacts), 1);
+  ASSERT_EQ(contacts.size(), 1u);
+  EXPECT_NEAR(contacts[0].penetrationDepth, 0.05, 1e-6);
+  EXPECT_TRUE(contacts[0].normal.isApprox(Eigen::Vector3d::UnitZ(), 1e-6));
+
+  T0.translation() = Eigen::Vector3d(0.5 + 0.1 - 0.02, 0.0, 0.0);
+  contacts.clear();
+  EXPECT_EQ(collision::collide(box, T1, ellipsoid, T0, &contacts), 1);
+  ASSERT_EQ(contacts.size(), 1u);
+  EXPECT_NEAR(contacts[0].penetrationDepth, 0.02, 1e-6);
+  EXPECT_TRUE(contacts[0].normal.isApprox(-Eigen::Vector3d::UnitX(), 1e-6));
+
+  // Separated along the short axis, which a sphere of diameter 1.0 would hit
+  T0.translation() = Eigen::Vector3d(0.5 + 0.1 + 0.05, 0.0, 0.0);
+  contacts.clear();
+  EXPECT_EQ(collision::collide(ellipsoid, T0, box, T1, &contacts), 0);
+
+  // Exact distance between separated convex primitives
+  const collision::ConvexSupport core0(
+        collision::ConvexSupport::ELLIPSOID, Eigen::Vector3d(0.1, 0.1, 0.5),
+        T0);
+  const collision::ConvexSupport core1(
+        collision::ConvexSupport::BOX, Eigen::Vector3d::Constant(0.5), T1);
+  Eigen::Vector3d p0;
+  Eigen::Vector3d p1;
+  EXPECT_NEAR(collision::computeConvexDistance(core0, core1, &p0, &p1), 0.05,
+              1e-6);
+  EXPECT_NEAR(p0[0], 0.55, 1e-6);
+  EXPECT_NEAR(p1[0], 0.5, 1e-6);
+}
+
+//==============================================================================
+TEST_F(COLLISION, MeshShapeCollisionMode)
+{
+  // Corners of a unit cube and a dent towards its center
+  aiScene* scene = new aiScene;
+  scene->mNumMeshes = 1;
+  scene->mMeshes = new aiMesh*[1];
+  aiMesh* mesh = new aiMesh;
+  scene->mMeshes[0] = mesh;
+  mesh->mNumVertices = 9;
+  mesh->mVertices = new aiVector3D[9];
+  for (unsigned int i = 0; i < 8; ++i)
+  {
+    mesh->mVertices[i].Set((i & 1) ? 0.5f : -0.5f, (i & 2) ? 0.5f : -0.5f,
+                           (i & 4) ? 0.5f : -0.5f);
+  }
+  mesh->mVertices[8].Set(0.0f, 0.0f, 0.1f);
+
+  MeshShapePtr shape(new MeshShape(Eigen::Vector3d::Ones(), scene));
+
+  // Concave meshes keep colliding with their triangles unless the convex
+  // hull is requested explicitly
+  EXPECT_EQ(shape->getCollisionMode(), MeshShape::TRIANGLES);
+  shape->setCollisionMode(MeshShape::CONVEX_HULL);
+  EXPECT_EQ(shape->getCollisionMode(), MeshShape::CONVEX_HULL);
+
+  EXPECT_EQ(shape->getConvexHullVertices().size(), 8u);
+  EXPECT_EQ(shape->getConvexHullTriangles().size(), 12u);
+
+  // The hull follows the scale of the mesh
+  shape->setScale(Eigen::Vector3d(2.0, 1.0, 1.0));
+  double maxX = 0.0;
+  for (const Eigen::Vector3d& vertex : shape->getConvexHullVertices())
+    maxX = std::max(maxX, vertex[0]);
+  EXPECT_NEAR(maxX, 1.0, 1e-9);
+}
+
+//==============================================================================
+TEST_F(COLLISION, DARTCollideConvexHull)
+{
+  std::vector<collision::Contact> contacts;
+
+  // Octahedron given by the convex hull of its vertices and some interior
+  // points, as a MeshShape in CONVEX_HULL mode would provide
+  std::vector<Eigen::Vector3d> points;
+  for (int i = 0; i < 3; ++i)
+  {
+    points.push_back(0.5 * Eigen::Vector3d::Unit(i));
+    points.push_back(-0.5 * Eigen::Vector3d::Unit(i));
+  }
+  for (int i = 0; i < 20; ++i)
+    points.push_back(0.1 * Eigen::Vector3d::Random());
+  std::vector<Eigen::Vector3i> triangles;
+  const std::vector<Eigen::Vector3d> vertices
+      = computeConvexHull3D(points, &triangles);
+  ASSERT_EQ(vertices.size(), 6u);
+  ASSERT_EQ(triangles.size(), 8u);
+
+  // Resting on a plane with its bottom vertex
+  Eigen::Isometry3d T0 = Eigen::Isometry3d::Identity();
+  Eigen::Isometry3d T1 = Eigen::Isometry3d::Identity();
+  T0.translation() = Eigen::Vector3d(0.0, 0.0, 0.5 - 0.02);
+  EXPECT_EQ(collision::collideHullPlane(vertices, T0, Eigen::Vector3d::UnitZ(),
+                                        0.0, T1, &contacts), 1);
+  ASSERT_EQ(contacts.size(), 1u);
+  EXPECT_NEAR(contacts[0].penetrationDepth, 0.02, 1e-6);
+  EXPECT_TRUE(contacts[0].normal.isApprox(Eigen::Vector3d::UnitZ(), 1e-6));
+
+  // Hull against a box, through GJK/EPA
+  const collision::ConvexSupport hull(vertices, triangles, T0);
+  const collision::ConvexSupport box(
+        collision::ConvexSupport::BOX, Eigen::Vector3d(1.0, 1.0, 0.1),
+        Eigen::Isometry3d(Eigen::Translation3d(0.0, 0.0, -0.1)));
+  contacts.clear();
+  EXPECT_EQ(collision::collideConvexConvex(hull, box, &contacts), 1);
+  ASSERT_EQ(contacts.size(), 1u);
+  EXPECT_NEAR(contacts[0].penetrationDepth, 0.02, 1e-6);
+  EXPECT_TRUE(contacts[0].normal.isApprox(Eigen::Vector3d::UnitZ(), 1e-6));
+  EXPECT_TRUE(hull.contains(T0.translation()));
+  EXPECT_FALSE(hull.contains(T0 * Eigen::Vector3d(0.3, 0.3, 0.0)));
+
+  // Separated from the box
+  T0.translation()[2] = 0.5 + 0.05;
+  const collision::ConvexSupport hull1(vertices, triangles, T0);
+  contacts.clear();
+  EXPECT_EQ(collision::collideConvexConvex(hull1, box, &contacts), 0);
+  EXPECT_NEAR(collision::computeConvexDistance(hull1, box), 0.05, 1e-6);
+}
+
+//==============================================================================
+size_t countCollidingPairs(collision::CollisionDetector* _detector)
+{
+  std::set<std::pair<const BodyNode*, const BodyNode*>> pairs;
+
+  _detector->detectCollision(true, true);
+  for (size_t i = 0; i < _detector->getNumContacts(); ++i)
+  {
+    const collision::Contact& contact = _detector->getContact(i);
+    const BodyNode* bn1 = contact.bodyNode1.lock().get();
+    const BodyNode* bn2 = contact.bodyNode2.lock().get();
+    pairs.insert(std::make_pair(std::min(bn1, bn2), std::max(bn1, bn2)));
+  }
+
+  return pairs.size();
+}
+
+//==============================================================================
+TEST_F(COLLISION, CollisionFilter)
+{
+  // A chain of three coincident boxes and another box overlapping all of them
+  SkeletonPtr chain = Skeleton::create("chain");
+  BodyNode* bn0 = chain->createJointAndBodyNodePair<FreeJoint>().second;
+  BodyNode* bn1 = chain->createJointAndBodyNodePair<RevoluteJoint>(bn0).second;
+  BodyNode* bn2 = chain->createJointAndBodyNodePair<RevoluteJoint>(bn1).second;
+
+  SkeletonPtr other = Skeleton::create("other");
+  BodyNode* bn3 = other->createJointAndBodyNodePair<FreeJoint>().second;
+
+  for (BodyNode* bn : {bn0, bn1, bn2, bn3})
+    bn->addCollisionShape(std::make_shared<BoxShape>(Eigen::Vector3d::Ones()));
+
+  collision::DARTCollisionDetector detector;
+  detector.addSkeleton(chain);
+  detector.addSkeleton(other);
+
+  // Self collision is disabled by default
+  EXPECT_EQ(countCollidingPairs(&detector), 3u);
+
+  // Adjacent bodies are excluded unless requested
+  chain->enableSelfCollision();
+  EXPECT_EQ(countCollidingPairs(&detector), 4u);
+  chain->enableSelfCollision(true);
+  EXPECT_EQ(countCollidingPairs(&detector), 6u);
+
+  // Explicitly disabled pairs of the allowed collision matrix
+  chain->setCollisionAllowed(bn0, bn2, false);
+  EXPECT_FALSE(chain->isCollisionAllowed(0, 2));
+  EXPECT_TRUE(chain->isCollisionAllowed(0, 1));
+  EXPECT_EQ(countCollidingPairs(&detector), 5u);
+
+  SkeletonPtr clone = chain->clone();
+  EXPECT_FALSE(clone->isCollisionAllowed(0, 2));
+  EXPECT_TRUE(clone->isCollisionAllowed(1, 2));
+
+  // Collision categories and masks
+  bn3->setCollisionCategory(0x2);
+  bn1->setCollisionMask(~0x2u);
+  EXPECT_EQ(countCollidingPairs(&detector), 4u);
+  bn3->setCollisionMask(0x0);
+  EXPECT_EQ(countCollidingPairs(&detector), 2u);
+
+  // Pairs disabled in the detector
+  detector.disablePair(bn0, bn1);
+  EXPECT_EQ(countCollidingPairs(&detector), 1u);
+
+  // Removing a body node keeps the remaining entries of the detector
+  detector.removeCollisionSkeletonNode(bn0);
+  EXPECT_EQ(countCollidingPairs(&detector), 1u);
+}
+
+//==============================================================================
+TEST_F(COLLISION, CollisionFilterAfterMove)
+{
+  // A chain of four BodyNodes and a branch off the root
+  SkeletonPtr chain = Skeleton::create("chain");
+  BodyNode* bn0 = chain->createJointAndBodyNodePair<FreeJoint>().second;
+  BodyNode* bn1 = chain->createJointAndBodyNodePair<RevoluteJoint>(bn0).second;
+  BodyNode* bn2 = chain->createJointAndBodyNodePair<RevoluteJoint>(bn1).second;
+  BodyNode* bn3 = chain->createJointAndBodyNodePair<RevoluteJoint>(bn2).second;
+  BodyNode* bn4 = chain->createJointAndBodyNodePair<RevoluteJoint>(bn0).second;
+  chain->enableSelfCollision(true);
+
+  auto isAllowed = [](const BodyNode* _bn1, const BodyNode* _bn2)
+  {
+    EXPECT_EQ(_bn1->getSkeleton(), _bn2->getSkeleton());
+    return _bn1->getSkeleton()->isCollisionAllowed(
+          _bn1->getIndexInSkeleton(), _bn2->getIndexInSkeleton());
+  };
+
+  chain->setCollisionAllowed(bn0, bn2, false);
+  chain->setCollisionAllowed(bn2, bn3, false);
+  chain->setCollisionAllowed(bn1, bn3, false);
+  chain->setCollisionAllowed(bn1, bn3, true);
+  EXPECT_FALSE(isAllowed(bn0, bn2));
+  EXPECT_FALSE(isAllowed(bn2, bn3));
+  EXPECT_TRUE(isAllowed(bn1, bn3));
+
+  // Moving within the Skeleton reindexes the BodyNodes, but keeps the pairs
+  // disabled
+  EXPECT_TRUE(bn2->moveTo(bn4));
+  EXPECT_EQ(bn4->getIndexInSkeleton(), 2u);
+  EXPECT_EQ(bn2->getIndexInSkeleton(), 3u);
+  EXPECT_FALSE(isAllowed(bn0, bn2));
+  EXPECT_FALSE(isAllowed(bn2, bn3));
+  EXPECT_TRUE(isAllowed(bn1, bn2));
+  EXPECT_TRUE(isAllowed(bn1, bn3));
+
+  // Moving to another Skeleton keeps the pairs whose BodyNodes both moved
+  SkeletonPtr other = Skeleton::create("other");
+  other->enableSelfCollision(true);
+  EXPECT_TRUE(bn2->moveTo(other, nullptr));
+  EXPECT_FALSE(isAllowed(bn2, bn3));
+  EXPECT_TRUE(isAllowed(bn0, bn1));
+
+  // Moving back does not resurrect the pair that was split up
+  EXPECT_TRUE(bn2->moveTo(chain, bn0));
+  EXPECT_TRUE(isAllowed(bn0, bn2));
+  EXPECT_FALSE(isAllowed(bn2, bn3));
+}
+
+//==============================================================================
+double shootBallThroughWall(bool _ccd)
+{
+  WorldPtr world(new World);
+  world->setGravity(Eigen::Vector3d::Zero());
+  world->setTimeStep(0.001);
+  world->getConstraintSolver()->setCollisionDetector(
+        new collision::DARTCollisionDetector());
+
+  SkeletonPtr wall = Skeleton::create("wall");
+  BodyNode* wallBody = wall->createJointAndBodyNodePair<WeldJoint>().second;
+  wallBody->addCollisionShape(
+        std::make_shared<BoxShape>(Eigen::Vector3d(0.01, 1.0, 1.0)));
+  world->addSkeleton(wall);
+
+  SkeletonPtr ball = Skeleton::create("ball");
+  BodyNode* ballBody = ball->createJointAndBodyNodePair<FreeJoint>().second;
+  ballBody->addCollisionShape(
+        std::make_shared<EllipsoidShape>(Eigen::Vector3d::Constant(0.04)));
+  ballBody->setCCDEnabled(_ccd);
+  ball->setPosition(3, -0.47);
+  ball->setVelocity(3, 100.0);
+  world->addSkeleton(ball);
+
+  // The ball travels 0.1 per step, which is more than the wall is thick
+  for (size_t i = 0; i < 20; ++i)
+    world->step();
+
+  return ball->getPosition(3);
+}
+
+//==============================================================================
+TEST_F(COLLISION, ContinuousCollisionDetection)
+{
+  EXPECT_GT(shootBallThroughWall(false), 0.0);
+
+  const double x = shootBallThroughWall(true);
+  EXPECT_LT(x, -0.02);
+  EXPECT_GT(x, -0.03);
+}
+
+//==============================================================================
+TEST_F(COLLISION, DARTCollideHeightmap)
+{
+  // A 5 x 5 grid with unit spacing whose vertices lie on z = 0.1 x
+  Eigen::MatrixXd heights(5, 5);
+  for (int i = 0; i < 5; ++i)
+  {
+    for (int j = 0; j < 5; ++j)
+      heights(i, j) = 0.1 * (j - 2.0);
+  }
+  ShapePtr heightmap(new HeightmapShape(heights, Eigen::Vector2d::Ones()));
+  const Eigen::Vector3d slopeNormal
+      = Eigen::Vector3d(-0.1, 0.0, 1.0).normalized();
+
+  std::vector<collision::Contact> contacts;
+  Eigen::Isometry3d T0 = Eigen::Isometry3d::Identity();
+  Eigen::Isometry3d T1 = Eigen::Isometry3d::Identity();
+
+  // Sphere sinking 0.1 into the slope
+  ShapePtr sphere(new EllipsoidShape(Eigen::Vector3d::Constant(1.0)));
+  T0.translation() = Eigen::Vector3d(0.3, 0.2, 0.03) + 0.4 * slopeNormal;
+  EXPECT_GT(collision::collide(sphere, T0, heightmap, T1, &contacts), 0);
+  double maxDepth = 0.0;
+  for (const collision::Contact& contact : contacts)
+  {
+    EXPECT_TRUE(contact.normal.isApprox(slopeNormal, 1e-6));
+    EXPECT_LT(contact.penetrationDepth, 0.1 + 1e-6);
+    maxDepth = std::max(maxDepth, contact.penetrationDepth);
+  }
+  EXPECT_NEAR(maxDepth, 0.1, 1e-6);
+
+  // Flipped order
+  contacts.clear();
+  EXPECT_GT(collision::collide(heightmap, T1, sphere, T0, &contacts), 0);
+  for (const collision::Contact& contact : contacts)
+    EXPECT_TRUE(contact.normal.isApprox(-slopeNormal, 1e-6));
+
+  // Separated sphere and sphere beyond the border of the grid
+  contacts.clear();
+  T0.translation() = Eigen::Vector3d(0.3, 0.2, 0.03) + 0.6 * slopeNormal;
+  EXPECT_EQ(collision::collide(sphere, T0, heightmap, T1, &contacts), 0);
+  T0.translation() = Eigen::Vector3d(3.0, 0.0, 0.0);
+  EXPECT_EQ(collision::collide(sphere, T0, heightmap, T1, &contacts), 0);
+
+  // Box resting on a flat heightmap that is rotated and translated
+  ShapePtr flat(new HeightmapShape(Eigen::MatrixXd::Zero(9, 9),
+                                   Eigen::Vector2d(0.25, 0.25)));
+  T1 = Eigen::Isometry3d::Identity();
+  T1.translation() = Eigen::Vector3d(1.0, -2.0, 0.5);
+  T1.linear() = Eigen::AngleAxisd(0.3, Eigen::Vector3d::UnitX()).matrix();
+  const Eigen::Vector3d up = T1.linear().col(2);
+
+  ShapePtr box(new BoxShape(Eigen::Vector3d(0.6, 0.4, 0.2)));
+  T0 = T1 * Eigen::Translation3d(0.1, 0.07, 0.09);
+  contacts.clear();
+  EXPECT_GE(collision::collide(box, T0, flat, T1, &contacts), 4);
+  for (const collision::Contact& contact : contacts)
+  {
+    EXPECT_TRUE(contact.normal.isApprox(up, 1e-6));
+    EXPECT_NEAR(contact.penetrationDepth, 0.01, 1e-6);
+  }
+
+  // Cylinder standing on it
+  ShapePtr cylinder(new CylinderShape(0.2, 0.4));
+  T0 = T1 * Eigen::Translation3d(-0.32, 0.41, 0.19);
+  contacts.clear();
+  EXPECT_GE(collision::collide(cylinder, T0, flat, T1, &contacts), 3);
+  for (const collision::Contact& contact : contacts)
+  {
+    EXPECT_TRUE(contact.normal.isApprox(up, 1e-6));
+    EXPECT_NEAR(contact.penetrationDepth, 0.01, 1e-6);
+  }
+
+  // Planes and other heightmaps are not supported
+  ShapePtr plane(new PlaneShape(Eigen::Vector3d::UnitZ(), 0.0));
+  EXPECT_EQ(collision::collide(plane, T0, flat, T1, &contacts), 0);
+  EXPECT_EQ(collision::collide(heightmap, T0, flat, T1, &contacts), 0);
+}
+
+//==============================================================================
+TEST_F(COLLISION, HeightmapTiles)
+{
+  HeightmapShape heightmap(Eigen::MatrixXd::Zero(11, 21),
+                           Eigen::Vector2d(0.5, 0.1));
+  heightmap.setTileSize(4);
+  EXPECT_EQ(heightmap.getNumTileRows(), 3u);
+  EXPECT_EQ(heightmap.getNumTileCols(), 5u);
+  EXPECT_TRUE(heightmap.getVertex(0, 0).isApprox(
+                Eigen::Vector3d(-5.0, -0.5, 0.0)));
+  EXPECT_TRUE(heightmap.getBoundingBox().getMax().isApprox(
+                Eigen::Vector3d(5.0, 0.5, 0.0)));
+
+  std::vector<size_t> versions;
+  for (size_t i = 0; i < 3; ++i)
+  {
+    for (size_t j = 0; j < 5; ++j)
+      versions.push_back(heightmap.getTileVersion(i, j));
+  }
+
+  // Vertex (5, 9) is interior to tile (1, 2), but its neighbors (4, 8),
+  // (4, 9) and (5, 8) lie on the borders with tiles (0, 1), (0, 2) and (1, 1)
+  heightmap.setHeight(5, 9, 1.0);
+  EXPECT_DOUBLE_EQ(heightmap.getMaxHeight(), 1.0);
+  EXPECT_DOUBLE_EQ(heightmap.getBoundingBox().getMax()[2], 1.0);
+
+  std::set<std::pair<size_t, size_t>> modified;
+  for (size_t i = 0; i < 3; ++i)
+  {
+    for (size_t j = 0; j < 5; ++j)
+    {
+      if (heightmap.getTileVersion(i, j) != versions[i * 5 + j])
+        modified.insert(std::make_pair(i, j));
+    }
+  }
+  const std::set<std::pair<size_t, size_t>> expected = {
+    {0, 1}, {0, 2}, {1, 1}, {1, 2}
+  };
+  EXPECT_EQ(modified, expected);
+
+  // Lowering the only maximum updates the range
+  heightmap.setHeight(5, 9, -0.5);
+  EXPECT_DOUBLE_EQ(heightmap.getMaxHeight(), 0.0);
+  EXPECT_DOUBLE_EQ(heightmap.getMinHeight(), -0.5);
+}
+
+//==============================================================================
+TEST_F(COLLISION, DistanceQuery)
+{
+  // A sphere above the ground and boxes scattered around it
+  SkeletonPtr robot = Skeleton::create("robot");
+  BodyNode* sphere = robot->createJointAndBodyNodePair<FreeJoint>().second;
+  sphere->addCollisionShape(
+        std::make_shared<EllipsoidShape>(Eigen::Vector3d::Constant(0.2)));
+  robot->setPosition(5, 1.0);
+
+  SkeletonPtr environment = Skeleton::create("environment");
+  BodyNode* ground
+      = environment->createJointAndBodyNodePair<WeldJoint>().second;
+  ground->addCollisionShape(
+        std::make_shared<PlaneShape>(Eigen::Vector3d::UnitZ(), 0.0));
+
+  std::vector<BodyNode*> boxes;
+  for (size_t i = 0; i < 10; ++i)
+  {
+    WeldJoint::Properties properties;
+    properties.mT_ParentBodyToJoint.translation()
+        = Eigen::Vector3d(2.0 + 0.5 * i, i % 2 ? 1.0 : -1.0, 1.0);
+    BodyNode* box = environment->createJointAndBodyNodePair<WeldJoint>(
+          nullptr, properties).second;
+    box->addCollisionShape(
+          std::make_shared<BoxShape>(Eigen::Vector3d::Constant(0.2)));
+    boxes.push_back(box);
+  }
+
+  collision::DARTCollisionDetector detector;
+  detector.addSkeleton(robot);
+  detector.addSkeleton(environment);
+
+  // Pairwise distance to the ground
+  collision::DistanceResult result;
+  EXPECT_NEAR(detector.computeDistance(sphere, ground, &result), 0.9, 1e-6);
+  EXPECT_NEAR(result.distance, 0.9, 1e-6);
+  EXPECT_TRUE(result.point1.isApprox(Eigen::Vector3d(0.0, 0.0, 0.9), 1e-6));
+  EXPECT_NEAR(result.point2[2], 0.0, 1e-6);
+  EXPECT_EQ(result.bodyNode1.lock().get(), sphere);
+  EXPECT_EQ(result.bodyNode2.lock().get(), ground);
+
+  // The upper bound stops the query early and leaves the result untouched
+  result.distance = -1.0;
+  EXPECT_DOUBLE_EQ(detector.computeDistance(sphere, ground, &result, 0.5),
+                   0.5);
+  EXPECT_DOUBLE_EQ(result.distance, -1.0);
+
+  // One versus all, where the boxes come closer than the ground as the
+  // sphere moves along the x-axis
+  for (size_t i = 0; i <= 60; ++i)
+  {
+    const double x = 0.1 * i;
+    robot->setPosition(3, x);
+
+    double expected = 0.9;
+    BodyNode* closest = ground;
+    for (BodyNode* box : boxes)
+    {
+      const Eigen::Vector3d center = box->getTransform().translation();
+      const Eigen::Vector3d offset
+          = (Eigen::Vector3d(x, 0.0, 1.0) - center).cwiseAbs()
+            - Eigen::Vector3d::Constant(0.1);
+      const double distance = offset.cwiseMax(0.0).norm() - 0.1;
+      if (distance < expected)
+      {
+        expected = distance;
+        closest = box;
+      }
+    }
+
+    EXPECT_NEAR(detector.computeDistance(sphere, &result), expected, 1e-6);
+    EXPECT_EQ(result.bodyNode2.lock().get(), closest);
+    EXPECT_NEAR((result.point1 - result.point2).norm(), expected, 1e-6);
+  }
+
+  // Filtered pairs are not considered
+  detector.disablePair(sphere, ground);
+  robot->setPosition(3, 0.0);
+  EXPECT_NEAR(detector.computeDistance(sphere, &result),
+              (Eigen::Vector2d(1.9, 0.9).norm() - 0.1), 1e-6);
+
+  // Intersecting bodies are at zero distance
+  robot->setPosition(3, 2.0);
+  robot->setPosition(4, -0.85);
+  EXPECT_DOUBLE_EQ(detector.computeDistance(sphere, &result), 0.0);
+  EXPECT_EQ(result.bodyNode2.lock().get(), boxes[0]);
+
+  // The cached closest body node loses its shape, so the next box is the
+  // closest one
+  ShapePtr boxShape = boxes[0]->getCollisionShape(0);
+  boxes[0]->removeCollisionShape(boxShape);
+  EXPECT_NEAR(detector.computeDistance(sphere, &result),
+              Eigen::Vector2d(0.9, 0.05).norm() - 0.1, 1e-6);
+  EXPECT_EQ(result.bodyNode2.lock().get(), boxes[2]);
+  boxes[0]->addCollisionShape(boxShape);
+  EXPECT_DOUBLE_EQ(detector.computeDistance(sphere, &result), 0.0);
+  EXPECT_EQ(result.bodyNode2.lock().get(), boxes[0]);
+
+  // Removed body nodes are no longer found
+  detector.removeSkeleton(environment);
+  EXPECT_EQ(detector.computeDistance(sphere, &result),
+            std::numeric_limits<double>::infinity());
+  detector.addSkeleton(environment);
+  EXPECT_DOUBLE_EQ(detector.computeDistance(sphere, &result), 0.0);
+  EXPECT_EQ(result.bodyNode2.lock().get(), boxes[0]);
+}
+
+//==============================================================================
+TEST_F(COLLISION, PlanningCollisionQuery)
+{
+  // A two-link robot among boxes standing on the ground
+  SkeletonPtr robot = Skeleton::create("robot");
+  BodyNode* base = robot->createJointAndBodyNodePair<FreeJoint>().second;
+  base->addCollisionShape(
+        std::make_shared<BoxShape>(Eigen::Vector3d(0.3, 0.3, 0.3)));
+  RevoluteJoint::Properties properties;
+  properties.mT_ParentBodyToJoint.translation()
+      = Eigen::Vector3d(0.0, 0.0, 0.15);
+  BodyNode* link = robot->createJointAndBodyNodePair<RevoluteJoint>(
+        base, properties).second;
+  std::shared_ptr<BoxShape> linkShape
+      = std::make_shared<BoxShape>(Eigen::Vector3d(0.8, 0.1, 0.1));
+  linkShape->setLocalTransform(
+        Eigen::Isometry3d(Eigen::Translation3d(0.4, 0.0, 0.05)));
+  link->addCollisionShape(linkShape);
+
+  SkeletonPtr obstacles = Skeleton::create("obstacles");
+  BodyNode* ground = obstacles->createJointAndBodyNodePair<WeldJoint>().second;
+  ground->addCollisionShape(
+        std::make_shared<PlaneShape>(Eigen::Vector3d::UnitZ(), -1.0));
+  std::vector<BodyNode*> boxes;
+  for (size_t i = 0; i < 5; ++i)
+  {
+    for (size_t j = 0; j < 5; ++j)
+    {
+      WeldJoint::Properties weldProperties;
+      weldProperties.mT_ParentBodyToJoint.translation()
+          = Eigen::Vector3d(1.2 * i - 2.4, 1.2 * j - 2.4, -0.5);
+      BodyNode* box = obstacles->createJointAndBodyNodePair<WeldJoint>(
+            nullptr, weldProperties).second;
+      box->addCollisionShape(
+            std::make_shared<BoxShape>(Eigen::Vector3d(0.4, 0.4, 1.0)));
+      boxes.push_back(box);
+    }
+  }
+
+  SkeletonPtr movable = Skeleton::create("movable");
+  BodyNode* ball = movable->createJointAndBodyNodePair<FreeJoint>().second;
+  ball->addCollisionShape(
+        std::make_shared<EllipsoidShape>(Eigen::Vector3d::Constant(0.6)));
+
+  collision::DARTCollisionDetector detector;
+  detector.addSkeleton(robot);
+  detector.addSkeleton(obstacles);
+  detector.addSkeleton(movable);
+
+  const std::vector<BodyNode*> movingBodyNodes = {base, link};
+
+  size_t numCollisions = 0;
+  for (size_t i = 0; i < 300; ++i)
+  {
+    Eigen::VectorXd positions = Eigen::VectorXd::Random(7);
+    positions.segment<3>(3) *= 3.0;
+    positions[5] = 0.5 * positions[5] - 0.2;
+    robot->setPositions(positions);
+
+    // The movable ball jumps every tenth sample
+    if (i % 10 == 0)
+    {
+      Eigen::Vector6d ballPositions = Eigen::Vector6d::Zero();
+      ballPositions.tail<3>() = 3.0 * Eigen::Vector3d::Random();
+      ballPositions[5] = 0.0;
+      movable->setPositions(ballPositions);
+    }
+
+    // Reference: every contact of the full detection involving the robot
+    detector.detectCollision(true, true);
+    bool expected = false;
+    for (size_t k = 0; k < detector.getNumContacts(); ++k)
+    {
+      const collision::Contact& contact = detector.getContact(k);
+      if (contact.bodyNode1.lock()->getSkeleton() == robot
+          || contact.bodyNode2.lock()->getSkeleton() == robot)
+      {
+        expected = true;
+      }
+    }
+
+    EXPECT_EQ(detector.checkCollision(movingBodyNodes), expected);
+    if (expected)
+      ++numCollisions;
+  }
+
+  // Both outcomes are exercised
+  EXPECT_GT(numCollisions, 0u);
+  EXPECT_LT(numCollisions, 300u);
+
+  // The robot hovers above the obstacles, which become static again
+  Eigen::VectorXd positions = Eigen::VectorXd::Zero(7);
+  positions[5] = 2.0;
+  robot->setPositions(positions);
+  Eigen::Vector6d ballPositions = Eigen::Vector6d::Zero();
+  ballPositions[3] = 10.0;
+  movable->setPositions(ballPositions);
+  EXPECT_FALSE(detector.checkCollision(movingBodyNodes));
+  EXPECT_FALSE(detector.checkCollision(movingBodyNodes));
+
+  // An obstacle moved by its joint transform, which leaves the positions of
+  // its skeleton unchanged
+  WeldJoint* joint = static_cast<WeldJoint*>(boxes[0]->getParentJoint());
+  const Eigen::Isometry3d T = joint->getTransformFromParentBodyNode();
+  joint->setTransformFromParentBodyNode(
+        Eigen::Isometry3d(Eigen::Translation3d(0.0, 0.0, 2.0)));
+  EXPECT_TRUE(detector.checkCollision(movingBodyNodes));
+  joint->setTransformFromParentBodyNode(T);
+  EXPECT_FALSE(detector.checkCollision(movingBodyNodes));
+  EXPECT_FALSE(detector.checkCollision(movingBodyNodes));
+
+  // An obstacle that gains a collision shape reaching the robot
+  std::shared_ptr<BoxShape> extraShape
+      = std::make_shared<BoxShape>(Eigen::Vector3d::Constant(0.2));
+  extraShape->setLocalTransform(
+        Eigen::Isometry3d(Eigen::Translation3d(2.4, 2.4, 2.5)));
+  boxes[0]->addCollisionShape(extraShape);
+  EXPECT_TRUE(detector.checkCollision(movingBodyNodes));
+  boxes[0]->removeCollisionShape(extraShape);
+  EXPECT_FALSE(detector.checkCollision(movingBodyNodes));
+  EXPECT_FALSE(detector.checkCollision(movingBodyNodes));
+
+  // The obstacle below the robot, whose collision shape is edited in place
+  // without touching the body node
+  std::shared_ptr<BoxShape> boxShape
+      = std::static_pointer_cast<BoxShape>(boxes[12]->getCollisionShape(0));
+  boxShape->setSize(Eigen::Vector3d(0.4, 0.4, 6.0));
+  EXPECT_TRUE(detector.checkCollision(movingBodyNodes));
+  boxShape->setSize(Eigen::Vector3d(0.4, 0.4, 1.0));
+  EXPECT_FALSE(detector.checkCollision(movingBodyNodes));
+  EXPECT_FALSE(detector.checkCollision(movingBodyNodes));
+
+  boxShape->setLocalTransform(
+        Eigen::Isometry3d(Eigen::Translation3d(0.0, 0.0, 2.0)));
+  EXPECT_TRUE(detector.checkCollision(movingBodyNodes));
+  boxShape->setLocalTransform(Eigen::Isometry3d::Identity());
+  EXPECT_FALSE(detector.checkCollision(movingBodyNodes));
+  EXPECT_FALSE(detector.checkCollision(movingBodyNodes));
+}
+
+//==============================================================================
+TEST_F(COLLISION, ContactRecords)
+{
+  // A box resting on the ground touches it at several points
+  SkeletonPtr ground = Skeleton::create("ground");
+  BodyNode* groundBody
+      = ground->createJointAndBodyNodePair<WeldJoint>().second;
+  groundBody->addCollisionShape(
+        std::make_shared<BoxShape>(Eigen::Vector3d(4.0, 4.0, 0.2)));
+
+  SkeletonPtr box = Skeleton::create("box");
+  BodyNode* boxBody = box->createJointAndBodyNodePair<FreeJoint>().second;
+  boxBody->addCollisionShape(
+        std::make_shared<BoxShape>(Eigen::Vector3d(0.5, 0.5, 0.5)));
+  Eigen::Vector6d positions = Eigen::Vector6d::Zero();
+  positions[0] = 0.1;
+  positions[5] = 0.34;
+  box->setPositions(positions);
+
+  collision::DARTCollisionDetector detector;
+  detector.addSkeleton(ground);
+  detector.addSkeleton(box);
+
+  EXPECT_TRUE(detector.detectCollision(true, true));
+  ASSERT_GT(detector.getNumContacts(), 1u);
+  EXPECT_EQ(detector.getContactRecords().size(), detector.getNumContacts());
+
+  // The compatibility view matches the records
+  for (size_t i = 0; i < detector.getNumContacts(); ++i)
+  {
+    const collision::ContactRecord& record = detector.getContactRecord(i);
+    const collision::Contact& contact = detector.getContact(i);
+    EXPECT_TRUE(record.point == contact.point);
+    EXPECT_TRUE(record.normal == contact.normal);
+    EXPECT_EQ(record.penetrationDepth, contact.penetrationDepth);
+    EXPECT_EQ(record.bodyNode1, contact.bodyNode1.lock().get());
+    EXPECT_EQ(record.bodyNode2, contact.bodyNode2.lock().get());
+    EXPECT_EQ(record.shape1, contact.shape1.get());
+    EXPECT_EQ(record.shape2, contact.shape2.get());
+    EXPECT_TRUE(record.bodyNode1 == boxBody || record.bodyNode2 == boxBody);
+  }
+
+  // Forces written to the records are visible through the compatibility view
+  detector.getContactRecord(0).force = Eigen::Vector3d(1.0, 2.0, 3.0);
+  EXPECT_TRUE(detector.getContact(0).force == Eigen::Vector3d(1.0, 2.0, 3.0));
+
+  // The compatibility view follows the reduction of the records
+  detector.reduceContacts(1);
+  EXPECT_EQ(detector.getNumContacts(), 1u);
+  EXPECT_TRUE(detector.getContact(0).point
+              == detector.getContactRecord(0).point);
+
+  // The records are cleared by the next detection
+  positions[5] = 2.0;
+  box->setPositions(positions);
+  EXPECT_FALSE(detector.detectCollision(true, true));
+  EXPECT_EQ(detector.getNumContacts(), 0u);
+  EXPECT_TRUE(detector.getContactRecords().empty());
+}
+
+//==============================================================================
+/// Create a world with a box resting on a ground box, which uses
+/// _detector for the contacts
+WorldPtr createRestingBoxWorld(collision::CollisionDetector* _detector)
+{
+  SkeletonPtr ground = Skeleton::create("ground");
+  BodyNode* groundBody
+      = ground->createJointAndBodyNodePair<WeldJoint>().second;
+  groundBody->addCollisionShape(
+        std::make_shared<BoxShape>(Eigen::Vector3d(4.0, 4.0, 0.2)));
+
+  SkeletonPtr box = Skeleton::create("box");
+  BodyNode* boxBody = box->createJointAndBodyNodePair<FreeJoint>().second;
+  boxBody->addCollisionShape(
+        std::make_shared<BoxShape>(Eigen::Vector3d(0.5, 0.5, 0.5)));
+  box->setPosition(5, 0.35);
+
+  WorldPtr world(new World);
+  world->getConstraintSolver()->setCollisionDetector(_detector);
+  world->addSkeleton(ground);
+  world->addSkeleton(box);
+  return world;
+}
+
+//==============================================================================
+/// Records the contact forces of the last nonempty records it cleared
+class ForceRecordingCollisionDetector : public collision::DARTCollisionDetector
+{
+public:
+  void clearAllContacts() override
+  {
+    if (!getContactRecords().empty())
+      mClearedForces.clear();
+    for (const collision::ContactRecord& record : getContactRecords())
+      mClearedForces.push_back(record.force);
+
+    collision::DARTCollisionDetector::clearAllContacts();
+  }
+
+  std::vector<Eigen::Vector3d> mClearedForces;
+};
+
+//==============================================================================
+TEST_F(COLLISION, ContactForcesBeforeClearing)
+{
+  // Detectors that carry the contact forces over to the next detection, for
+  // warm starting, see the forces of the last step when the constraint
+  // solver clears the contacts
+  ForceRecordingCollisionDetector* detector
+      = new ForceRecordingCollisionDetector;
+  WorldPtr world = createRestingBoxWorld(detector);
+  for (size_t i = 0; i < 100; ++i)
+    world->step();
+
+  ASSERT_GT(detector->getNumContacts(), 0u);
+  std::vector<Eigen::Vector3d> forces;
+  for (size_t i = 0; i < detector->getNumContacts(); ++i)
+    forces.push_back(detector->getContactRecord(i).force);
+
+  world->step();
+  ASSERT_EQ(detector->mClearedForces.size(), forces.size());
+  Eigen::Vector3d totalForce = Eigen::Vector3d::Zero();
+  for (size_t i = 0; i < forces.size(); ++i)
+  {
+    EXPECT_TRUE(detector->mClearedForces[i] == forces[i]);
+    totalForce += forces[i];
+  }
+
+  // The forces carry the weight of the box, with the sign depending on the
+  // order of the bodies in the contacts
+  const double weight = 9.81 * world->getSkeleton("box")->getMass();
+  EXPECT_NEAR(std::abs(totalForce[2]), weight, 1e-3 * weight);
+}
+
+#ifdef HAVE_BULLET_COLLISION
+//==============================================================================
+TEST_F(COLLISION, BulletContactWarmStart)
+{
+  collision::BulletCollisionDetector* detector
+      = new collision::BulletCollisionDetector;
+  WorldPtr world = createRestingBoxWorld(detector);
+  for (size_t i = 0; i < 100; ++i)
+    world->step();
+
+  ASSERT_GT(detector->getNumContacts(), 0u);
+  Eigen::Vector3d totalForce = Eigen::Vector3d::Zero();
+  for (size_t i = 0; i < detector->getNumContacts(); ++i)
+    totalForce += detector->getContactRecord(i).force;
+  EXPECT_GT(std::abs(totalForce[2]), 0.0);
+
+  // The contact points persist in the next detection, which is run as the
+  // constraint solver does, so they start from the forces of the last step
+  detector->clearAllContacts();
+  EXPECT_TRUE(detector->detectCollision(true, true));
+  Eigen::Vector3d warmStartForce = Eigen::Vector3d::Zero();
+  for (size_t i = 0; i < detector->getNumContacts(); ++i)
+  {
+    const Eigen::Vector3d& force = detector->getContactRecord(i).force;
+    EXPECT_FALSE(force.isZero());
+    warmStartForce += force;
+  }
+  EXPECT_TRUE(warmStartForce.isApprox(totalForce, 1e-9));
+}
+#endif
+
+//==============================================================================
+TEST_F(COLLISION, ParallelNarrowPhase)
+{
+  // A pile of boxes, spheres and capsules in a small volume
+  SkeletonPtr pile = Skeleton::create("pile");
+  pile->enableSelfCollision();
+  for (size_t i = 0; i < 40; ++i)
+  {
+    FreeJoint::Properties properties;
+    properties.mT_ParentBodyToJoint.translation()
+        = 0.8 * Eigen::Vector3d::Random();
+    properties.mT_ParentBodyToJoint.linear()
+        = math::expMapRot(Eigen::Vector3d::Random());
+    BodyNode* body = pile->createJointAndBodyNodePair<FreeJoint>(
+          nullptr, properties).second;
+
+    if (i % 3 == 0)
+      body->addCollisionShape(
+            std::make_shared<BoxShape>(Eigen::Vector3d(0.4, 0.3, 0.2)));
+    else if (i % 3 == 1)
+      body->addCollisionShape(
+            std::make_shared<EllipsoidShape>(Eigen::Vector3d::Constant(0.3)));
+    else
+      body->addCollisionShape(std::make_shared<CapsuleShape>(0.1, 0.4));
+  }
+
+  collision::DARTCollisionDetector detector;
+  detector.addSkeleton(pile);
+  EXPECT_EQ(detector.getNumThreads(), 1u);
+
+  EXPECT_TRUE(detector.detectCollision(true, true));
+  const std::vector<collision::ContactRecord> serialContacts
+      = detector.getContactRecords();
+  ASSERT_GT(serialContacts.size(), 10u);
+
+  // The contacts and their order do not depend on the number of threads
+  for (size_t numThreads : {2u, 3u, 8u, 0u})
+  {
+    detector.setNumThreads(numThreads);
+    EXPECT_TRUE(detector.detectCollision(true, true));
+    ASSERT_EQ(detector.getNumContacts(), serialContacts.size());
+    for (size_t i = 0; i < serialContacts.size(); ++i)
+    {
+      const collision::ContactRecord& contact = detector.getContactRecord(i);
+      EXPECT_TRUE(contact.point == serialContacts[i].point);
+      EXPECT_TRUE(contact.normal == serialContacts[i].normal);
+      EXPECT_EQ(contact.penetrationDepth, serialContacts[i].penetrationDepth);
+      EXPECT_EQ(contact.bodyNode1, serialContacts[i].bodyNode1);
+      EXPECT_EQ(contact.bodyNode2, serialContacts[i].bodyNode2);
+      EXPECT_EQ(contact.shape1, serialContacts[i].shape1);
+      EXPECT_EQ(contact.shape2, serialContacts[i].shape2);
+    }
+  }
+}
+
 //==============================================================================
 TEST_F(COLLISION, CollisionOfPrescribedJoints)
 {
@@ -34,8 +34,11 @@
  *   POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <vector>
+
 #include <gtest/gtest.h>
 
+#include "dart/common/Parallel.h"
 #include "dart/common/Timer.h"
 
 using namespace dart::common;
@@ -74,6 +77,37 @@ TEST(Common, Timer)
 #endif
 }
 
+//==============================================================================
+TEST(Common, ParallelFor)
+{
+  const size_t numTasks = 9;
+  const size_t numThreads = getNumParallelThreads(6, numTasks);
+  EXPECT_EQ(numThreads, 6u);
+  EXPECT_EQ(getNumParallelThreads(20, numTasks), numTasks);
+  EXPECT_GE(getNumParallelThreads(0, numTasks), 1u);
+
+  std::vector<size_t> begins(numThreads);
+  std::vector<size_t> ends(numThreads);
+  parallelFor(numTasks, numThreads,
+              [&](size_t _thread, size_t _begin, size_t _end)
+              {
+                begins[_thread] = _begin;
+                ends[_thread] = _end;
+              });
+
+  // The chunks cover all the tasks in order, and their sizes differ by at
+  // most one
+  EXPECT_EQ(begins[0], 0u);
+  EXPECT_EQ(ends[numThreads - 1], numTasks);
+  for (size_t i = 0; i < numThreads; ++i)
+  {
+    if (i > 0)
+      EXPECT_EQ(begins[i], ends[i - 1]);
+    EXPECT_GE(ends[i] - begins[i], numTasks / numThreads);
+    EXPECT_LE(ends[i] - begins[i], numTasks / numThreads + 1);
+  }
+}
+
 //==============================================================================
 int main(int argc, char* argv[])
 {
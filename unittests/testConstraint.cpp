@@ -46,6 +46,9 @@
 #include "dart/math/Geometry.h"
 #include "dart/math/Helpers.h"
 #include "dart/collision/dart/DARTCollisionDetector.h"
+#include "dart/constraint/BallJointConstraint.h"
+#include "dart/constraint/BlockPGSLCPSolver.h"
+#include "dart/constraint/DantzigLCPSolver.h"
 #include "dart/dynamics/BodyNode.h"
 #include "dart/dynamics/Skeleton.h"
 #include "dart/simulation/World.h"
@@ -239,6 +242,308 @@ TEST_F(ConstraintTest, SingleContactTest)
   SingleContactTest(getList()[0]);
 }
 
+//==============================================================================
+// Block PGS solver that checks the contact impulses of every solve
+class ConeCheckingBlockPGSLCPSolver
+    : public dart::constraint::BlockPGSLCPSolver
+{
+public:
+  explicit ConeCheckingBlockPGSLCPSolver(double _timestep)
+    : BlockPGSLCPSolver(_timestep),
+      mNumContactBlocks(0),
+      mMinNormalImpulse(0.0),
+      mMaxConeRatio(0.0)
+  {
+  }
+
+  void solve(dart::constraint::ConstrainedGroup* _group) override
+  {
+    BlockPGSLCPSolver::solve(_group);
+
+    for (size_t i = 0; i < mIsContactBlock.size(); ++i)
+    {
+      if (!mIsContactBlock[i])
+        continue;
+
+      const size_t o = mOffsets[i];
+      const double normal = mX[o];
+      mMinNormalImpulse = std::min(mMinNormalImpulse, normal);
+      ++mNumContactBlocks;
+
+      if (normal <= 0.0)
+        continue;
+
+      const double u1 = mX[o + 1] / (mHi[o + 1] * normal);
+      const double u2 = mX[o + 2] / (mHi[o + 2] * normal);
+      mMaxConeRatio = std::max(mMaxConeRatio, std::sqrt(u1 * u1 + u2 * u2));
+    }
+  }
+
+  size_t mNumContactBlocks;
+  double mMinNormalImpulse;
+  double mMaxConeRatio;
+};
+
+//==============================================================================
+TEST_F(ConstraintTest, BlockPGSBoxStacks)
+{
+  using namespace dart::collision;
+  using namespace dart::constraint;
+
+  WorldPtr world(new World);
+  world->setGravity(Vector3d(0.0, -10.0, 0.0));
+  world->setTimeStep(0.001);
+
+  ConstraintSolver* cs = world->getConstraintSolver();
+  cs->setCollisionDetector(new DARTCollisionDetector());
+  ConeCheckingBlockPGSLCPSolver* lcpSolver
+      = new ConeCheckingBlockPGSLCPSolver(world->getTimeStep());
+  lcpSolver->setNNCGEnabled(true);
+  cs->setLCPSolver(lcpSolver);
+  EXPECT_EQ(cs->getLCPSolver(), lcpSolver);
+
+  SkeletonPtr ground = createGround(Vector3d(10.0, 0.1, 10.0),
+                                    Vector3d(0.0, -0.05, 0.0));
+  ground->setMobile(false);
+  world->addSkeleton(ground);
+
+  // Two independent stacks of two boxes each
+  const double size = 0.2;
+  std::vector<SkeletonPtr> boxes;
+  for (size_t i = 0; i < 2; ++i)
+  {
+    for (size_t j = 0; j < 2; ++j)
+    {
+      SkeletonPtr box = createBox(Vector3d::Constant(size),
+                                  Vector3d(i * 1.0, (j + 0.5) * size, 0.0));
+      world->addSkeleton(box);
+      boxes.push_back(box);
+    }
+  }
+
+  for (size_t i = 0; i < 500; ++i)
+    world->step();
+
+  EXPECT_GT(lcpSolver->getNumIterations(), 0u);
+  EXPECT_LE(lcpSolver->getNumIterations(), lcpSolver->getMaxIterations());
+
+  // The impulses stay inside the friction cones
+  EXPECT_GT(lcpSolver->mNumContactBlocks, 0u);
+  EXPECT_GE(lcpSolver->mMinNormalImpulse, 0.0);
+  EXPECT_LE(lcpSolver->mMaxConeRatio, 1.0 + 1e-9);
+
+  for (size_t i = 0; i < boxes.size(); ++i)
+  {
+    const double expectedHeight = ((i % 2) + 0.5) * size;
+    BodyNode* bn = boxes[i]->getBodyNode(0);
+    EXPECT_NEAR(bn->getWorldTransform().translation()[1], expectedHeight,
+                1e-2);
+    EXPECT_NEAR(bn->getLinearVelocity().norm(), 0.0, 1e-2);
+  }
+}
+
+//==============================================================================
+WorldPtr createClosedLoopWorld(bool _eliminateBilateralRows)
+{
+  using namespace dart::collision;
+  using namespace dart::constraint;
+
+  WorldPtr world(new World);
+  world->setGravity(Vector3d(0.0, -10.0, 0.0));
+  world->setTimeStep(0.001);
+
+  ConstraintSolver* cs = world->getConstraintSolver();
+  cs->setCollisionDetector(new DARTCollisionDetector());
+  DantzigLCPSolver* lcpSolver
+      = dynamic_cast<DantzigLCPSolver*>(cs->getLCPSolver());
+  EXPECT_TRUE(lcpSolver != nullptr);
+  EXPECT_TRUE(lcpSolver->isBilateralEliminationEnabled());
+  lcpSolver->setBilateralEliminationEnabled(_eliminateBilateralRows);
+
+  // Spinning box pinned to the world at one of its top corners and sliding on
+  // the ground: bilateral and contact rows in the same group
+  SkeletonPtr ground = createGround(Vector3d(1.0, 0.1, 1.0),
+                                    Vector3d(5.0, -0.05, 0.0));
+  ground->setMobile(false);
+  world->addSkeleton(ground);
+
+  SkeletonPtr box = createBox(Vector3d::Constant(0.2),
+                              Vector3d(5.0, 0.1, 0.0));
+  Eigen::VectorXd velocities = Eigen::VectorXd::Zero(6);
+  velocities[1] = 2.0;
+  box->setVelocities(velocities);
+  world->addSkeleton(box);
+  cs->addConstraint(std::make_shared<BallJointConstraint>(
+      box->getBodyNode(0), Vector3d(5.1, 0.2, 0.1)));
+
+  // Box hanging in the air from one of its corners: only bilateral rows
+  SkeletonPtr pendulum = createBox(Vector3d::Constant(0.2),
+                                   Vector3d(0.0, 1.0, 0.0),
+                                   Vector3d(0.3, 0.0, 0.2));
+  velocities.setZero();
+  velocities[0] = 1.0;
+  pendulum->setVelocities(velocities);
+  world->addSkeleton(pendulum);
+  BodyNode* bob = pendulum->getBodyNode(0);
+  cs->addConstraint(std::make_shared<BallJointConstraint>(
+      bob, bob->getWorldTransform() * Vector3d(0.1, 0.1, 0.1)));
+
+  return world;
+}
+
+//==============================================================================
+WorldPtr createSlidingBoxWorld(dart::constraint::LCPSolver* _lcpSolver)
+{
+  WorldPtr world(new World);
+  world->setGravity(Vector3d(0.0, -10.0, 0.0));
+  world->setTimeStep(0.001);
+
+  dart::constraint::ConstraintSolver* cs = world->getConstraintSolver();
+  cs->setCollisionDetector(new dart::collision::DARTCollisionDetector());
+  if (_lcpSolver)
+    cs->setLCPSolver(_lcpSolver);
+
+  SkeletonPtr ground = createGround(Vector3d(10.0, 0.1, 10.0),
+                                    Vector3d(0.0, -0.05, 0.0));
+  ground->setMobile(false);
+  world->addSkeleton(ground);
+
+  // A box that slightly penetrates the ground while sliding and spinning
+  SkeletonPtr box = createBox(Vector3d(0.3, 0.2, 0.25),
+                              Vector3d(0.0, 0.0999, 0.0));
+  box->getBodyNode(0)->setFrictionCoeff(0.4);
+  Eigen::Vector6d velocities;
+  velocities << 0.0, 0.5, 0.0, 0.3, -0.01, 0.1;
+  box->setVelocities(velocities);
+  world->addSkeleton(box);
+
+  return world;
+}
+
+//==============================================================================
+TEST_F(ConstraintTest, BlockPGSMatchesDantzig)
+{
+  using namespace dart::constraint;
+
+  WorldPtr dantzigWorld = createSlidingBoxWorld(nullptr);
+  ASSERT_NE(dynamic_cast<DantzigLCPSolver*>(
+              dantzigWorld->getConstraintSolver()->getLCPSolver()), nullptr);
+
+  // The friction pyramid is the friction model of the Dantzig solver
+  BlockPGSLCPSolver* lcpSolver = new BlockPGSLCPSolver(0.001);
+  lcpSolver->setFrictionModel(BlockPGSLCPSolver::FRICTION_PYRAMID);
+  lcpSolver->setMaxIterations(100000);
+  lcpSolver->setTolerance(1e-7);
+  WorldPtr pgsWorld = createSlidingBoxWorld(lcpSolver);
+
+  dantzigWorld->step();
+  pgsWorld->step();
+
+  // The iteration stops once the impulses have converged
+  EXPECT_GT(lcpSolver->getNumIterations(), 1u);
+  EXPECT_LT(lcpSolver->getNumIterations(), lcpSolver->getMaxIterations());
+  EXPECT_LE(lcpSolver->getMaxImpulseChange(), lcpSolver->getTolerance());
+
+  const Eigen::VectorXd expected
+      = dantzigWorld->getSkeleton(1)->getVelocities();
+  const Eigen::VectorXd actual = pgsWorld->getSkeleton(1)->getVelocities();
+  EXPECT_TRUE(equals(expected, actual, 1e-6));
+
+  // Without a tolerance, every solve runs up to the maximum number of sweeps
+  lcpSolver->setMaxIterations(3);
+  lcpSolver->setTolerance(0.0);
+  pgsWorld->step();
+  EXPECT_EQ(lcpSolver->getNumIterations(), 3u);
+  EXPECT_GT(lcpSolver->getMaxImpulseChange(), 0.0);
+}
+
+//==============================================================================
+TEST_F(ConstraintTest, BilateralRowElimination)
+{
+  WorldPtr reduced = createClosedLoopWorld(true);
+  WorldPtr full = createClosedLoopWorld(false);
+
+  const Vector3d boxPin(5.1, 0.2, 0.1);
+  BodyNode* box = reduced->getSkeleton(1)->getBodyNode(0);
+  const Vector3d boxPinLocal = box->getWorldTransform().inverse() * boxPin;
+
+  for (size_t i = 0; i < 200; ++i)
+  {
+    reduced->step();
+    full->step();
+
+    for (size_t j = 1; j < reduced->getNumSkeletons(); ++j)
+    {
+      const SkeletonPtr skelReduced = reduced->getSkeleton(j);
+      const SkeletonPtr skelFull = full->getSkeleton(j);
+      EXPECT_TRUE(equals(skelReduced->getPositions(),
+                         skelFull->getPositions(), 1e-6));
+      EXPECT_TRUE(equals(skelReduced->getVelocities(),
+                         skelFull->getVelocities(), 1e-6));
+    }
+  }
+
+  // The box kept spinning about its pin and the pin held
+  EXPECT_GT(std::abs(reduced->getSkeleton(1)->getVelocity(1)), 0.1);
+  EXPECT_NEAR((box->getWorldTransform() * boxPinLocal - boxPin).norm(), 0.0,
+              1e-2);
+}
+
+//==============================================================================
+TEST_F(ConstraintTest, ContactManifoldReduction)
+{
+  using namespace dart::collision;
+  using namespace dart::constraint;
+
+  WorldPtr world(new World);
+  world->setGravity(Vector3d(0.0, -10.0, 0.0));
+  world->setTimeStep(0.001);
+
+  ConstraintSolver* cs = world->getConstraintSolver();
+  cs->setCollisionDetector(new DARTCollisionDetector());
+  EXPECT_EQ(cs->getMaxNumContactsPerPair(), 0u);
+  cs->setMaxNumContactsPerPair(4);
+
+  SkeletonPtr ground = createGround(Vector3d(10.0, 0.1, 10.0),
+                                    Vector3d(0.0, -0.05, 0.0));
+  ground->setMobile(false);
+  world->addSkeleton(ground);
+
+  // A plate made of a 3x3 grid of boxes, which produces 36 contacts with the
+  // ground without reduction
+  const double size = 0.1;
+  SkeletonPtr plate = createObject(Vector3d(0.0, 0.5 * size, 0.0));
+  BodyNode* bn = plate->getBodyNode(0);
+  for (int i = -1; i <= 1; ++i)
+  {
+    for (int j = -1; j <= 1; ++j)
+    {
+      std::shared_ptr<Shape> shape(new BoxShape(Vector3d::Constant(size)));
+      shape->setOffset(Vector3d(i * size, 0.0, j * size));
+      bn->addCollisionShape(shape);
+    }
+  }
+  world->addSkeleton(plate);
+
+  CollisionDetector* cd = cs->getCollisionDetector();
+  for (size_t i = 0; i < 500; ++i)
+  {
+    world->step();
+    EXPECT_LE(cd->getNumContacts(), 4u);
+  }
+
+  // The reduced manifold spans the whole plate, so it stays level
+  EXPECT_NEAR(bn->getWorldTransform().translation()[1], 0.5 * size, 1e-2);
+  const Eigen::Matrix3d R = bn->getWorldTransform().linear();
+  EXPECT_TRUE(equals(R, Eigen::Matrix3d::Identity().eval(), 1e-3));
+  EXPECT_NEAR(bn->getLinearVelocity().norm(), 0.0, 1e-2);
+
+  // Without reduction every contact is kept
+  cs->setMaxNumContactsPerPair(0);
+  world->step();
+  EXPECT_GT(cd->getNumContacts(), 4u);
+}
+
 //==============================================================================
 int main(int argc, char* argv[])
 {
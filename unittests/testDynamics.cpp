@@ -43,11 +43,19 @@
 #include "TestHelpers.h"
 
 #include "dart/common/Console.h"
+#include "dart/common/Timer.h"
 #include "dart/math/Geometry.h"
 #include "dart/math/Helpers.h"
+#include "dart/dynamics/ArticulatedBodyModel.h"
+#include "dart/dynamics/BallJoint.h"
 #include "dart/dynamics/BodyNode.h"
+#include "dart/dynamics/EulerJoint.h"
+#include "dart/dynamics/FreeJoint.h"
+#include "dart/dynamics/PrismaticJoint.h"
+#include "dart/dynamics/RevoluteJoint.h"
 #include "dart/dynamics/Skeleton.h"
 #include "dart/dynamics/SimpleFrame.h"
+#include "dart/dynamics/WeldJoint.h"
 #include "dart/simulation/World.h"
 #include "dart/utils/SkelParser.h"
 
@@ -106,6 +114,13 @@ public:
   // Test if the com acceleration is equal to the gravity
   void testCenterOfMassFreeFall(const std::string& _fileName);
 
+  // Test the centroidal momentum matrix and its velocity product term
+  void testCentroidalMomentum(const std::string& _fileName);
+
+  // Test the operational-space inertia, the dynamically consistent inverse and
+  // the null-space projector against their dense definitions
+  void testOperationalSpace(const std::string& _fileName);
+
   //
   void testConstraintImpulse(const std::string& _fileName);
 
@@ -1564,6 +1579,236 @@ void DynamicsTest::testCenterOfMass(const std::string& _fileName)
   }
 }
 
+//==============================================================================
+void compareCentroidalMomentumToOracle(const SkeletonPtr& skel,
+                                       const Frame* refFrame,
+                                       double tolerance)
+{
+  // Sum the Jacobians of the individual BodyNodes
+  const size_t dof = skel->getNumDofs();
+  const Vector3d com = skel->getCOM();
+  math::Jacobian comJacOracle = math::Jacobian::Zero(6, dof);
+  math::Jacobian momentumOracle = math::Jacobian::Zero(6, dof);
+  for (size_t i = 0; i < skel->getNumBodyNodes(); ++i)
+  {
+    const BodyNode* bn = skel->getBodyNode(i);
+    const math::Jacobian bnJ = bn->getMass()
+        * bn->getJacobian(bn->getLocalCOM(), refFrame);
+    const math::Jacobian bnP = bn->getSpatialInertia() * bn->getJacobian();
+    const Isometry3d& T = bn->getWorldTransform();
+
+    for (size_t j = 0; j < bn->getNumDependentGenCoords(); ++j)
+    {
+      const size_t index = bn->getDependentGenCoordIndex(j);
+      comJacOracle.col(index) += bnJ.col(j);
+
+      const Vector3d l = T.linear() * bnP.col(j).tail<3>();
+      momentumOracle.col(index).head<3>() += T.linear() * bnP.col(j).head<3>()
+                                           + (T.translation() - com).cross(l);
+      momentumOracle.col(index).tail<3>() += l;
+    }
+  }
+  comJacOracle /= skel->getMass();
+  momentumOracle = math::AdRInvJac(refFrame->getWorldTransform(),
+                                   momentumOracle);
+
+  math::Jacobian comJac = skel->getCOMJacobian(refFrame);
+  bool comJacEqual = equals(comJacOracle, comJac, tolerance);
+  EXPECT_TRUE(comJacEqual);
+  if (!comJacEqual)
+    printComparisonError("COM Jacobian", skel->getName(),
+                         refFrame->getName(), comJacOracle, comJac);
+
+  math::LinearJacobian comLinearJac = skel->getCOMLinearJacobian(refFrame);
+  bool comLinearJacEqual = equals(
+        math::LinearJacobian(comJacOracle.bottomRows<3>()), comLinearJac,
+        tolerance);
+  EXPECT_TRUE(comLinearJacEqual);
+
+  math::Jacobian momentum = skel->getCentroidalMomentumMatrix(refFrame);
+  bool momentumEqual = equals(momentumOracle, momentum, tolerance);
+  EXPECT_TRUE(momentumEqual);
+  if (!momentumEqual)
+    printComparisonError("centroidal momentum matrix", skel->getName(),
+                         refFrame->getName(), momentumOracle, momentum);
+}
+
+//==============================================================================
+void DynamicsTest::testCentroidalMomentum(const std::string& _fileName)
+{
+  //---------------------------- Settings --------------------------------------
+  // Number of random state tests for each skeletons
+#ifndef NDEBUG  // Debug mode
+  size_t nRandomItr = 2;
+#else
+  size_t nRandomItr = 20;
+#endif
+
+  // Lower and upper bound of configuration for system
+  double lb = -1.5 * DART_PI;
+  double ub =  1.5 * DART_PI;
+
+  // Step size of the central differences
+  const double eps = 1e-6;
+
+  //----------------------------- Tests ----------------------------------------
+  simulation::WorldPtr myWorld = utils::SkelParser::readWorld(_fileName);
+  EXPECT_TRUE(myWorld != nullptr);
+
+  for (size_t i = 0; i < myWorld->getNumSkeletons(); ++i)
+  {
+    SkeletonPtr skeleton = myWorld->getSkeleton(i);
+
+    size_t dof = skeleton->getNumDofs();
+    if (dof == 0 || skeleton->getMass() == 0.0)
+      continue;
+
+    for (size_t j = 0; j < nRandomItr; ++j)
+    {
+      VectorXd q  = VectorXd(dof);
+      VectorXd dq = VectorXd(dof);
+      for (size_t k = 0; k < dof; ++k)
+      {
+        q[k]  = math::random(lb, ub);
+        dq[k] = math::random(lb, ub);
+      }
+      skeleton->setPositions(q);
+      skeleton->setVelocities(dq);
+
+      randomizeRefFrames();
+
+      compareCentroidalMomentumToOracle(skeleton, Frame::World(), 1e-6);
+
+      for (size_t r = 0; r < refFrames.size(); ++r)
+        compareCentroidalMomentumToOracle(skeleton, refFrames[r], 1e-6);
+
+      // The velocity product term is the rate of change of the centroidal
+      // momentum while the generalized velocities are kept constant
+      Vector6d bias = skeleton->getCentroidalMomentumBias();
+
+      skeleton->integratePositions(eps);
+      Vector6d momentumNext = skeleton->getCentroidalMomentumMatrix() * dq;
+      skeleton->setPositions(q);
+      skeleton->integratePositions(-eps);
+      Vector6d momentumPrev = skeleton->getCentroidalMomentumMatrix() * dq;
+      skeleton->setPositions(q);
+
+      Vector6d biasFd = (momentumNext - momentumPrev) / (2.0 * eps);
+      bool biasEqual = equals(bias, biasFd, 1e-4 * (1.0 + bias.norm()));
+      EXPECT_TRUE(biasEqual);
+      if (!biasEqual)
+        printComparisonError("centroidal momentum bias", skeleton->getName(),
+                             Frame::World()->getName(), biasFd, bias);
+    }
+  }
+}
+
+//==============================================================================
+void compareOperationalSpaceToDense(
+    const SkeletonPtr& skel,
+    const std::vector<const dynamics::JacobianNode*>& nodes,
+    const std::vector<Vector3d>& offsets,
+    bool linearOnly)
+{
+  MatrixXd J;
+  if (linearOnly)
+    skel->getWorldLinearJacobians(nodes, offsets, J);
+  else
+    skel->getWorldJacobians(nodes, offsets, J);
+
+  const MatrixXd invM = skel->getMassMatrix().inverse();
+  const MatrixXd invLambdaDense = J * invM * J.transpose();
+
+  const MatrixXd& invLambda
+      = skel->getInvOperationalSpaceInertia(nodes, offsets, linearOnly);
+  const double tol = 1e-8 * (1.0 + invLambdaDense.norm());
+  bool invLambdaEqual = equals(invLambdaDense, invLambda, tol);
+  EXPECT_TRUE(invLambdaEqual);
+  if (!invLambdaEqual)
+    printComparisonError("inverse operational-space inertia", skel->getName(),
+                         "World", invLambdaDense, invLambda);
+
+  // The rest is only defined for tasks that are not singular
+  SelfAdjointEigenSolver<MatrixXd> eig(invLambdaDense);
+  if (eig.eigenvalues().minCoeff() < 1e-4 * eig.eigenvalues().maxCoeff())
+    return;
+
+  const MatrixXd lambdaDense = invLambdaDense.inverse();
+  const MatrixXd& lambda
+      = skel->getOperationalSpaceInertia(nodes, offsets, linearOnly);
+  EXPECT_TRUE(equals(lambdaDense, lambda, 1e-6 * (1.0 + lambdaDense.norm())));
+
+  const MatrixXd JbarDense = invM * J.transpose() * lambdaDense;
+  const MatrixXd& Jbar
+      = skel->getDynamicallyConsistentInverse(nodes, offsets, linearOnly);
+  EXPECT_TRUE(equals(JbarDense, Jbar, 1e-6 * (1.0 + JbarDense.norm())));
+  EXPECT_TRUE(equals(MatrixXd(J * Jbar),
+                     MatrixXd(MatrixXd::Identity(J.rows(), J.rows())), 1e-6));
+
+  // Generalized forces in the null space must not accelerate the task
+  const MatrixXd& N = skel->getNullSpaceProjector(nodes, offsets, linearOnly);
+  const MatrixXd NDense = MatrixXd::Identity(skel->getNumDofs(),
+                                             skel->getNumDofs())
+                          - J.transpose() * JbarDense.transpose();
+  EXPECT_TRUE(equals(NDense, N, 1e-6 * (1.0 + NDense.norm())));
+  EXPECT_TRUE(equals(MatrixXd(J * invM * N),
+                     MatrixXd(MatrixXd::Zero(J.rows(), skel->getNumDofs())),
+                     1e-6 * (1.0 + J.norm() * invM.norm())));
+}
+
+//==============================================================================
+void DynamicsTest::testOperationalSpace(const std::string& _fileName)
+{
+  //---------------------------- Settings --------------------------------------
+  // Number of random state tests for each skeletons
+#ifndef NDEBUG  // Debug mode
+  size_t nRandomItr = 2;
+#else
+  size_t nRandomItr = 20;
+#endif
+
+  // Lower and upper bound of configuration for system
+  double lb = -1.5 * DART_PI;
+  double ub =  1.5 * DART_PI;
+
+  //----------------------------- Tests ----------------------------------------
+  simulation::WorldPtr myWorld = utils::SkelParser::readWorld(_fileName);
+  EXPECT_TRUE(myWorld != nullptr);
+
+  for (size_t i = 0; i < myWorld->getNumSkeletons(); ++i)
+  {
+    SkeletonPtr skeleton = myWorld->getSkeleton(i);
+
+    size_t dof = skeleton->getNumDofs();
+    if (dof == 0 || !skeleton->isMobile())
+      continue;
+
+    // Use the last BodyNode and, if there is one, a BodyNode in the middle
+    std::vector<const dynamics::JacobianNode*> nodes;
+    const size_t numBodies = skeleton->getNumBodyNodes();
+    nodes.push_back(skeleton->getBodyNode(numBodies - 1));
+    if (numBodies > 2)
+      nodes.push_back(skeleton->getBodyNode(numBodies / 2));
+
+    for (size_t j = 0; j < nRandomItr; ++j)
+    {
+      VectorXd q = VectorXd(dof);
+      for (size_t k = 0; k < dof; ++k)
+        q[k] = math::random(lb, ub);
+      skeleton->setPositions(q);
+
+      std::vector<Vector3d> offsets;
+      for (size_t k = 0; k < nodes.size(); ++k)
+        offsets.push_back(Vector3d::Random());
+
+      compareOperationalSpaceToDense(skeleton, nodes, offsets, false);
+      compareOperationalSpaceToDense(skeleton, nodes, offsets, true);
+      compareOperationalSpaceToDense(skeleton, nodes,
+                                     std::vector<Vector3d>(), true);
+    }
+  }
+}
+
 //==============================================================================
 void compareCOMAccelerationToGravity(SkeletonPtr skel,
                                      const Eigen::Vector3d& gravity,
@@ -1999,6 +2244,133 @@ TEST_F(DynamicsTest, testCenterOfMassFreeFall)
   }
 }
 
+//==============================================================================
+TEST_F(DynamicsTest, testCentroidalMomentum)
+{
+  for (size_t i = 0; i < getList().size(); ++i)
+  {
+#ifndef NDEBUG
+    dtdbg << getList()[i] << std::endl;
+#endif
+    testCentroidalMomentum(getList()[i]);
+  }
+}
+
+//==============================================================================
+TEST_F(DynamicsTest, testOperationalSpace)
+{
+  for (size_t i = 0; i < getList().size(); ++i)
+  {
+#ifndef NDEBUG
+    dtdbg << getList()[i] << std::endl;
+#endif
+    testOperationalSpace(getList()[i]);
+  }
+}
+
+//==============================================================================
+TEST_F(DynamicsTest, OperationalSpaceEndEffector)
+{
+  // Chain of ball joints with an EndEffector at its tip
+  SkeletonPtr skel = Skeleton::create("chain");
+  BodyNode* bn = nullptr;
+  for (size_t i = 0; i < 4; ++i)
+  {
+    BallJoint::Properties properties;
+    if (bn)
+      properties.mT_ParentBodyToJoint.translation() = Vector3d(0.0, 0.0, 0.5);
+    bn = skel->createJointAndBodyNodePair<BallJoint>(bn, properties).second;
+  }
+  EndEffector* ee = bn->createEndEffector("ee");
+  skel->setPositions(VectorXd::Random(skel->getNumDofs()));
+
+  std::vector<const dynamics::JacobianNode*> nodes;
+  nodes.push_back(ee);
+  const std::vector<Vector3d> offsets;
+  compareOperationalSpaceToDense(skel, nodes, offsets, false);
+
+  // Moving the EndEffector changes the task without changing the
+  // configuration
+  Eigen::Isometry3d tf = Eigen::Isometry3d::Identity();
+  tf.translation() = Vector3d(0.3, -0.2, 0.4);
+  tf.linear() = math::expMapRot(Vector3d(0.2, 0.5, -0.1));
+  ee->setRelativeTransform(tf);
+  compareOperationalSpaceToDense(skel, nodes, offsets, false);
+  compareOperationalSpaceToDense(skel, nodes, offsets, true);
+
+  ee->setRelativeTransform(Eigen::Isometry3d::Identity());
+  compareOperationalSpaceToDense(skel, nodes, offsets, true);
+}
+
+//==============================================================================
+TEST_F(DynamicsTest, OperationalSpaceBenchmark)
+{
+#ifndef NDEBUG  // Debug mode
+  const size_t numLinks = 10;
+  const size_t testCount = 10;
+#else
+  const size_t numLinks = 50;
+  const size_t testCount = 200;
+#endif
+
+  // Chain of ball joints
+  SkeletonPtr skel = Skeleton::create("chain");
+  BodyNode* bn = nullptr;
+  for (size_t i = 0; i < numLinks; ++i)
+  {
+    BallJoint::Properties properties;
+    if (bn)
+      properties.mT_ParentBodyToJoint.translation() = Vector3d(0.0, 0.0, 0.5);
+    bn = skel->createJointAndBodyNodePair<BallJoint>(bn, properties).second;
+  }
+  const size_t dof = skel->getNumDofs();
+
+  std::vector<const dynamics::JacobianNode*> nodes;
+  nodes.push_back(skel->getBodyNode(numLinks - 1));
+  nodes.push_back(skel->getBodyNode(numLinks / 2));
+
+  const std::vector<Vector3d> offsets;
+  std::vector<VectorXd> positions;
+  for (size_t i = 0; i < testCount; ++i)
+    positions.push_back(VectorXd::Random(dof));
+
+  // Recursive operational-space inertia and dynamically consistent inverse
+  MatrixXd lambda;
+  MatrixXd Jbar;
+  common::Timer recursiveTimer("Operational space - recursive");
+  recursiveTimer.start();
+  for (size_t i = 0; i < testCount; ++i)
+  {
+    skel->setPositions(positions[i]);
+    lambda = skel->getOperationalSpaceInertia(nodes, offsets, true);
+    Jbar = skel->getDynamicallyConsistentInverse(nodes, offsets, true);
+  }
+  recursiveTimer.stop();
+
+  // Dense operational-space inertia and dynamically consistent inverse
+  MatrixXd J;
+  MatrixXd lambdaDense;
+  MatrixXd JbarDense;
+  common::Timer denseTimer("Operational space - dense");
+  denseTimer.start();
+  for (size_t i = 0; i < testCount; ++i)
+  {
+    skel->setPositions(positions[i]);
+    skel->getWorldLinearJacobians(nodes, offsets, J);
+    const MatrixXd& invM = skel->getInvMassMatrix();
+    const MatrixXd invMJt = invM * J.transpose();
+    lambdaDense = (J * invMJt).inverse();
+    JbarDense = invMJt * lambdaDense;
+  }
+  denseTimer.stop();
+
+  recursiveTimer.print();
+  denseTimer.print();
+
+  EXPECT_TRUE(equals(lambdaDense, lambda, 1e-6 * (1.0 + lambdaDense.norm())));
+  EXPECT_TRUE(equals(JbarDense, Jbar, 1e-6 * (1.0 + JbarDense.norm())));
+}
+
 //==============================================================================
 TEST_F(DynamicsTest, testConstraintImpulse)
 {
@@ -2132,6 +2504,229 @@ TEST_F(DynamicsTest, HybridDynamics)
   }
 }
 
+//==============================================================================
+SkeletonPtr createArticulatedBodyModelTestSkeleton()
+{
+  SkeletonPtr skel = Skeleton::create("articulated body model");
+
+  BodyNode* root = skel->createJointAndBodyNodePair<FreeJoint>().second;
+  BodyNode* bn = skel->createJointAndBodyNodePair<RevoluteJoint>(root).second;
+  bn = skel->createJointAndBodyNodePair<BallJoint>(bn).second;
+  bn = skel->createJointAndBodyNodePair<WeldJoint>(bn).second;
+  skel->createJointAndBodyNodePair<PrismaticJoint>(bn);
+  bn = skel->createJointAndBodyNodePair<PrismaticJoint>(root).second;
+  skel->createJointAndBodyNodePair<RevoluteJoint>(bn);
+
+  for(size_t i=0; i < skel->getNumBodyNodes(); ++i)
+  {
+    bn = skel->getBodyNode(i);
+    bn->setMass(0.5 + 0.25*i);
+    bn->setMomentOfInertia(0.1 + 0.01*i, 0.2, 0.15, 0.01, 0.02, -0.01);
+    bn->setLocalCOM(0.1*Eigen::Vector3d::Random());
+
+    Joint* joint = bn->getParentJoint();
+    joint->setTransformFromParentBodyNode(
+          math::expMap(0.5*Eigen::Vector6d::Random()));
+    joint->setTransformFromChildBodyNode(
+          math::expMap(0.5*Eigen::Vector6d::Random()));
+
+    if(RevoluteJoint* revolute = dynamic_cast<RevoluteJoint*>(joint))
+      revolute->setAxis(Eigen::Vector3d::Random().normalized());
+    else if(PrismaticJoint* prismatic = dynamic_cast<PrismaticJoint*>(joint))
+      prismatic->setAxis(Eigen::Vector3d::Random().normalized());
+
+    for(size_t j=0; j < joint->getNumDofs(); ++j)
+    {
+      joint->setDampingCoefficient(j, 0.1*i);
+      joint->setSpringStiffness(j, 0.5);
+      joint->setRestPosition(j, 0.1);
+    }
+  }
+
+  skel->getBodyNode(2)->setGravityMode(false);
+
+  return skel;
+}
+
+//==============================================================================
+TEST(ArticulatedBodyModel, CompareToSkeleton)
+{
+  SkeletonPtr skel = createArticulatedBodyModelTestSkeleton();
+  const size_t numDofs = skel->getNumDofs();
+  const size_t numBodyNodes = skel->getNumBodyNodes();
+  const double dt = skel->getTimeStep();
+
+  ArticulatedBodyModeld model(*skel);
+  EXPECT_TRUE(model.isValid());
+  EXPECT_EQ(model.getNumDofs(), numDofs);
+  EXPECT_EQ(model.getNumBodyNodes(), numBodyNodes);
+
+  const size_t numStates = 5;
+  const Eigen::MatrixXd positions = Eigen::MatrixXd::Random(numDofs, numStates);
+  const Eigen::MatrixXd velocities
+      = Eigen::MatrixXd::Random(numDofs, numStates);
+  const Eigen::MatrixXd forces = Eigen::MatrixXd::Random(numDofs, numStates);
+
+  Eigen::aligned_vector<Eigen::Isometry3d> batchTransforms;
+  model.computeForwardKinematics(positions, batchTransforms);
+  ASSERT_EQ(batchTransforms.size(), numStates*numBodyNodes);
+
+  const Eigen::MatrixXd batchAccelerations
+      = model.computeForwardDynamics(positions, velocities, forces);
+
+  for(size_t k=0; k < numStates; ++k)
+  {
+    Eigen::VectorXd q = positions.col(k);
+    Eigen::VectorXd dq = velocities.col(k);
+    const Eigen::VectorXd tau = forces.col(k);
+
+    skel->setPositions(q);
+    skel->setVelocities(dq);
+    skel->setForces(tau);
+    skel->computeForwardDynamics();
+
+    Eigen::aligned_vector<Eigen::Isometry3d> transforms;
+    model.computeForwardKinematics(q, transforms);
+    ASSERT_EQ(transforms.size(), numBodyNodes);
+    for(size_t i=0; i < numBodyNodes; ++i)
+    {
+      const Eigen::Matrix4d expected
+          = skel->getBodyNode(i)->getWorldTransform().matrix();
+      EXPECT_TRUE(equals(transforms[i].matrix(), expected, 1e-10));
+      EXPECT_TRUE(equals(batchTransforms[k*numBodyNodes + i].matrix(),
+                         expected, 1e-10));
+    }
+
+    const Eigen::VectorXd ddq = model.computeForwardDynamics(q, dq, tau);
+    EXPECT_TRUE(equals(ddq, skel->getAccelerations(), 1e-9));
+    EXPECT_TRUE(equals(Eigen::VectorXd(batchAccelerations.col(k)), ddq, 0.0));
+
+    // One semi-implicit Euler step
+    skel->integrateVelocities(dt);
+    skel->integratePositions(dt);
+    model.integrate(q, dq, tau);
+    EXPECT_TRUE(equals(dq, skel->getVelocities(), 1e-9));
+    EXPECT_TRUE(equals(q, skel->getPositions(), 1e-9));
+  }
+
+  // Unsupported joints make the model invalid
+  skel->getBodyNode(1)->changeParentJointType<EulerJoint>();
+  EXPECT_FALSE(ArticulatedBodyModeld(*skel).isValid());
+}
+
+//==============================================================================
+TEST(ArticulatedBodyModel, SinglePrecisionDrift)
+{
+  const size_t numBodyNodes = 10;
+  SkeletonPtr skel = createNLinkPendulum(
+        numBodyNodes, Eigen::Vector3d(0.1, 0.1, 0.3), DOF_ROLL,
+        Eigen::Vector3d(0.0, 0.0, 0.15));
+  skel->setPositions(Eigen::VectorXd::Constant(numBodyNodes, 0.3));
+  const size_t numDofs = skel->getNumDofs();
+  const double dt = skel->getTimeStep();
+
+  ArticulatedBodyModeld modeld(*skel);
+  ArticulatedBodyModelf modelf(*skel);
+  EXPECT_TRUE(modelf.isValid());
+  EXPECT_EQ(modelf.getTimeStep(), static_cast<float>(dt));
+
+  Eigen::VectorXd qd = skel->getPositions();
+  Eigen::VectorXd dqd = Eigen::VectorXd::Zero(numDofs);
+  const Eigen::VectorXd taud = Eigen::VectorXd::Zero(numDofs);
+
+  Eigen::VectorXf qf = qd.cast<float>();
+  Eigen::VectorXf dqf = dqd.cast<float>();
+  const Eigen::VectorXf tauf = taud.cast<float>();
+
+  // A batch of identical states must follow the single state exactly
+  const size_t numStates = 4;
+  Eigen::MatrixXf Qf = qf.replicate(1, numStates);
+  Eigen::MatrixXf DQf = dqf.replicate(1, numStates);
+  const Eigen::MatrixXf TAUf = tauf.replicate(1, numStates);
+
+  // Simulate 5 seconds of the damped pendulum swinging under gravity
+  const size_t numSteps = 5000;
+  double maxPositionError = 0.0;
+  for(size_t i=0; i < numSteps; ++i)
+  {
+    skel->computeForwardDynamics();
+    skel->integrateVelocities(dt);
+    skel->integratePositions(dt);
+
+    modeld.integrate(qd, dqd, taud);
+    modelf.integrate(qf, dqf, tauf);
+    modelf.integrate(Qf, DQf, TAUf);
+
+    // The double precision model follows the Skeleton up to round-off
+    EXPECT_TRUE(equals(qd, skel->getPositions(), 1e-8));
+
+    maxPositionError = std::max(
+          maxPositionError, (qf.cast<double>() - qd).cwiseAbs().maxCoeff());
+  }
+
+  for(size_t k=0; k < numStates; ++k)
+  {
+    EXPECT_TRUE(equals(Eigen::VectorXf(Qf.col(k)), qf, 0.0));
+    EXPECT_TRUE(equals(Eigen::VectorXf(DQf.col(k)), dqf, 0.0));
+  }
+
+  // The single precision model drifts, but stays close to the double
+  // precision one over the whole simulation
+  dtmsg << "Maximum position error of the single precision model after "
+        << numSteps << " steps: " << maxPositionError << "\n";
+  EXPECT_LT(maxPositionError, 1e-3);
+}
+
+//==============================================================================
+TEST(Skeleton, TrajectoryInverseDynamics)
+{
+  SkeletonPtr skel = createArticulatedBodyModelTestSkeleton();
+  const size_t numDofs = skel->getNumDofs();
+  const size_t numSamples = 101;
+
+  skel->getBodyNode(3)->addExtForce(Eigen::Vector3d(0.1, -0.2, 0.3),
+                                    Eigen::Vector3d(0.0, 0.05, 0.0));
+  skel->getBodyNode(5)->addExtTorque(Eigen::Vector3d(-0.3, 0.1, 0.2));
+
+  const Eigen::MatrixXd positions
+      = Eigen::MatrixXd::Random(numDofs, numSamples);
+  const Eigen::MatrixXd velocities
+      = Eigen::MatrixXd::Random(numDofs, numSamples);
+  const Eigen::MatrixXd accelerations
+      = Eigen::MatrixXd::Random(numDofs, numSamples);
+
+  const Eigen::VectorXd originalPositions = skel->getPositions();
+
+  const Eigen::MatrixXd forces1 = skel->computeInverseDynamics(
+        positions, velocities, accelerations, true, true, true, 1);
+  const Eigen::MatrixXd forces4 = skel->computeInverseDynamics(
+        positions, velocities, accelerations, true, true, true, 4);
+  const Eigen::MatrixXd forcesNoExt = skel->computeInverseDynamics(
+        positions, velocities, accelerations);
+
+  // The Skeleton itself must not have been touched
+  EXPECT_TRUE(equals(skel->getPositions(), originalPositions, 0.0));
+
+  ASSERT_EQ(static_cast<size_t>(forces1.cols()), numSamples);
+  ASSERT_EQ(static_cast<size_t>(forces4.cols()), numSamples);
+  EXPECT_TRUE(equals(forces1, forces4, 0.0));
+
+  for(size_t i=0; i < numSamples; ++i)
+  {
+    skel->setPositions(positions.col(i));
+    skel->setVelocities(velocities.col(i));
+    skel->setAccelerations(accelerations.col(i));
+
+    skel->computeInverseDynamics(true, true, true);
+    EXPECT_TRUE(equals(Eigen::VectorXd(forces1.col(i)), skel->getForces(),
+                       1e-12));
+
+    skel->computeInverseDynamics();
+    EXPECT_TRUE(equals(Eigen::VectorXd(forcesNoExt.col(i)), skel->getForces(),
+                       1e-12));
+  }
+}
+
 //==============================================================================
 int main(int argc, char* argv[])
 {
@@ -599,6 +599,55 @@ TEST(LIE_GROUP_OPERATORS, ADJOINT_MAPPINGS)
     }
 }
 
+/******************************************************************************/
+TEST(GEOMETRY, CONVEX_HULL_3D)
+{
+  // Corners of a box with interior points and duplicated corners
+  std::vector<Eigen::Vector3d> points;
+  for (int i = 0; i < 8; ++i)
+  {
+    const Eigen::Vector3d corner((i & 1) ? 1.0 : -1.0,
+                                 (i & 2) ? 2.0 : -2.0,
+                                 (i & 4) ? 0.5 : -0.5);
+    points.push_back(corner);
+    points.push_back(corner);
+  }
+  for (int i = 0; i < 100; ++i)
+    points.push_back(0.4 * Eigen::Vector3d::Random());
+
+  std::vector<Eigen::Vector3i> triangles;
+  std::vector<Eigen::Vector3d> hull = computeConvexHull3D(points, &triangles);
+  EXPECT_EQ(hull.size(), 8u);
+  EXPECT_EQ(triangles.size(), 12u);
+
+  // Points on a sphere are all hull vertices, and the hull is a closed
+  // polyhedron whose faces point outwards
+  points.clear();
+  for (int i = 0; i < 200; ++i)
+    points.push_back(Eigen::Vector3d::Random().normalized());
+
+  hull = computeConvexHull3D(points, &triangles);
+  EXPECT_EQ(hull.size(), points.size());
+  EXPECT_EQ(hull.size() - 3 * triangles.size() / 2 + triangles.size(), 2u);
+
+  for (const Eigen::Vector3i& triangle : triangles)
+  {
+    const Eigen::Vector3d& a = hull[triangle[0]];
+    const Eigen::Vector3d normal
+        = (hull[triangle[1]] - a).cross(hull[triangle[2]] - a).normalized();
+    EXPECT_GT(normal.dot(a), 0.0);
+    for (const Eigen::Vector3d& point : points)
+      EXPECT_LE(normal.dot(point - a), 1e-9);
+  }
+
+  // Coplanar points do not span a volume
+  points.clear();
+  for (int i = 0; i < 10; ++i)
+    points.push_back(Eigen::Vector3d(i, i * i, 0.0));
+  EXPECT_TRUE(computeConvexHull3D(points, &triangles).empty());
+  EXPECT_TRUE(triangles.empty());
+}
+
 /******************************************************************************/
 int main(int argc, char* argv[])
 {
@@ -85,6 +85,53 @@ SkeletonPtr createFreeFloatingTwoLinkRobot(Vector3d dim1,
   return robot;
 }
 
+//==============================================================================
+TEST(InverseKinematics, SolveBatch)
+{
+  const size_t numTargets = 20;
+
+  SkeletonPtr robot = createNLinkRobot(4, Vector3d(0.3, 0.3, 1.0), DOF_ROLL,
+                                       true);
+  BodyNode* ee = robot->getBodyNode("ee");
+  const std::shared_ptr<InverseKinematics>& ik = ee->getIK(true);
+  ik->getErrorMethod().setAngularBounds(
+        Eigen::Vector3d::Constant(-std::numeric_limits<double>::infinity()),
+        Eigen::Vector3d::Constant( std::numeric_limits<double>::infinity()));
+
+  // Start away from the singular, fully stretched configuration
+  robot->setPositions(Eigen::VectorXd::Constant(robot->getNumDofs(), 0.3));
+
+  // Generate a sequence of reachable targets along a path in joint space
+  const Eigen::VectorXd originalPositions = robot->getPositions();
+  Eigen::aligned_vector<Eigen::Isometry3d> targets;
+  for(size_t i=0; i < numTargets; ++i)
+  {
+    robot->setPositions(
+          Eigen::VectorXd::Constant(robot->getNumDofs(), 0.3 + 0.02*(i+1)));
+    targets.push_back(ee->getWorldTransform());
+  }
+  robot->setPositions(originalPositions);
+
+  std::vector<Eigen::VectorXd> solutions;
+  std::vector<bool> successes;
+  const size_t numSolved = ik->solveBatch(targets, solutions, successes, 3);
+
+  EXPECT_EQ(numSolved, numTargets);
+  ASSERT_EQ(solutions.size(), numTargets);
+  ASSERT_EQ(successes.size(), numTargets);
+
+  // The original Skeleton must not have been touched by the batch
+  EXPECT_TRUE(equals(robot->getPositions(), originalPositions));
+
+  for(size_t i=0; i < numTargets; ++i)
+  {
+    EXPECT_TRUE(successes[i]);
+    robot->setPositions(ik->getDofs(), solutions[i]);
+    EXPECT_NEAR((ee->getWorldTransform().translation()
+                 - targets[i].translation()).norm(), 0.0, 1e-4);
+  }
+}
+
 #ifdef HAVE_NLOPT
 //==============================================================================
 //TEST(InverseKinematics, FittingTransformation)
@@ -35,12 +35,19 @@
  */
 
 #include <iostream>
+#include <limits>
 #include <gtest/gtest.h>
 #include "TestHelpers.h"
 
 #include "dart/common/Timer.h"
 #include "dart/math/Geometry.h"
 #include "dart/math/Helpers.h"
+#include "dart/math/SpatialAlgebra.h"
+#include "dart/lcpsolver/lcp.h"
+#include "dart/lcpsolver/matrix.h"
+#include "dart/collision/dart/DARTCollisionDetector.h"
+#include "dart/constraint/ConstraintSolver.h"
+#include "dart/constraint/DantzigLCPSolver.h"
 #include "dart/dynamics/RevoluteJoint.h"
 #include "dart/dynamics/Skeleton.h"
 #include "dart/simulation/World.h"
@@ -1299,6 +1306,396 @@ TEST(MATH, PerformanceComparisonOfAdTJac)
   //       function for fixed size Jacobian is AdTJac3
 }
 
+//==============================================================================
+// Record the contact LCPs of a few steps of two stacks of boxes
+std::vector<constraint::LCPRecord> recordContactLCPs()
+{
+  WorldPtr world(new World);
+  world->setTimeStep(0.001);
+  world->getConstraintSolver()->setCollisionDetector(
+        new collision::DARTCollisionDetector());
+
+  constraint::DantzigLCPSolver* lcpSolver
+      = dynamic_cast<constraint::DantzigLCPSolver*>(
+        world->getConstraintSolver()->getLCPSolver());
+  lcpSolver->setRecordingEnabled(true);
+
+  world->addSkeleton(createGround(Eigen::Vector3d(10.0, 10.0, 0.1),
+                                  Eigen::Vector3d(0.0, 0.0, -0.05)));
+  for (size_t i = 0; i < 2; ++i)
+  {
+    for (size_t j = 0; j < 1 + i; ++j)
+    {
+      SkeletonPtr box = createBox(Eigen::Vector3d::Constant(0.2),
+                                  Eigen::Vector3d(i * 1.0, 0.05 * j,
+                                                  0.0999 + 0.1999 * j),
+                                  Eigen::Vector3d(0.0, 0.0, 0.3 * j));
+      box->setVelocities(0.1 * Eigen::VectorXd::Random(6));
+      world->addSkeleton(box);
+    }
+  }
+
+  std::vector<constraint::LCPRecord> records;
+  for (size_t i = 0; i < 3; ++i)
+  {
+    world->step();
+    records.insert(records.end(), lcpSolver->getRecords().begin(),
+                   lcpSolver->getRecords().end());
+  }
+
+  return records;
+}
+
+//==============================================================================
+// Check the LDLT factorization, the LDLT solve and the dot product of every
+// SIMD level against the scalar kernels for a symmetric positive definite A
+void checkSIMDKernels(const Eigen::MatrixXd& A, const Eigen::VectorXd& b)
+{
+  const int maxLevel = _dGetMaxSIMDLevel();
+  const int n = static_cast<int>(A.rows());
+  const int nskip = dPAD(n);
+
+  std::vector<dReal> Aref(n * nskip, 0.0);
+  for (int i = 0; i < n; ++i)
+    for (int j = 0; j < n; ++j)
+      Aref[i * nskip + j] = A(i, j);
+
+  std::vector<dReal> Lref(Aref);
+  std::vector<dReal> dref(n);
+  _dFactorLDLTScalar(Lref.data(), dref.data(), n, nskip);
+  std::vector<dReal> xref(b.data(), b.data() + n);
+  _dSolveL1Scalar(Lref.data(), xref.data(), n, nskip);
+  for (int i = 0; i < n; ++i)
+    xref[i] *= dref[i];
+  _dSolveL1TScalar(Lref.data(), xref.data(), n, nskip);
+  const dReal dotref = _dDotScalar(Aref.data(), b.data(), n);
+
+  // The scalar path has to solve A*x = b
+  Eigen::Map<Eigen::VectorXd> xrefMap(xref.data(), n);
+  EXPECT_TRUE((A * xrefMap - b).norm() < 1e-9 * (1.0 + b.norm()));
+
+  // The kernels only differ in the order of the summations, whose rounding
+  // errors are amplified by the condition number of A
+  const Eigen::VectorXd sv
+      = Eigen::JacobiSVD<Eigen::MatrixXd>(A).singularValues();
+  const double tol = 1e-12 + 1e-14 * (sv[0] / sv[n - 1]);
+  for (int level = dSIMD_NONE; level <= maxLevel; ++level)
+  {
+    EXPECT_EQ(_dSetSIMDLevel(level), level);
+
+    std::vector<dReal> L(Aref);
+    std::vector<dReal> d(n);
+    dFactorLDLT(L.data(), d.data(), n, nskip);
+    for (int i = 0; i < n; ++i)
+    {
+      EXPECT_NEAR(d[i], dref[i], tol * std::abs(dref[i]));
+      for (int j = 0; j < i; ++j)
+        EXPECT_NEAR(L[i * nskip + j], Lref[i * nskip + j], tol);
+    }
+
+    std::vector<dReal> x(b.data(), b.data() + n);
+    dSolveLDLT(L.data(), d.data(), x.data(), n, nskip);
+    for (int i = 0; i < n; ++i)
+      EXPECT_NEAR(x[i], xref[i], tol * xrefMap.cwiseAbs().maxCoeff());
+
+    EXPECT_NEAR(dDot(Aref.data(), b.data(), n), dotref,
+                1e-10 * (1.0 + std::abs(dotref)));
+  }
+}
+
+//==============================================================================
+TEST(MATH, LCPSolverSIMDKernels)
+{
+  const int maxLevel = _dGetMaxSIMDLevel();
+  const int origLevel = _dGetSIMDLevel();
+
+  for (int n : {1, 3, 8, 13, 31, 64})
+  {
+    // Random symmetric positive definite matrix
+    Eigen::MatrixXd M = Eigen::MatrixXd::Random(n, n);
+    Eigen::MatrixXd A = M * M.transpose()
+        + static_cast<double>(n) * Eigen::MatrixXd::Identity(n, n);
+    checkSIMDKernels(A, Eigen::VectorXd::Random(n));
+  }
+
+  // Recorded contact LCPs, whose matrices are badly conditioned and only
+  // regularized by the constraint force mixing
+  const std::vector<constraint::LCPRecord> records = recordContactLCPs();
+  ASSERT_FALSE(records.empty());
+  for (const constraint::LCPRecord& record : records)
+  {
+    ASSERT_TRUE(record.mIsValid);
+    checkSIMDKernels(record.mA, record.mB);
+
+    // The whole LCP solve has to agree between the SIMD levels
+    const int n = static_cast<int>(record.mA.rows());
+    const int nskip = dPAD(n);
+    Eigen::VectorXd xref;
+    for (int level = dSIMD_NONE; level <= maxLevel; ++level)
+    {
+      _dSetSIMDLevel(level);
+
+      std::vector<dReal> A(n * nskip, 0.0);
+      for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+          A[i * nskip + j] = record.mA(i, j);
+      Eigen::VectorXd b = record.mB;
+      Eigen::VectorXd lo = record.mLo;
+      Eigen::VectorXd hi = record.mHi;
+      std::vector<int> findex(record.mFindex);
+      Eigen::VectorXd x = Eigen::VectorXd::Zero(n);
+      Eigen::VectorXd w = Eigen::VectorXd::Zero(n);
+
+      dSolveLCP(n, A.data(), x.data(), b.data(), w.data(), 0, lo.data(),
+                hi.data(), findex.data());
+
+      if (level == dSIMD_NONE)
+      {
+        xref = x;
+        EXPECT_TRUE(equals(x, record.mX, 1e-9));
+      }
+      else
+      {
+        EXPECT_TRUE(equals(x, xref, 1e-9));
+      }
+    }
+  }
+
+  _dSetSIMDLevel(origLevel);
+}
+
+//==============================================================================
+/// Random rigid transform whose bottom row is filled with NaN on purpose,
+/// since neither the portable nor the SIMD kernels may depend on it
+Isometry3d randomTransform()
+{
+  Isometry3d T;
+  T.linear() = expMapRot(Vector3d::Random() * DART_PI);
+  T.translation() = Vector3d::Random();
+  T.matrix().row(3).setConstant(std::numeric_limits<double>::quiet_NaN());
+  return T;
+}
+
+//==============================================================================
+/// Random symmetric spatial inertia
+Matrix6d randomInertia()
+{
+  Matrix6d A = Matrix6d::Random();
+  return A * A.transpose() + Matrix6d::Identity();
+}
+
+//==============================================================================
+TEST(MATH, SpatialAlgebraSIMDKernels)
+{
+  const SimdLevel maxLevel = getMaxSimdLevel();
+  const SimdLevel origLevel = getSimdLevel();
+  const double tol = 1e-12;
+
+  for (int i = 0; i < 1000; ++i)
+  {
+    const Isometry3d T = randomTransform();
+    const Vector6d V = Vector6d::Random();
+    const Vector6d W = Vector6d::Random();
+    const Matrix6d I = randomInertia();
+    const Jacobian J = Jacobian::Random(6, i % 8);
+    // Rotation vectors on both sides of the small angle branch of expMap
+    const Vector6d S = (i % 2 == 0) ? Vector6d(Vector6d::Random())
+                                    : Vector6d(1e-9 * Vector6d::Random());
+
+    EXPECT_EQ(setSimdLevel(SimdLevel::NONE), SimdLevel::NONE);
+    const Vector6d AdTRef = AdT(T, V);
+    const Vector6d AdInvTRef = AdInvT(T, V);
+    const Vector6d dAdInvTRef = dAdInvT(T, V);
+    const Vector6d adRef = ad(V, W);
+    const Vector6d dadRef = dad(V, W);
+    const Matrix6d inertiaRef = transformInertia(T, I);
+    const Jacobian AdTJacRef = AdTJac(T, J);
+    const Isometry3d expMapRef = expMap(S);
+
+    // The portable implementations against the matrix forms
+    const Matrix6d AdTMatrix = getAdTMatrix(T);
+    EXPECT_TRUE(equals(AdTRef, Vector6d(AdTMatrix * V), tol));
+    EXPECT_TRUE(equals(inertiaRef,
+                       Matrix6d(AdTMatrix.transpose() * I * AdTMatrix), 1e-10));
+
+    for (int level = static_cast<int>(SimdLevel::NONE);
+         level <= static_cast<int>(maxLevel); ++level)
+    {
+      EXPECT_EQ(setSimdLevel(static_cast<SimdLevel>(level)),
+                static_cast<SimdLevel>(level));
+
+      EXPECT_TRUE(equals(AdT(T, V), AdTRef, tol));
+      EXPECT_TRUE(equals(AdInvT(T, V), AdInvTRef, tol));
+      EXPECT_TRUE(equals(dAdInvT(T, V), dAdInvTRef, tol));
+      EXPECT_TRUE(equals(ad(V, W), adRef, tol));
+      EXPECT_TRUE(equals(dad(V, W), dadRef, tol));
+      EXPECT_TRUE(equals(AdTJac(T, J), AdTJacRef, tol));
+      if (J.cols() > 0)
+      {
+        // Block argument
+        EXPECT_TRUE(equals(Vector6d(AdTJac(T, J.col(0))),
+                           Vector6d(AdTJacRef.col(0)), tol));
+      }
+
+      const Matrix6d inertia = transformInertia(T, I);
+      EXPECT_TRUE(equals(inertia, inertiaRef, 1e-10));
+      EXPECT_TRUE(equals(inertia, Matrix6d(inertia.transpose()), 0.0));
+
+      const Isometry3d E = expMap(S);
+      EXPECT_TRUE(equals(E.matrix(), expMapRef.matrix(), tol));
+      EXPECT_TRUE(E.matrix().row(3) == Vector4d(0, 0, 0, 1).transpose());
+    }
+  }
+
+  setSimdLevel(origLevel);
+}
+
+//==============================================================================
+TEST(MATH, TemplatedSpatialAlgebra)
+{
+  for (int i = 0; i < 1000; ++i)
+  {
+    const Isometry3d T = randomTransform();
+    const Vector6d V = Vector6d::Random();
+    const Vector6d W = Vector6d::Random();
+    const Matrix6d I = randomInertia();
+    // Rotation vectors on both sides of the small angle branch of expMapRot
+    const Vector3d q = (i % 2 == 0) ? Vector3d(Vector3d::Random())
+                                    : Vector3d(1e-5 * Vector3d::Random());
+
+    // The double precision instantiations against Geometry.h
+    EXPECT_TRUE(equals(AdT<double>(T, V), AdT(T, V), 1e-12));
+    EXPECT_TRUE(equals(AdInvT<double>(T, V), AdInvT(T, V), 1e-12));
+    EXPECT_TRUE(equals(dAdInvT<double>(T, V), dAdInvT(T, V), 1e-12));
+    EXPECT_TRUE(equals(ad<double>(V, W), ad(V, W), 1e-12));
+    EXPECT_TRUE(equals(dad<double>(V, W), dad(V, W), 1e-12));
+    EXPECT_TRUE(equals(transformInertia<double>(T, I),
+                       transformInertia(T, I), 1e-10));
+    EXPECT_TRUE(equals(expMapRot<double>(q), expMapRot(q), 1e-12));
+    EXPECT_TRUE(equals(logMap<double>(expMapRot(q)), q, 1e-9));
+
+    // The single precision instantiations only lose precision
+    const Isometry3f Tf = T.cast<float>();
+    const math::Vector6<float> Vf = V.cast<float>();
+    const math::Vector6<float> Wf = W.cast<float>();
+    EXPECT_TRUE(equals(Vector6d(AdT<float>(Tf, Vf).cast<double>()),
+                       AdT(T, V), 1e-4));
+    EXPECT_TRUE(equals(Vector6d(AdInvT<float>(Tf, Vf).cast<double>()),
+                       AdInvT(T, V), 1e-4));
+    EXPECT_TRUE(equals(Vector6d(ad<float>(Vf, Wf).cast<double>()),
+                       ad(V, W), 1e-4));
+    EXPECT_TRUE(equals(Vector6d(dad<float>(Vf, Wf).cast<double>()),
+                       dad(V, W), 1e-4));
+    EXPECT_TRUE(equals(
+        Matrix6d(transformInertia<float>(Tf, I.cast<float>()).cast<double>()),
+        transformInertia(T, I), 1e-3));
+    EXPECT_TRUE(equals(
+        Matrix3d(expMapRot<float>(q.cast<float>()).cast<double>()),
+        expMapRot(q), 1e-5));
+  }
+}
+
+//==============================================================================
+TEST(MATH, PerformanceComparisonOfSpatialAlgebraKernels)
+{
+#ifndef NDEBUG
+  const int testCount = 1e+1;
+#else
+  const int testCount = 1e+3;
+#endif
+  const int n = 1000;
+
+  const SimdLevel origLevel = getSimdLevel();
+
+  // Independent inputs, as in a pass over the bodies of a skeleton
+  std::vector<Isometry3d, Eigen::aligned_allocator<Isometry3d>> T(n);
+  std::vector<Vector6d, Eigen::aligned_allocator<Vector6d>> V(n);
+  std::vector<Vector6d, Eigen::aligned_allocator<Vector6d>> W(n);
+  std::vector<Matrix6d, Eigen::aligned_allocator<Matrix6d>> I(n);
+  std::vector<Matrix6d, Eigen::aligned_allocator<Matrix6d>> AI(n);
+  std::vector<Jacobian> J(n, Jacobian::Random(6, 6));
+  for (int i = 0; i < n; ++i)
+  {
+    T[i] = expMap(Vector6d::Random());
+    V[i] = Vector6d::Random();
+    I[i] = randomInertia();
+  }
+
+  for (int level = static_cast<int>(SimdLevel::NONE);
+       level <= static_cast<int>(getMaxSimdLevel()); ++level)
+  {
+    setSimdLevel(static_cast<SimdLevel>(level));
+    const std::string name = level == 0 ? " - portable" : " - SIMD";
+
+    Timer tAdT("AdT" + name);
+    tAdT.start();
+    for (int k = 0; k < testCount; ++k)
+      for (int i = 0; i < n; ++i)
+        W[i] = AdT(T[i], V[i]);
+    tAdT.stop();
+
+    Timer tAdInvT("AdInvT" + name);
+    tAdInvT.start();
+    for (int k = 0; k < testCount; ++k)
+      for (int i = 0; i < n; ++i)
+        W[i] = AdInvT(T[i], V[i]);
+    tAdInvT.stop();
+
+    Timer tdAdInvT("dAdInvT" + name);
+    tdAdInvT.start();
+    for (int k = 0; k < testCount; ++k)
+      for (int i = 0; i < n; ++i)
+        W[i] = dAdInvT(T[i], V[i]);
+    tdAdInvT.stop();
+
+    Timer tad("ad" + name);
+    tad.start();
+    for (int k = 0; k < testCount; ++k)
+      for (int i = 0; i < n; ++i)
+        W[i] = ad(V[i], V[n - 1 - i]);
+    tad.stop();
+
+    Timer tdad("dad" + name);
+    tdad.start();
+    for (int k = 0; k < testCount; ++k)
+      for (int i = 0; i < n; ++i)
+        W[i] = dad(V[i], V[n - 1 - i]);
+    tdad.stop();
+
+    Timer tInertia("transformInertia" + name);
+    tInertia.start();
+    for (int k = 0; k < testCount; ++k)
+      for (int i = 0; i < n; ++i)
+        AI[i] = transformInertia(T[i], I[i]);
+    tInertia.stop();
+
+    Timer tJac("AdTJac (6 columns)" + name);
+    tJac.start();
+    for (int k = 0; k < testCount; ++k)
+      for (int i = 0; i < n; ++i)
+        J[i] = AdTJac(T[i], J[n - 1 - i]);
+    tJac.stop();
+
+    Timer tExp("expMap" + name);
+    tExp.start();
+    for (int k = 0; k < testCount; ++k)
+      for (int i = 0; i < n; ++i)
+        T[i] = expMap(V[i]);
+    tExp.stop();
+
+    tAdT.print();
+    tAdInvT.print();
+    tdAdInvT.print();
+    tad.print();
+    tdad.print();
+    tInertia.print();
+    tJac.print();
+    tExp.print();
+  }
+
+  setSimdLevel(origLevel);
+}
+
 //==============================================================================
 int main(int argc, char* argv[])
 {
@@ -178,6 +178,43 @@ TEST(Signal, ConnectionLifeTime)
   EXPECT_FALSE(connection1.isConnected());
 }
 
+//==============================================================================
+TEST(Signal, ConnectionsChangedWhileRaising)
+{
+  Signal<void(int)> signal;
+  callCount1 = 0;
+
+  // A slot that disconnects itself the first time it is called
+  Connection selfDisconnecting;
+  selfDisconnecting = signal.connect(
+        [&](int) { callCount1++; selfDisconnecting.disconnect(); });
+
+  // A slot that connects another slot the first time it is called
+  bool connected = false;
+  signal.connect([&](int)
+  {
+    if (!connected)
+    {
+      signal.connect(foo1);
+      connected = true;
+    }
+  });
+  EXPECT_EQ(static_cast<int>(signal.getNumConnections()), 2);
+
+  signal.raise(0);
+  EXPECT_EQ(static_cast<int>(signal.getNumConnections()), 2);
+  EXPECT_FALSE(selfDisconnecting.isConnected());
+
+  callCount1 = 0;
+  signal.raise(0);
+  EXPECT_EQ(callCount1, 1);
+
+  signal.disconnectAll();
+  EXPECT_EQ(static_cast<int>(signal.getNumConnections()), 0);
+  signal.raise(0);
+  EXPECT_EQ(callCount1, 1);
+}
+
 //==============================================================================
 float product(float x, float y) { return x * y; }
 float quotient(float x, float y) { return x / y; }
@@ -331,6 +368,41 @@ TEST(Signal, FrameSignals)
   F3.setParentFrame(&F1);
 }
 
+//==============================================================================
+TEST(Signal, FrameUpdateSignals)
+{
+  SimpleFrame F1(Frame::World(), "F1");
+  SimpleFrame F2(&F1, "F2");
+
+  int parentCount = 0;
+  int childCount = 0;
+  ScopedConnection c1(F1.onTransformUpdated.connect(
+                        [&](const Entity*) { ++parentCount; }));
+  ScopedConnection c2(F2.onTransformUpdated.connect(
+                        [&](const Entity*) { ++childCount; }));
+
+  F2.getWorldTransform();
+
+  Isometry3d tf(Isometry3d::Identity());
+  tf.translate(Vector3d(0.1, 0.0, 0.0));
+  F1.setRelativeTransform(tf);
+  EXPECT_EQ(parentCount, 1);
+  EXPECT_EQ(childCount, 1);
+
+  // Every direct change is announced, since subscribers may depend on the
+  // relative transform, but the children are only notified once until they
+  // have been updated
+  F1.setRelativeTransform(tf);
+  F1.setRelativeTransform(tf);
+  EXPECT_EQ(parentCount, 3);
+  EXPECT_EQ(childCount, 1);
+
+  F2.getWorldTransform();
+  F1.setRelativeTransform(tf);
+  EXPECT_EQ(parentCount, 4);
+  EXPECT_EQ(childCount, 2);
+}
+
 //==============================================================================
 int main(int argc, char* argv[])
 {
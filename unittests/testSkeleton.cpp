@@ -41,7 +41,9 @@
 #include "dart/common/sub_ptr.h"
 #include "dart/math/Geometry.h"
 #include "dart/utils/SkelParser.h"
+#include "dart/dynamics/BallJoint.h"
 #include "dart/dynamics/BodyNode.h"
+#include "dart/dynamics/PrismaticJoint.h"
 #include "dart/dynamics/RevoluteJoint.h"
 #include "dart/dynamics/Skeleton.h"
 #include "dart/simulation/World.h"
@@ -1044,6 +1046,127 @@ TEST(Skeleton, Group)
     EXPECT_EQ(group->getDof(i), dofs[i]);
 }
 
+TEST(Skeleton, WorldJacobians)
+{
+  SkeletonPtr skel = constructLinkageTestSkeleton();
+  SkeletonPtr skel2 = constructLinkageTestSkeleton();
+  skel2->getRootBodyNode()->moveTo(skel, nullptr);
+
+  for(size_t i=0; i < skel->getNumJoints(); ++i)
+  {
+    Eigen::Isometry3d tf = Eigen::Isometry3d::Identity();
+    tf.translation() = Eigen::Vector3d::Random();
+    tf.linear() = math::expMapRot(Eigen::Vector3d::Random());
+    skel->getJoint(i)->setTransformFromParentBodyNode(tf);
+  }
+
+  std::vector<const JacobianNode*> nodes;
+  std::vector<Eigen::Vector3d> offsets;
+  for(size_t i=0; i < skel->getNumBodyNodes(); i += 3)
+  {
+    BodyNode* bn = skel->getBodyNode(i);
+    nodes.push_back(bn);
+    offsets.push_back(Eigen::Vector3d::Random());
+
+    EndEffector* ee = bn->createEndEffector();
+    Eigen::Isometry3d tf = Eigen::Isometry3d::Identity();
+    tf.translation() = Eigen::Vector3d::Random();
+    ee->setDefaultRelativeTransform(tf, true);
+    nodes.push_back(ee);
+    offsets.push_back(Eigen::Vector3d::Random());
+  }
+
+  const size_t dofs = skel->getNumDofs();
+  Eigen::MatrixXd J;
+  Eigen::MatrixXd JLinear;
+  for(size_t trial=0; trial < 5; ++trial)
+  {
+    skel->setPositions(Eigen::VectorXd::Random(dofs));
+
+    // The cached World Jacobians must agree with the body Jacobians
+    for(size_t i=0; i < skel->getNumBodyNodes(); ++i)
+    {
+      const BodyNode* bn = skel->getBodyNode(i);
+      EXPECT_TRUE(equals(bn->getWorldJacobian(),
+          math::AdRJac(bn->getWorldTransform(), bn->getJacobian())));
+    }
+
+    skel->getWorldJacobians(nodes, offsets, J);
+    skel->getWorldLinearJacobians(nodes, offsets, JLinear);
+    ASSERT_EQ(static_cast<size_t>(J.rows()), 6*nodes.size());
+    ASSERT_EQ(static_cast<size_t>(J.cols()), dofs);
+    ASSERT_EQ(static_cast<size_t>(JLinear.rows()), 3*nodes.size());
+
+    for(size_t i=0; i < nodes.size(); ++i)
+    {
+      const JacobianNode* node = nodes[i];
+      const math::Jacobian nodeJ = node->getWorldJacobian(offsets[i]);
+      EXPECT_TRUE(equals(nodeJ, math::AdRJac(node->getWorldTransform(),
+                                             node->getJacobian(offsets[i]))));
+
+      Eigen::MatrixXd expected = Eigen::MatrixXd::Zero(6, dofs);
+      for(size_t j=0; j < node->getNumDependentGenCoords(); ++j)
+        expected.col(node->getDependentGenCoordIndex(j)) = nodeJ.col(j);
+
+      EXPECT_TRUE(equals(expected, Eigen::MatrixXd(J.block(6*i, 0, 6, dofs))));
+      EXPECT_TRUE(equals(Eigen::MatrixXd(expected.bottomRows<3>()),
+                         Eigen::MatrixXd(JLinear.block(3*i, 0, 3, dofs))));
+    }
+  }
+}
+
+void checkDynamicsProgram(const SkeletonPtr& skel)
+{
+  const size_t dofs = skel->getNumDofs();
+  for(size_t trial=0; trial < 3; ++trial)
+  {
+    skel->setPositions(Eigen::VectorXd::Random(dofs));
+    skel->setVelocities(Eigen::VectorXd::Random(dofs));
+    skel->setForces(Eigen::VectorXd::Random(dofs));
+
+    skel->setDynamicsProgramEnabled(false);
+    skel->computeForwardDynamics();
+    const Eigen::VectorXd expectedAcc = skel->getAccelerations();
+    const Eigen::MatrixXd expectedInvM = skel->getInvMassMatrix();
+
+    // Resetting the positions invalidates the articulated inertias
+    skel->setDynamicsProgramEnabled(true);
+    skel->setPositions(skel->getPositions());
+    skel->computeForwardDynamics();
+    EXPECT_TRUE(equals(expectedAcc, skel->getAccelerations(), 1e-9));
+    EXPECT_TRUE(equals(expectedInvM, skel->getInvMassMatrix(), 1e-9));
+  }
+}
+
+TEST(Skeleton, DynamicsProgram)
+{
+  std::vector<SkeletonPtr> skeletons = getSkeletons();
+  WorldPtr softWorld =
+      utils::SkelParser::readWorld(DART_DATA_PATH"skel/softBodies.skel");
+  for(size_t i=0; i < softWorld->getNumSkeletons(); ++i)
+    skeletons.push_back(softWorld->getSkeleton(i));
+
+  for(const SkeletonPtr& skel : skeletons)
+    checkDynamicsProgram(skel);
+
+  // Changes of structure must be picked up by the program
+  SkeletonPtr skel = constructLinkageTestSkeleton();
+  checkDynamicsProgram(skel);
+
+  skel->getBodyNode("c3b1")->changeParentJointType<BallJoint>();
+  skel->getBodyNode("c4b2")->changeParentJointType<PrismaticJoint>();
+  skel->getBodyNode("c5b1")->changeParentJointType<WeldJoint>();
+  checkDynamicsProgram(skel);
+
+  skel->getBodyNode("c3b3")->remove();
+  checkDynamicsProgram(skel);
+
+  SkeletonPtr other = constructLinkageTestSkeleton();
+  other->getBodyNode("c1b3")->moveTo(skel->getBodyNode("c2b3"));
+  checkDynamicsProgram(skel);
+  checkDynamicsProgram(other);
+}
+
 int main(int argc, char* argv[])
 {
   ::testing::InitGoogleTest(&argc, argv);
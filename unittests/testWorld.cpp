@@ -42,9 +42,15 @@
 #include "dart/math/Geometry.h"
 #include "dart/utils/SkelParser.h"
 #include "dart/dynamics/BodyNode.h"
+#include "dart/dynamics/PrismaticJoint.h"
 #include "dart/dynamics/RevoluteJoint.h"
+#include "dart/dynamics/ScrewJoint.h"
 #include "dart/dynamics/Skeleton.h"
 #include "dart/simulation/World.h"
+#include "dart/collision/dart/DARTCollisionDetector.h"
+#include "dart/constraint/BallJointConstraint.h"
+#include "dart/constraint/ConstraintSolver.h"
+#include "dart/constraint/DantzigLCPSolver.h"
 
 using namespace dart;
 using namespace math;
@@ -259,6 +265,442 @@ TEST(World, Cloning)
   }
 }
 
+//==============================================================================
+Eigen::MatrixXd computeStepJacobian(WorldPtr _world, SkeletonPtr _skeleton,
+                                    bool _wrtForces)
+{
+  const double eps = 1e-6;
+  const size_t numDofs = _skeleton->getNumDofs();
+  const World::State state = _world->getState();
+
+  Eigen::MatrixXd jacobian(2*numDofs, _wrtForces ? numDofs : 2*numDofs);
+  for(int j=0; j < jacobian.cols(); ++j)
+  {
+    Eigen::VectorXd next[2];
+    for(size_t s=0; s < 2; ++s)
+    {
+      const double delta = (s == 0) ? eps : -eps;
+      _world->setState(state);
+
+      if(_wrtForces)
+        _skeleton->setForce(j, _skeleton->getForce(j) + delta);
+      else if(static_cast<size_t>(j) < numDofs)
+        _skeleton->setPosition(j, _skeleton->getPosition(j) + delta);
+      else
+        _skeleton->setVelocity(j - numDofs,
+                               _skeleton->getVelocity(j - numDofs) + delta);
+
+      _world->step();
+
+      next[s].resize(2*numDofs);
+      next[s] << _skeleton->getPositions(), _skeleton->getVelocities();
+    }
+
+    jacobian.col(j) = (next[0] - next[1]) / (2.0*eps);
+  }
+
+  _world->setState(state);
+
+  return jacobian;
+}
+
+//==============================================================================
+Eigen::VectorXd computeStepFrictionDerivative(WorldPtr _world,
+                                              SkeletonPtr _skeleton)
+{
+  const double eps = 1e-6;
+  const World::State state = _world->getState();
+
+  std::vector<BodyNode*> bodyNodes;
+  std::vector<double> frictionCoeffs;
+  for(size_t i=0; i < _world->getNumSkeletons(); ++i)
+  {
+    SkeletonPtr skel = _world->getSkeleton(i);
+    for(size_t k=0; k < skel->getNumBodyNodes(); ++k)
+    {
+      bodyNodes.push_back(skel->getBodyNode(k));
+      frictionCoeffs.push_back(skel->getBodyNode(k)->getFrictionCoeff());
+    }
+  }
+
+  Eigen::VectorXd next[2];
+  for(size_t s=0; s < 2; ++s)
+  {
+    const double delta = (s == 0) ? eps : -eps;
+    _world->setState(state);
+    for(size_t k=0; k < bodyNodes.size(); ++k)
+      bodyNodes[k]->setFrictionCoeff(frictionCoeffs[k] + delta);
+
+    _world->step();
+
+    next[s].resize(2*_skeleton->getNumDofs());
+    next[s] << _skeleton->getPositions(), _skeleton->getVelocities();
+  }
+
+  for(size_t k=0; k < bodyNodes.size(); ++k)
+    bodyNodes[k]->setFrictionCoeff(frictionCoeffs[k]);
+  _world->setState(state);
+
+  return (next[0] - next[1]) / (2.0*eps);
+}
+
+//==============================================================================
+TEST(World, AnalyticLinearization)
+{
+  // A branching tree of single-dof joints with springs, dampers and an
+  // external force, without collision shapes
+  SkeletonPtr skel = Skeleton::create();
+  Eigen::Isometry3d offset(Eigen::Translation3d(0.05, -0.1, -0.3));
+
+  BodyNode* root = skel->createJointAndBodyNodePair<RevoluteJoint>().second;
+  BodyNode* bn = root;
+  for(size_t i=0; i < 3; ++i)
+  {
+    auto pair = skel->createJointAndBodyNodePair<PrismaticJoint>(bn);
+    pair.first->setAxis(Eigen::Vector3d(0.3, 1.0, -0.2).normalized());
+    pair.first->setTransformFromParentBodyNode(offset);
+    bn = pair.second;
+
+    RevoluteJoint* revolute
+        = skel->createJointAndBodyNodePair<RevoluteJoint>(bn).first;
+    revolute->setAxis(Eigen::Vector3d(1.0, 0.2, 0.5).normalized());
+    revolute->setTransformFromParentBodyNode(offset);
+    bn = revolute->getChildBodyNode();
+  }
+
+  auto screw = skel->createJointAndBodyNodePair<ScrewJoint>(root);
+  screw.first->setAxis(Eigen::Vector3d::UnitY());
+  screw.first->setPitch(0.4);
+  screw.first->setTransformFromChildBodyNode(offset);
+  skel->createJointAndBodyNodePair<RevoluteJoint>(screw.second).first
+      ->setTransformFromParentBodyNode(offset.inverse());
+
+  for(size_t i=0; i < skel->getNumBodyNodes(); ++i)
+  {
+    BodyNode* bodyNode = skel->getBodyNode(i);
+    bodyNode->setMass(0.5 + 0.1*i);
+    bodyNode->setLocalCOM(Eigen::Vector3d(0.01*i, -0.02, 0.1));
+    bodyNode->setMomentOfInertia(0.01, 0.02 + 0.001*i, 0.015, 0.001, 0.0, 0.0);
+  }
+
+  for(size_t i=0; i < skel->getNumDofs(); ++i)
+  {
+    skel->getDof(i)->setDampingCoefficient(0.1*i);
+    skel->getDof(i)->setSpringStiffness(0.5*(i%3));
+    skel->getDof(i)->setRestPosition(0.1);
+  }
+  skel->getBodyNode(4)->setGravityMode(false);
+
+  WorldPtr world(new World);
+  world->setTimeStep(0.002);
+  world->addSkeleton(skel);
+
+  ASSERT_TRUE(skel->hasAnalyticDynamicsDerivatives());
+
+  for(size_t trial=0; trial < 5; ++trial)
+  {
+    const size_t numDofs = skel->getNumDofs();
+    skel->setPositions(Eigen::VectorXd::Random(numDofs));
+    skel->setVelocities(Eigen::VectorXd::Random(numDofs));
+    skel->setForces(Eigen::VectorXd::Random(numDofs));
+    skel->getBodyNode(5)->setExtForce(Eigen::Vector3d(0.2, -0.5, 0.3),
+                                      Eigen::Vector3d(0.0, 0.1, 0.0));
+    const Eigen::VectorXd positions = skel->getPositions();
+
+    Eigen::MatrixXd A;
+    Eigen::MatrixXd B;
+    EXPECT_EQ(world->linearize(skel, A, B), World::ANALYTIC_DERIVATIVES);
+    EXPECT_TRUE(equals(skel->getPositions(), positions, 0.0));
+
+    const Eigen::MatrixXd expectedA = computeStepJacobian(world, skel, false);
+    const Eigen::MatrixXd expectedB = computeStepJacobian(world, skel, true);
+
+    EXPECT_TRUE(equals(A, expectedA, 1e-7));
+    EXPECT_TRUE(equals(B, expectedB, 1e-7));
+  }
+
+  // Errors are not mistaken for either method
+  Eigen::MatrixXd A;
+  Eigen::MatrixXd B;
+  SkeletonPtr other = skel->clone();
+  EXPECT_EQ(world->linearize(other, A, B), World::LINEARIZATION_FAILED);
+
+  SkeletonPtr empty = Skeleton::create("empty");
+  world->addSkeleton(empty);
+  EXPECT_EQ(world->linearize(empty, A, B), World::LINEARIZATION_FAILED);
+}
+
+//==============================================================================
+TEST(World, LinearizationWithContact)
+{
+  WorldPtr world(new World);
+  world->addSkeleton(createGround(Eigen::Vector3d(10.0, 10.0, 0.1)));
+
+  // The box penetrates the ground slightly
+  SkeletonPtr box = createBox(Eigen::Vector3d(0.2, 0.2, 0.2),
+                              Eigen::Vector3d(0.0, 0.0, 0.149));
+  world->addSkeleton(box);
+  box->setVelocities(Eigen::VectorXd::Random(6));
+
+  const World::State state = world->getState();
+
+  Eigen::MatrixXd A1;
+  Eigen::MatrixXd B1;
+  Eigen::MatrixXd A4;
+  Eigen::MatrixXd B4;
+  EXPECT_EQ(world->linearize(box, A1, B1, 1), World::FINITE_DIFFERENCES);
+  EXPECT_EQ(world->linearize(box, A4, B4, 4), World::FINITE_DIFFERENCES);
+
+  // The state must have been restored
+  EXPECT_EQ(world->getTime(), state.mTime);
+  EXPECT_TRUE(equals(box->getPositions(), state.mPositions[1], 0.0));
+  EXPECT_TRUE(equals(box->getVelocities(), state.mVelocities[1], 0.0));
+
+  EXPECT_TRUE(equals(A1, computeStepJacobian(world, box, false), 0.0));
+  EXPECT_TRUE(equals(B1, computeStepJacobian(world, box, true), 0.0));
+  EXPECT_TRUE(equals(A1, A4, 0.0));
+  EXPECT_TRUE(equals(B1, B4, 0.0));
+}
+
+//==============================================================================
+TEST(World, LinearizationThroughContact)
+{
+  WorldPtr world(new World);
+  world->addSkeleton(createGround(Eigen::Vector3d(10.0, 10.0, 0.1)));
+
+  // A box that translates and yaws on a chain of single-dof joints so that
+  // the dynamics derivatives are available analytically
+  SkeletonPtr box = Skeleton::create();
+  BodyNode* bn = nullptr;
+  for(size_t i=0; i < 3; ++i)
+  {
+    auto pair = box->createJointAndBodyNodePair<PrismaticJoint>(bn);
+    pair.first->setAxis(Eigen::Vector3d::Unit(i));
+    pair.second->setMass(0.1);
+    bn = pair.second;
+  }
+  auto yaw = box->createJointAndBodyNodePair<RevoluteJoint>(bn);
+  yaw.first->setAxis(Eigen::Vector3d::UnitZ());
+  yaw.second->setMass(2.0);
+  yaw.second->setMomentOfInertia(0.02, 0.03, 0.04);
+  std::shared_ptr<Shape> shape(new BoxShape(Eigen::Vector3d(0.3, 0.2, 0.2)));
+  yaw.second->addCollisionShape(shape);
+  world->addSkeleton(box);
+  world->getConstraintSolver()->setCollisionDetector(
+        new collision::DARTCollisionDetector());
+
+  constraint::DantzigLCPSolver* lcpSolver
+      = dynamic_cast<constraint::DantzigLCPSolver*>(
+        world->getConstraintSolver()->getLCPSolver());
+  ASSERT_NE(lcpSolver, nullptr);
+  ASSERT_TRUE(box->hasAnalyticDynamicsDerivatives());
+
+  Eigen::MatrixXd A;
+  Eigen::MatrixXd B;
+  Eigen::VectorXd dNextdFriction;
+
+  // The box penetrates the ground slightly
+  box->setPositions(Eigen::Vector4d(0.1, -0.2, 0.149, 0.3));
+  box->setVelocities(Eigen::Vector4d(0.01, -0.02, -0.05, 0.03));
+  box->setForces(Eigen::Vector4d(1.0, 0.5, 0.0, 0.1));
+
+  // The contacts of the last step belong to the user, so linearize() has to
+  // restore them
+  collision::CollisionDetector* detector
+      = world->getConstraintSolver()->getCollisionDetector();
+  std::vector<collision::ContactRecord> contacts;
+  auto expectContactsRestored = [&]()
+  {
+    ASSERT_EQ(detector->getNumContacts(), contacts.size());
+    for(size_t i=0; i < contacts.size(); ++i)
+    {
+      const collision::Contact& contact = detector->getContact(i);
+      EXPECT_TRUE(equals(contact.point, contacts[i].point, 0.0));
+      EXPECT_TRUE(equals(contact.normal, contacts[i].normal, 0.0));
+      EXPECT_TRUE(equals(contact.force, contacts[i].force, 0.0));
+    }
+  };
+
+  const World::State initialState = world->getState();
+  world->step();
+  world->setState(initialState);
+  contacts = detector->getContactRecords();
+  ASSERT_FALSE(contacts.empty());
+
+  // Without recording, the contact falls back to finite differences
+  EXPECT_EQ(world->linearize(box, A, B, dNextdFriction),
+            World::FINITE_DIFFERENCES);
+  expectContactsRestored();
+  EXPECT_TRUE(equals(dNextdFriction,
+                     computeStepFrictionDerivative(world, box), 1e-8));
+
+  lcpSolver->setRecordingEnabled(true);
+  ASSERT_TRUE(lcpSolver->isRecordingEnabled());
+
+  // Sticking contacts, where every row of the LCPs is clamped, sliding
+  // contacts, where the friction rows are at their bounds, and a penetration
+  // shallow enough for the error reduction velocity not to be clamped
+  const Eigen::Vector2d cases[] = {Eigen::Vector2d(0.149, 0.0),
+                                   Eigen::Vector2d(0.149, 2.0),
+                                   Eigen::Vector2d(0.14995, 0.0)};
+  for(const Eigen::Vector2d& heightAndSpeed : cases)
+  {
+    box->setPosition(2, heightAndSpeed[0]);
+    box->setVelocity(0, 0.01 + heightAndSpeed[1]);
+    const World::State state = world->getState();
+
+    // The records of the last step belong to the user, so linearize() has to
+    // leave them alone
+    world->step();
+    world->setState(state);
+    const std::vector<constraint::LCPRecord> records = lcpSolver->getRecords();
+    ASSERT_EQ(records.size(), 1u);
+    contacts = detector->getContactRecords();
+
+    EXPECT_EQ(world->linearize(box, A, B, dNextdFriction),
+              World::ANALYTIC_DERIVATIVES);
+    ASSERT_EQ(lcpSolver->getRecords().size(), records.size());
+    EXPECT_TRUE(equals(lcpSolver->getRecords()[0].mX, records[0].mX, 0.0));
+    expectContactsRestored();
+    EXPECT_EQ(world->getTime(), state.mTime);
+    EXPECT_TRUE(equals(box->getPositions(), state.mPositions[1], 0.0));
+    EXPECT_TRUE(equals(box->getVelocities(), state.mVelocities[1], 0.0));
+
+    const Eigen::MatrixXd expectedA = computeStepJacobian(world, box, false);
+    const Eigen::MatrixXd expectedB = computeStepJacobian(world, box, true);
+
+    // The change of the contact geometry with the yaw is not differentiated
+    const Eigen::MatrixXd dNextdPos = A.leftCols(4);
+    const Eigen::MatrixXd dNextdVel = A.rightCols(4);
+    EXPECT_TRUE(equals(dNextdPos, Eigen::MatrixXd(expectedA.leftCols(4)),
+                       1e-6));
+    EXPECT_TRUE(equals(dNextdVel, Eigen::MatrixXd(expectedA.rightCols(4)),
+                       1e-8));
+    EXPECT_TRUE(equals(B, expectedB, 1e-8));
+    EXPECT_TRUE(equals(dNextdFriction,
+                       computeStepFrictionDerivative(world, box), 1e-8));
+  }
+
+  // Derivatives of the sliding impulses with respect to the friction
+  // coefficient
+  const double eps = 1e-6;
+  box->setPosition(2, 0.149);
+  box->setVelocity(0, 2.0);
+  box->getBodyNode(3)->setFrictionCoeff(0.5);
+  const World::State state = world->getState();
+
+  lcpSolver->clearRecords();
+  world->step();
+  ASSERT_EQ(lcpSolver->getRecords().size(), 1u);
+  const constraint::LCPRecord record = lcpSolver->getRecords()[0];
+  ASSERT_TRUE(record.mIsValid);
+
+  Eigen::MatrixXd dImpulsedBias;
+  Eigen::VectorXd dImpulsedFriction;
+  record.computeImpulseDerivatives(dImpulsedBias, dImpulsedFriction);
+
+  Eigen::VectorXd impulses[2];
+  for(size_t s=0; s < 2; ++s)
+  {
+    world->setState(state);
+    lcpSolver->clearRecords();
+    box->getBodyNode(3)->setFrictionCoeff(0.5 + ((s == 0) ? eps : -eps));
+    world->step();
+    ASSERT_EQ(lcpSolver->getRecords().size(), 1u);
+    impulses[s] = lcpSolver->getRecords()[0].mX;
+  }
+
+  EXPECT_TRUE(equals(dImpulsedFriction,
+                     Eigen::VectorXd((impulses[0] - impulses[1]) / (2.0*eps)),
+                     1e-6));
+
+  // Every step replaces the records of the previous one
+  world->setState(state);
+  world->step();
+  world->step();
+  EXPECT_EQ(lcpSolver->getRecords().size(), 1u);
+
+  lcpSolver->setRecordingEnabled(false);
+  lcpSolver->clearRecords();
+}
+
+//==============================================================================
+TEST(World, LinearizationThroughJointConstraints)
+{
+  // A pendulum of three links whose middle joint is past its upper limit
+  SkeletonPtr skel = Skeleton::create();
+  BodyNode* bn = nullptr;
+  for(size_t i=0; i < 3; ++i)
+  {
+    auto pair = skel->createJointAndBodyNodePair<RevoluteJoint>(bn);
+    pair.first->setAxis(Eigen::Vector3d(0.2, 1.0, 0.1*i).normalized());
+    pair.first->setTransformFromParentBodyNode(
+          Eigen::Isometry3d(Eigen::Translation3d(0.0, 0.0, -0.3)));
+    pair.second->setMass(0.5 + 0.1*i);
+    pair.second->setLocalCOM(Eigen::Vector3d(0.02, 0.0, -0.15));
+    pair.second->setMomentOfInertia(0.01, 0.02, 0.015);
+    bn = pair.second;
+  }
+  skel->getJoint(1)->setPositionLimitEnforced(true);
+  skel->getJoint(1)->setPositionUpperLimit(0, 0.3);
+
+  WorldPtr world(new World);
+  world->setTimeStep(0.002);
+  world->addSkeleton(skel);
+  world->getConstraintSolver()->setCollisionDetector(
+        new collision::DARTCollisionDetector());
+
+  constraint::DantzigLCPSolver* lcpSolver
+      = dynamic_cast<constraint::DantzigLCPSolver*>(
+        world->getConstraintSolver()->getLCPSolver());
+  ASSERT_NE(lcpSolver, nullptr);
+  ASSERT_TRUE(skel->hasAnalyticDynamicsDerivatives());
+  lcpSolver->setRecordingEnabled(true);
+
+  skel->setPositions(Eigen::Vector3d(0.2, 0.301, -0.1));
+  skel->setVelocities(Eigen::Vector3d(0.1, 0.5, -0.2));
+  skel->setForces(Eigen::Vector3d(0.1, 0.2, 0.0));
+
+  // The bias of a joint limit does not depend on the positions, so the limit
+  // is differentiated analytically
+  const World::State state = world->getState();
+  world->step();
+  world->setState(state);
+  ASSERT_EQ(lcpSolver->getRecords().size(), 1u);
+  EXPECT_TRUE(lcpSolver->getRecords()[0].mIsValid);
+
+  Eigen::MatrixXd A;
+  Eigen::MatrixXd B;
+  EXPECT_EQ(world->linearize(skel, A, B), World::ANALYTIC_DERIVATIVES);
+
+  // The change of the mass matrix with the positions is not differentiated,
+  // but the limited joint follows the bias of its row exactly
+  const Eigen::MatrixXd expectedA = computeStepJacobian(world, skel, false);
+  const Eigen::MatrixXd expectedB = computeStepJacobian(world, skel, true);
+  const Eigen::MatrixXd dNextdVel = A.rightCols(3);
+  EXPECT_TRUE(equals(dNextdVel, Eigen::MatrixXd(expectedA.rightCols(3)),
+                     1e-6));
+  EXPECT_TRUE(equals(Eigen::MatrixXd(A.row(1)),
+                     Eigen::MatrixXd(expectedA.row(1)), 1e-6));
+  EXPECT_TRUE(equals(Eigen::MatrixXd(A.row(4)),
+                     Eigen::MatrixXd(expectedA.row(4)), 1e-6));
+  EXPECT_TRUE(equals(B, expectedB, 1e-6));
+
+  // The error of a ball joint constraint is not tied to a single row, so its
+  // group falls back to finite differences
+  world->getConstraintSolver()->addConstraint(
+        std::make_shared<constraint::BallJointConstraint>(
+          skel->getBodyNode(2), skel->getBodyNode(2)->getTransform()
+          * Eigen::Vector3d(0.0, 0.0, -0.3)));
+  world->step();
+  world->setState(state);
+  ASSERT_EQ(lcpSolver->getRecords().size(), 1u);
+  EXPECT_FALSE(lcpSolver->getRecords()[0].mIsValid);
+  EXPECT_EQ(world->linearize(skel, A, B), World::FINITE_DIFFERENCES);
+
+  lcpSolver->setRecordingEnabled(false);
+}
+
 //==============================================================================
 int main(int argc, char* argv[])
 {